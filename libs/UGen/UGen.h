@@ -84,14 +84,23 @@ BEGIN_UGEN_NAMESPACE
 	#endif
 #endif
 
+#include "core/ugen_Atomic.h"
+#include "core/ugen_BlockPool.h"
+#include "core/ugen_SIMD.h"
+#include "core/ugen_ScratchBlocks.h"
 #include "core/ugen_UGen.h"
 #include "core/ugen_UGenInternal.h"
 #include "core/ugen_UGenArray.h"
 #include "core/ugen_Constants.h"
 #include "core/ugen_Random.h"
 #include "core/ugen_Bits.h"
+#include "core/ugen_LockFreeFifo.h"
+#include "core/ugen_TripleBuffer.h"
+#include "core/ugen_Thread.h"
+#include "core/ugen_BackgroundDeleter.h"
 #include "core/ugen_Value.h"
 #include "core/ugen_Arrays.h"
+#include "core/ugen_DiskStreamThread.h"
 #include "basics/ugen_ScalarUGens.h"
 #include "basics/ugen_UnaryOpUGens.h"
 #include "basics/ugen_BinaryOpUGens.h"
@@ -102,6 +111,7 @@ BEGIN_UGEN_NAMESPACE
 #include "basics/ugen_Temporary.h"
 #include "basics/ugen_Pause.h"
 #include "basics/ugen_MulAdd.h"
+#include "basics/ugen_FusedExpression.h"
 #include "basics/ugen_Thru.h"
 #include "basics/ugen_Chain.h"
 #include "basics/ugen_WrapFold.h"
@@ -109,6 +119,8 @@ BEGIN_UGEN_NAMESPACE
 #include "envelopes/ugen_Env.h"
 #include "envelopes/ugen_EnvGen.h"
 #include "buffers/ugen_Buffer.h"
+#include "buffers/ugen_AudioFile.h"
+#include "buffers/ugen_BufferCache.h"
 #include "buffers/ugen_PlayBuf.h"
 #include "oscillators/wavetable/ugen_TableOsc.h"
 #include "oscillators/simple/ugen_LFSaw.h"
@@ -145,6 +157,7 @@ BEGIN_UGEN_NAMESPACE
 
 #ifdef UGEN_HRTF
 #include "convolution/ugen_HRTF.h"
+#include "convolution/ugen_Binaural.h"
 #endif
 
 #ifndef UGEN_ANDROID
@@ -158,6 +171,8 @@ BEGIN_UGEN_NAMESPACE
 	#include "gui/ugen_Scope.h"
 	#include "fft/ugen_FFTMagnitude.h"
 	#include "fft/ugen_FFTMagnitudeSelection.h"
+	#include "fft/ugen_SpectralProcess.h"
+	#include "fft/ugen_STFT.h"
 	#include "neuralnet/ugen_NeuralNetwork.h"
 	#include "neuralnet/ugen_NeuralNetworkUGen.h"
 	#include "buffers/ugen_XFadePlayBuf.h"
@@ -214,6 +229,18 @@ BEGIN_UGEN_NAMESPACE
 	#endif
 #endif
 
+#if !defined(UGEN_JUCE) && !defined(UGEN_IPHONE)
+	// Juce and the iPhone have their own DiskIn and DiskOut
+	#include "buffers/ugen_DiskStream.h"
+#endif
+
+#if defined(UGEN_CONVOLUTION) && !defined(UGEN_JUCE) && !defined(UGEN_IPHONE)
+	// other platforms use FFTReal (or FFTW if UGEN_FFTW is defined)
+	#include "convolution/ugen_Convolution.h"
+	#include "convolution/ugen_Correlation.h"
+	#include "convolution/ugen_SimpleConvolution.h"
+#endif
+
 #ifdef UGEN_IPHONE
 	// include these on the iPhone even if we're using Juce
 	#include "iphone/ugen_NSUtilities.h"
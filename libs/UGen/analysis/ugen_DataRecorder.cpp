@@ -40,65 +40,186 @@
 BEGIN_UGEN_NAMESPACE
 
 #include "ugen_DataRecorder.h"
+#include "../core/ugen_DiskStreamThread.h"
 
+static volatile int totalDroppedFrames = 0;
+
+/** Frames queued by a DataRecorderUGenInternal and written on the DiskStreamThread. 
+ Frame slots are passed back and forth by index so neither thread allocates or locks. */
+class DataRecorderStream : public DiskStream
+{
+public:
+	DataRecorderStream(Text const& path, 
+					   const int numChannelsToUse, 
+					   const bool timeStampToUse,
+					   const DataRecorderFormat formatToUse,
+					   const int numFramesToUse) throw()
+	:	numChannels(numChannelsToUse),
+		numFrames(ugen::max(numFramesToUse, 1)),
+		timeStamp(timeStampToUse),
+		format(formatToUse),
+		file(fopen(path.getArray(), format == DataRecorderBinary ? "wb" : "w")),
+		frameTimes(new unsigned int[numFrames]),
+		frameValues(new float[numFrames * numChannels]),
+		freeFrames(numFrames),
+		filledFrames(numFrames),
+		numDroppedFrames(0)
+	{
+		if(file == 0)
+			printf("DataRecorder: could not open '%s'\n", path.getArray());
+		
+		for(int i = 0; i < numFrames; i++)
+			freeFrames.push(i);
+	}
+	
+	~DataRecorderStream()
+	{
+		if(file != 0)
+			fclose(file);
+		
+		delete [] frameTimes;
+		delete [] frameValues;
+	}
+	
+	/** Queue one frame, called on the audio thread. */
+	void record(const unsigned int time, const float** inputSampleData, const int index) throw()
+	{
+		int frame;
+		
+		if(freeFrames.pop(frame) == false)
+		{
+			atomicIncrement(numDroppedFrames);
+			atomicIncrement(totalDroppedFrames);
+			return;
+		}
+		
+		frameTimes[frame] = time;
+		float* values = frameValues + frame * numChannels;
+		
+		for(int channel = 0; channel < numChannels; channel++)
+			values[channel] = inputSampleData[channel][index];
+		
+		filledFrames.push(frame);
+	}
+	
+	void service() throw()
+	{
+		int frame;
+		
+		while(filledFrames.pop(frame))
+		{
+			if(file != 0)
+			{
+				const float* values = frameValues + frame * numChannels;
+				
+				if(format == DataRecorderBinary)
+				{
+					if(timeStamp)
+						fwrite(frameTimes + frame, sizeof(unsigned int), 1, file);
+					
+					fwrite(values, sizeof(float), numChannels, file);
+				}
+				else
+				{
+					if(timeStamp)
+						fprintf(file, "%u ", frameTimes[frame]);
+					
+					for(int channel = 0; channel < numChannels; channel++)
+						fprintf(file, "%.16f ", values[channel]);
+					
+					fputc('\n', file);
+				}
+			}
+			
+			freeFrames.push(frame);
+		}
+	}
+	
+	inline int getNumDroppedFrames() const throw()	{ return atomicGet(numDroppedFrames); }
+	
+private:
+	const int numChannels;
+	const int numFrames;
+	const bool timeStamp;
+	const DataRecorderFormat format;
+	FILE* const file;
+	unsigned int* const frameTimes;
+	float* const frameValues;
+	LockFreeFifo<int> freeFrames;
+	LockFreeFifo<int> filledFrames;
+	volatile int numDroppedFrames;
+};
 
 DataRecorderUGenInternal::DataRecorderUGenInternal(UGen const& input, 
 												   UGen const& trig, 
 												   Text const& file, 
-												   const bool _timeStamp) throw()
+												   const bool _timeStamp,
+												   const DataRecorderFormat format,
+												   const int numFrames) throw()
 :	ProxyOwnerUGenInternal(NumInputs, input.getNumChannels()-1),
-	fileWriter(file),
+	stream(new DataRecorderStream(file, input.getNumChannels(), _timeStamp, format, numFrames)),
+	inputSampleData(new const float*[input.getNumChannels()]),
 	lastTrig(0.f),
 	timeStamp(_timeStamp)
 {
 	inputs[Input] = input;
 	inputs[Trig] = trig;
+	
+	DiskStreamThread::add(stream);
+}
+
+DataRecorderUGenInternal::~DataRecorderUGenInternal() throw()
+{
+	stream->release(); // frames already queued are still written
+	delete [] inputSampleData;
+}
+
+int DataRecorderUGenInternal::getNumDroppedFrames() const throw()
+{
+	return stream->getNumDroppedFrames();
 }
 
 void DataRecorderUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int /*channel*/) throw()
 {
-	int numSamplesToProcess = uGenOutput.getBlockSize();
+	const int numSamplesToProcess = uGenOutput.getBlockSize();
+	const int numChannels = inputs[Input].getNumChannels();
 	const float *trigSamples = inputs[Trig].processBlock(shouldDelete, blockID, 0);
 	
+	for(int channel = 0; channel < numChannels; channel++)
+		inputSampleData[channel] = inputs[Input].processBlock(shouldDelete, blockID, channel);
+	
 	for(int i = 0; i < numSamplesToProcess; i++)
 	{
 		float thisTrig = trigSamples[i];
 		
 		if(thisTrig > 0.f && lastTrig <= 0.f)
-		{
-			if(timeStamp == true)
-			{
-				fileWriter.writeValue(blockID+i);
-				fileWriter.write(" ");
-			}
-				
-			for(int channel = 0; channel < inputs[Input].getNumChannels(); channel++)
-			{
-				float *values = inputs[Input].processBlock(shouldDelete, blockID, channel);
-				float value = values[i];
-				fileWriter.writeValue(value);
-				fileWriter.write(" ");
-			}
-			
-			fileWriter.write("\n");
-		}
+			stream->record(blockID+i, inputSampleData, i);
 		
 		lastTrig = thisTrig;
 	}
 	
-	for(int channel = 0; channel < inputs[Input].getNumChannels(); channel++)
+	for(int channel = 0; channel < numChannels; channel++)
 	{
-		float *inputValues = inputs[Input].processBlock(shouldDelete, blockID, channel);
 		float *outputValues = proxies[channel]->getSampleData();
-		memcpy(outputValues, inputValues, numSamplesToProcess * sizeof(float));
+		memcpy(outputValues, inputSampleData[channel], numSamplesToProcess * sizeof(float));
 	}
 }
 
-DataRecorder::DataRecorder(UGen const& input, UGen const& trig, Text const& file, const bool timeStamp) throw()
+DataRecorder::DataRecorder(UGen const& input, 
+						   UGen const& trig, 
+						   Text const& file, 
+						   const bool timeStamp,
+						   const DataRecorderFormat format,
+						   const int numFrames) throw()
 {
-	DataRecorderUGenInternal *internal = new DataRecorderUGenInternal(input, trig.mix(), file, timeStamp);
+	DataRecorderUGenInternal *internal = new DataRecorderUGenInternal(input, trig.mix(), file, timeStamp, format, numFrames);
 	initInternal(input.getNumChannels());
 	generateFromProxyOwner(internal);	
 }
 
+int DataRecorder::getNumDroppedFrames() throw()
+{
+	return atomicGet(totalDroppedFrames);
+}
+
 END_UGEN_NAMESPACE
@@ -41,26 +41,89 @@
 #include "../core/ugen_UGen.h"
 #include "../core/ugen_TextFile.h"
 
+class DataRecorderStream;
+
+/** The file formats DataRecorder can write. */
+enum DataRecorderFormat
+{
+	DataRecorderText,		///< A line for each frame with the time stamp (if used) then each value, separated by spaces.
+	DataRecorderBinary		///< Each frame is the time stamp (if used) as a 32-bit unsigned int then each value as a 32-bit float, in the machine's byte order.
+};
+
 /** @ingroup UGenInternals */
 class DataRecorderUGenInternal : public ProxyOwnerUGenInternal
 {
 public:
-	DataRecorderUGenInternal(UGen const& input, UGen const& trig, Text const& file, const bool timeStamp = false) throw();
+	DataRecorderUGenInternal(UGen const& input, 
+							 UGen const& trig, 
+							 Text const& file, 
+							 const bool timeStamp = false,
+							 const DataRecorderFormat format = DataRecorderText,
+							 const int numFrames = 4096) throw();
+	~DataRecorderUGenInternal() throw();
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
 	
+	/** The number of frames this DataRecorder has dropped. */
+	int getNumDroppedFrames() const throw();
+	
 	enum Inputs { Input, Trig, NumInputs };
 	
 protected:	
-	TextFileWriter fileWriter;
+	DataRecorderStream* const stream;
+	const float** inputSampleData;
 	float lastTrig;
 	const bool timeStamp;
 };
 
-/** Record the state of an input UGen at a given trigger into a text file. */
-UGenSublcassDeclaration(DataRecorder,
-								 (input, trig, file, timeStamp), 
-								 (UGen const& input, UGen const& trig, Text const& file, const bool timeStamp = false),
-								 COMMON_UGEN_DOCS);
+/** Record the state of an input UGen at a given trigger into a file.
+ 
+ Each trigger copies the input's values (and the time stamp) into a queue on the audio thread,
+ these frames are formatted and written to the file on the DiskStreamThread. If the writing
+ falls behind so that numFrames frames are already waiting further frames are dropped and
+ counted, see getNumDroppedFrames(). The input is passed through to the output. */
+class DataRecorder : public UGen
+{
+public:
+	DataRecorder () throw() : UGen() { }
+	
+	/** Record to a file.
+	 @param input		The UGen to record.
+	 @param trig		A frame is recorded each time this changes from 0 or less to greater than 0.
+	 @param file		The path of the file.
+	 @param timeStamp	Whether to start each frame with its time stamp.
+	 @param format		DataRecorderText or DataRecorderBinary.
+	 @param numFrames	The number of frames which can wait to be written. */
+	DataRecorder (UGen const& input, 
+				  UGen const& trig, 
+				  Text const& file, 
+				  const bool timeStamp = false,
+				  const DataRecorderFormat format = DataRecorderText,
+				  const int numFrames = 4096) throw();
+	
+	static inline UGen AR (UGen const& input, 
+						   UGen const& trig, 
+						   Text const& file, 
+						   const bool timeStamp = false,
+						   const DataRecorderFormat format = DataRecorderText,
+						   const int numFrames = 4096) throw()
+	{ 
+		return DataRecorder (input, trig, file, timeStamp, format, numFrames); 
+	}
+	
+	static inline UGen KR (UGen const& input, 
+						   UGen const& trig, 
+						   Text const& file, 
+						   const bool timeStamp = false,
+						   const DataRecorderFormat format = DataRecorderText,
+						   const int numFrames = 4096) throw()
+	{ 
+		return UGen(DataRecorder (input, trig, file, timeStamp, format, numFrames)).kr(); 
+	}
+	
+	/** The number of frames, over every DataRecorder since the application started, which were dropped
+	 because the file writing had fallen behind. DataRecorderUGenInternal::getNumDroppedFrames() counts just one file. */
+	static int getNumDroppedFrames() throw();
+};
 
 
 
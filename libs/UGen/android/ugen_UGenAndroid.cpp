@@ -174,6 +174,7 @@ int AndroidIOHost::processBlock(const int bufferLength, short *shortBuffer) thro
 		// set outputs
 		output.setOutputs(floatBufferData, blockSize, numOutputs);
 		
+		BackgroundThread::setAudioThread();
 		currentBlockID = UGen::getNextBlockID(blockSize);
 		output.prepareAndProcessBlock(blockSize, currentBlockID, -1);
 	}
@@ -211,6 +212,7 @@ int AndroidIOHost::processBlockOutputOnly(const int bufferLength, short *shortBu
 	{
 		output.setOutputs(floatBufferData, blockSize, numOutputs);
 		
+		BackgroundThread::setAudioThread();
 		currentBlockID = UGen::getNextBlockID(blockSize);
 		output.prepareAndProcessBlock(blockSize, currentBlockID, -1);
 	} 
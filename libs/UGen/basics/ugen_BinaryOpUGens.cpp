@@ -44,6 +44,8 @@ BEGIN_UGEN_NAMESPACE
 
 #include "../core/ugen_UGenArray.h"
 #include "../buffers/ugen_Buffer.h"
+#include "../core/ugen_SIMD.h"
+#include "ugen_ScalarUGens.h"
 #include "ugen_BinaryOpUGens.h"
 #include "ugen_UnaryOpUGens.h"
 
@@ -72,17 +74,53 @@ BinaryOpValueInternal::BinaryOpValueInternal(Value const& leftOperand, Value con
 {
 }
 
+BinaryOpScalarSymbolUGenDefinitionNoProcessBlock(Add,		+,	+);
+BinaryOpScalarSymbolUGenDefinitionNoProcessBlock(Subtract,	-,	-);
+BinaryOpScalarSymbolUGenDefinitionNoProcessBlock(Multiply,	*,	*);
+
 // using vector ops these might be defined elsewhere...
-#if defined(UGEN_VFP) || defined(UGEN_NEON) || defined(UGEN_VDSP)
-BinaryOpSymbolUGenDefinitionNoProcessBlock(Add,				+,	+);
-BinaryOpSymbolUGenDefinitionNoProcessBlock(Subtract,		-,	-);
-BinaryOpSymbolUGenDefinitionNoProcessBlock(Multiply,		*,	*);
-#else
-BinaryOpSymbolUGenDefinition(Add,					+,	+);
-BinaryOpSymbolUGenDefinition(Subtract,				-,	-);
-BinaryOpSymbolUGenDefinition(Multiply,				*,	*);
+#if !defined(UGEN_VFP) && !defined(UGEN_NEON) && !defined(UGEN_VDSP) && !defined(UGEN_SIMD)
+void BinaryAddUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	BinaryOpSymbolUGenProcessBlock(shouldDelete, blockID, channel, +)
+}
+
+void BinarySubtractUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	BinaryOpSymbolUGenProcessBlock(shouldDelete, blockID, channel, -)
+}
+
+void BinaryMultiplyUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	BinaryOpSymbolUGenProcessBlock(shouldDelete, blockID, channel, *)
+}
 #endif
 
+// the operations with a scalar operand use the vector-scalar kernels which fall back to plain loops
+void BinaryAddScalarUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	BinaryOpScalarUGenPullOperands(shouldDelete, blockID, channel)
+	
+	SIMD::add(vectorOperandSamples, scalarOperandValue, uGenOutput.getSampleData(), uGenOutput.getBlockSize());
+}
+
+void BinarySubtractScalarUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	BinaryOpScalarUGenPullOperands(shouldDelete, blockID, channel)
+	
+	if(scalarOperand == LeftOperand)
+		SIMD::subtract(scalarOperandValue, vectorOperandSamples, uGenOutput.getSampleData(), uGenOutput.getBlockSize());
+	else
+		SIMD::subtract(vectorOperandSamples, scalarOperandValue, uGenOutput.getSampleData(), uGenOutput.getBlockSize());
+}
+
+void BinaryMultiplyScalarUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	BinaryOpScalarUGenPullOperands(shouldDelete, blockID, channel)
+	
+	SIMD::multiply(vectorOperandSamples, scalarOperandValue, uGenOutput.getSampleData(), uGenOutput.getBlockSize());
+}
+
 BinaryOpSymbolUGenDefinition(LessThan,				<,	<);
 BinaryOpSymbolUGenDefinition(GreaterThan,			>,	>);
 BinaryOpSymbolUGenDefinition(LessThanOrEquals,		<=, <=);
@@ -96,10 +134,16 @@ BinaryOpFunctionUGenDefinition(IsNotEqualTo,	isNotEqualTo,	isNotEqualTo);
 BinaryOpFunctionUGenDefinition(Pow,			pow,		pow);
 BinaryOpFunctionUGenDefinition(Hypot,		hypot,		hypot);
 BinaryOpFunctionUGenDefinition(Atan2,		atan2,		atan2);
+// the SIMD kernels cover these too
+#ifdef UGEN_SIMD
+BinaryOpFunctionUGenDefinitionNoProcessBlock(Min,	min,		min);
+BinaryOpFunctionUGenDefinitionNoProcessBlock(Max,	max,		max);
+BinaryOpFunctionUGenDefinitionNoProcessBlock(Clip2,	clip2,		clip2);
+#else
 BinaryOpFunctionUGenDefinition(Min,			min,		min);
 BinaryOpFunctionUGenDefinition(Max,			max,		max);
-
 BinaryOpFunctionUGenDefinition(Clip2,		clip2,		clip2);
+#endif
 
 #ifndef UGEN_NOEXTGPL
 BinaryOpFunctionUGenDefinition(Wrap,		wrap,		wrap);
@@ -158,20 +202,51 @@ BinaryDivideUGen::BinaryDivideUGen(UGen const& leftOperand, UGen const& rightOpe
 	
 	for(unsigned int i = 0; i < numInternalUGens; i++) 
 	{ 
+		const int leftIndex = i % numLeftChannels;
 		const int rightIndex = i % numRightChannels;
 		if(rightOperand.isConst(rightIndex))
 		{
 			// special case where the right operand is a scalar
 			// use multiplication by the reciprocal instead
 			float reciprocalRightOperand = 1.f / rightOperand.getValue(rightIndex);
-			internalUGens[i] = new BinaryMultiplyUGenInternal(leftOperand, reciprocalRightOperand); 
+			
+			if(leftOperand.isConst(leftIndex))
+				internalUGens[i] = new ScalarUGenInternal(leftOperand.getValue(leftIndex) * reciprocalRightOperand);
+			else
+				internalUGens[i] = new BinaryMultiplyScalarUGenInternal(leftOperand, reciprocalRightOperand, 
+																		BinaryOpUGenInternal::RightOperand, 0);
 		}
+		else if(leftOperand.isScalar(leftIndex))
+			internalUGens[i] = new BinaryDivideScalarUGenInternal(leftOperand, rightOperand, BinaryOpUGenInternal::LeftOperand, i); 
+		else if(rightOperand.isScalar(rightIndex))
+			internalUGens[i] = new BinaryDivideScalarUGenInternal(leftOperand, rightOperand, BinaryOpUGenInternal::RightOperand, i); 
 		else
 			internalUGens[i] = new BinaryDivideUGenInternal(leftOperand, rightOperand); 
 	}
 } 
 
-#if !defined(UGEN_VFP) && !defined(UGEN_NEON) && !defined(UGEN_VDSP)
+BinaryOpScalarUGenDefinition(Divide);
+
+void BinaryDivideScalarUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw() 
+{ 
+	BinaryOpScalarUGenPullOperands(shouldDelete, blockID, channel)
+	
+	const int numSamplesToProcess = uGenOutput.getBlockSize(); 
+	float* outputSamples = uGenOutput.getSampleData(); 
+	
+	if(scalarOperand == LeftOperand)
+	{
+		SIMD::divide(scalarOperandValue, vectorOperandSamples, outputSamples, numSamplesToProcess);
+	}
+	else
+	{
+		// not a constant so this can't be a multiplication by the reciprocal
+		for(int i = 0; i < numSamplesToProcess; ++i)
+			outputSamples[i] = vectorOperandSamples[i] / scalarOperandValue;
+	}
+} 
+
+#if !defined(UGEN_VFP) && !defined(UGEN_NEON) && !defined(UGEN_VDSP) && !defined(UGEN_SIMD)
 void BinaryDivideUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw() 
 { 
 	int numSamplesToProcess = uGenOutput.getBlockSize(); 
@@ -50,30 +50,78 @@
 #include "../core/ugen_Value.h"
 #include "ugen_InlineBinaryOps.h"
 
+// when both operands of a channel are constants the result is folded into a constant at construction time
 #define BinaryOpSymbolUGenConstructor(INTERNALUGENCLASSNAME, OPSYMBOL_INTERNAL, leftOperand_, rightOperand_)			\
-		if(leftOperand_.getNumChannels() > rightOperand_.getNumChannels())												\
-			initInternal(leftOperand_.getNumChannels());																\
+		const int numLeftChannels_ = leftOperand_.getNumChannels();														\
+		const int numRightChannels_ = rightOperand_.getNumChannels();													\
+																														\
+		if(numLeftChannels_ > numRightChannels_)																		\
+			initInternal(numLeftChannels_);																				\
 		else																											\
-			initInternal(rightOperand_.getNumChannels());																\
+			initInternal(numRightChannels_);																			\
 																														\
-		for(unsigned int i = 0; i < numInternalUGens; i++)																		\
+		for(unsigned int i = 0; i < numInternalUGens; i++)																\
 		{																												\
+			if(leftOperand_.isConst(i % numLeftChannels_) && rightOperand_.isConst(i % numRightChannels_))				\
+			{																											\
+				internalUGens[i] = new ScalarUGenInternal(leftOperand_.getValue(i) OPSYMBOL_INTERNAL rightOperand_.getValue(i));	\
+				continue;																								\
+			}																											\
+																														\
 			internalUGens[i] = new INTERNALUGENCLASSNAME(leftOperand_, rightOperand_);									\
 			internalUGens[i]->initValue(leftOperand_.getValue(i) OPSYMBOL_INTERNAL rightOperand_.getValue(i));			\
 		}
 
+// as above but a channel with one scalar operand uses SCALARINTERNALUGENCLASSNAME which reads its value once per block
+#define BinaryOpScalarSymbolUGenConstructor(INTERNALUGENCLASSNAME, SCALARINTERNALUGENCLASSNAME, OPSYMBOL_INTERNAL, leftOperand_, rightOperand_)	\
+		const int numLeftChannels_ = leftOperand_.getNumChannels();														\
+		const int numRightChannels_ = rightOperand_.getNumChannels();													\
+																														\
+		if(numLeftChannels_ > numRightChannels_)																		\
+			initInternal(numLeftChannels_);																				\
+		else																											\
+			initInternal(numRightChannels_);																			\
+																														\
+		for(unsigned int i = 0; i < numInternalUGens; i++)																\
+		{																												\
+			if(leftOperand_.isConst(i % numLeftChannels_) && rightOperand_.isConst(i % numRightChannels_))				\
+			{																											\
+				internalUGens[i] = new ScalarUGenInternal(leftOperand_.getValue(i) OPSYMBOL_INTERNAL rightOperand_.getValue(i));	\
+				continue;																								\
+			}																											\
+																														\
+			if(rightOperand_.isScalar(i % numRightChannels_))															\
+				internalUGens[i] = new SCALARINTERNALUGENCLASSNAME(leftOperand_, rightOperand_, BinaryOpUGenInternal::RightOperand, i);	\
+			else if(leftOperand_.isScalar(i % numLeftChannels_))														\
+				internalUGens[i] = new SCALARINTERNALUGENCLASSNAME(leftOperand_, rightOperand_, BinaryOpUGenInternal::LeftOperand, i);	\
+			else																										\
+				internalUGens[i] = new INTERNALUGENCLASSNAME(leftOperand_, rightOperand_);								\
+																														\
+			internalUGens[i]->initValue(leftOperand_.getValue(i) OPSYMBOL_INTERNAL rightOperand_.getValue(i));			\
+		}
+
 
 #define BinaryOpFunctionUGenConstructor(INTERNALUGENCLASSNAME, OPFUNCTION_INTERNAL, leftOperand_, rightOperand_)		\
-		if(leftOperand_.getNumChannels() > rightOperand_.getNumChannels())												\
-			initInternal(leftOperand_.getNumChannels());																\
+		const int numLeftChannels_ = leftOperand_.getNumChannels();														\
+		const int numRightChannels_ = rightOperand_.getNumChannels();													\
+																														\
+		if(numLeftChannels_ > numRightChannels_)																		\
+			initInternal(numLeftChannels_);																				\
 		else																											\
-			initInternal(rightOperand_.getNumChannels());																\
+			initInternal(numRightChannels_);																			\
 																														\
-		for(unsigned int i = 0; i < numInternalUGens; i++)																		\
+		for(unsigned int i = 0; i < numInternalUGens; i++)																\
 		{																												\
+			const float value_ = ugen::OPFUNCTION_INTERNAL(leftOperand_.getValue(i), rightOperand_.getValue(i));		\
+																														\
+			if(leftOperand_.isConst(i % numLeftChannels_) && rightOperand_.isConst(i % numRightChannels_))				\
+			{																											\
+				internalUGens[i] = new ScalarUGenInternal(value_);														\
+				continue;																								\
+			}																											\
+																														\
 			internalUGens[i] = new INTERNALUGENCLASSNAME(leftOperand_, rightOperand_);									\
-			internalUGens[i]->initValue(ugen::OPFUNCTION_INTERNAL(leftOperand_.getValue(i),								\
-																  rightOperand_.getValue(i)));							\
+			internalUGens[i]->initValue(value_);																		\
 		}
 
 #define BinaryOpUGenConstructor(INTERNALUGENCLASSNAME, leftOperand_, rightOperand_)										\
@@ -181,6 +229,55 @@
 			}																											\
 
 
+// for Binary##OPNAME##ScalarUGenInternal::processBlock(), pulls the vector operand and reads the scalar one
+#define BinaryOpScalarUGenPullOperands(shouldDelete_, blockID_, channel_)												\
+		const float* vectorOperandSamples;																				\
+		if(scalarOperand == LeftOperand) {																				\
+			if(!scalarOperandIsConst) inputs[LeftOperand].processBlock(shouldDelete_, blockID_, channel_);				\
+			vectorOperandSamples = inputs[RightOperand].processBlock(shouldDelete_, blockID_, channel_);				\
+		} else {																										\
+			vectorOperandSamples = inputs[LeftOperand].processBlock(shouldDelete_, blockID_, channel_);					\
+			if(!scalarOperandIsConst) inputs[RightOperand].processBlock(shouldDelete_, blockID_, channel_);				\
+		}																												\
+		const float scalarOperandValue = inputs[scalarOperand].getValue(channel_);
+
+
+#define BinaryOpScalarUGenDeclaration(OPNAME)																			\
+		/** Internal for Binary##OPNAME##UGen where one operand is a scalar.											\
+			The scalar operand's value is read once per block rather than pulling a whole block							\
+			of the same value and it isn't pulled at all if it's a constant (pointer based									\
+			scalars still need to be pulled to update their value). @ingroup UGenInternals */							\
+		class Binary##OPNAME##ScalarUGenInternal : public Binary##OPNAME##UGenInternal									\
+		{																												\
+		public:																											\
+			Binary##OPNAME##ScalarUGenInternal(UGen const& leftOperand, UGen const& rightOperand,						\
+											   const int scalarOperand, const int channel) throw();						\
+			UGenInternal* getChannel(const int channel) throw();														\
+			void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();				\
+		private:																										\
+			const int scalarOperand;																					\
+			const bool scalarOperandIsConst;																			\
+		};
+
+#define BinaryOpScalarUGenDefinition(OPNAME)																			\
+	Binary##OPNAME##ScalarUGenInternal::Binary##OPNAME##ScalarUGenInternal(UGen const& leftOperand,						\
+																		   UGen const& rightOperand,					\
+																		   const int scalarOperandIndex,				\
+																		   const int channel) throw()					\
+	:	Binary##OPNAME##UGenInternal(leftOperand, rightOperand),														\
+		scalarOperand(scalarOperandIndex),																				\
+		scalarOperandIsConst(inputs[scalarOperandIndex].isConst(channel % inputs[scalarOperandIndex].getNumChannels()))	\
+	{																													\
+		ugen_assert(inputs[scalarOperand].isScalar(channel % inputs[scalarOperand].getNumChannels()));					\
+	}																													\
+																														\
+	UGenInternal* Binary##OPNAME##ScalarUGenInternal::getChannel(const int channel) throw()								\
+	{																													\
+		return new Binary##OPNAME##ScalarUGenInternal(inputs[LeftOperand].getChannel(channel),							\
+													  inputs[RightOperand].getChannel(channel),							\
+													  scalarOperand, 0);												\
+	}
+
 #define BinaryOpCommonUGenDeclaration(OPNAME)																			\
 		/** Internal for Binary##OPNAME##UGen @ingroup UGenInternals */													\
 		class Binary##OPNAME##UGenInternal : public BinaryOpUGenInternal												\
@@ -361,12 +458,28 @@
 
 
 #define BinaryOpSymbolUGenDefinitionNoProcessBlock(OPNAME, OPSYMBOL, OPSYMBOL_INTERNAL)									\
-	BinaryOpCommonUGenDefinition(OPNAME)																				\
+	BinaryOpSymbolUGenDefinitionNoConstructor(OPNAME, OPSYMBOL, OPSYMBOL_INTERNAL)										\
 																														\
 	Binary##OPNAME##UGen::Binary##OPNAME##UGen(UGen const& leftOperand, UGen const& rightOperand) throw()				\
 	{																													\
 		BinaryOpSymbolUGenConstructor(Binary##OPNAME##UGenInternal, OPSYMBOL_INTERNAL, leftOperand, rightOperand)		\
 	}																													\
+
+
+// the Binary##OPNAME##ScalarUGenInternal::processBlock() function still needs to be defined
+#define BinaryOpScalarSymbolUGenDefinitionNoProcessBlock(OPNAME, OPSYMBOL, OPSYMBOL_INTERNAL)							\
+	BinaryOpSymbolUGenDefinitionNoConstructor(OPNAME, OPSYMBOL, OPSYMBOL_INTERNAL)										\
+	BinaryOpScalarUGenDefinition(OPNAME)																				\
+																														\
+	Binary##OPNAME##UGen::Binary##OPNAME##UGen(UGen const& leftOperand, UGen const& rightOperand) throw()				\
+	{																													\
+		BinaryOpScalarSymbolUGenConstructor(Binary##OPNAME##UGenInternal, Binary##OPNAME##ScalarUGenInternal,			\
+											OPSYMBOL_INTERNAL, leftOperand, rightOperand)								\
+	}																													\
+
+
+#define BinaryOpSymbolUGenDefinitionNoConstructor(OPNAME, OPSYMBOL, OPSYMBOL_INTERNAL)									\
+	BinaryOpCommonUGenDefinition(OPNAME)																				\
 																														\
 	float Binary##OPNAME##UGenInternal::getValue(const int channel) const throw()										\
 	{																													\
@@ -504,12 +617,7 @@
 
 	
 #define BinaryOpFunctionUGenDefinition(OPNAME, OPFUNCTION, OPFUNCTION_INTERNAL)											\
-	BinaryOpCommonUGenDefinition(OPNAME)																				\
-																														\
-	Binary##OPNAME##UGen::Binary##OPNAME##UGen(UGen const& leftOperand, UGen const& rightOperand) throw()				\
-	{																													\
-		BinaryOpFunctionUGenConstructor(Binary##OPNAME##UGenInternal, OPFUNCTION_INTERNAL, leftOperand, rightOperand)	\
-	}																													\
+	BinaryOpFunctionUGenDefinitionNoProcessBlock(OPNAME, OPFUNCTION, OPFUNCTION_INTERNAL)								\
 																														\
 	void Binary##OPNAME##UGenInternal::processBlock(bool& shouldDelete,													\
 													const unsigned int blockID,											\
@@ -517,6 +625,15 @@
 	{																													\
 		BinaryOpFunctionUGenProcessBlock(shouldDelete, blockID, channel, OPFUNCTION_INTERNAL)							\
 	}																													\
+
+
+#define BinaryOpFunctionUGenDefinitionNoProcessBlock(OPNAME, OPFUNCTION, OPFUNCTION_INTERNAL)								\
+	BinaryOpCommonUGenDefinition(OPNAME)																				\
+																														\
+	Binary##OPNAME##UGen::Binary##OPNAME##UGen(UGen const& leftOperand, UGen const& rightOperand) throw()				\
+	{																													\
+		BinaryOpFunctionUGenConstructor(Binary##OPNAME##UGenInternal, OPFUNCTION_INTERNAL, leftOperand, rightOperand)	\
+	}																													\
 																														\
 	float Binary##OPNAME##UGenInternal::getValue(const int channel) const throw()										\
 	{																													\
@@ -679,6 +796,8 @@ public:
 	
 	enum Inputs { LeftOperand, RightOperand, NumInputs };
 	
+	bool hasSharableOutput() const throw() { return true; }
+	
 protected:
 };
 
@@ -699,6 +818,9 @@ protected:
 BinaryOpSymbolUGenDeclaration(Add,					+);
 BinaryOpSymbolUGenDeclaration(Subtract,				-);
 BinaryOpSymbolUGenDeclaration(Multiply,				*);
+BinaryOpScalarUGenDeclaration(Add);
+BinaryOpScalarUGenDeclaration(Subtract);
+BinaryOpScalarUGenDeclaration(Multiply);
 //BinaryOpSymbolUGenDeclaration(Divide,				/);
 BinaryOpSymbolUGenDeclaration(LessThan,				<);
 BinaryOpSymbolUGenDeclaration(GreaterThan,			>);
@@ -746,6 +868,10 @@ public:
 	UGenInternal* getChannel(const int channel) throw(); 
 	UGenInternal* getKr() throw(); 
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw(); 
+	float getValue(const int channel) const throw() 
+	{ 
+		return inputs[LeftOperand].getValue(channel) / inputs[RightOperand].getValue(channel);
+	}
 }; 
 
 /** Control rate internal for BinaryDivideUGen */
@@ -755,15 +881,14 @@ public:
 	BinaryDivideUGenInternalK(UGen const& leftOperand, UGen const& rightOperand) throw(); 
 	UGenInternal* getKr() throw() { incrementRefCount(); return this; } 
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw(); 
-	float getValue(const int channel) const throw() 
-	{ 
-		return inputs[LeftOperand].getValue(channel) / inputs[RightOperand].getValue(channel);
-	}
 	
 private: 
 	float value; 
 }; 
 
+// a constant right operand is turned into a multiplication instead
+BinaryOpScalarUGenDeclaration(Divide);
+
 /** A BinaryOpUGen usually created using the operator / when applied to other UGen instances. 
  It is not normally required to use this UGen explicitly. 
  @code
@@ -842,6 +967,7 @@ public:
 	IngoreRightOperandUGenInternal(UGen const& leftOperand, UGen const& rightOperand) throw(); 
 	UGenInternal* getChannel(const int channel) throw(); 
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw(); 
+	bool hasSharableOutput() const throw() { return false; } // redirects the left operand's output
 }; 
 
 class IngoreRightOperandUGen : public UGen 
@@ -0,0 +1,435 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "../core/ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_FusedExpression.h"
+#include "../core/ugen_UGen.h"
+#include "../core/ugen_SIMD.h"
+#include "ugen_BinaryOpUGens.h"
+#include "ugen_UnaryOpUGens.h"
+#include "ugen_MulAdd.h"
+
+/** Finds the chains of operators in a graph and builds their programs. */
+class FusedExpressionUGenInternal::Fuser
+{
+public:
+	Fuser() throw() : numFused(0) { }
+	
+	/** Replace each internal of a UGen which is the root of a chain with a fused node, 
+	 or search below it if it isn't. */
+	void fuseUGen(UGen& ugen) throw()
+	{
+		for(unsigned int channel = 0; channel < ugen.numInternalUGens; channel++)
+		{
+			UGenInternal* internal = ugen.internalUGens[channel];
+			UGenInternal* fused = createFused(internal);
+			
+			if(fused != 0)
+			{
+				ugen.internalUGens[channel] = fused;
+				internal->decrementRefCount(); // the fused node only refers to the leaves so this frees the operators
+			}
+			else
+			{
+				fuseInputs(internal);
+			}
+		}
+	}
+	
+	inline int getNumFused() const throw() { return numFused; }
+	
+private:	
+	void fuseInputs(UGenInternal* internal) throw()
+	{
+		if(contains(searched, internal))
+			return;
+		
+		searched.add(internal);
+		
+		for(unsigned int i = 0; i < internal->numInputs_; i++)
+			fuseUGen(internal->inputs[i]);
+	}
+	
+	static bool contains(ObjectArray<UGenInternal*> const& array, UGenInternal* item) throw()
+	{
+		for(int i = 0; i < array.size(); i++)
+			if(array[i] == item) return true;
+		
+		return false;
+	}
+	
+	/** Returns the opcode for an operator node or -1 if it can't be fused. */
+	static int getOpcode(UGenInternal* internal) throw()
+	{
+		// the control rate versions interpolate so are left alone, as are nodes using a scratch block
+		if(internal->isControlRateOnly() || !internal->getOutputRef().isUsingOwnBlock())
+			return -1;
+		
+		if(dynamic_cast<BinaryAddUGenInternal*> (internal) != 0)			return Add;
+		if(dynamic_cast<BinarySubtractUGenInternal*> (internal) != 0)		return Subtract;
+		if(dynamic_cast<BinaryMultiplyUGenInternal*> (internal) != 0)		return Multiply;
+		if(dynamic_cast<BinaryDivideUGenInternal*> (internal) != 0)			return Divide;
+		if(dynamic_cast<BinaryMinUGenInternal*> (internal) != 0)			return Min;
+		if(dynamic_cast<BinaryMaxUGenInternal*> (internal) != 0)			return Max;
+		if(dynamic_cast<BinaryClip2UGenInternal*> (internal) != 0)			return Clip2;
+		if(dynamic_cast<MulAddUGenInternal*> (internal) != 0)				return MulAdd;
+		if(dynamic_cast<UnaryNegUGenInternal*> (internal) != 0)				return Neg;
+		if(dynamic_cast<UnaryAbsUGenInternal*> (internal) != 0)				return Abs;
+		if(dynamic_cast<UnaryReciprocalUGenInternal*> (internal) != 0)		return Reciprocal;
+		if(dynamic_cast<UnarySquaredUGenInternal*> (internal) != 0)			return Squared;
+		if(dynamic_cast<UnaryCubedUGenInternal*> (internal) != 0)			return Cubed;
+		if(dynamic_cast<UnarySqrtUGenInternal*> (internal) != 0)			return Sqrt;
+		
+		return -1;
+	}
+	
+	/** Returns the internal of an input which can be fused into its parent, or 0. */
+	static UGenInternal* getCandidate(UGen const& input) throw()
+	{
+		// multichannel inputs are mapped to a channel when they're pulled
+		if(input.numInternalUGens != 1) 
+			return 0;
+		
+		UGenInternal* internal = input.internalUGens[0];
+		
+		if(internal->getRefCount() != 1 || getOpcode(internal) < 0)
+			return 0;
+		
+		return internal;
+	}
+	
+	UGenInternal* createFused(UGenInternal* root) throw()
+	{
+		if(getOpcode(root) < 0)
+			return 0;
+		
+		UGenArray leaves;
+		ObjectArray<Instruction> instructions;
+		
+		if(!visit(root, leaves, instructions) || instructions.size() < 2)
+			return 0;
+		
+		// search the leaves only once they're known to be fused
+		for(int i = 0; i < leaves.size(); i++)
+			fuseUGen(leaves[i]);
+		
+		// the leaves' operand numbers were assigned before the number of leaves was known
+		for(int i = 0; i < instructions.size(); i++)
+		{
+			for(int j = 0; j < MaxOperands; j++)
+			{
+				int& operand = instructions[i].operands[j];
+				if(operand < 0) operand = -operand - 1;
+				else			operand += leaves.size();
+			}
+		}
+		
+		numFused++;
+		
+		return new FusedExpressionUGenInternal(leaves, instructions);
+	}
+	
+	/** Lists the leaves under a node and the instructions for it and its fused inputs, in 
+	 the order they would be pulled. Leaves get negative operand numbers for now.
+	 @return	false if one of the leaves is using a scratch block. */
+	bool visit(UGenInternal* node, UGenArray& leaves, ObjectArray<Instruction>& instructions) throw()
+	{
+		Instruction instruction;
+		instruction.opcode = getOpcode(node);
+		
+		ugen_assert(node->numInputs_ <= MaxOperands);
+		
+		for(int i = 0; i < MaxOperands; i++)
+		{
+			if(i >= (int)node->numInputs_)
+			{
+				instruction.operands[i] = instruction.operands[0];
+				continue;
+			}
+			
+			UGen& input = node->inputs[i];
+			UGenInternal* child = getCandidate(input);
+			
+			if(child != 0)
+			{
+				if(!visit(child, leaves, instructions))
+					return false;
+				
+				instruction.operands[i] = instructions.size() - 1;
+			}
+			else
+			{
+				for(unsigned int channel = 0; channel < input.numInternalUGens; channel++)
+					if(!input.internalUGens[channel]->getOutputRef().isUsingOwnBlock())
+						return false;
+				
+				leaves.add(input);
+				instruction.operands[i] = -leaves.size();
+			}
+		}
+		
+		instructions.add(instruction);
+		return true;
+	}
+	
+	ObjectArray<UGenInternal*> searched;
+	int numFused;
+};
+
+int FusedExpressionUGenInternal::fuse(UGen& graph) throw()
+{
+	Fuser fuser;
+	fuser.fuseUGen(graph);
+	return fuser.getNumFused();
+}
+
+FusedExpressionUGenInternal::FusedExpressionUGenInternal(UGenArray const& leaves, 
+														 ObjectArray<Instruction> const& instructionsToUse) throw()
+:	UGenInternal(leaves.size()),
+	numInstructions(instructionsToUse.size()),
+	instructions(new Instruction[numInstructions]),
+	inputSamples(new const float*[leaves.size()]),
+	inputStrides(new int[leaves.size()]),
+	scalarValues(new float[leaves.size()]),
+	constants(new float[leaves.size() * TileSize]),
+	temporaries(new float[numInstructions * TileSize])
+{
+	ugen_assert(numInstructions > 0);
+	
+	for(unsigned int i = 0; i < numInputs_; i++)
+		inputs[i] = leaves[i];
+	
+	for(int i = 0; i < numInstructions; i++)
+		instructions[i] = instructionsToUse[i];
+	
+	initValue(getValue(0));
+}
+
+FusedExpressionUGenInternal::~FusedExpressionUGenInternal()
+{
+	delete [] instructions;
+	delete [] inputSamples;
+	delete [] inputStrides;
+	delete [] scalarValues;
+	delete [] constants;
+	delete [] temporaries;
+}
+
+UGenInternal* FusedExpressionUGenInternal::getChannel(const int channel) throw()
+{
+	UGenArray leaves;
+	
+	for(unsigned int i = 0; i < numInputs_; i++)
+		leaves.add(inputs[i].getChannel(channel));
+	
+	ObjectArray<Instruction> program(numInstructions, instructions);
+	
+	return new FusedExpressionUGenInternal(leaves, program);
+}
+
+UGenInternal* FusedExpressionUGenInternal::getKr() throw()
+{
+	// the control rate operators hold their value over the block rather than running the program
+	return getOperandUGen(numInputs_ + numInstructions - 1).kr().getInternalUGen(0);
+}
+
+float FusedExpressionUGenInternal::getOperandValue(const int operand, const int channel) const throw()
+{
+	if(operand < (int)numInputs_)
+		return inputs[operand].getValue(channel);
+	
+	// each result is used once so this visits each instruction once
+	const int* operands = instructions[operand - numInputs_].operands;
+	const float a = getOperandValue(operands[0], channel);
+	
+	switch(instructions[operand - numInputs_].opcode)
+	{
+		case Add:			return a + getOperandValue(operands[1], channel);
+		case Subtract:		return a - getOperandValue(operands[1], channel);
+		case Multiply:		return a * getOperandValue(operands[1], channel);
+		case Divide:		return a / getOperandValue(operands[1], channel);
+		case Min:			return ugen::min(a, getOperandValue(operands[1], channel));
+		case Max:			return ugen::max(a, getOperandValue(operands[1], channel));
+		case Clip2:			return ugen::clip2(a, getOperandValue(operands[1], channel));
+		case MulAdd:		return a * getOperandValue(operands[1], channel) + getOperandValue(operands[2], channel);
+		case Neg:			return ugen::neg(a);
+		case Abs:			return ugen::abs(a);
+		case Reciprocal:	return ugen::reciprocal(a);
+		case Squared:		return ugen::squared(a);
+		case Cubed:			return ugen::cubed(a);
+		case Sqrt:			return ugen::sqrt(a);
+		default:			ugen_assertfalse; return 0.f;
+	}
+}
+
+UGen FusedExpressionUGenInternal::getOperandUGen(const int operand) const throw()
+{
+	if(operand < (int)numInputs_)
+		return inputs[operand];
+	
+	const int* operands = instructions[operand - numInputs_].operands;
+	const UGen a = getOperandUGen(operands[0]);
+	
+	switch(instructions[operand - numInputs_].opcode)
+	{
+		case Add:			return a + getOperandUGen(operands[1]);
+		case Subtract:		return a - getOperandUGen(operands[1]);
+		case Multiply:		return a * getOperandUGen(operands[1]);
+		case Divide:		return a / getOperandUGen(operands[1]);
+		case Min:			return a.min(getOperandUGen(operands[1]));
+		case Max:			return a.max(getOperandUGen(operands[1]));
+		case Clip2:			return a.clip2(getOperandUGen(operands[1]));
+		case MulAdd:		return UGen(new MulAddUGenInternal(a, getOperandUGen(operands[1]), getOperandUGen(operands[2])));
+		case Neg:			return a.neg();
+		case Abs:			return a.abs();
+		case Reciprocal:	return a.reciprocal();
+		case Squared:		return a.squared();
+		case Cubed:			return a.cubed();
+		case Sqrt:			return a.sqrt();
+		default:			ugen_assertfalse; return a;
+	}
+}
+
+void FusedExpressionUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	const int blockSize = uGenOutput.getBlockSize();
+	float* outputSamples = uGenOutput.getSampleData();
+	
+	// pull the leaves in order, constants don't need to be pulled and scalars are only
+	// read once (a tile is filled with what their block would hold for the other operations)
+	for(unsigned int i = 0; i < numInputs_; i++)
+	{
+		UGen& input = inputs[i];
+		const int inputChannel = channel % input.getNumChannels();
+		
+		if(input.isScalar(inputChannel))
+		{
+			float* constant = constants + i * TileSize;
+			float blockValue;
+			
+			if(input.isConst(inputChannel))
+			{
+				scalarValues[i] = input.getValue(channel);
+				blockValue = 0.f + scalarValues[i];
+			}
+			else
+			{
+				input.processBlock(shouldDelete, blockID, channel);
+				scalarValues[i] = blockValue = input.getValue(channel);
+			}
+			
+			for(int j = 0; j < TileSize; ++j)
+				constant[j] = blockValue;
+			
+			inputSamples[i] = constant;
+			inputStrides[i] = 0;
+		}
+		else
+		{
+			inputSamples[i] = input.processBlock(shouldDelete, blockID, channel);
+			inputStrides[i] = 1;
+		}
+	}
+	
+	const int last = numInstructions - 1;
+	
+	for(int offset = 0; offset < blockSize; offset += TileSize)
+	{
+		const int numSamples = ugen::min(blockSize - offset, (int)TileSize);
+		
+		for(int i = 0; i < numInstructions; i++)
+		{
+			Instruction const& instruction = instructions[i];
+			const int* operands = instruction.operands;
+			const float* a = getOperand(operands[0], offset);
+			const float* b = getOperand(operands[1], offset);
+			const float* c = getOperand(operands[2], offset);
+			float* result = (i == last) ? outputSamples + offset : temporaries + i * TileSize;
+			
+			// as the operators with a scalar operand do, use the vector-scalar kernels where possible
+			switch(instruction.opcode)
+			{
+				case Add:			
+					if(isScalarOperand(operands[1]))		SIMD::add(a, scalarValues[operands[1]], result, numSamples);
+					else if(isScalarOperand(operands[0]))	SIMD::add(b, scalarValues[operands[0]], result, numSamples);
+					else									SIMD::add(a, b, result, numSamples);
+					break;
+				case Subtract:		
+					if(isScalarOperand(operands[1]))		SIMD::subtract(a, scalarValues[operands[1]], result, numSamples);
+					else if(isScalarOperand(operands[0]))	SIMD::subtract(scalarValues[operands[0]], b, result, numSamples);
+					else									SIMD::subtract(a, b, result, numSamples);
+					break;
+				case Multiply:		
+					if(isScalarOperand(operands[1]))		SIMD::multiply(a, scalarValues[operands[1]], result, numSamples);
+					else if(isScalarOperand(operands[0]))	SIMD::multiply(b, scalarValues[operands[0]], result, numSamples);
+					else									SIMD::multiply(a, b, result, numSamples);
+					break;
+				case Divide:		
+					if(isScalarOperand(operands[0]))		SIMD::divide(scalarValues[operands[0]], b, result, numSamples);
+					else									SIMD::divide(a, b, result, numSamples);
+					break;
+				case MulAdd:
+					if(isScalarOperand(operands[1]) && isScalarOperand(operands[2]))
+						SIMD::mulAdd(a, scalarValues[operands[1]], scalarValues[operands[2]], result, numSamples);
+					else
+						SIMD::mulAdd(a, b, c, result, numSamples);
+					break;
+				case Min:			SIMD::min(a, b, result, numSamples);			break;
+				case Max:			SIMD::max(a, b, result, numSamples);			break;
+				case Clip2:			SIMD::clip2(a, b, result, numSamples);			break;
+				case Neg:			SIMD::neg(a, result, numSamples);				break;
+				case Abs:			SIMD::abs(a, result, numSamples);				break;
+				case Reciprocal:	SIMD::reciprocal(a, result, numSamples);		break;
+				case Squared:		SIMD::squared(a, result, numSamples);			break;
+				case Cubed:			SIMD::cubed(a, result, numSamples);				break;
+				case Sqrt:			SIMD::sqrt(a, result, numSamples);				break;
+				default:			ugen_assertfalse;
+			}
+		}
+	}
+}
+
+float FusedExpressionUGenInternal::getValue(const int channel) const throw()
+{
+	return getOperandValue(numInputs_ + numInstructions - 1, channel);
+}
+
+
+END_UGEN_NAMESPACE
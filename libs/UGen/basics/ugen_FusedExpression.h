@@ -0,0 +1,132 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_FUSEDEXPRESSION_H
+#define UGEN_FUSEDEXPRESSION_H
+
+#include "../core/ugen_UGenInternal.h"
+#include "../core/ugen_UGenArray.h"
+
+/** Evaluates a chain of arithmetic operators as a single node.
+ 
+ A graph like SinOsc::AR(f) * amp * env + offset normally has a node for each operator, 
+ each writing a whole block which the next one reads back. When a tree of these nodes 
+ (audio rate Add, Subtract, Multiply, Divide, Min, Max, Clip2, MulAdd and the Neg, Abs, 
+ Reciprocal, Squared, Cubed and Sqrt unary operators) is fused its leaves become the inputs
+ of this node and the operators become a short program. The program is run over tiles of
+ TileSize samples so the intermediate results stay in a few small arrays in the cache 
+ rather than in separate blocks. Each operation uses the same SIMD kernel as the node it
+ replaces so the output is exactly the same.
+ 
+ Only nodes used by a single parent are fused (a node used elsewhere becomes a leaf)
+ and the leaves are pulled in the order the operators would have pulled them so 
+ shouldDelete propagates in the same way. Nothing else is kept from the operator nodes
+ so they and their blocks are freed once the graph is fused, getValue() runs the program
+ on the values of the leaves and getKr() builds the control rate operators from it.
+ 
+ @see UGen::fuse() */
+class FusedExpressionUGenInternal : public UGenInternal
+{
+public:
+	enum Opcode
+	{
+		Add, Subtract, Multiply, Divide, Min, Max, Clip2, MulAdd,
+		Neg, Abs, Reciprocal, Squared, Cubed, Sqrt,
+		NumOpcodes
+	};
+	
+	enum Constants 
+	{ 
+		TileSize = 64,
+		MaxOperands = 3
+	};
+	
+	/** One operation, operands less than the number of inputs refer to the inputs 
+	 otherwise they refer to the result of an earlier instruction. */
+	struct Instruction
+	{
+		int opcode;
+		int operands[MaxOperands];
+	};
+	
+	/** Replace the chains of operators in a graph with fused nodes, in place.
+	 
+	 This must be done before UGen::shareOutputBlocks() (nodes already mapped onto scratch 
+	 blocks are left alone). The graph must not be being rendered on another thread.
+	 @return	The number of fused nodes created. */
+	static int fuse(UGen& graph) throw();
+	
+	FusedExpressionUGenInternal(UGenArray const& leaves, 
+								ObjectArray<Instruction> const& instructions) throw();
+	~FusedExpressionUGenInternal();
+	
+	UGenInternal* getChannel(const int channel) throw();
+	UGenInternal* getKr() throw();
+	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	float getValue(const int channel) const throw();
+	bool hasSharableOutput() const throw() { return true; }
+	
+	inline int getNumInstructions() const throw()	{ return numInstructions; }
+	
+private:
+	class Fuser;
+	
+	inline const float* getOperand(const int operand, const int offset) const throw()
+	{
+		return (operand < (int)numInputs_) ? inputSamples[operand] + offset * inputStrides[operand]
+										   : temporaries + (operand - numInputs_) * TileSize;
+	}
+	
+	inline bool isScalarOperand(const int operand) const throw()
+	{
+		return (operand < (int)numInputs_) && (inputStrides[operand] == 0);
+	}
+	
+	float getOperandValue(const int operand, const int channel) const throw();
+	UGen getOperandUGen(const int operand) const throw();
+	
+	int numInstructions;
+	Instruction* instructions;
+	const float** inputSamples;
+	int* inputStrides;			// 1 for blocks, 0 for the scalars in constants
+	float* scalarValues;		// the values of the scalar inputs
+	float* constants;			// a tile for each input which may hold a scalar
+	float* temporaries;			// a tile for each instruction
+};
+
+
+#endif // UGEN_FUSEDEXPRESSION_H
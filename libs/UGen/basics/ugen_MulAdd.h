@@ -233,6 +233,8 @@ public:
 	UGenInternal* getChannel(const int channel) throw();
 	UGenInternal* getKr() throw();
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	float getValue(const int channel) const throw();
+	bool hasSharableOutput() const throw() { return true; }
 	
 	enum Inputs { Input, Mul, Add, NumInputs };
 	
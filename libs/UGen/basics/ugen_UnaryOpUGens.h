@@ -311,6 +311,8 @@ public:
 	
 	enum Inputs { Operand, NumInputs };
 	
+	bool hasSharableOutput() const throw() { return true; }
+	
 protected:
 };
 
@@ -0,0 +1,1345 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "../core/ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_AudioFile.h"
+#include "../core/ugen_SIMD.h"
+#include "../core/ugen_Thread.h"
+#include "../basics/ugen_InlineBinaryOps.h"
+
+int AudioFile::maximumDecodeThreads = BackgroundThread::getNumProcessors();
+
+// byte order helpers, file data is unsigned bytes so sign extension is explicit
+
+static inline unsigned int littleEndian16(const unsigned char* bytes) throw()	{ return bytes[0] | (bytes[1] << 8);	}
+static inline unsigned int bigEndian16(const unsigned char* bytes) throw()		{ return (bytes[0] << 8) | bytes[1];	}
+
+static inline unsigned int littleEndian32(const unsigned char* bytes) throw()
+{
+	return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) | ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static inline unsigned int bigEndian32(const unsigned char* bytes) throw()
+{
+	return ((unsigned int)bytes[0] << 24) | ((unsigned int)bytes[1] << 16) | ((unsigned int)bytes[2] << 8) | (unsigned int)bytes[3];
+}
+
+static inline bool isChunkID(const unsigned char* bytes, const char* chunkID) throw()
+{
+	return memcmp(bytes, chunkID, 4) == 0;
+}
+
+/** Decode an 80-bit IEEE extended float, as used for the AIFF sample rate. */
+static double extendedToDouble(const unsigned char* bytes) throw()
+{
+	const int exponent = ((bytes[0] & 0x7F) << 8) | bytes[1];
+	const unsigned int hiMantissa = bigEndian32(bytes + 2);
+	const unsigned int loMantissa = bigEndian32(bytes + 6);
+	
+	if(exponent == 0 && hiMantissa == 0 && loMantissa == 0) 
+		return 0.0;
+	
+	const double value = ldexp((double)hiMantissa, exponent - 16383 - 31) + ldexp((double)loMantissa, exponent - 16383 - 63);
+	return (bytes[0] & 0x80) ? -value : value;
+}
+
+/** Encode a positive number as an 80-bit IEEE extended float. */
+static void doubleToExtended(const double value, unsigned char* bytes) throw()
+{
+	memset(bytes, 0, 10);
+	
+	if(value <= 0.0) 
+		return;
+	
+	int exponent;
+	const double mantissa = frexp(value, &exponent); // 0.5 <= mantissa < 1 so the integer bit is set
+	exponent += 16382;
+	
+	const double hiPart = ldexp(mantissa, 32);
+	const unsigned int hiMantissa = (unsigned int)hiPart;
+	const unsigned int loMantissa = (unsigned int)ldexp(hiPart - hiMantissa, 32);
+	
+	bytes[0] = (exponent >> 8) & 0x7F;
+	bytes[1] = exponent & 0xFF;
+	
+	for(int i = 0; i < 4; i++)
+	{
+		bytes[2 + i] = (hiMantissa >> (24 - i * 8)) & 0xFF;
+		bytes[6 + i] = (loMantissa >> (24 - i * 8)) & 0xFF;
+	}
+}
+
+static inline float intToFloatFactor(const int bitsPerSample) throw()
+{
+	switch(bitsPerSample)
+	{
+		case 16:	return 1.0 / 0x7FFF;
+		case 24:	return 1.0 / 0x7FFFFF;
+		default:	return 1.0 / 0x7FFFFFFF;
+	}
+}
+
+static inline float floatToIntFactor(const int bitsPerSample) throw()
+{
+	switch(bitsPerSample)
+	{
+		case 16:	return 0x7FFF;
+		case 24:	return 0x7FFFFF;
+		default:	return 0x7FFFFFFF;
+	}
+}
+
+/** The layout of the sample data in a file. */
+class AudioFileFormat
+{
+public:
+	AudioFileFormat() throw()
+	:	numChannels(0),
+		numFrames(0),
+		bitsPerSample(0),
+		bytesPerSample(0),
+		isFloat(false),
+		isBigEndian(false),
+		dataOffset(0),
+		sampleRate(0.0)
+	{
+	}
+	
+	inline int getBytesPerFrame() const throw() { return numChannels * bytesPerSample; }
+	
+	/** Check the format is one we can decode and limit the number of frames to the data in the file. */
+	bool validate(const unsigned int dataSize, const long fileSize) throw()
+	{
+		if(numChannels < 1 || sampleRate <= 0.0) 
+			return false;
+		
+		if(isFloat ? (bitsPerSample != 32) : (bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32))
+			return false;
+		
+		bytesPerSample = bitsPerSample / 8;
+		
+		const long available = fileSize > dataOffset ? fileSize - dataOffset : 0;
+		const long size = (long)dataSize < available ? (long)dataSize : available; // truncated files are common
+		const long frames = size / getBytesPerFrame();
+		
+		numFrames = frames < 0x7FFFFFFF ? (int)frames : 0x7FFFFFFF;
+		return true;
+	}
+	
+	int numChannels;
+	int numFrames;
+	int bitsPerSample;
+	int bytesPerSample;
+	bool isFloat;
+	bool isBigEndian;
+	long dataOffset;
+	double sampleRate;
+};
+
+/** The contents of a (small) chunk. */
+class AudioFileChunk
+{
+public:
+	AudioFileChunk() throw()
+	:	position(-1), size(0), data(0)
+	{
+	}
+	
+	~AudioFileChunk()
+	{
+		delete [] data;
+	}
+	
+	/** Note where the chunk is, it's read later if it's needed. */
+	void set(const long chunkPosition, const unsigned int chunkSize) throw()
+	{
+		position = chunkPosition;
+		size = chunkSize;
+	}
+	
+	bool read(FILE* file) throw()
+	{
+		if(position < 0 || size > MaximumSize || fseek(file, position, SEEK_SET) != 0)
+			return false;
+		
+		delete [] data;
+		data = new unsigned char[size + 1]; // + 1 so text at the end is always terminated
+		size = (unsigned int)fread(data, 1, size, file);
+		data[size] = 0;
+		return true;
+	}
+	
+	inline bool contains(const unsigned int offset, const unsigned int numBytes) const throw() 
+	{ 
+		return (data != 0) && (offset <= size) && (numBytes <= size - offset); 
+	}
+	
+	inline const unsigned char* at(const unsigned int offset) const throw()	{ return data + offset; }
+	inline unsigned int getSize() const throw()								{ return size;			}
+	
+	/** A null terminated string of at most numBytes. */
+	Text getText(const unsigned int offset, const unsigned int numBytes) const throw()
+	{
+		if(!contains(offset, numBytes)) 
+			return Text();
+		
+		unsigned int length = 0;
+		while(length < numBytes && data[offset + length] != 0) 
+			length++;
+		
+		return length > 0 ? Text(length + 1, (const char*)data + offset, true) : Text(); // the size includes the null
+	}
+	
+private:
+	enum { MaximumSize = 1 << 24 }; // metadata chunks are small, this avoids allocating huge bogus ones
+	
+	long position;
+	unsigned int size;
+	unsigned char* data;
+	
+	AudioFileChunk (const AudioFileChunk&);
+	const AudioFileChunk& operator= (const AudioFileChunk&);
+};
+
+static int indexOfCuePoint(CuePointArray const& cuePoints, const int cueID) throw()
+{
+	for(int i = 0; i < cuePoints.length(); i++)
+		if(cuePoints[i].getID() == cueID)
+			return i;
+	
+	return -1;
+}
+
+static bool parseWav(FILE* file, const long fileSize, AudioFileFormat& format, 
+					 CuePointArray& cuePoints, LoopPointArray& loopPoints) throw()
+{
+	AudioFileChunk fmtChunk, cueChunk, listChunk, smplChunk;
+	unsigned int dataSize = 0;
+	bool hasData = false;
+	
+	unsigned char header[8];
+	long position = 12;
+	
+	while(fseek(file, position, SEEK_SET) == 0 && fread(header, 1, 8, file) == 8)
+	{
+		const unsigned int chunkSize = littleEndian32(header + 4);
+		const long chunkPosition = position + 8;
+		
+		if(isChunkID(header, "fmt "))		fmtChunk.set(chunkPosition, chunkSize);
+		else if(isChunkID(header, "cue "))	cueChunk.set(chunkPosition, chunkSize);
+		else if(isChunkID(header, "smpl"))	smplChunk.set(chunkPosition, chunkSize);
+		else if(isChunkID(header, "LIST"))
+		{
+			// only the associated data list has the cue labels, others (e.g., INFO) may come after it
+			unsigned char listType[4];
+			
+			if(chunkSize >= 4 && fread(listType, 1, 4, file) == 4 && isChunkID(listType, "adtl"))
+				listChunk.set(chunkPosition, chunkSize);
+		}
+		else if(isChunkID(header, "data"))
+		{
+			format.dataOffset = chunkPosition;
+			dataSize = chunkSize;
+			hasData = true;
+		}
+		
+		position = chunkPosition + chunkSize + (chunkSize & 1);
+	}
+	
+	if(!hasData || !fmtChunk.read(file) || !fmtChunk.contains(0, 16)) 
+		return false;
+	
+	enum { PCM = 1, IEEEFloat = 3, Extensible = 0xFFFE };
+	
+	unsigned int formatTag = littleEndian16(fmtChunk.at(0));
+	
+	if(formatTag == Extensible && fmtChunk.contains(24, 2))
+		formatTag = littleEndian16(fmtChunk.at(24)); // the start of the sub format GUID
+	
+	if(formatTag != PCM && formatTag != IEEEFloat)
+		return false;
+	
+	format.numChannels = littleEndian16(fmtChunk.at(2));
+	format.sampleRate = littleEndian32(fmtChunk.at(4));
+	format.bitsPerSample = littleEndian16(fmtChunk.at(14));
+	format.isFloat = formatTag == IEEEFloat;
+	format.isBigEndian = false;
+	
+	const unsigned int blockAlign = littleEndian16(fmtChunk.at(12));
+	
+	if(!format.validate(dataSize, fileSize) || blockAlign != (unsigned int)format.getBytesPerFrame())
+		return false;
+	
+	if(cueChunk.read(file) && cueChunk.contains(0, 4))
+	{
+		const unsigned int numCuePoints = littleEndian32(cueChunk.at(0));
+		
+		for(unsigned int i = 0; i < numCuePoints && cueChunk.contains(4 + i * 24, 24); i++)
+		{
+			const unsigned char* cue = cueChunk.at(4 + i * 24);
+			
+			CuePoint cuePoint;
+			cuePoint.getID() = (int)littleEndian32(cue);
+			cuePoint.getSampleOffset() = (int)littleEndian32(cue + 20);
+			cuePoints.add(cuePoint);
+		}
+	}
+	
+	if(listChunk.read(file) && listChunk.contains(0, 4) && isChunkID(listChunk.at(0), "adtl"))
+	{
+		unsigned int offset = 4;
+		
+		while(listChunk.contains(offset, 8))
+		{
+			const unsigned char* subChunk = listChunk.at(offset);
+			const unsigned int subChunkSize = littleEndian32(subChunk + 4);
+			
+			if(subChunkSize >= 4 && listChunk.contains(offset + 8, subChunkSize))
+			{
+				const int index = indexOfCuePoint(cuePoints, (int)littleEndian32(subChunk + 8));
+				
+				if(index >= 0)
+				{
+					if(isChunkID(subChunk, "labl"))
+						cuePoints[index].getLabel() = listChunk.getText(offset + 12, subChunkSize - 4);
+					else if(isChunkID(subChunk, "note"))
+						cuePoints[index].getComment() = listChunk.getText(offset + 12, subChunkSize - 4);
+				}
+			}
+			
+			offset += 8 + subChunkSize + (subChunkSize & 1);
+		}
+	}
+	
+	if(smplChunk.read(file) && smplChunk.contains(0, 36))
+	{
+		static const int types[] = { LoopPoint::Forward, LoopPoint::PingPong, LoopPoint::Reverse };
+		const unsigned int numLoops = littleEndian32(smplChunk.at(28));
+		
+		for(unsigned int i = 0; i < numLoops && smplChunk.contains(36 + i * 24, 24); i++)
+		{
+			const unsigned char* loop = smplChunk.at(36 + i * 24);
+			const unsigned int type = littleEndian32(loop + 4);
+			
+			LoopPoint loopPoint;
+			loopPoint.getID() = (int)littleEndian32(loop);
+			loopPoint.getType() = type < 3 ? types[type] : LoopPoint::Forward;
+			loopPoint.getStartPoint().getSampleOffset() = (int)littleEndian32(loop + 8);
+			loopPoint.getEndPoint().getSampleOffset() = (int)littleEndian32(loop + 12);
+			loopPoints.add(loopPoint);
+		}
+	}
+	
+	return true;
+}
+
+static bool parseAiff(FILE* file, const long fileSize, const bool isAifc, AudioFileFormat& format, 
+					  CuePointArray& cuePoints, LoopPointArray& loopPoints) throw()
+{
+	AudioFileChunk commChunk, markChunk, instChunk;
+	unsigned int dataSize = 0;
+	bool hasData = false;
+	
+	unsigned char header[16];
+	long position = 12;
+	
+	while(fseek(file, position, SEEK_SET) == 0 && fread(header, 1, 8, file) == 8)
+	{
+		const unsigned int chunkSize = bigEndian32(header + 4);
+		const long chunkPosition = position + 8;
+		
+		if(isChunkID(header, "COMM"))		commChunk.set(chunkPosition, chunkSize);
+		else if(isChunkID(header, "MARK"))	markChunk.set(chunkPosition, chunkSize);
+		else if(isChunkID(header, "INST"))	instChunk.set(chunkPosition, chunkSize);
+		else if(isChunkID(header, "SSND") && chunkSize >= 8 && fread(header + 8, 1, 8, file) == 8)
+		{
+			const unsigned int offset = bigEndian32(header + 8);
+			format.dataOffset = chunkPosition + 8 + offset;
+			dataSize = chunkSize - 8 > offset ? chunkSize - 8 - offset : 0;
+			hasData = true;
+		}
+		
+		position = chunkPosition + chunkSize + (chunkSize & 1);
+	}
+	
+	if(!hasData || !commChunk.read(file) || !commChunk.contains(0, 18)) 
+		return false;
+	
+	format.numChannels = (short)bigEndian16(commChunk.at(0));
+	format.bitsPerSample = (short)bigEndian16(commChunk.at(6));
+	format.sampleRate = extendedToDouble(commChunk.at(8));
+	format.isFloat = false;
+	format.isBigEndian = true;
+	
+	if(isAifc)
+	{
+		if(!commChunk.contains(18, 4)) 
+			return false;
+		
+		const unsigned char* compression = commChunk.at(18);
+		
+		if(isChunkID(compression, "sowt"))
+			format.isBigEndian = false;
+		else if(isChunkID(compression, "fl32") || isChunkID(compression, "FL32"))
+			format.isFloat = true;
+		else if(!isChunkID(compression, "NONE") && !isChunkID(compression, "twos"))
+			return false;
+	}
+	
+	const unsigned int numFrames = bigEndian32(commChunk.at(2));
+	
+	if(!format.validate(dataSize, fileSize))
+		return false;
+	
+	if((unsigned int)format.numFrames > numFrames)
+		format.numFrames = (int)numFrames;
+	
+	if(markChunk.read(file) && markChunk.contains(0, 2))
+	{
+		const unsigned int numMarkers = bigEndian16(markChunk.at(0));
+		unsigned int offset = 2;
+		
+		for(unsigned int i = 0; i < numMarkers && markChunk.contains(offset, 7); i++)
+		{
+			const unsigned char* marker = markChunk.at(offset);
+			const unsigned int labelLength = marker[6];
+			
+			CuePoint cuePoint;
+			cuePoint.getID() = (short)bigEndian16(marker);
+			cuePoint.getSampleOffset() = (int)bigEndian32(marker + 2);
+			cuePoint.getLabel() = markChunk.getText(offset + 7, labelLength);
+			cuePoints.add(cuePoint);
+			
+			offset += 7 + labelLength + ((labelLength & 1) == 0); // the pascal string is padded to an even length
+		}
+	}
+	
+	if(instChunk.read(file) && instChunk.contains(0, 20))
+	{
+		static const int types[] = { LoopPoint::NoLoop, LoopPoint::Forward, LoopPoint::PingPong };
+		
+		for(int i = 0; i < 2; i++) // the sustain loop then the release loop
+		{
+			const unsigned char* loop = instChunk.at(8 + i * 6);
+			const unsigned int playMode = bigEndian16(loop);
+			const int startIndex = indexOfCuePoint(cuePoints, (short)bigEndian16(loop + 2));
+			const int endIndex = indexOfCuePoint(cuePoints, (short)bigEndian16(loop + 4));
+			
+			if(playMode == 0 || playMode > 2 || startIndex < 0 || endIndex < 0)
+				continue;
+			
+			LoopPoint loopPoint;
+			loopPoint.getID() = cuePoints[startIndex].getID();
+			loopPoint.getType() = types[playMode];
+			loopPoint.getStartPoint() = cuePoints[startIndex];
+			loopPoint.getEndPoint() = cuePoints[endIndex];
+			loopPoints.add(loopPoint);
+		}
+	}
+	
+	return true;
+}
+
+/** Gather one channel's samples from interleaved frames as ints, float data keeps its bit pattern. */
+static void unpackChannel(const unsigned char* bytes, AudioFileFormat const& format, int* samples, const int numFrames) throw()
+{
+	const int stride = format.getBytesPerFrame();
+	
+	switch(format.bytesPerSample * (format.isBigEndian ? -1 : 1))
+	{
+		case 2:
+			for(int i = 0; i < numFrames; i++, bytes += stride)
+				samples[i] = (short)(bytes[0] | (bytes[1] << 8));
+			break;
+		case -2:
+			for(int i = 0; i < numFrames; i++, bytes += stride)
+				samples[i] = (short)((bytes[0] << 8) | bytes[1]);
+			break;
+		case 3:
+			for(int i = 0; i < numFrames; i++, bytes += stride)
+				samples[i] = ((int)(signed char)bytes[2] << 16) | (bytes[1] << 8) | bytes[0];
+			break;
+		case -3:
+			for(int i = 0; i < numFrames; i++, bytes += stride)
+				samples[i] = ((int)(signed char)bytes[0] << 16) | (bytes[1] << 8) | bytes[2];
+			break;
+		case 4:
+			for(int i = 0; i < numFrames; i++, bytes += stride)
+				samples[i] = (int)littleEndian32(bytes);
+			break;
+		case -4:
+			for(int i = 0; i < numFrames; i++, bytes += stride)
+				samples[i] = (int)bigEndian32(bytes);
+			break;
+	}
+}
+
+/** Interleave one channel's samples into frames. */
+static void packChannel(const int* samples, const int bytesPerSample, const bool isBigEndian, 
+						unsigned char* bytes, const int stride, const int numFrames) throw()
+{
+	for(int i = 0; i < numFrames; i++, bytes += stride)
+	{
+		const unsigned int sample = (unsigned int)samples[i];
+		
+		for(int b = 0; b < bytesPerSample; b++)
+		{
+			const int shift = (isBigEndian ? bytesPerSample - 1 - b : b) * 8;
+			bytes[b] = (sample >> shift) & 0xFF;
+		}
+	}
+}
+
+/** Convert a chunk of interleaved frames into each channel's samples starting at an offset. */
+static void decodeChunk(const unsigned char* bytes, AudioFileFormat const& format, int* samples, 
+						float* const* channels, const int offset, const int numFrames) throw()
+{
+	const float factor = intToFloatFactor(format.bitsPerSample);
+	
+	for(int channel = 0; channel < format.numChannels; channel++)
+	{
+		float* const output = channels[channel] + offset;
+		unpackChannel(bytes + channel * format.bytesPerSample, format, samples, numFrames);
+		
+		if(format.isFloat)
+			memcpy(output, samples, numFrames * sizeof(float));
+		else
+			SIMD::intToFloat(samples, factor, output, numFrames);
+	}
+}
+
+/** Read and convert a range of frames, each decoding thread opens the file itself. */
+static bool decodeFrames(const char* path, AudioFileFormat const& format, float* const* channels, 
+						 const int startFrame, const int endFrame) throw()
+{
+	if(startFrame >= endFrame) 
+		return true;
+	
+	FILE* file = fopen(path, "rb");
+	
+	if(file == 0) 
+		return false;
+	
+	const int bytesPerFrame = format.getBytesPerFrame();
+	
+	unsigned char* bytes = new unsigned char[AudioFile::ChunkFrames * bytesPerFrame];
+	int* samples = new int[AudioFile::ChunkFrames];
+	
+	bool succeeded = fseek(file, format.dataOffset + (long)startFrame * bytesPerFrame, SEEK_SET) == 0;
+	
+	for(int frame = startFrame; succeeded && frame < endFrame; frame += AudioFile::ChunkFrames)
+	{
+		const int numFrames = ugen::min((int)AudioFile::ChunkFrames, endFrame - frame);
+		
+		if((int)fread(bytes, bytesPerFrame, numFrames, file) != numFrames)
+		{
+			succeeded = false;
+			break;
+		}
+		
+		decodeChunk(bytes, format, samples, channels, frame, numFrames);
+	}
+	
+	delete [] samples;
+	delete [] bytes;
+	fclose(file);
+	return succeeded;
+}
+
+/** Decodes a range of frames on another thread. */
+class AudioFileDecodeThread : public BackgroundThread
+{
+public:
+	AudioFileDecodeThread(const char* pathToUse, AudioFileFormat const& formatToUse, float* const* channelsToUse,
+						  const int startFrameToUse, const int endFrameToUse) throw()
+	:	path(pathToUse),
+		format(formatToUse),
+		channels(channelsToUse),
+		startFrame(startFrameToUse),
+		endFrame(endFrameToUse),
+		succeeded(false)
+	{
+	}
+	
+	~AudioFileDecodeThread()
+	{
+		stopThread();
+	}
+	
+	/** Wait for the range to be decoded, if the thread couldn't be started it's decoded here. */
+	bool finish() throw()
+	{
+		if(isThreadRunning())
+			stopThread(); // run() doesn't check threadShouldExit() so this waits for it to finish
+		else
+			run();
+		
+		return succeeded;
+	}
+	
+protected:
+	void run()
+	{
+		succeeded = decodeFrames(path, format, channels, startFrame, endFrame);
+	}
+	
+private:
+	const char* path;
+	AudioFileFormat const& format;
+	float* const* channels;
+	const int startFrame, endFrame;
+	bool succeeded;
+};
+
+/** Parse the header of an open file. */
+static bool readFormat(FILE* file, AudioFileFormat& format, CuePointArray& cuePoints, LoopPointArray& loopPoints) throw()
+{
+	fseek(file, 0, SEEK_END);
+	const long fileSize = ftell(file);
+	
+	unsigned char header[12];
+	
+	if(fseek(file, 0, SEEK_SET) != 0 || fread(header, 1, 12, file) != 12)
+		return false;
+	
+	if(isChunkID(header, "RIFF") && isChunkID(header + 8, "WAVE"))
+		return parseWav(file, fileSize, format, cuePoints, loopPoints);
+	else if(isChunkID(header, "FORM") && (isChunkID(header + 8, "AIFF") || isChunkID(header + 8, "AIFC")))
+		return parseAiff(file, fileSize, isChunkID(header + 8, "AIFC"), format, cuePoints, loopPoints);
+	
+	return false;
+}
+
+double AudioFile::read(const char* path, Buffer& buffer, int* bits, MetaData* metaData) throw()
+{
+	buffer = Buffer();
+	
+	if(bits) *bits = 0;
+	
+	if(path == 0 || path[0] == 0) 
+	{
+		printf("AudioFile: File path is null\n");
+		return 0.0;
+	}
+	
+	FILE* file = fopen(path, "rb");
+	
+	if(file == 0) 
+	{
+		printf("AudioFile: Could not open file: %s\n", path);
+		return 0.0;
+	}
+	
+	AudioFileFormat format;
+	CuePointArray cuePoints;
+	LoopPointArray loopPoints;
+	const bool parsed = readFormat(file, format, cuePoints, loopPoints);
+	
+	fclose(file);
+	
+	if(!parsed) 
+	{
+		printf("AudioFile: Sound file format not supported: %s\n", path);
+		return 0.0;
+	}
+	
+	if(format.numFrames < 1)
+		return 0.0;
+	
+	Buffer decoded = Buffer::withSize(format.numFrames, format.numChannels, false);
+	float** channels = new float*[format.numChannels];
+	
+	for(int channel = 0; channel < format.numChannels; channel++)
+		channels[channel] = decoded.getDataUnchecked(channel);
+	
+	// split the frames into ranges for the other threads, the calling thread decodes the first range
+	const int samplesPerFrame = format.numChannels;
+	const int maximumThreads = (int)ugen::min((double)getMaximumDecodeThreads(), 
+											  (double)format.numFrames * samplesPerFrame / MinimumSamplesPerThread);
+	const int numThreads = ugen::max(1, maximumThreads);
+	
+	ObjectArray<AudioFileDecodeThread*> threads;
+	
+	for(int i = 1; i < numThreads; i++)
+	{
+		AudioFileDecodeThread* thread = new AudioFileDecodeThread(path, format, channels,
+																  (int)((double)format.numFrames * i / numThreads),
+																  (int)((double)format.numFrames * (i + 1) / numThreads));
+		thread->startThread();
+		threads.add(thread);
+	}
+	
+	bool succeeded = decodeFrames(path, format, channels, 0, (int)((double)format.numFrames / numThreads));
+	
+	for(int i = 0; i < threads.length(); i++)
+	{
+		succeeded = threads[i]->finish() && succeeded;
+		delete threads[i];
+	}
+	
+	delete [] channels;
+	
+	if(!succeeded)
+	{
+		printf("AudioFile: Could not read audio data: %s\n", path);
+		return 0.0;
+	}
+	
+	buffer = decoded;
+	
+	if(bits) *bits = format.bitsPerSample;
+	
+	if(metaData)
+	{
+		for(int i = 0; i < cuePoints.length(); i++)
+			metaData->getCuePoints().add(cuePoints[i]);
+		
+		for(int i = 0; i < loopPoints.length(); i++)
+			metaData->getLoopPoints().add(loopPoints[i]);
+	}
+	
+	return format.sampleRate;
+}
+
+// writing helpers
+
+static inline void writeID(FILE* file, const char* chunkID) throw()
+{
+	fwrite(chunkID, 1, 4, file);
+}
+
+static void writeInt(FILE* file, const unsigned int value, const int numBytes, const bool isBigEndian) throw()
+{
+	unsigned char bytes[4];
+	
+	for(int b = 0; b < numBytes; b++)
+		bytes[b] = (value >> ((isBigEndian ? numBytes - 1 - b : b) * 8)) & 0xFF;
+	
+	fwrite(bytes, 1, numBytes, file);
+}
+
+static inline void writeLittleEndian16(FILE* file, const unsigned int value) throw()	{ writeInt(file, value, 2, false);	}
+static inline void writeLittleEndian32(FILE* file, const unsigned int value) throw()	{ writeInt(file, value, 4, false);	}
+static inline void writeBigEndian16(FILE* file, const unsigned int value) throw()		{ writeInt(file, value, 2, true);	}
+static inline void writeBigEndian32(FILE* file, const unsigned int value) throw()		{ writeInt(file, value, 4, true);	}
+
+/** Write text with a terminating null padded to an even length, as used in WAV 'adtl' chunks. */
+static void writeEvenText(FILE* file, Text const& text) throw()
+{
+	const int length = text.length();
+	
+	if(length > 0) 
+		fwrite(text.getArray(), 1, length, file);
+	
+	fputc(0, file);
+	
+	if((length & 1) == 0) 
+		fputc(0, file);
+}
+
+static inline unsigned int evenTextSize(Text const& text) throw()
+{
+	const unsigned int length = text.length() + 1;
+	return length + (length & 1);
+}
+
+/** Convert and write frames using working memory for AudioFile::ChunkFrames frames. */
+static void encodeFrames(FILE* file, const float* const* channels, const int numChannels, const int size,
+						 const int bitsPerSample, const bool isBigEndian, unsigned char* bytes, int* samples) throw()
+{
+	const int bytesPerSample = bitsPerSample / 8;
+	const int bytesPerFrame = numChannels * bytesPerSample;
+	const float factor = floatToIntFactor(bitsPerSample);
+	
+	for(int frame = 0; frame < size; frame += AudioFile::ChunkFrames)
+	{
+		const int numFrames = ugen::min((int)AudioFile::ChunkFrames, size - frame);
+		
+		for(int channel = 0; channel < numChannels; channel++)
+		{
+			SIMD::floatToInt(channels[channel] + frame, factor, samples, numFrames);
+			packChannel(samples, bytesPerSample, isBigEndian, bytes + channel * bytesPerSample, bytesPerFrame, numFrames);
+		}
+		
+		fwrite(bytes, bytesPerFrame, numFrames, file);
+	}
+}
+
+static void writeSampleData(FILE* file, Buffer const& buffer, const int bitsPerSample, const bool isBigEndian) throw()
+{
+	const int numChannels = buffer.getNumChannels();
+	const int size = buffer.size();
+	const int bytesPerFrame = numChannels * (bitsPerSample / 8);
+	
+	unsigned char* bytes = new unsigned char[AudioFile::ChunkFrames * bytesPerFrame];
+	int* samples = new int[AudioFile::ChunkFrames];
+	const float** channels = new const float*[numChannels];
+	
+	for(int channel = 0; channel < numChannels; channel++)
+		channels[channel] = buffer.getDataUnchecked(channel);
+	
+	encodeFrames(file, channels, numChannels, size, bitsPerSample, isBigEndian, bytes, samples);
+	
+	const unsigned int dataSize = (unsigned int)size * bytesPerFrame;
+	
+	if(dataSize & 1) 
+		fputc(0, file);
+	
+	delete [] channels;
+	delete [] samples;
+	delete [] bytes;
+}
+
+/** Write everything up to the sample data, the RIFF size is left for the caller to patch. */
+static void writeWavHeader(FILE* file, const int numChannels, const int bitsPerSample, 
+						   const double sampleRate, const int numFrames) throw()
+{
+	const unsigned int bytesPerFrame = numChannels * (bitsPerSample / 8);
+	const unsigned int dataSize = (unsigned int)numFrames * bytesPerFrame;
+	
+	writeID(file, "RIFF");
+	writeLittleEndian32(file, 0); // patched when we know the size
+	writeID(file, "WAVE");
+	
+	writeID(file, "fmt ");
+	writeLittleEndian32(file, 16);
+	writeLittleEndian16(file, 1); // PCM
+	writeLittleEndian16(file, numChannels);
+	writeLittleEndian32(file, (unsigned int)(sampleRate + 0.5));
+	writeLittleEndian32(file, (unsigned int)(sampleRate + 0.5) * bytesPerFrame);
+	writeLittleEndian16(file, bytesPerFrame);
+	writeLittleEndian16(file, bitsPerSample);
+	
+	writeID(file, "data");
+	writeLittleEndian32(file, dataSize);
+}
+
+/** Write everything up to the sample data, the FORM size is left for the caller to patch. */
+static void writeAiffHeader(FILE* file, const int numChannels, const int bitsPerSample, 
+							const double sampleRate, const int numFrames) throw()
+{
+	const unsigned int dataSize = (unsigned int)numFrames * numChannels * (bitsPerSample / 8);
+	
+	writeID(file, "FORM");
+	writeBigEndian32(file, 0); // patched when we know the size
+	writeID(file, "AIFF");
+	
+	writeID(file, "COMM");
+	writeBigEndian32(file, 18);
+	writeBigEndian16(file, numChannels);
+	writeBigEndian32(file, numFrames);
+	writeBigEndian16(file, bitsPerSample);
+	
+	unsigned char extended[10];
+	doubleToExtended(sampleRate, extended);
+	fwrite(extended, 1, 10, file);
+	
+	writeID(file, "SSND");
+	writeBigEndian32(file, 8 + dataSize);
+	writeBigEndian32(file, 0); // offset
+	writeBigEndian32(file, 0); // block size
+}
+
+static void writeWav(FILE* file, Buffer const& buffer, const int bitsPerSample, 
+					 const double sampleRate, MetaData const& metaData) throw()
+{
+	writeWavHeader(file, buffer.getNumChannels(), bitsPerSample, sampleRate, buffer.size());
+	writeSampleData(file, buffer, bitsPerSample, false);
+	
+	// cue points are renumbered by their index, the labels and comments refer to these
+	CuePointArray const& cuePoints = metaData.getCuePoints();
+	const int numCuePoints = cuePoints.length();
+	
+	if(numCuePoints > 0)
+	{
+		writeID(file, "cue ");
+		writeLittleEndian32(file, 4 + numCuePoints * 24);
+		writeLittleEndian32(file, numCuePoints);
+		
+		unsigned int listSize = 4; // 'adtl'
+		
+		for(int i = 0; i < numCuePoints; i++)
+		{
+			writeLittleEndian32(file, i);
+			writeLittleEndian32(file, cuePoints[i].getSampleOffset()); // position in playlist order
+			writeID(file, "data");
+			writeLittleEndian32(file, 0);
+			writeLittleEndian32(file, 0);
+			writeLittleEndian32(file, cuePoints[i].getSampleOffset());
+			
+			if(cuePoints[i].getLabel().length() > 0)	listSize += 12 + evenTextSize(cuePoints[i].getLabel());
+			if(cuePoints[i].getComment().length() > 0)	listSize += 12 + evenTextSize(cuePoints[i].getComment());
+		}
+		
+		if(listSize > 4)
+		{
+			writeID(file, "LIST");
+			writeLittleEndian32(file, listSize);
+			writeID(file, "adtl");
+			
+			for(int i = 0; i < numCuePoints; i++)
+			{
+				if(cuePoints[i].getLabel().length() > 0)
+				{
+					writeID(file, "labl");
+					writeLittleEndian32(file, 4 + cuePoints[i].getLabel().length() + 1);
+					writeLittleEndian32(file, i);
+					writeEvenText(file, cuePoints[i].getLabel());
+				}
+				
+				if(cuePoints[i].getComment().length() > 0)
+				{
+					writeID(file, "note");
+					writeLittleEndian32(file, 4 + cuePoints[i].getComment().length() + 1);
+					writeLittleEndian32(file, i);
+					writeEvenText(file, cuePoints[i].getComment());
+				}
+			}
+		}
+	}
+	
+	LoopPointArray const& loopPoints = metaData.getLoopPoints();
+	int numLoops = 0;
+	
+	for(int i = 0; i < loopPoints.length(); i++)
+		if(loopPoints[i].getType() != LoopPoint::NoLoop)
+			numLoops++;
+	
+	if(numLoops > 0)
+	{
+		writeID(file, "smpl");
+		writeLittleEndian32(file, 36 + numLoops * 24);
+		writeLittleEndian32(file, 0); // manufacturer
+		writeLittleEndian32(file, 0); // product
+		writeLittleEndian32(file, (unsigned int)(1000000000.0 / sampleRate + 0.5)); // sample period in ns
+		writeLittleEndian32(file, 60); // MIDI unity note
+		writeLittleEndian32(file, 0); // pitch fraction
+		writeLittleEndian32(file, 0); // SMPTE format
+		writeLittleEndian32(file, 0); // SMPTE offset
+		writeLittleEndian32(file, numLoops);
+		writeLittleEndian32(file, 0); // sampler data
+		
+		for(int i = 0; i < loopPoints.length(); i++)
+		{
+			LoopPoint const& loopPoint = loopPoints[i];
+			
+			if(loopPoint.getType() == LoopPoint::NoLoop)
+				continue;
+			
+			const int type = loopPoint.getType() == LoopPoint::PingPong ? 1 : loopPoint.getType() == LoopPoint::Reverse ? 2 : 0;
+			
+			writeLittleEndian32(file, i);
+			writeLittleEndian32(file, type);
+			writeLittleEndian32(file, loopPoint.getStartPoint().getSampleOffset());
+			writeLittleEndian32(file, loopPoint.getEndPoint().getSampleOffset());
+			writeLittleEndian32(file, 0); // fraction
+			writeLittleEndian32(file, 0); // play count (infinite)
+		}
+	}
+	
+	const long fileSize = ftell(file);
+	fseek(file, 4, SEEK_SET);
+	writeLittleEndian32(file, (unsigned int)(fileSize - 8));
+}
+
+/** AIFF loops refer to markers, loop points which use one of the cue points share its marker. */
+static int findOrAddMarker(CuePointArray& markers, CuePoint const& cuePoint) throw()
+{
+	for(int i = 0; i < markers.length(); i++)
+		if(markers[i].getInternal() == cuePoint.getInternal())
+			return i + 1;
+	
+	markers.add(cuePoint);
+	return markers.length();
+}
+
+static void writeAiff(FILE* file, Buffer const& buffer, const int bitsPerSample, 
+					  const double sampleRate, MetaData const& metaData) throw()
+{
+	writeAiffHeader(file, buffer.getNumChannels(), bitsPerSample, sampleRate, buffer.size());
+	writeSampleData(file, buffer, bitsPerSample, true);
+	
+	// marker IDs must be non-zero so they are numbered from 1, AIFF has only two loops
+	CuePointArray markers;
+	
+	for(int i = 0; i < metaData.getCuePoints().length(); i++)
+		markers.add(metaData.getCuePoints()[i]);
+	
+	int loopModes[2] = { 0, 0 };
+	int loopMarkers[2][2] = { { 0, 0 }, { 0, 0 } };
+	int numLoops = 0;
+	
+	for(int i = 0; i < metaData.getLoopPoints().length() && numLoops < 2; i++)
+	{
+		LoopPoint const& loopPoint = metaData.getLoopPoints()[i];
+		
+		if(loopPoint.getType() != LoopPoint::Forward && loopPoint.getType() != LoopPoint::PingPong)
+			continue;
+		
+		loopModes[numLoops] = loopPoint.getType() == LoopPoint::PingPong ? 2 : 1;
+		loopMarkers[numLoops][0] = findOrAddMarker(markers, loopPoint.getStartPoint());
+		loopMarkers[numLoops][1] = findOrAddMarker(markers, loopPoint.getEndPoint());
+		numLoops++;
+	}
+	
+	const int numMarkers = ugen::min(markers.length(), 0x7FFF);
+	
+	if(numMarkers > 0)
+	{
+		unsigned int markSize = 2;
+		
+		for(int i = 0; i < numMarkers; i++)
+		{
+			const unsigned int labelLength = ugen::min(markers[i].getLabel().length(), 255);
+			markSize += 7 + labelLength + ((labelLength & 1) == 0);
+		}
+		
+		writeID(file, "MARK");
+		writeBigEndian32(file, markSize);
+		writeBigEndian16(file, numMarkers);
+		
+		for(int i = 0; i < numMarkers; i++)
+		{
+			const int labelLength = ugen::min(markers[i].getLabel().length(), 255);
+			
+			writeBigEndian16(file, i + 1);
+			writeBigEndian32(file, markers[i].getSampleOffset());
+			fputc(labelLength, file);
+			
+			if(labelLength > 0) 
+				fwrite(markers[i].getLabel().getArray(), 1, labelLength, file);
+			
+			if((labelLength & 1) == 0) 
+				fputc(0, file);
+		}
+	}
+	
+	if(numLoops > 0)
+	{
+		writeID(file, "INST");
+		writeBigEndian32(file, 20);
+		
+		const unsigned char instrument[] = { 60, 0, 0, 127, 1, 127 }; // base note, detune, note and velocity ranges
+		fwrite(instrument, 1, sizeof(instrument), file);
+		writeBigEndian16(file, 0); // gain
+		
+		for(int i = 0; i < 2; i++)
+		{
+			writeBigEndian16(file, loopModes[i]);
+			writeBigEndian16(file, loopMarkers[i][0]);
+			writeBigEndian16(file, loopMarkers[i][1]);
+		}
+	}
+	
+	const long fileSize = ftell(file);
+	fseek(file, 4, SEEK_SET);
+	writeBigEndian32(file, (unsigned int)(fileSize - 8));
+}
+
+bool AudioFile::write(const char* path, 
+					  Buffer const& buffer, 
+					  const Type type,
+					  const int bitDepth, 
+					  const double sampleRate,
+					  const bool overwriteExisitingFile,
+					  MetaData const& metaData) throw()
+{
+	ugen_assert(path != 0);
+	
+	if(buffer.getNumChannels() < 1 || buffer.size() < 1) 
+		return false;
+	
+	if(!overwriteExisitingFile)
+	{
+		FILE* existing = fopen(path, "rb");
+		
+		if(existing != 0)
+		{
+			fclose(existing);
+			return false;
+		}
+	}
+	
+	int bitsPerSample = bitDepth;
+	
+	if(bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32)
+	{
+		printf("AudioFile: warning: bit depth of %d not supported, using 16\n", bitDepth);
+		bitsPerSample = 16;
+	}
+	
+	FILE* file = fopen(path, "wb");
+	
+	if(file == 0) 
+	{
+		printf("AudioFile: Could not create file: %s\n", path);
+		return false;
+	}
+	
+	if(type == AIFF)
+		writeAiff(file, buffer, bitsPerSample, sampleRate, metaData);
+	else
+		writeWav(file, buffer, bitsPerSample, sampleRate, metaData);
+	
+	const bool succeeded = ferror(file) == 0;
+	fclose(file);
+	
+	if(!succeeded)
+		printf("AudioFile: error: writing file %s\n", path);
+	
+	return succeeded;
+}
+
+AudioFile::Type AudioFile::getTypeForPath(Text const& path) throw()
+{
+	TextArray split = path.split(".");
+	
+	if(split.length() > 1 && (split.last().equalsIgnoreCase("aif") || split.last().equalsIgnoreCase("aiff")))
+		return AIFF;
+	
+	return WAV;
+}
+
+void AudioFile::setMaximumDecodeThreads(const int numThreads) throw()
+{
+	maximumDecodeThreads = ugen::max(1, numThreads);
+}
+
+int AudioFile::getMaximumDecodeThreads() throw()
+{
+	return maximumDecodeThreads;
+}
+
+AudioFileReader::AudioFileReader(const char* path) throw()
+:	file(0),
+	format(new AudioFileFormat()),
+	bytes(0),
+	samples(0),
+	filePosition(-1)
+{
+	if(path == 0 || path[0] == 0) 
+	{
+		printf("AudioFileReader: File path is null\n");
+		return;
+	}
+	
+	file = fopen(path, "rb");
+	
+	if(file == 0) 
+	{
+		printf("AudioFileReader: Could not open file: %s\n", path);
+		return;
+	}
+	
+	CuePointArray cuePoints;
+	LoopPointArray loopPoints;
+	
+	if(!readFormat(file, *format, cuePoints, loopPoints))
+	{
+		printf("AudioFileReader: Sound file format not supported: %s\n", path);
+		fclose(file);
+		file = 0;
+		return;
+	}
+	
+	bytes = new unsigned char[AudioFile::ChunkFrames * format->getBytesPerFrame()];
+	samples = new int[AudioFile::ChunkFrames];
+}
+
+AudioFileReader::~AudioFileReader()
+{
+	if(file != 0)
+		fclose(file);
+	
+	delete [] samples;
+	delete [] bytes;
+	delete format;
+}
+
+int AudioFileReader::getNumChannels() const throw()		{ return format->numChannels;		}
+int AudioFileReader::getNumFrames() const throw()		{ return format->numFrames;			}
+int AudioFileReader::getBitsPerSample() const throw()	{ return format->bitsPerSample;		}
+double AudioFileReader::getSampleRate() const throw()	{ return format->sampleRate;		}
+
+int AudioFileReader::read(float* const* channels, const int startFrame, const int numFrames) throw()
+{
+	if(file == 0 || startFrame < 0 || startFrame >= format->numFrames) 
+		return 0;
+	
+	const int endFrame = ugen::min(startFrame + numFrames, format->numFrames);
+	const int bytesPerFrame = format->getBytesPerFrame();
+	
+	// reading on from the last frame read doesn't need a seek (which would empty the stdio buffer)
+	if(startFrame != filePosition)
+	{
+		if(fseek(file, format->dataOffset + (long)startFrame * bytesPerFrame, SEEK_SET) != 0)
+		{
+			filePosition = -1;
+			return 0;
+		}
+		
+		filePosition = startFrame;
+	}
+	
+	for(int frame = startFrame; frame < endFrame; )
+	{
+		const int chunkFrames = ugen::min((int)AudioFile::ChunkFrames, endFrame - frame);
+		const int numRead = (int)fread(bytes, bytesPerFrame, chunkFrames, file);
+		
+		decodeChunk(bytes, *format, samples, channels, frame - startFrame, numRead);
+		frame += numRead;
+		filePosition = frame;
+		
+		if(numRead != chunkFrames)
+		{
+			filePosition = -1;
+			return frame - startFrame;
+		}
+	}
+	
+	return endFrame - startFrame;
+}
+
+AudioFileWriter::AudioFileWriter(const char* path, 
+								 const int numChannelsToUse, 
+								 const AudioFile::Type typeToUse,
+								 const int bitDepth, 
+								 const double sampleRateToUse,
+								 const bool overwriteExisitingFile) throw()
+:	file(0),
+	numChannels(numChannelsToUse),
+	type(typeToUse),
+	bitsPerSample(bitDepth),
+	sampleRate(sampleRateToUse),
+	numFramesWritten(0),
+	bytes(0),
+	samples(0)
+{
+	ugen_assert(path != 0);
+	
+	if(numChannels < 1) 
+		return;
+	
+	if(!overwriteExisitingFile)
+	{
+		FILE* existing = fopen(path, "rb");
+		
+		if(existing != 0)
+		{
+			fclose(existing);
+			return;
+		}
+	}
+	
+	if(bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32)
+	{
+		printf("AudioFileWriter: warning: bit depth of %d not supported, using 16\n", bitDepth);
+		bitsPerSample = 16;
+	}
+	
+	file = fopen(path, "wb");
+	
+	if(file == 0) 
+	{
+		printf("AudioFileWriter: Could not create file: %s\n", path);
+		return;
+	}
+	
+	if(type == AudioFile::AIFF)
+		writeAiffHeader(file, numChannels, bitsPerSample, sampleRate, 0);
+	else
+		writeWavHeader(file, numChannels, bitsPerSample, sampleRate, 0);
+	
+	bytes = new unsigned char[AudioFile::ChunkFrames * numChannels * (bitsPerSample / 8)];
+	samples = new int[AudioFile::ChunkFrames];
+}
+
+AudioFileWriter::~AudioFileWriter()
+{
+	if(file != 0)
+	{
+		const unsigned int dataSize = (unsigned int)numFramesWritten * numChannels * (bitsPerSample / 8);
+		
+		if(dataSize & 1) 
+			fputc(0, file);
+		
+		// the headers are the same size whatever the number of frames so just write them again
+		const long fileSize = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		
+		if(type == AudioFile::AIFF)
+		{
+			writeAiffHeader(file, numChannels, bitsPerSample, sampleRate, numFramesWritten);
+			fseek(file, 4, SEEK_SET);
+			writeBigEndian32(file, (unsigned int)(fileSize - 8));
+		}
+		else
+		{
+			writeWavHeader(file, numChannels, bitsPerSample, sampleRate, numFramesWritten);
+			fseek(file, 4, SEEK_SET);
+			writeLittleEndian32(file, (unsigned int)(fileSize - 8));
+		}
+		
+		if(ferror(file) != 0)
+			printf("AudioFileWriter: error: writing file\n");
+		
+		fclose(file);
+	}
+	
+	delete [] samples;
+	delete [] bytes;
+}
+
+bool AudioFileWriter::write(const float* const* channels, const int numFrames) throw()
+{
+	if(file == 0) 
+		return false;
+	
+	if(numFrames < 1)
+		return true;
+	
+	encodeFrames(file, channels, numChannels, numFrames, bitsPerSample, type == AudioFile::AIFF, bytes, samples);
+	numFramesWritten += numFrames;
+	
+	return ferror(file) == 0;
+}
+
+
+END_UGEN_NAMESPACE
@@ -0,0 +1,202 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef _UGEN_ugen_AudioFile_H_
+#define _UGEN_ugen_AudioFile_H_
+
+
+#include "ugen_Buffer.h"
+
+/** Reads and writes uncompressed WAV and AIFF files without Juce or CoreAudio.
+ 
+ Buffer uses this to load and save audio files when it isn't built with Juce or for the 
+ iPhone. 16, 24 and 32-bit integer and 32-bit float data can be read (including the 
+ little endian 'sowt' and float 'fl32' AIFC types) and 16, 24 or 32-bit integer files 
+ can be written. The samples are converted with the SIMD kernels.
+ 
+ Cue points and loop points are read into and written from the MetaData. In WAV files
+ these are the 'cue ' chunk (with labels and comments in a 'LIST' 'adtl' chunk) and the
+ loops of the 'smpl' chunk. In AIFF files these are the 'MARK' chunk and the sustain and
+ release loops of the 'INST' chunk (which refer to markers, so the cue points read from
+ an AIFF file include the loop markers).
+ 
+ Large files are decoded on several threads, each opens the file itself then reads and 
+ converts its own range of sample frames. 
+ 
+ @see Buffer */
+class AudioFile
+{
+public:
+	enum Type
+	{
+		WAV,
+		AIFF
+	};
+	
+	enum Constants
+	{
+		ChunkFrames = 4096,					///< The number of frames read or written at a time.
+		MinimumSamplesPerThread = 1 << 18	///< Files are split into ranges of at least this many samples to decode.
+	};
+	
+	/** Read an audio file into a Buffer.
+	 @param path		The path of the file.
+	 @param buffer		Assigned a new Buffer with the file's channels (or an empty Buffer if the file can't be read).
+	 @param bits		If not 0 this is set to the bit depth of the file (or 0 if it can't be read).
+	 @param metaData	If not 0 the cue points and loop points in the file are added to this.
+	 @return			The sample rate of the file or 0.0 if it couldn't be read. */
+	static double read(const char* path, Buffer& buffer, int* bits = 0, MetaData* metaData = 0) throw();
+	
+	/** Write a Buffer to an audio file.
+	 @param path					The path of the file.
+	 @param buffer					The Buffer to write.
+	 @param type					WAV or AIFF.
+	 @param bitDepth				16, 24 or 32 (integer).
+	 @param sampleRate				The sample rate to store in the file.
+	 @param overwriteExisitingFile	If this is false and the file exists nothing is written.
+	 @param metaData				Cue points and loop points to write to the file.
+	 @return						@c true if the file was written. */
+	static bool write(const char* path, 
+					  Buffer const& buffer, 
+					  const Type type,
+					  const int bitDepth, 
+					  const double sampleRate,
+					  const bool overwriteExisitingFile,
+					  MetaData const& metaData = MetaData()) throw();
+	
+	/** The type of file for a path, AIFF for ".aif" and ".aiff" files otherwise WAV. */
+	static Type getTypeForPath(Text const& path) throw();
+	
+	/** Set the maximum number of threads used to decode a file, including the calling thread.
+	 The default is the number of processors. */
+	static void setMaximumDecodeThreads(const int numThreads) throw();
+	static int getMaximumDecodeThreads() throw();
+	
+private:
+	static int maximumDecodeThreads;
+};
+
+class AudioFileFormat;
+
+/** Reads ranges of sample frames from a WAV or AIFF file which is kept open, e.g., to stream a file 
+ which is too long to load into a Buffer. This reads the same formats as AudioFile::read().
+ 
+ An AudioFileReader must only be used by one thread at a time. 
+ 
+ @see AudioFile, AudioFileWriter, DiskIn */
+class AudioFileReader
+{
+public:
+	AudioFileReader(const char* path) throw();
+	~AudioFileReader();
+	
+	/** @return @c true if the file was opened and its format is supported. */
+	inline bool isOpen() const throw()			{ return file != 0;		}
+	
+	int getNumChannels() const throw();
+	int getNumFrames() const throw();
+	int getBitsPerSample() const throw();
+	double getSampleRate() const throw();
+	
+	/** Read and convert a range of sample frames.
+	 @param channels	One array for each channel in the file, each with space for numFrames samples.
+	 @param startFrame	The first frame to read.
+	 @param numFrames	The number of frames to read.
+	 @return			The number of frames read, this is fewer than numFrames at the end of the file or if there was an error. */
+	int read(float* const* channels, const int startFrame, const int numFrames) throw();
+	
+private:
+	FILE* file;
+	AudioFileFormat* format;
+	unsigned char* bytes;
+	int* samples;
+	int filePosition;
+	
+	AudioFileReader (const AudioFileReader&);
+	const AudioFileReader& operator= (const AudioFileReader&);
+};
+
+/** Writes a WAV or AIFF file a few sample frames at a time, e.g., to record to disk.
+ The header is rewritten with the final size when the writer is deleted.
+ 
+ An AudioFileWriter must only be used by one thread at a time.
+ 
+ @see AudioFile, AudioFileReader, DiskOut */
+class AudioFileWriter
+{
+public:
+	/** Create the file.
+	 @param path					The path of the file.
+	 @param numChannels				The number of channels to write.
+	 @param type					WAV or AIFF.
+	 @param bitDepth				16, 24 or 32 (integer).
+	 @param sampleRate				The sample rate to store in the file.
+	 @param overwriteExisitingFile	If this is false and the file exists the writer isn't opened. */
+	AudioFileWriter(const char* path, 
+					const int numChannels, 
+					const AudioFile::Type type,
+					const int bitDepth, 
+					const double sampleRate,
+					const bool overwriteExisitingFile) throw();
+	~AudioFileWriter();
+	
+	inline bool isOpen() const throw()				{ return file != 0;				}
+	inline int getNumChannels() const throw()		{ return numChannels;			}
+	inline int getNumFramesWritten() const throw()	{ return numFramesWritten;		}
+	
+	/** Convert and append sample frames.
+	 @param channels	One array for each channel, each with numFrames samples.
+	 @param numFrames	The number of frames to write.
+	 @return			@c false if the file isn't open or there was an error. */
+	bool write(const float* const* channels, const int numFrames) throw();
+	
+private:
+	FILE* file;
+	const int numChannels;
+	const AudioFile::Type type;
+	int bitsPerSample;
+	const double sampleRate;
+	int numFramesWritten;
+	unsigned char* bytes;
+	int* samples;
+	
+	AudioFileWriter (const AudioFileWriter&);
+	const AudioFileWriter& operator= (const AudioFileWriter&);
+};
+
+
+#endif // _UGEN_ugen_AudioFile_H_
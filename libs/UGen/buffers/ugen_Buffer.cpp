@@ -46,6 +46,8 @@ BEGIN_UGEN_NAMESPACE
 #include "../basics/ugen_UnaryOpUGens.h"
 #if defined(UGEN_IPHONE) || defined(DOXYGEN)
 	#include "../iphone/ugen_NSUtilities.h"
+#elif !defined(UGEN_JUCE)
+	#include "ugen_AudioFile.h"
 #endif
 
 //#define BUFFERTESTMEMORY 1
@@ -62,7 +64,8 @@ BufferChannelInternal::BufferChannelInternal(const unsigned int size, bool zeroD
 	size_(size),
 	allocatedSize(size),
 	currentWriteBlockID(-1),
-	circularHead(-1), previousCircularHead(-1)
+	circularHead(-1), previousCircularHead(-1),
+	owner(0)
 {
 //	ugen_assert(size > 0);
 	
@@ -89,7 +92,8 @@ BufferChannelInternal::BufferChannelInternal(const unsigned int size,
 	size_(size),
 	allocatedSize(0),
 	currentWriteBlockID(-1),
-	circularHead(-1), previousCircularHead(-1)
+	circularHead(-1), previousCircularHead(-1),
+	owner(0)
 {
 	ugen_assert(size > 0);
 	ugen_assert(sourceDataSize > 0);
@@ -125,7 +129,8 @@ BufferChannelInternal::BufferChannelInternal(const unsigned int size, const doub
 :	size_(size),
 	allocatedSize(size),
 	currentWriteBlockID(-1),
-	circularHead(-1), previousCircularHead(-1)
+	circularHead(-1), previousCircularHead(-1),
+	owner(0)
 {
 	ugen_assert(size >= 2);
 	
@@ -146,17 +151,35 @@ BufferChannelInternal::BufferChannelInternal(const unsigned int size, const doub
 #endif	
 }
 
+BufferChannelInternal::BufferChannelInternal(const unsigned int size, float* sourceData, SmartPointer* dataOwner) throw()
+:	data(sourceData),
+	size_(size),
+	allocatedSize(0),
+	currentWriteBlockID(-1),
+	circularHead(-1), previousCircularHead(-1),
+	owner(dataOwner)
+{
+	ugen_assert(sourceData != 0);
+	
+	if(owner != 0)
+		owner->incrementRefCount();
+}
+
 BufferChannelInternal::~BufferChannelInternal() throw()
 {
 	if(allocatedSize > 0)
 		delete [] data;
 	
+	if(owner != 0)
+		owner->decrementRefCount();
+	
 	data = 0;
 	size_= 0;
 	allocatedSize = 0;
 	currentWriteBlockID = -1;
 	circularHead = -1;
 	previousCircularHead = -1;
+	owner = 0;
 }
 
 Buffer::Buffer() throw()
@@ -1579,6 +1602,72 @@ bool Buffer::initFromAudioFileAiff32(const char* audioFilePath,
 	return true;
 }
 
+
+#else // neither Juce nor CoreAudio, use our own WAV and AIFF reader and writer
+
+Buffer::Buffer(const char *audioFilePath, int *bits, double* sampleRate, MetaData* metaData) throw()
+:	numChannels_(0),
+	size_(0),
+	channels(0)
+{
+	if(!sampleRate)
+	{
+		double fileSampleRate = initFromAudioFile(audioFilePath, bits, metaData);
+		double currentSampleRate = UGen::getSampleRate();
+		
+		if((fileSampleRate != 0.0) && (fileSampleRate != currentSampleRate))
+			operator= (changeSampleRate(fileSampleRate, currentSampleRate));
+	}
+	else
+	{
+		*sampleRate = initFromAudioFile(audioFilePath, bits, metaData);
+	}
+}
+
+Buffer::Buffer(Text const& audioFilePath, int *bits, double* sampleRate, MetaData* metaData) throw()
+:	numChannels_(0),
+	size_(0),
+	channels(0)
+{	
+	if(!sampleRate)
+	{
+		double fileSampleRate = initFromAudioFile(audioFilePath.getArray(), bits, metaData);
+		double currentSampleRate = UGen::getSampleRate();
+		
+		if((fileSampleRate != 0.0) && (fileSampleRate != currentSampleRate))
+		{
+			ugen_assert(metaData == 0); // meta data markers will be incorrect at the new sample rate
+			operator= (changeSampleRate(fileSampleRate, currentSampleRate));			
+		}
+	}
+	else
+	{
+		*sampleRate = initFromAudioFile(audioFilePath.getArray(), bits, metaData);
+	}
+}
+
+double Buffer::initFromAudioFile(const char* audioFilePath, int *bits, MetaData* metaData) throw()
+{
+	return AudioFile::read(audioFilePath, *this, bits, metaData);
+}
+
+bool Buffer::write(Text const& audioFilePath, 
+				   bool overwriteExisitingFile, 
+				   int bitDepth,
+				   MetaData const& metaData) throw()
+{
+	ugen_assert(bitDepth >= 16);
+	
+	const Text pathChecked = audioFilePath.split(".").length() <= 1 ? audioFilePath + ".wav" : audioFilePath;
+	
+	return AudioFile::write(pathChecked.getArray(), 
+							*this, 
+							AudioFile::getTypeForPath(pathChecked), 
+							bitDepth, 
+							UGen::getSampleRate(), 
+							overwriteExisitingFile, 
+							metaData);
+}
 #endif
 
 
@@ -3086,6 +3175,8 @@ ComplexBuffer ComplexBuffer::operator* (ComplexBuffer const& rightOperand) const
 
 
 BufferSender::BufferSender() throw()
+:	snapshotSize(0),
+	snapshotNumChannels(0)
 {
 }
 
@@ -3096,12 +3187,31 @@ BufferSender::~BufferSender()
 	{
 		receivers[channel]->removeBufferSender(this);
 	}	
+	
+	const int numSnapshotReceivers = snapshotReceivers.size();
+	for(int i = 0; i < numSnapshotReceivers; i++)
+	{
+		snapshotReceivers[i]->removeBufferSender(this);
+	}
 }
 
 void BufferSender::addBufferReceiver(BufferReceiver* receiver) throw()
 {
 	if(receiver == 0) { ugen_assertfalse; return; }
-	if(receivers.contains(receiver)) return;
+	if(receivers.contains(receiver) || snapshotReceivers.contains(receiver)) return;
+	
+	if(snapshotSize > 0)
+	{
+		TripleBuffer receiverSnapshots(snapshotSize, snapshotNumChannels);
+		
+		if(receiver->handleSnapshots(receiverSnapshots))
+		{
+			snapshots.add(receiverSnapshots);
+			snapshotReceivers.add(receiver);
+			receiver->addBufferSender(this);
+			return;
+		}
+	}
 	
 	receivers.add(receiver);
 	receiver->addBufferSender(this);
@@ -3116,6 +3226,17 @@ void BufferSender::removeBufferReceiver(BufferReceiver* receiver) throw()
 		receivers.removeItem(receiver);
 		receiver->removeBufferSender(this);
 	}
+	else
+	{
+		const int index = snapshotReceivers.indexOf(receiver);
+		
+		if(index >= 0)
+		{
+			snapshotReceivers.remove(index);
+			snapshots.remove(index);
+			receiver->removeBufferSender(this);
+		}
+	}
 }
 
 void BufferSender::sendBuffer(Buffer const& buffer, const double value1, const int value2) throw()
@@ -3127,6 +3248,29 @@ void BufferSender::sendBuffer(Buffer const& buffer, const double value1, const i
 	}
 }
 
+void BufferSender::enableSnapshots(const int maximumSize, const int numChannels) throw()
+{
+	snapshotSize = maximumSize;
+	snapshotNumChannels = numChannels;
+}
+
+void BufferSender::publishSnapshot(Buffer const& buffer, const int size, const double value1, const int value2) throw()
+{
+	const int numSnapshots = snapshots.size();
+	
+	for(int i = 0; i < numSnapshots; i++)
+	{
+		TripleBuffer& receiverSnapshots = snapshots[i];
+		const int numChannels = ugen::min(buffer.getNumChannels(), receiverSnapshots.getNumChannels());
+		const int numSamples = ugen::min(size, receiverSnapshots.getMaximumSize());
+		
+		for(int channel = 0; channel < numChannels; channel++)
+			memcpy(receiverSnapshots.getWriteData(channel), buffer.getData(channel), numSamples * sizeof(float));
+		
+		receiverSnapshots.publish(numSamples, value1, value2);
+	}
+}
+
 BufferReceiver::BufferReceiver() throw()
 {
 }
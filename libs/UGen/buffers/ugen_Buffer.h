@@ -44,6 +44,7 @@
 #include "../envelopes/ugen_EnvCurve.h"
 #include "../core/ugen_Arrays.h"
 #include "../core/ugen_Text.h"
+#include "../core/ugen_TripleBuffer.h"
 
 class CuePointInternal : public SmartPointer
 {
@@ -272,6 +273,10 @@ public:
 	BufferChannelInternal(const unsigned int size, bool zeroData = false) throw();
 	BufferChannelInternal(const unsigned int size, const unsigned int sourceDataSize, float* sourceData, const bool copyTheData) throw();
 	BufferChannelInternal(const unsigned int size, const double start, const double end) throw();
+	
+	/** Use data which belongs to another object (e.g., a memory-mapped file) without copying it. 
+	 The owner is kept alive for as long as this channel is. */
+	BufferChannelInternal(const unsigned int size, float* sourceData, SmartPointer* dataOwner) throw();
 	~BufferChannelInternal() throw();
 	
 	inline float getSampleUnchecked(const int index) const throw() { return data[index]; }
@@ -313,6 +318,7 @@ private:
 	unsigned int currentWriteBlockID;
 	int circularHead; // -1 means it is not a crcular buffer
 	int previousCircularHead;
+	SmartPointer* owner;
 	
 	BufferChannelInternal (const BufferChannelInternal&);
     const BufferChannelInternal& operator= (const BufferChannelInternal&);
@@ -644,6 +650,10 @@ protected:
 	bool initFromAudioFileAiff32(const char* audioFilePath, bool overwriteExisitingFile, MetaData const& metaData = MetaData()) throw();
 
 
+public:
+#elif !defined(UGEN_JUCE)
+protected:
+	double initFromAudioFile(const char* audioFilePath, int *bits = 0, MetaData* metaData = 0) throw();
 public:
 #endif
 	/** Constuct a Buffer from two other buffers by combining the channels. 
@@ -1344,7 +1354,20 @@ public:
 	void sendBuffer(Buffer const& buffer, const double value1 = 0.0, const int value2 = 0) throw();
 	
 protected:
+	/** Offer snapshots to receivers added from now on. Each receiver which accepts them in 
+	 BufferReceiver::handleSnapshots() gets its own TripleBuffer which publishSnapshot() writes to,
+	 it is not sent buffers with sendBuffer(). */
+	void enableSnapshots(const int maximumSize, const int numChannels) throw();
+	
+	/** Copy the first size samples of each channel of a buffer into the TripleBuffer of each 
+	 receiver which is reading snapshots and publish them. This doesn't lock or allocate. */
+	void publishSnapshot(Buffer const& buffer, const int size, const double value1 = 0.0, const int value2 = 0) throw();
+	
 	BufferReceiverArray receivers;
+	BufferReceiverArray snapshotReceivers;
+	ObjectArray<TripleBuffer> snapshots;
+	int snapshotSize;
+	int snapshotNumChannels;
 };
 
 /** Subclasses of this receive Buffer objects from BufferSender objects. */
@@ -1360,6 +1383,12 @@ public:
 	 used to send a time offset, FFT start bin and the FFT size if appropriate. */
 	virtual void handleBuffer(Buffer const& buffer, const double value1, const int value2) = 0;
 	
+	/** Senders which can publish their buffers as snapshots (e.g., Sender) offer a TripleBuffer
+	 here when the receiver is added. Return @c true to keep it and read the latest frame from it 
+	 on your own thread, handleBuffer() is then not called on the audio thread for that sender.
+	 The default returns @c false. */
+	virtual bool handleSnapshots(TripleBuffer const& snapshots) { (void)snapshots; return false; }
+	
 	/** This saves having to get the pointer to a BufferReceiver object, it will be casted automatically. */
 	operator BufferReceiver*() throw() { return this; }
 		
@@ -0,0 +1,379 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+#include "../core/ugen_StandardHeader.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined (_WIN32) || defined (_WIN64)
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_BufferCache.h"
+#include "../core/ugen_UGen.h"
+
+/** The start of a cache file, the rest of the first BufferCache::Alignment bytes are zero. 
+ Everything is in the byte order of the machine which wrote it. */
+struct BufferCacheHeader
+{
+	enum Constants
+	{
+		ByteOrderMark = 0x01020304
+	};
+	
+	char magic[8];					// "UGENBUFC"
+	unsigned int version;
+	unsigned int byteOrder;			// ByteOrderMark as written
+	unsigned int numChannels;
+	unsigned int numFrames;
+	unsigned int channelStride;		// the number of frames from the start of one channel to the next
+	unsigned int reserved;
+	double sampleRate;				// of the samples in the cache
+	double sourceSampleRate;		// of the audio file the samples were decoded from
+	double sourceSize;				// of the audio file in bytes
+	double sourceTime;				// the modification time of the audio file
+};
+
+static const char cacheMagic[8] = { 'U', 'G', 'E', 'N', 'B', 'U', 'F', 'C' };
+
+/** A cache file mapped copy-on-write into memory, shared by the channels of the Buffers using it. */
+class BufferCacheMapping : public SmartPointer
+{
+public:
+	static BufferCacheMapping* open(const char* path) throw()
+	{
+#if defined (_WIN32) || defined (_WIN64)
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		
+		if(file == INVALID_HANDLE_VALUE)
+			return 0;
+		
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = 0;
+		void* data = 0;
+		
+		if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= BufferCache::Alignment)
+			mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+		
+		CloseHandle(file); // the mapping keeps the file open
+		
+		if(mapping != 0)
+			data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		
+		if(data == 0)
+		{
+			if(mapping != 0) 
+				CloseHandle(mapping);
+			
+			return 0;
+		}
+		
+		return new BufferCacheMapping(data, (size_t)fileSize.QuadPart, mapping);
+#else
+		const int file = ::open(path, O_RDONLY);
+		
+		if(file < 0)
+			return 0;
+		
+		struct stat info;
+		void* data = MAP_FAILED;
+		
+		if(fstat(file, &info) == 0 && info.st_size >= BufferCache::Alignment)
+			data = mmap(0, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0); 
+		
+		::close(file); // the mapping keeps the file open
+		
+		if(data == MAP_FAILED)
+			return 0;
+		
+		return new BufferCacheMapping(data, (size_t)info.st_size, 0);
+#endif
+	}
+	
+	~BufferCacheMapping()
+	{
+#if defined (_WIN32) || defined (_WIN64)
+		UnmapViewOfFile(data);
+		CloseHandle(handle);
+#else
+		munmap(data, size);
+#endif
+	}
+	
+	inline unsigned char* getData() const throw()		{ return (unsigned char*)data;		}
+	inline size_t getSize() const throw()				{ return size;						}
+	
+	inline BufferCacheHeader const& getHeader() const throw()	
+	{ 
+		return *(const BufferCacheHeader*)data; 
+	}
+	
+	/** Ask the system to start reading the whole file in, this returns immediately. */
+	void warmUp() throw()
+	{
+#if !defined (_WIN32) && !defined (_WIN64)
+		madvise(data, size, MADV_WILLNEED);
+#endif
+	}
+	
+private:
+	BufferCacheMapping(void* dataToUse, const size_t sizeToUse, void* handleToUse) throw()
+	:	data(dataToUse),
+		size(sizeToUse),
+		handle(handleToUse)
+	{
+	}
+	
+	void* const data;
+	const size_t size;
+	void* const handle;
+};
+
+static bool getFileInfo(const char* path, double& size, double& time) throw()
+{
+	struct stat info;
+	
+	if(stat(path, &info) != 0)
+		return false;
+	
+	size = (double)info.st_size;
+	time = (double)info.st_mtime;
+	return true;
+}
+
+Buffer BufferCache::load(const char* audioFilePath, const char* cachePath, double* sampleRate, const bool warmUp) throw()
+{
+	if(audioFilePath == 0 || audioFilePath[0] == 0) 
+	{
+		printf("BufferCache: File path is null\n");
+		return Buffer();
+	}
+	
+	double sourceSize, sourceTime;
+	
+	if(!getFileInfo(audioFilePath, sourceSize, sourceTime))
+	{
+		printf("BufferCache: Could not open file: %s\n", audioFilePath);
+		return Buffer();
+	}
+	
+	const Text defaultCachePath = Text(audioFilePath) + ".ugencache";
+	
+	if(cachePath == 0)
+		cachePath = defaultCachePath.getArray();
+	
+	// 0.0 means the samples must be at the file's own sample rate
+	const double requiredSampleRate = sampleRate ? 0.0 : UGen::getSampleRate();
+	
+	Buffer buffer = map(cachePath, sourceSize, sourceTime, requiredSampleRate, sampleRate, warmUp);
+	
+	if(buffer.size() > 0)
+		return buffer;
+	
+	double sourceSampleRate = 0.0;
+	Buffer decoded(audioFilePath, 0, &sourceSampleRate);
+	
+	if(decoded.size() < 1)
+		return Buffer();
+	
+	double decodedSampleRate = sourceSampleRate;
+	
+	if(requiredSampleRate > 0.0 && sourceSampleRate != requiredSampleRate)
+	{
+		decoded = decoded.changeSampleRate(sourceSampleRate, requiredSampleRate);
+		decodedSampleRate = requiredSampleRate;
+	}
+	
+	if(write(cachePath, decoded, decodedSampleRate, sourceSize, sourceTime, sourceSampleRate))
+	{
+		buffer = map(cachePath, sourceSize, sourceTime, requiredSampleRate, sampleRate, warmUp);
+		
+		if(buffer.size() > 0)
+			return buffer;
+	}
+	
+	printf("BufferCache: warning: could not use cache file: %s\n", cachePath);
+	
+	if(sampleRate) *sampleRate = decodedSampleRate;
+	
+	return decoded;
+}
+
+Buffer BufferCache::map(const char* cachePath, double* sampleRate, const bool warmUp) throw()
+{
+	ugen_assert(cachePath != 0);
+	
+	return map(cachePath, -1.0, -1.0, -1.0, sampleRate, warmUp);
+}
+
+Buffer BufferCache::map(const char* cachePath, 
+						const double sourceSize, 
+						const double sourceTime, 
+						const double requiredSampleRate,
+						double* sampleRate, 
+						const bool warmUp) throw()
+{
+	BufferCacheMapping* mapping = BufferCacheMapping::open(cachePath);
+	
+	if(mapping == 0)
+		return Buffer();
+	
+	// a negative source size or required sample rate skips that check
+	BufferCacheHeader const& header = mapping->getHeader();
+	const double requiredSize = Alignment + (double)header.numChannels * header.channelStride * sizeof(float);
+	
+	if(memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 
+	   || header.version != Version
+	   || header.byteOrder != BufferCacheHeader::ByteOrderMark
+	   || header.numChannels < 1
+	   || header.numFrames < 1
+	   || header.numFrames > 0x7FFFFFFF
+	   || header.channelStride < header.numFrames
+	   || (double)mapping->getSize() < requiredSize
+	   || (sourceSize >= 0.0 && (header.sourceSize != sourceSize || header.sourceTime != sourceTime))
+	   || (requiredSampleRate == 0.0 && header.sampleRate != header.sourceSampleRate)
+	   || (requiredSampleRate > 0.0 && header.sampleRate != requiredSampleRate))
+	{
+		mapping->decrementRefCount();
+		return Buffer();
+	}
+	
+	Buffer buffer;
+	
+	for(unsigned int channel = 0; channel < header.numChannels; channel++)
+	{
+		float* data = (float*)(mapping->getData() + Alignment + (size_t)channel * header.channelStride * sizeof(float));
+		BufferChannelInternal* internal = new BufferChannelInternal(header.numFrames, data, mapping);
+		Buffer channelBuffer(internal);
+		internal->decrementRefCount(); // channelBuffer has its own reference
+		
+		buffer = channel == 0 ? channelBuffer : buffer << channelBuffer;
+	}
+	
+	if(warmUp)
+		mapping->warmUp();
+	
+	if(sampleRate) *sampleRate = header.sampleRate;
+	
+	mapping->decrementRefCount(); // the channels have their own references
+	return buffer;
+}
+
+bool BufferCache::write(const char* cachePath, Buffer const& buffer, const double sampleRate) throw()
+{
+	return write(cachePath, buffer, sampleRate, -1.0, -1.0, sampleRate);
+}
+
+bool BufferCache::write(const char* cachePath, 
+						Buffer const& buffer, 
+						const double sampleRate,
+						const double sourceSize, 
+						const double sourceTime, 
+						const double sourceSampleRate) throw()
+{
+	ugen_assert(cachePath != 0);
+	
+	const int numChannels = buffer.getNumChannels();
+	const int numFrames = buffer.size();
+	
+	if(numChannels < 1 || numFrames < 1)
+		return false;
+	
+	const int framesPerAlignment = Alignment / sizeof(float);
+	const unsigned int channelStride = (numFrames + framesPerAlignment - 1) / framesPerAlignment * framesPerAlignment;
+	
+	BufferCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+	header.version = Version;
+	header.byteOrder = BufferCacheHeader::ByteOrderMark;
+	header.numChannels = numChannels;
+	header.numFrames = numFrames;
+	header.channelStride = channelStride;
+	header.sampleRate = sampleRate;
+	header.sourceSampleRate = sourceSampleRate;
+	header.sourceSize = sourceSize;
+	header.sourceTime = sourceTime;
+	
+	const Text temporaryPath = Text(cachePath) + ".tmp";
+	FILE* file = fopen(temporaryPath.getArray(), "wb");
+	
+	if(file == 0)
+	{
+		printf("BufferCache: Could not create file: %s\n", temporaryPath.getArray());
+		return false;
+	}
+	
+	unsigned char* padding = new unsigned char[Alignment];
+	memset(padding, 0, Alignment);
+	memcpy(padding, &header, sizeof(header));
+	fwrite(padding, 1, Alignment, file);
+	memset(padding, 0, sizeof(header));
+	
+	for(int channel = 0; channel < numChannels; channel++)
+	{
+		fwrite(buffer.getDataUnchecked(channel), sizeof(float), numFrames, file);
+		fwrite(padding, sizeof(float), channelStride - numFrames, file);
+	}
+	
+	delete [] padding;
+	
+	const bool succeeded = ferror(file) == 0;
+	fclose(file);
+	
+	// replace any old cache in one step so a partly written cache is never used
+	if(succeeded)
+	{
+		remove(cachePath);
+		
+		if(rename(temporaryPath.getArray(), cachePath) == 0)
+			return true;
+	}
+	
+	printf("BufferCache: error: writing file %s\n", cachePath);
+	remove(temporaryPath.getArray());
+	return false;
+}
+
+
+END_UGEN_NAMESPACE
@@ -0,0 +1,111 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+#ifndef _UGEN_ugen_BufferCache_H_
+#define _UGEN_ugen_BufferCache_H_
+
+
+#include "ugen_Buffer.h"
+
+/** Keeps decoded audio files in cache files which Buffers use directly through a memory map.
+ 
+ The first time a file is loaded it is decoded as usual and the samples are written to a 
+ cache file as raw 32-bit floats, one channel after another with each channel starting on a 
+ page boundary. Later loads just map the cache file (as long as the audio file's size and 
+ modification time haven't changed) so nothing is decoded or copied. Pages of sample data are 
+ read from disk the first time they are used and the system can drop them again when memory is 
+ short, so a large sample library costs little until it is played. Writing to a mapped Buffer 
+ only changes this process's copy, never the cache file.
+ 
+ The Buffers work with anything which takes a Buffer, e.g., PlayBuf, XFadeLoopPlayBuf and 
+ TableOsc. Reading a page which isn't in memory yet blocks the reading thread (which may be the
+ audio thread) so pass @c true for warmUp to have the system start reading the whole file in
+ the background as soon as it is mapped.
+ 
+ Cache files are only valid on machines with the same byte order, they are rebuilt if not.
+ 
+ @see Buffer, AudioFile */
+class BufferCache
+{
+public:
+	enum Constants
+	{
+		Version = 1,
+		Alignment = 16384		///< Channels start at a multiple of this many bytes (the largest common page size).
+	};
+	
+	/** Load an audio file through a cache file, decoding it and making the cache if necessary.
+	 @param audioFilePath	The path of the audio file.
+	 @param cachePath		The path of the cache file, if this is 0 ".ugencache" is added to the audio file path.
+	 @param sampleRate		If this is 0 the samples are converted to the current sample rate (as Buffer does, 
+							the converted samples are cached) otherwise this is set to the sample rate of the file.
+	 @param warmUp			Whether to start reading the whole cache file into memory in the background.
+	 @return				The mapped Buffer. If the cache couldn't be written this is the decoded Buffer
+							in memory, if the audio file couldn't be read this is an empty Buffer. */
+	static Buffer load(const char* audioFilePath, 
+					   const char* cachePath = 0, 
+					   double* sampleRate = 0, 
+					   const bool warmUp = false) throw();
+	
+	/** Map an existing cache file without checking it against an audio file.
+	 @param cachePath		The path of the cache file.
+	 @param sampleRate		If this isn't 0 it is set to the sample rate of the samples in the cache.
+	 @param warmUp			Whether to start reading the whole cache file into memory in the background.
+	 @return				The mapped Buffer, or an empty Buffer if the file isn't a valid cache. */
+	static Buffer map(const char* cachePath, double* sampleRate = 0, const bool warmUp = false) throw();
+	
+	/** Write a Buffer to a cache file, e.g., for a Buffer which was generated rather than loaded.
+	 The file is written under a temporary name then renamed so a cache file is always complete. */
+	static bool write(const char* cachePath, Buffer const& buffer, const double sampleRate) throw();
+	
+private:
+	static Buffer map(const char* cachePath, 
+					  const double sourceSize, 
+					  const double sourceTime, 
+					  const double requiredSampleRate,
+					  double* sampleRate, 
+					  const bool warmUp) throw();
+	
+	static bool write(const char* cachePath, 
+					  Buffer const& buffer, 
+					  const double sampleRate,
+					  const double sourceSize, 
+					  const double sourceTime, 
+					  const double sourceSampleRate) throw();
+};
+
+
+#endif // _UGEN_ugen_BufferCache_H_
@@ -0,0 +1,576 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+#include "../core/ugen_StandardHeader.h"
+
+#if !defined(UGEN_JUCE) && !defined(UGEN_IPHONE)
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_DiskStream.h"
+#include "../core/ugen_DiskStreamThread.h"
+#include "../basics/ugen_InlineBinaryOps.h"
+
+static volatile int totalUnderruns = 0;
+static volatile int totalOverruns = 0;
+
+/** Reads a file ahead of the playback position into a ring of pages.
+ 
+ Pages pass from the I/O thread to the audio thread through one fifo and back through 
+ another, each is stamped with the generation of the read ahead it belongs to. A seek starts 
+ a new generation so the audio thread just discards pages from earlier ones. */
+class DiskInStream : public DiskStream
+{
+public:
+	DiskInStream(AudioFileReader* readerToUse, const bool loopFlag, const int startFrame, const int bufferFrames) throw()
+	:	reader(readerToUse),
+		numChannels(reader->getNumChannels()),
+		numFrames(reader->getNumFrames()),
+		sampleRate(reader->getSampleRate()),
+		loop(loopFlag),
+		numPages(ugen::max(2, bufferFrames / DiskIn::PageFrames)),
+		headSize(ugen::min((int)DiskIn::HeadFrames, numFrames)),
+		head(BufferSpec(headSize, numChannels, true)),
+		pages(BufferSpec(numPages * DiskIn::PageFrames, numChannels, true)),
+		pageStart(new int[numPages]),
+		pageLength(new int[numPages]),
+		pageGeneration(new int[numPages]),
+		pageIsLast(new bool[numPages]),
+		freePages(numPages),
+		filledPages(numPages),
+		channelPointers(new float*[numChannels]),
+		generation(0),
+		seekFrame(0),
+		requestedFrame(-1),
+		position(0),
+		inHead(false),
+		waitingForSeek(false),
+		finished(false),
+		currentPage(-1),
+		pageOffset(0),
+		numUnderruns(0),
+		ioGeneration(-1),
+		ioFrame(0),
+		ioFinished(true)
+	{
+		for(int channel = 0; channel < numChannels; channel++)
+			channelPointers[channel] = head.getDataUnchecked(channel);
+		
+		reader->read(channelPointers, 0, headSize);
+		
+		for(int page = 0; page < numPages; page++)
+			freePages.push(page);
+		
+		// read the first pages here so playback can start immediately
+		startAt(startFrame);
+		service();
+	}
+	
+	~DiskInStream()
+	{
+		delete [] channelPointers;
+		delete [] pageIsLast;
+		delete [] pageGeneration;
+		delete [] pageLength;
+		delete [] pageStart;
+		delete reader;
+	}
+	
+	inline int getNumChannels() const throw()	{ return numChannels;					}
+	inline int getNumUnderruns() const throw()	{ return atomicGet(numUnderruns);		}
+	inline double getDuration() const throw()	{ return numFrames / sampleRate;		}
+	inline double getPosition() const throw()	{ return atomicGet(position) / sampleRate; }
+	
+	/** Ask the audio thread to move, this can be called from any thread. */
+	void requestPosition(const double time) throw()
+	{
+		int frame = (int)(time * sampleRate + 0.5);
+		
+		if(loop)
+			frame = frame % numFrames + (frame < 0 ? numFrames : 0);
+		else
+			frame = ugen::clip(frame, 0, numFrames - 1);
+		
+		atomicSet(requestedFrame, frame);
+	}
+	
+	/** Fill a block on the audio thread. @return @c true once a file which doesn't loop has finished. */
+	bool process(float* const* outputs, const int numSamples) throw()
+	{
+		const int requested = atomicGet(requestedFrame);
+		
+		if(requested >= 0 && atomicCompareAndSwap(requestedFrame, requested, -1))
+			startAt(requested);
+		
+		int offset = 0;
+		
+		while(offset < numSamples)
+		{
+			if(finished)
+				break;
+			
+			if(inHead)
+			{
+				const int numFramesToCopy = ugen::min(numSamples - offset, headSize - position);
+				copy(head, position, outputs, offset, numFramesToCopy);
+				offset += numFramesToCopy;
+				atomicSet(position, position + numFramesToCopy);
+				
+				if(position >= headSize)
+				{
+					if(headSize < numFrames)	inHead = false;					// the read ahead carries on from here
+					else if(loop)				atomicSet(position, 0);
+					else						finished = true;
+				}
+			}
+			else
+			{
+				if(currentPage < 0 && !nextPage())
+				{
+					// after a seek we expect to wait for the read ahead so that isn't counted
+					if(!waitingForSeek)
+					{
+						atomicIncrement(numUnderruns);
+						atomicIncrement(totalUnderruns);
+					}
+					
+					break;
+				}
+				
+				const int numFramesToCopy = ugen::min(numSamples - offset, pageLength[currentPage] - pageOffset);
+				copy(pages, currentPage * DiskIn::PageFrames + pageOffset, outputs, offset, numFramesToCopy);
+				offset += numFramesToCopy;
+				pageOffset += numFramesToCopy;
+				atomicSet(position, pageStart[currentPage] + pageOffset);
+				
+				if(pageOffset >= pageLength[currentPage])
+				{
+					finished = pageIsLast[currentPage];
+					freePages.push(currentPage);
+					currentPage = -1;
+				}
+			}
+		}
+		
+		for(int channel = 0; channel < numChannels; channel++)
+			memset(outputs[channel] + offset, 0, (numSamples - offset) * sizeof(float));
+		
+		return finished;
+	}
+	
+	/** Read into any free pages, this is called on the DiskStreamThread. */
+	void service() throw()
+	{
+		if(headSize >= numFrames)
+			return; // it's all in memory
+		
+		while(true)
+		{
+			const int currentGeneration = atomicGet(generation);
+			
+			if(currentGeneration != ioGeneration)
+			{
+				ioGeneration = currentGeneration;
+				ioFrame = atomicGet(seekFrame);
+				ioFinished = false;
+			}
+			
+			int page;
+			
+			if(ioFinished || !freePages.pop(page))
+				return;
+			
+			for(int channel = 0; channel < numChannels; channel++)
+				channelPointers[channel] = pages.getDataUnchecked(channel) + page * DiskIn::PageFrames;
+			
+			const int numFramesToRead = ugen::min((int)DiskIn::PageFrames, numFrames - ioFrame);
+			const int numRead = reader->read(channelPointers, ioFrame, numFramesToRead);
+			
+			pageStart[page] = ioFrame;
+			pageLength[page] = numRead;
+			pageGeneration[page] = ioGeneration;
+			ioFrame += numRead;
+			
+			// a read error is treated as the end of the file
+			if(numRead < numFramesToRead || ioFrame >= numFrames)
+			{
+				if(loop && numRead > 0)		ioFrame = 0;
+				else						ioFinished = true;
+			}
+			
+			pageIsLast[page] = ioFinished;
+			filledPages.push(page);
+		}
+	}
+	
+private:
+	/** Restart playback at a frame on the audio thread (or before the stream is added to the DiskStreamThread). */
+	void startAt(const int frame) throw()
+	{
+		if(currentPage >= 0)
+		{
+			freePages.push(currentPage);
+			currentPage = -1;
+		}
+		
+		atomicSet(position, frame);
+		inHead = frame < headSize;
+		waitingForSeek = !inHead;
+		finished = false;
+		
+		// the I/O thread reads from wherever the head runs out
+		atomicSet(seekFrame, inHead ? headSize : frame);
+		atomicIncrement(generation);
+	}
+	
+	/** Take the next page of the current generation on the audio thread, returning older pages. */
+	bool nextPage() throw()
+	{
+		int page;
+		
+		while(filledPages.pop(page))
+		{
+			if(pageGeneration[page] == generation)
+			{
+				currentPage = page;
+				pageOffset = 0;
+				waitingForSeek = false;
+				return true;
+			}
+			
+			freePages.push(page);
+		}
+		
+		return false;
+	}
+	
+	inline void copy(Buffer const& source, const int sourceOffset, float* const* outputs, const int offset, const int numFramesToCopy) throw()
+	{
+		for(int channel = 0; channel < numChannels; channel++)
+			memcpy(outputs[channel] + offset, source.getDataUnchecked(channel) + sourceOffset, numFramesToCopy * sizeof(float));
+	}
+	
+	AudioFileReader* const reader;
+	const int numChannels;
+	const int numFrames;
+	const double sampleRate;
+	const bool loop;
+	const int numPages;
+	const int headSize;
+	Buffer head;
+	Buffer pages;
+	int* const pageStart;
+	int* const pageLength;
+	int* const pageGeneration;
+	bool* const pageIsLast;
+	LockFreeFifo<int> freePages;		// audio thread to I/O thread
+	LockFreeFifo<int> filledPages;		// I/O thread to audio thread
+	float** const channelPointers;		// I/O thread only
+	
+	// written by the audio thread (requestedFrame by anything)
+	volatile int generation;
+	volatile int seekFrame;
+	volatile int requestedFrame;
+	volatile int position;
+	bool inHead, waitingForSeek, finished;
+	int currentPage;
+	int pageOffset;
+	volatile int numUnderruns;
+	
+	// I/O thread only
+	int ioGeneration;
+	int ioFrame;
+	bool ioFinished;
+};
+
+/** Collects blocks into a ring of pages which are written on the DiskStreamThread. */
+class DiskOutStream : public DiskStream
+{
+public:
+	DiskOutStream(AudioFileWriter* writerToUse, const int bufferFrames) throw()
+	:	writer(writerToUse),
+		numChannels(writer->getNumChannels()),
+		numPages(ugen::max(2, bufferFrames / DiskIn::PageFrames)),
+		pages(BufferSpec(numPages * DiskIn::PageFrames, numChannels, false)),
+		pageLength(new int[numPages]),
+		freePages(numPages),
+		filledPages(numPages),
+		channelPointers(new const float*[numChannels]),
+		currentPage(-1),
+		pageOffset(0),
+		numOverruns(0)
+	{
+		for(int page = 0; page < numPages; page++)
+			freePages.push(page);
+	}
+	
+	~DiskOutStream()
+	{
+		delete writer; // this completes the file
+		delete [] channelPointers;
+		delete [] pageLength;
+	}
+	
+	inline int getNumOverruns() const throw()	{ return atomicGet(numOverruns);	}
+	
+	/** Copy a block on the audio thread. */
+	void write(const float* const* inputs, const int numSamples) throw()
+	{
+		int offset = 0;
+		
+		while(offset < numSamples)
+		{
+			if(currentPage < 0 && !freePages.pop(currentPage))
+			{
+				atomicIncrement(numOverruns);
+				atomicIncrement(totalOverruns);
+				return;
+			}
+			
+			const int numFramesToCopy = ugen::min(numSamples - offset, DiskIn::PageFrames - pageOffset);
+			
+			for(int channel = 0; channel < numChannels; channel++)
+				memcpy(pages.getDataUnchecked(channel) + currentPage * DiskIn::PageFrames + pageOffset, 
+					   inputs[channel] + offset, 
+					   numFramesToCopy * sizeof(float));
+			
+			offset += numFramesToCopy;
+			pageOffset += numFramesToCopy;
+			
+			if(pageOffset == DiskIn::PageFrames)
+				sendPage();
+		}
+	}
+	
+	/** Send the part filled page, this is called by the last thread to write before release(). */
+	void flush() throw()
+	{
+		if(currentPage >= 0 && pageOffset > 0)
+			sendPage();
+	}
+	
+	/** Write any filled pages, this is called on the DiskStreamThread. */
+	void service() throw()
+	{
+		int page;
+		
+		while(filledPages.pop(page))
+		{
+			for(int channel = 0; channel < numChannels; channel++)
+				channelPointers[channel] = pages.getDataUnchecked(channel) + page * DiskIn::PageFrames;
+			
+			writer->write(channelPointers, pageLength[page]);
+			freePages.push(page);
+		}
+	}
+	
+private:
+	void sendPage() throw()
+	{
+		pageLength[currentPage] = pageOffset;
+		filledPages.push(currentPage);
+		currentPage = -1;
+		pageOffset = 0;
+	}
+	
+	AudioFileWriter* const writer;
+	const int numChannels;
+	const int numPages;
+	Buffer pages;
+	int* const pageLength;
+	LockFreeFifo<int> freePages;		// I/O thread to audio thread
+	LockFreeFifo<int> filledPages;		// audio thread to I/O thread
+	const float** const channelPointers;
+	int currentPage;
+	int pageOffset;
+	volatile int numOverruns;
+};
+
+DiskInUGenInternal::DiskInUGenInternal(DiskInStream* streamToUse, const UGen::DoneAction doneAction) throw()
+:	ProxyOwnerUGenInternal(0, streamToUse->getNumChannels() - 1),
+	stream(streamToUse),
+	outputSampleData(new float*[streamToUse->getNumChannels()]),
+	doneAction_(doneAction),
+	shouldDeleteValue(doneAction_ == UGen::DeleteWhenDone)
+{
+	DiskStreamThread::add(stream);
+}
+
+DiskInUGenInternal::~DiskInUGenInternal() throw()
+{
+	stream->release();
+	delete [] outputSampleData;
+}
+
+void DiskInUGenInternal::prepareForBlock(const int /*actualBlockSize*/, const unsigned int /*blockID*/, const int /*channel*/) throw()
+{
+	senderUserData = userData;
+	if(isDone()) sendDoneInternal();
+}
+
+void DiskInUGenInternal::processBlock(bool& shouldDelete, const unsigned int /*blockID*/, const int /*channel*/) throw()
+{
+	const int blockSize = uGenOutput.getBlockSize();
+	
+	for(int i = 0; i < getNumChannels(); i++)
+		outputSampleData[i] = proxies[i]->getSampleData();
+	
+	if(stream->process(outputSampleData, blockSize))
+	{
+		shouldDelete = shouldDelete ? true : shouldDeleteValue;
+		setIsDone();
+	}
+}
+
+double DiskInUGenInternal::getDuration() const throw()
+{
+	return stream->getDuration();
+}
+
+double DiskInUGenInternal::getPosition() const throw()
+{
+	return stream->getPosition();
+}
+
+bool DiskInUGenInternal::setPosition(const double newPosition) throw()
+{
+	stream->requestPosition(newPosition);
+	return true;
+}
+
+int DiskInUGenInternal::getNumUnderruns() const throw()
+{
+	return stream->getNumUnderruns();
+}
+
+DiskIn::DiskIn(Text const& path, 
+			   const bool loopFlag, 
+			   const double startTime, 
+			   const int numFrames,
+			   const UGen::DoneAction doneAction) throw()
+{
+	AudioFileReader* reader = new AudioFileReader(path.getArray());
+	
+	if(!reader->isOpen() || reader->getNumFrames() < 1)
+	{
+		delete reader;
+		return;
+	}
+	
+	const int numChannels = reader->getNumChannels();
+	const int startFrame = ugen::clip((int)(startTime * reader->getSampleRate() + 0.5), 0, reader->getNumFrames() - 1);
+	
+	initInternal(numChannels);
+	generateFromProxyOwner(new DiskInUGenInternal(new DiskInStream(reader, loopFlag, startFrame, numFrames), doneAction));
+}
+
+int DiskIn::getNumUnderruns() throw()
+{
+	return atomicGet(totalUnderruns);
+}
+
+DiskOutUGenInternal::DiskOutUGenInternal(DiskOutStream* streamToUse, UGen const& input) throw()
+:	ProxyOwnerUGenInternal(NumInputs, input.getNumChannels() - 1),
+	stream(streamToUse),
+	inputSampleData(new const float*[input.getNumChannels()])
+{
+	inputs[Input] = input;
+	DiskStreamThread::add(stream);
+}
+
+DiskOutUGenInternal::~DiskOutUGenInternal() throw()
+{
+	stream->flush();
+	stream->release();
+	delete [] inputSampleData;
+}
+
+void DiskOutUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int /*channel*/) throw()
+{
+	const int blockSize = uGenOutput.getBlockSize();
+	
+	for(int i = 0; i < getNumChannels(); i++)
+	{
+		const float* inputSamples = inputs[Input].processBlock(shouldDelete, blockID, i);
+		memcpy(proxies[i]->getSampleData(), inputSamples, blockSize * sizeof(float));
+		inputSampleData[i] = inputSamples;
+	}
+	
+	stream->write(inputSampleData, blockSize);
+}
+
+int DiskOutUGenInternal::getNumOverruns() const throw()
+{
+	return stream->getNumOverruns();
+}
+
+DiskOut::DiskOut(Text const& path, 
+				 UGen const& input, 
+				 bool overwriteExisitingFile, 
+				 int bitDepth, 
+				 const int numFrames) throw()
+{
+	const int numChannels = input.getNumChannels();
+	
+	if(numChannels < 1)
+		return;
+	
+	AudioFileWriter* writer = new AudioFileWriter(path.getArray(), 
+												  numChannels, 
+												  AudioFile::getTypeForPath(path), 
+												  bitDepth, 
+												  UGen::getSampleRate(), 
+												  overwriteExisitingFile);
+	
+	if(!writer->isOpen())
+	{
+		printf("DiskOut: Could not open file: %s\n", path.getArray());
+		delete writer;
+		return;
+	}
+	
+	initInternal(numChannels);
+	generateFromProxyOwner(new DiskOutUGenInternal(new DiskOutStream(writer, numFrames), input));
+}
+
+int DiskOut::getNumOverruns() throw()
+{
+	return atomicGet(totalOverruns);
+}
+
+END_UGEN_NAMESPACE
+
+#endif // !UGEN_JUCE && !UGEN_IPHONE
@@ -0,0 +1,185 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+#ifndef _UGEN_ugen_DiskStream_H_
+#define _UGEN_ugen_DiskStream_H_
+
+
+#include "../core/ugen_UGen.h"
+#include "ugen_AudioFile.h"
+
+class DiskInStream;
+class DiskOutStream;
+
+/** @ingroup UGenInternals */
+class DiskInUGenInternal :	public ProxyOwnerUGenInternal,
+							public DoneActionSender
+{
+public:
+	DiskInUGenInternal(DiskInStream* stream, const UGen::DoneAction doneAction) throw();
+	~DiskInUGenInternal() throw();
+	void prepareForBlock(const int actualBlockSize, const unsigned int blockID, const int channel) throw();
+	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	
+	double getDuration() const throw();
+	double getPosition() const throw();
+	bool setPosition(const double newPosition) throw();
+	
+	int getNumUnderruns() const throw();
+	
+protected:
+	DiskInStream* const stream;
+	float** outputSampleData;
+	const UGen::DoneAction doneAction_;
+	const bool shouldDeleteValue;
+};
+
+/** Streams a WAV or AIFF file from disk.
+ 
+ The file is read ahead on a shared background thread into a ring of pages which the audio 
+ thread takes from without ever touching the file or taking a lock, so many long 
+ multichannel files can be streamed at once. The first part of the file is loaded when 
+ the DiskIn is created so it starts immediately. 
+ 
+ setPosition() only posts a request so it never blocks, positions within the preloaded head
+ play at once otherwise the output is silent until the read ahead has caught up. If the 
+ reading falls behind at any other time the output is silent (and the file falls behind) 
+ for those samples and the underrun is counted, see getNumUnderruns().
+ 
+ This is the portable version used unless Juce or the iPhone is being used. The sample rate
+ of the file isn't converted.
+ 
+ @ingroup AllUGens SoundFileUGens
+ @see PlayBuf, DiskOut, AudioFileReader */
+class DiskIn : public UGen 
+{ 
+public: 
+	enum Constants
+	{
+		PageFrames = 4096,		///< The number of frames read ahead at a time.
+		HeadFrames = 32768		///< The number of frames at the start of the file which are kept in memory.
+	};
+	
+	DiskIn () throw() : UGen() { } 
+	
+	/** Stream a file.
+	 @param path		The path of the file.
+	 @param loopFlag	Whether the file loops (back to the start).
+	 @param startTime	The position to start at in seconds.
+	 @param numFrames	The number of frames to read ahead of the playback position.
+	 @param doneAction	What to do when a file which doesn't loop ends. */
+	DiskIn (Text const& path, 
+			const bool loopFlag = false, 
+			const double startTime = 0.0, 
+			const int numFrames = 65536,
+			const UGen::DoneAction doneAction = UGen::DeleteWhenDone) throw(); 
+	
+	static inline UGen AR (Text const& path, 
+						   const bool loopFlag = false, 
+						   const double startTime = 0.0,
+						   const int numFrames = 65536,
+						   const UGen::DoneAction doneAction = UGen::DeleteWhenDone) throw() 
+	{ 
+		return DiskIn (path, loopFlag, startTime, numFrames, doneAction); 
+	} 
+	
+	/** The number of blocks, over every DiskIn since the application started, in which the read 
+	 ahead didn't have the samples ready. DiskInUGenInternal::getNumUnderruns() counts just one file. */
+	static int getNumUnderruns() throw();
+};
+
+/** @ingroup UGenInternals */
+class DiskOutUGenInternal : public ProxyOwnerUGenInternal
+{
+public:
+	DiskOutUGenInternal(DiskOutStream* stream, UGen const& input) throw();
+	~DiskOutUGenInternal() throw();
+	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	
+	int getNumOverruns() const throw();
+	
+	enum Inputs { Input, NumInputs };
+	
+protected:
+	DiskOutStream* const stream;
+	const float** inputSampleData;
+};
+
+/** Streams data from a UGen out to a WAV or AIFF file.
+ 
+ The audio thread copies each block into a ring of pages which are written to the file on a
+ shared background thread. If the writing falls behind so there is no page to copy into those
+ samples are left out of the file and the overrun is counted. The file is completed (once 
+ everything has been written) after the DiskOut is deleted. The input is passed through 
+ to the output.
+ 
+ This is the portable version used unless Juce or the iPhone is being used.
+ 
+ @ingroup AllUGens SoundFileUGens 
+ @see DiskIn, AudioFileWriter */
+class DiskOut : public UGen 
+{ 
+public: 
+	DiskOut () throw() : UGen() { } 
+	
+	/** Record to a file.
+	 @param path					The path of the file, files ending ".aif" or ".aiff" are AIFF otherwise WAV.
+	 @param input					The UGen to record.
+	 @param overwriteExisitingFile	If this is false and the file exists nothing is recorded.
+	 @param bitDepth				16, 24 or 32 (integer).
+	 @param numFrames				The number of frames which can wait to be written. */
+	DiskOut (Text const& path, 
+			 UGen const& input, 
+			 bool overwriteExisitingFile = false, 
+			 int bitDepth = 24, 
+			 const int numFrames = 65536) throw(); 
+	
+	static inline UGen AR (Text const& path, 
+						   UGen const& input, 
+						   bool overwriteExisitingFile = false, 
+						   int bitDepth = 24,
+						   const int numFrames = 65536) throw()
+	{ 
+		return DiskOut (path, input, overwriteExisitingFile, bitDepth, numFrames); 
+	}
+	
+	/** The number of blocks, over every DiskOut since the application started, which couldn't all
+	 be written. DiskOutUGenInternal::getNumOverruns() counts just one file. */
+	static int getNumOverruns() throw();
+};
+
+
+#endif // _UGEN_ugen_DiskStream_H_
@@ -0,0 +1,386 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+  
+ HRTF data from the work at MIT by Bill Gardner and Keith Martin
+ http://sound.media.mit.edu/resources/KEMAR.html
+ 
+ ==============================================================================
+ */
+
+#if defined(UGEN_HRTF)
+
+#include "../core/ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_Binaural.h"
+#include "../fft/ugen_FFTEngineInternal.h"
+#include "../core/ugen_SIMD.h"
+#include "../basics/ugen_InlineUnaryOps.h"
+
+/** Sources which move less than this (in radians) keep their current response. */
+static const float ugen_BinauralMovementThreshold = 0.001f;
+
+/** out += a * b for spectra in the packed split format, the DC and Nyquist bins are both real. */
+static inline void ugen_BinauralMultiplyAccumulate(const float* a, const float* b, float* out) throw()
+{
+	const int halfSize = HRTFGrid::FFTSize / 2;
+	
+	out[0] += a[0] * b[0];
+	out[halfSize] += a[halfSize] * b[halfSize];
+	
+	SIMD::complexMultiplyAccumulate(a + 1, a + halfSize + 1, b + 1, b + halfSize + 1, 
+									out + 1, out + halfSize + 1, halfSize - 1);
+}
+
+//=============================== HRTFGrid ======================================
+
+HRTFGrid::HRTFGrid() throw()
+:	spectra(new float[NumElevations * NumAzimuths * FFTSize * 2])
+{
+	FFTEngine fftEngine(FFTSize);
+	float* timeBuffer = new float[FFTSize];
+	int measured[360];
+	
+	memset(timeBuffer, 0, FFTSize * sizeof(float));
+	
+	for(int elevationIndex = 0; elevationIndex < NumElevations; elevationIndex++)
+	{
+		const int elevation = MinimumElevation + elevationIndex * ElevationStep;
+		
+		// the measured azimuths around the full circle, the left side mirrors the right
+		int numMeasured = 0;
+		
+		for(int azimuth = 0; azimuth <= 180; azimuth++)
+			if(HRTF::closestAzimuth(elevation, azimuth) == azimuth)
+				measured[numMeasured++] = azimuth;
+		
+		for(int i = numMeasured - 1; i >= 0; i--)
+			if(measured[i] > 0 && measured[i] < 180)
+				measured[numMeasured++] = 360 - measured[i];
+		
+		for(int azimuthIndex = 0; azimuthIndex < NumAzimuths; azimuthIndex++)
+		{
+			const int azimuth = azimuthIndex * AzimuthStep;
+			
+			int upper = 1;
+			while(upper < numMeasured && measured[upper] <= azimuth) upper++;
+			
+			const int lowerAzimuth = measured[upper - 1];
+			const int upperAzimuth = (upper < numMeasured) ? measured[upper] : 360;
+			const int upperMeasured = upperAzimuth % 360;
+			const float fraction = (float)(azimuth - lowerAzimuth) / (float)(upperAzimuth - lowerAzimuth);
+			
+			Buffer lowerResponse = HRTF::getClosestResponseDegrees(lowerAzimuth <= 180 ? lowerAzimuth : lowerAzimuth - 360, 
+																   elevation);
+			Buffer upperResponse = HRTF::getClosestResponseDegrees(upperMeasured <= 180 ? upperMeasured : upperMeasured - 360, 
+																   elevation);
+			
+			float* spectrum = const_cast<float*> (getSpectra(azimuthIndex, elevationIndex));
+			
+			for(int ear = 0; ear < 2; ear++)
+			{
+				// interpolate in the time domain, scaled so the inverse FFT needs no scaling
+				const float scale = 1.f / FFTSize;
+				SIMD::multiply(lowerResponse.getData(ear), (1.f - fraction) * scale, timeBuffer, ResponseSize);
+				SIMD::multiplyAccumulate(upperResponse.getData(ear), fraction * scale, timeBuffer, ResponseSize);
+				
+				DSPSplitComplex output;
+				output.realp = spectrum + ear * FFTSize;
+				output.imagp = output.realp + FFTSize / 2;
+				fftEngine.getInternal()->fft(output, timeBuffer);
+			}
+		}
+	}
+	
+	delete [] timeBuffer;
+}
+
+HRTFGrid::~HRTFGrid()
+{
+	delete [] spectra;
+}
+
+HRTFGrid& HRTFGrid::getInstance() throw()
+{
+	static HRTFGrid grid;
+	return grid;
+}
+
+void HRTFGrid::interpolate(const float azimuth, const float elevation, float* output) const throw()
+{
+	float azimuthDegrees = fmodf(rad2deg(azimuth), 360.f);
+	if(azimuthDegrees < 0.f) azimuthDegrees += 360.f;
+	
+	const float azimuthPosition = azimuthDegrees / AzimuthStep;
+	int azimuth0 = (int)azimuthPosition;
+	const float azimuthFraction = azimuthPosition - azimuth0;
+	if(azimuth0 >= NumAzimuths) azimuth0 -= NumAzimuths;
+	const int azimuth1 = (azimuth0 + 1 < NumAzimuths) ? azimuth0 + 1 : 0;
+	
+	const float elevationDegrees = ugen::max((float)MinimumElevation, ugen::min((float)MaximumElevation, rad2deg(elevation)));
+	const float elevationPosition = (elevationDegrees - MinimumElevation) / ElevationStep;
+	const int elevation0 = ugen::min((int)elevationPosition, NumElevations - 2);
+	const float elevationFraction = elevationPosition - elevation0;
+	
+	const int size = FFTSize * 2;
+	SIMD::multiply(getSpectra(azimuth0, elevation0), (1.f - azimuthFraction) * (1.f - elevationFraction), output, size);
+	SIMD::multiplyAccumulate(getSpectra(azimuth1, elevation0), azimuthFraction * (1.f - elevationFraction), output, size);
+	SIMD::multiplyAccumulate(getSpectra(azimuth0, elevation0 + 1), (1.f - azimuthFraction) * elevationFraction, output, size);
+	SIMD::multiplyAccumulate(getSpectra(azimuth1, elevation0 + 1), azimuthFraction * elevationFraction, output, size);
+}
+
+//=============================== Binaural ======================================
+
+BinauralUGenInternal::BinauralUGenInternal(UGen const& input, UGen const& azimuth, UGen const& elevation) throw()
+:	ProxyOwnerUGenInternal(NumInputs, 1),
+	grid(HRTFGrid::getInstance()),
+	fftEngine(FFTSize),
+	numSources(ugen::max(input.getNumChannels(), 1)),
+	framePosition(0),
+	hasFilters(false),
+	inputFrames(new float[numSources * HopSize]),
+	outputFrame(new float[HopSize * 2]),
+	overlap(new float[HopSize * 2]),
+	filters(new float[numSources * SpectrumSize]),
+	filterAzimuths(new float[numSources]),
+	filterElevations(new float[numSources]),
+	targetAzimuths(new float[numSources]),
+	targetElevations(new float[numSources]),
+	timeBuffer(new float[FFTSize]),
+	inputSpectrum(new float[FFTSize]),
+	previousSpectra(new float[numSources * FFTSize]),
+	newFilter(new float[SpectrumSize]),
+	sum(new float[SpectrumSize]),
+	difference(new float[SpectrumSize]),
+	previousDifference(new float[SpectrumSize]),
+	alternatingSigns(new float[FFTSize]),
+	fadeIn(new float[HopSize]),
+	fadeOut(new float[HopSize])
+{
+	inputs[Input] = input;
+	inputs[Azimuth] = azimuth;
+	inputs[Elevation] = elevation;
+	
+	memset(inputFrames, 0, numSources * HopSize * sizeof(float));
+	memset(outputFrame, 0, HopSize * 2 * sizeof(float));
+	memset(overlap, 0, HopSize * 2 * sizeof(float));
+	memset(targetAzimuths, 0, numSources * sizeof(float));
+	memset(targetElevations, 0, numSources * sizeof(float));
+	memset(previousSpectra, 0, numSources * FFTSize * sizeof(float));
+	
+	// bin k is multiplied by (-1)^k, the Nyquist bin is even and takes the place of imag[0]
+	for(int i = 0; i < FFTSize; i++)
+		alternatingSigns[i] = ((i % (FFTSize / 2)) & 1) ? -1.f : 1.f;
+	
+	for(int i = 0; i < HopSize; i++)
+	{
+		fadeIn[i] = (float)(i + 1) / HopSize;
+		fadeOut[i] = 1.f - fadeIn[i];
+	}
+}
+
+BinauralUGenInternal::~BinauralUGenInternal()
+{
+	delete [] inputFrames;
+	delete [] outputFrame;
+	delete [] overlap;
+	delete [] filters;
+	delete [] filterAzimuths;
+	delete [] filterElevations;
+	delete [] targetAzimuths;
+	delete [] targetElevations;
+	delete [] timeBuffer;
+	delete [] inputSpectrum;
+	delete [] previousSpectra;
+	delete [] newFilter;
+	delete [] sum;
+	delete [] difference;
+	delete [] previousDifference;
+	delete [] alternatingSigns;
+	delete [] fadeIn;
+	delete [] fadeOut;
+}
+
+void BinauralUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int /*channel*/) throw()
+{
+	const int blockSize = uGenOutput.getBlockSize();
+	float* outputSamples0 = proxies[0]->getSampleData();
+	float* outputSamples1 = proxies[1]->getSampleData();
+	int offset = 0;
+	
+	while(offset < blockSize)
+	{
+		const int numSamplesThisTime = ugen::min(blockSize - offset, HopSize - framePosition);
+		const bool frameIsComplete = (framePosition + numSamplesThisTime) == HopSize;
+		
+		for(int source = 0; source < numSources; source++)
+		{
+			// each input is processed every block (and the block is cached) even if its values aren't used
+			const float* inputSamples = inputs[Input].processBlock(shouldDelete, blockID, source);
+			const float* azimuthSamples = inputs[Azimuth].processBlock(shouldDelete, blockID, source);
+			const float* elevationSamples = inputs[Elevation].processBlock(shouldDelete, blockID, source);
+			
+			memcpy(inputFrames + source * HopSize + framePosition, inputSamples + offset, numSamplesThisTime * sizeof(float));
+			
+			if(frameIsComplete)
+			{
+				targetAzimuths[source] = azimuthSamples[offset + numSamplesThisTime - 1];
+				targetElevations[source] = elevationSamples[offset + numSamplesThisTime - 1];
+			}
+		}
+		
+		memcpy(outputSamples0 + offset, outputFrame + framePosition, numSamplesThisTime * sizeof(float));
+		memcpy(outputSamples1 + offset, outputFrame + HopSize + framePosition, numSamplesThisTime * sizeof(float));
+		
+		framePosition += numSamplesThisTime;
+		offset += numSamplesThisTime;
+		
+		if(frameIsComplete)
+		{
+			processFrame();
+			framePosition = 0;
+		}
+	}
+}
+
+void BinauralUGenInternal::processFrame() throw()
+{
+	const int halfSize = FFTSize / 2;
+	FFTEngineInternal* engine = fftEngine.getInternal();
+	bool sourcesMoved = false;
+	
+	memset(sum, 0, SpectrumSize * sizeof(float));
+	memset(timeBuffer + HopSize, 0, (FFTSize - HopSize) * sizeof(float));
+	
+	DSPSplitComplex spectrum;
+	spectrum.realp = inputSpectrum;
+	spectrum.imagp = inputSpectrum + halfSize;
+	
+	for(int source = 0; source < numSources; source++)
+	{
+		memcpy(timeBuffer, inputFrames + source * HopSize, HopSize * sizeof(float));
+		engine->fft(spectrum, timeBuffer);
+		
+		float* filter = filters + source * SpectrumSize;
+		float* previousSpectrum = previousSpectra + source * FFTSize;
+		const float azimuth = targetAzimuths[source];
+		const float elevation = targetElevations[source];
+		
+		if(hasFilters == false)
+		{
+			grid.interpolate(azimuth, elevation, filter);
+			filterAzimuths[source] = azimuth;
+			filterElevations[source] = elevation;
+		}
+		else if((fabsf(azimuth - filterAzimuths[source]) > ugen_BinauralMovementThreshold) ||
+				(fabsf(elevation - filterElevations[source]) > ugen_BinauralMovementThreshold))
+		{
+			if(sourcesMoved == false)
+			{
+				memset(difference, 0, SpectrumSize * sizeof(float));
+				memset(previousDifference, 0, SpectrumSize * sizeof(float));
+				sourcesMoved = true;
+			}
+			
+			// accumulate the change this source makes to the output, including the tail of the 
+			// last frame which is still playing, then switch to the new response
+			grid.interpolate(azimuth, elevation, newFilter);
+			SIMD::subtract(newFilter, filter, filter, SpectrumSize);
+			ugen_BinauralMultiplyAccumulate(inputSpectrum, filter, difference);
+			ugen_BinauralMultiplyAccumulate(inputSpectrum, filter + FFTSize, difference + FFTSize);
+			ugen_BinauralMultiplyAccumulate(previousSpectrum, filter, previousDifference);
+			ugen_BinauralMultiplyAccumulate(previousSpectrum, filter + FFTSize, previousDifference + FFTSize);
+			memcpy(filter, newFilter, SpectrumSize * sizeof(float));
+			
+			filterAzimuths[source] = azimuth;
+			filterElevations[source] = elevation;
+		}
+		
+		ugen_BinauralMultiplyAccumulate(inputSpectrum, filter, sum);
+		ugen_BinauralMultiplyAccumulate(inputSpectrum, filter + FFTSize, sum + FFTSize);
+		
+		// shifted so the tail of its convolution lands in the first half
+		SIMD::multiply(inputSpectrum, alternatingSigns, previousSpectrum, FFTSize);
+	}
+	
+	hasFilters = true;
+	
+	for(int ear = 0; ear < 2; ear++)
+	{
+		float* output = outputFrame + ear * HopSize;
+		float* earOverlap = overlap + ear * HopSize;
+		
+		// overlap-add, the second half is carried into the next frame
+		spectrum.realp = sum + ear * FFTSize;
+		spectrum.imagp = spectrum.realp + halfSize;
+		engine->ifft(timeBuffer, spectrum);
+		
+		SIMD::add(timeBuffer, earOverlap, output, HopSize);
+		memcpy(earOverlap, timeBuffer + HopSize, HopSize * sizeof(float));
+		
+		if(sourcesMoved)
+		{
+			// the output so far has the moved sources' new responses for this frame but their 
+			// old responses for the tail of the last, fade both to the new responses
+			spectrum.realp = previousDifference + ear * FFTSize;
+			spectrum.imagp = spectrum.realp + halfSize;
+			engine->ifft(timeBuffer, spectrum);
+			
+			SIMD::multiply(timeBuffer, fadeIn, timeBuffer, HopSize);
+			SIMD::add(output, timeBuffer, output, HopSize);
+			
+			spectrum.realp = difference + ear * FFTSize;
+			spectrum.imagp = spectrum.realp + halfSize;
+			engine->ifft(timeBuffer, spectrum);
+			
+			SIMD::multiply(timeBuffer, fadeOut, timeBuffer, HopSize);
+			SIMD::subtract(output, timeBuffer, output, HopSize);
+		}
+	}
+}
+
+Binaural::Binaural(UGen const& input, UGen const& azimuth, UGen const& elevation) throw()
+{
+	initInternal(2);
+	
+	BinauralUGenInternal* internal = new BinauralUGenInternal(input, azimuth, elevation);
+	internalUGens[0] = internal;
+	internalUGens[1] = internal->getProxy(1);
+}
+
+END_UGEN_NAMESPACE
+
+#endif // UGEN_HRTF
@@ -0,0 +1,180 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+  
+ HRTF data from the work at MIT by Bill Gardner and Keith Martin
+ http://sound.media.mit.edu/resources/KEMAR.html
+ 
+ ==============================================================================
+ */
+
+#ifndef _UGEN_ugen_Binaural_H_
+#define _UGEN_ugen_Binaural_H_
+
+#include "../core/ugen_UGen.h"
+#include "../fft/ugen_FFTEngine.h"
+#include "ugen_HRTF.h"
+
+/** The HRTF set resampled onto a regular azimuth/elevation grid and stored as spectra.
+ 
+ Each elevation of the MIT set is measured at a different spacing so the responses are linearly 
+ interpolated around the full circle (mirroring the measured half with the ears swapped) at 
+ every AzimuthStep degrees. Each point is then zero padded to FFTSize and transformed once, 
+ scaled by 1/FFTSize so that the inverse transform of a product needs no further scaling. 
+ This takes about 2MB and is built the first time getInstance() is called, which should be 
+ on the main thread (constructing a Binaural UGen does this).
+ 
+ @see Binaural, HRTF */
+class HRTFGrid
+{
+public:
+	static HRTFGrid& getInstance() throw();
+	
+	enum Constants
+	{
+		ResponseSize = 128,
+		FFTSize = 256,
+		AzimuthStep = 5,
+		NumAzimuths = 360 / AzimuthStep,
+		ElevationStep = 10,
+		MinimumElevation = -40,
+		MaximumElevation = 90,
+		NumElevations = (MaximumElevation - MinimumElevation) / ElevationStep + 1
+	};
+	
+	/** Get the spectra for a direction by bilinear interpolation between the four closest grid points.
+	 The azimuth and elevation are in radians, as HRTF::getClosestResponse(), so positive azimuths 
+	 are to the right. The output is FFTSize * 2 floats, the left then the right spectrum, each in the 
+	 packed split format of the FFTEngine (the real parts then the imaginary parts with the Nyquist 
+	 bin in place of the DC imaginary part). */
+	void interpolate(const float azimuth, const float elevation, float* output) const throw();
+	
+	/** The spectra of one grid point, the left ear then the right ear. */
+	inline const float* getSpectra(const int azimuthIndex, const int elevationIndex) const throw()
+	{
+		ugen_assert(azimuthIndex >= 0 && azimuthIndex < NumAzimuths);
+		ugen_assert(elevationIndex >= 0 && elevationIndex < NumElevations);
+		return spectra + (elevationIndex * NumAzimuths + azimuthIndex) * FFTSize * 2;
+	}
+	
+private:
+	HRTFGrid() throw();
+	~HRTFGrid();
+	
+	float* spectra;
+	
+	HRTFGrid (const HRTFGrid&);
+	const HRTFGrid& operator= (const HRTFGrid&);
+};
+
+/** @ingroup UGenInternals */
+class BinauralUGenInternal : public ProxyOwnerUGenInternal
+{
+public:
+	BinauralUGenInternal(UGen const& input, UGen const& azimuth, UGen const& elevation) throw();
+	~BinauralUGenInternal();
+	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	
+	enum Inputs { Input, Azimuth, Elevation, NumInputs };
+	
+	enum Constants
+	{
+		HopSize = HRTFGrid::ResponseSize,
+		FFTSize = HRTFGrid::FFTSize,
+		SpectrumSize = FFTSize * 2 ///< The left and right spectra.
+	};
+	
+protected:
+	void processFrame() throw();
+	
+	HRTFGrid const& grid;
+	FFTEngine fftEngine;
+	const int numSources;
+	int framePosition;
+	bool hasFilters;
+	
+	float* inputFrames;			///< HopSize samples of each source.
+	float* outputFrame;			///< HopSize samples of each ear.
+	float* overlap;				///< The tail of the last frame for each ear.
+	float* filters;				///< The current left and right spectra of each source.
+	float* filterAzimuths;
+	float* filterElevations;
+	float* targetAzimuths;
+	float* targetElevations;
+	float* timeBuffer;			///< FFTSize samples.
+	float* inputSpectrum;		///< FFTSize floats.
+	float* previousSpectra;		///< The spectrum of the last frame of each source, shifted by HopSize.
+	float* newFilter;			///< SpectrumSize floats.
+	float* sum;					///< The output spectrum of each ear.
+	float* difference;			///< The change in each ear due to moving sources.
+	float* previousDifference;	///< The change in each ear from the tails of the last frames of moving sources.
+	float* alternatingSigns;	///< FFTSize floats, multiplying a spectrum by these shifts it by HopSize.
+	float* fadeIn;				///< HopSize samples ramping from 0 to 1.
+	float* fadeOut;				///< HopSize samples ramping from 1 to 0.
+};
+
+#define Binaural_Doc	@param input		The sources, each channel is a separate source.					\
+						@param azimuth		The azimuth of each source in radians, 0 is straight ahead		\
+											and positive values are to the right. This may have one			\
+											channel for each source (the channels wrap if there are fewer).	\
+						@param elevation	The elevation of each source in radians (-40 to 90 degrees),	\
+											the channels wrap as for azimuth.
+
+/** A binaural spatialiser for any number of moving sources using the MIT KEMAR HRTFs.
+ 
+ The sources are convolved with HRTFs interpolated from the HRTFGrid, which holds the whole set 
+ pre-transformed so moving a source only means blending four stored spectra. Sources are summed 
+ in the frequency domain so the cost of each is one forward FFT and a few multiply-accumulates 
+ per 128 samples. When a source moves its output is crossfaded from the old response to the new 
+ one over the next frame. The crossfade is done on the difference the move makes to the output, 
+ summed over every source that moved, so there are at most six inverse FFTs per frame whatever 
+ the number of sources. 
+ 
+ The azimuth and elevation are read once per frame and the output is delayed by 128 samples. 
+ The output is always stereo (left, right).
+ 
+ For example:
+ @code
+	UGen sources = UGen(PinkNoise::AR(0.1), Dust::AR(20, 0.5));		// two sources
+	UGen azimuths = UGen(LFSaw::AR(0.1), LFSaw::AR(-0.13)) * pi;	// circling in opposite directions
+	UGen binaural = Binaural::AR(sources, azimuths, 0.f);
+ @endcode
+ 
+ @ingroup AllUGens FFTUGens
+ @see HRTFGrid, HRTF */
+UGenSublcassDeclaration(Binaural, (input, azimuth, elevation),
+						(UGen const& input, UGen const& azimuth = 0.f, UGen const& elevation = 0.f), 
+						COMMON_UGEN_DOCS Binaural_Doc);
+
+#endif // _UGEN_ugen_Binaural_H_
@@ -38,7 +38,7 @@
 
 #if defined(UGEN_CONVOLUTION) && UGEN_CONVOLUTION
 
-#if !defined(WIN32) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
+#if defined(__APPLE__) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
 	#include <Accelerate/Accelerate.h>
 	#include <CoreServices/CoreServices.h>
 #endif
@@ -530,6 +530,71 @@ PartConvolve::PartConvolve(UGen const& input, PartBuffer const& partImpulse) thr
 	}
 }
 
+ZeroLatencyConvolveUGenInternal::ZeroLatencyConvolveUGenInternal(UGen const& input, PartitionedImpulse* impulseToUse) throw()
+:	UGenInternal(NumInputs),
+	impulse(impulseToUse),
+	convolver(impulseToUse)
+{
+	inputs[Input] = input;
+	impulse->incrementRefCount();
+}
+
+ZeroLatencyConvolveUGenInternal::~ZeroLatencyConvolveUGenInternal() throw()
+{
+	impulse->decrementRefCount();
+}
+
+UGenInternal* ZeroLatencyConvolveUGenInternal::getChannel(const int channel) throw()
+{
+	if(channel < 0 || inputs[Input].getNumChannels() < 2)
+	{
+		incrementRefCount();
+		return this;
+	}
+	else
+	{
+		UGenInternal* inputInternal	= inputs[Input].getInternalUGen(channel % inputs[Input].getNumChannels());
+		return new ZeroLatencyConvolveUGenInternal(UGen(inputInternal, channel), impulse);
+	}
+}
+
+void ZeroLatencyConvolveUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	const int numSamples = uGenOutput.getBlockSize();
+	float* outputSamples = uGenOutput.getSampleData();
+	const float* inputSamples = inputs[Input].processBlock(shouldDelete, blockID, channel);
+	
+	convolver.process(inputSamples, outputSamples, numSamples);
+}
+
+ZeroLatencyConvolve::ZeroLatencyConvolve(UGen const& input, Buffer const& impulse) throw()
+{
+	const int numImpulseChannels = ugen::max(1, impulse.getNumChannels());
+	const int numChannels = ugen::max(input.getNumChannels(), numImpulseChannels);
+	initInternal(numChannels);
+	
+	// each impulse channel is partitioned once and shared by the channels using it
+	PartitionedImpulse** partitionedChannels = new PartitionedImpulse*[numImpulseChannels];
+	
+	for(int i = 0; i < numImpulseChannels; i++)
+	{
+		if(impulse.getNumChannels() > 0)
+			partitionedChannels[i] = new PartitionedImpulse(impulse.getData(i), impulse.size(), UGen::getEstimatedBlockSize());
+		else
+			partitionedChannels[i] = new PartitionedImpulse(0, 0, UGen::getEstimatedBlockSize());
+	}
+	
+	for(int i = 0; i < numChannels; i++)
+	{
+		internalUGens[i] = new ZeroLatencyConvolveUGenInternal(input, partitionedChannels[i % numImpulseChannels]);
+	}
+	
+	for(int i = 0; i < numImpulseChannels; i++)
+		partitionedChannels[i]->decrementRefCount();
+	
+	delete [] partitionedChannels;
+}
+
 #if !defined(UGEN_FFTW) && !defined(UGEN_FFTREAL)
 TimeConvolveUGenInternal::TimeConvolveUGenInternal(UGen const& input, 
 												   Buffer const& impulse, 
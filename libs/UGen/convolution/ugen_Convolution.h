@@ -45,6 +45,7 @@
 #include "../basics/ugen_MixUGen.h"
 #include "../fft/ugen_FFTEngineInternal.h"
 #include "../fft/ugen_FFTEngine.h"
+#include "ugen_PartitionedConvolver.h"
 
 
 /** Stores a "partitioned" FFT buffer. */
@@ -201,16 +202,7 @@ public:
 };
 
 
-#if defined(UGEN_FFTW) || defined(UGEN_FFTREAL)
-DefineCustomUGen(ZeroLatencyConvolve,
-				 (Mix(UGenArray(PartConvolve(input, impulse, 8192, 0, 14)) <<
-					 UGenArray(PartConvolve(input, impulse, 2048, 8192, 12)) <<
-					 UGenArray(PartConvolve(input, impulse, 512, 2048, 10)) <<
-					 UGenArray(PartConvolve(input, impulse, 128, 512, 8)) <<
-					 UGenArray(PartConvolve(input, impulse, 0, 128, 6)))),			// No TimeConvolve yet on Windows
-				 (UGen const& input, Buffer const& impulse), COMMON_UGEN_DOCS);
-
-#else // assume we have the Mac vDSP interfaces
+#if !defined(UGEN_FFTW) && !defined(UGEN_FFTREAL) // assume we have the Mac vDSP interfaces
 
 /** A UGenInternal which performs time domain convolution.
  @ingroup UGenInternals */
@@ -248,18 +240,39 @@ UGenSublcassDeclaration(TimeConvolve, (input, impulse, startPoint, endPoint, dum
 						 long endPoint = 0, 
 						 long dummy = 0), COMMON_UGEN_DOCS);
 
+#endif // assumed we have the Mac vDSP interfaces
+
+/** A UGenInternal which performs zero latency non-uniform partitioned convolution.
+ @ingroup UGenInternals
+ @see ZeroLatencyConvolve, PartitionedConvolver */
+class ZeroLatencyConvolveUGenInternal : public UGenInternal
+{
+public:
+	ZeroLatencyConvolveUGenInternal(UGen const& input, PartitionedImpulse* impulse) throw();
+	~ZeroLatencyConvolveUGenInternal() throw();
+	UGenInternal* getChannel(const int channel) throw();
+	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	
+	enum Inputs { Input, NumInputs };
+	
+protected:
+	PartitionedImpulse* impulse;
+	PartitionedConvolver convolver;
+};
+
+#define ZeroLatencyConvolve_Docs	@param input		The input signal to convolve.												\
+									@param impulse		The impulse response to convolve with the @c input. The					\
+														partition sizes are chosen from its length and the host block size.
+
 /** Real time zero latency convolution. 
+ The number of channels will be determined by the larger of the number
+ of channels in the impulse Buffer and the input UGen. The start of the impulse
+ is convolved directly and the rest in partitions which double in size, the larger 
+ partitions are computed on background threads (see PartitionedConvolver).
  @ingroup FFTUGens */
-DefineCustomUGen(ZeroLatencyConvolve,
-				 (Mix(UGenArray(PartConvolve(input, impulse, 8192, 0, 14)) <<
-					 UGenArray(PartConvolve(input, impulse, 2048, 8192, 12)) <<
-					 UGenArray(PartConvolve(input, impulse, 512, 2048, 10)) <<
-					 UGenArray(PartConvolve(input, impulse, 128, 512, 8)) <<
-					 UGenArray(TimeConvolve(input, impulse, 0, 128)))),
-				 (UGen const& input, Buffer const& impulse),
-				 COMMON_UGEN_DOCS);
-
-#endif // assumed we have the Mac vDSP interfaces
+UGenSublcassDeclarationNoDefault(ZeroLatencyConvolve, (input, impulse),
+								 (UGen const& input, Buffer const& impulse), 
+								 COMMON_UGEN_DOCS ZeroLatencyConvolve_Docs);
 
 /** True stereo, real time, zero latency convolution ! 
  @ingroup FFTUGens */
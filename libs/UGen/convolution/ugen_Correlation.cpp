@@ -36,7 +36,7 @@
 
 #if defined(UGEN_CONVOLUTION) && UGEN_CONVOLUTION
 
-#if !defined(WIN32) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
+#if defined(__APPLE__) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
 	#include <Accelerate/Accelerate.h>
 	#include <CoreServices/CoreServices.h>
 #endif
@@ -47,25 +47,39 @@ BEGIN_UGEN_NAMESPACE
 #include "ugen_Correlation.h"
 #include "../basics/ugen_BinaryOpUGens.h"
 #include "../core/ugen_UGenArray.h"
+#include "../core/ugen_SIMD.h"
+#include "../fft/ugen_FFTEngineInternal.h"
 
 
+static int calculateCorrelationFFTSize(const int length) throw()
+{
+	// at least twice the length so the lags don't wrap around, FFTEngine takes sizes below 16 as powers of 2
+	return ugen::max(16, (int)Bits::nextPowerOf2(length * 2));
+}
+
 CorrelationUGenInternal::CorrelationUGenInternal(UGen const& inputA, 
                                                  UGen const& inputB, 
                                                  const int length,
-                                                 const int initialDelay) throw() // Will I need the delay?
+                                                 const int initialDelay,
+												 const int hopSize) throw()
 :	UGenInternal(NumInputs),
     length_(length),
-	bufferSize_(length_ * 2),
-	initialDelay_(initialDelay),
-	buffers(BufferSpec(bufferSize_, NumBuffers, true)),
+	initialDelay_(ugen::max(0, initialDelay)),
+	hopSize_(hopSize <= 0 ? length : ugen::min(hopSize, length)),
+	fftEngine(calculateCorrelationFFTSize(length)),
+	fftSize(fftEngine.size()),
+	buffers(BufferSpec(length_, NumBuffers, true)),
+	transforms(BufferSpec(fftSize, NumTransforms, true)),
     window(Buffer::hannWindow(length_)),
     score(Buffer::newClear(length_, 1, true)),
-	bufferIndex(initialDelay <= 0 ? 0 : initialDelay >= bufferSize_ ? 0 : bufferSize_ - initialDelay),
+	lagCurve(Buffer::newClear(length_, 1, true)),
+	bufferIndex(0),
+	samplesUntilCorrelation(length_ + initialDelay_),
+	indexOfMax(-1),
     lockedIndexOfMax(-1)
 {
 	inputs[InputA] = inputA;
 	inputs[InputB] = inputB;
-    
 }
 
 CorrelationUGenInternal::~CorrelationUGenInternal()
@@ -77,7 +91,8 @@ UGenInternal* CorrelationUGenInternal::getChannel(const int channel) throw()
 	return new CorrelationUGenInternal(inputs[InputA].getChannel(channel), 
                                        inputs[InputB].getChannel(channel), 
                                        length_, 
-                                       initialDelay_);
+                                       initialDelay_,
+									   hopSize_);
 }
 
 void CorrelationUGenInternal::outputIndex(float* outputSamples, int numSamplesToProcess)
@@ -87,21 +102,6 @@ void CorrelationUGenInternal::outputIndex(float* outputSamples, int numSamplesTo
         outputSamples[i] = fIndexOfMax;    
 }
 
-void CorrelationUGenInternal::outputBuffer(float* outputSamples, int numSamplesToProcess)
-{
-    float* const outputBufferSamples = buffers.getDataUnchecked(OutputBuffer);
-    memcpy(outputSamples, outputBufferSamples, numSamplesToProcess * sizeof(float));
-    outputSamples[numSamplesToProcess-1] = -length_;
-}
-
-void CorrelationUGenInternal::outputScore(float* outputSamples, int numSamplesToProcess)
-{
-    float* const scoreSamples = score.getDataUnchecked(0);
-    memcpy(outputSamples, scoreSamples, numSamplesToProcess * sizeof(float));
-    outputSamples[numSamplesToProcess-1] = -length_;
-}
-
-
 void CorrelationUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
 {
 	const int blockSize = uGenOutput.getBlockSize();
@@ -111,104 +111,126 @@ void CorrelationUGenInternal::processBlock(bool& shouldDelete, const unsigned in
 	float* inputBSamples = inputs[InputB].processBlock(shouldDelete, blockID, channel);
 	float* outputSamples = uGenOutput.getSampleData();
 	
-    float* const windowsSamples = window.getDataUnchecked(0);
-    float* const scoreSamples = score.getDataUnchecked(0);
 	float* const bufferASamples = buffers.getDataUnchecked(InputBufferA);
 	float* const bufferBSamples = buffers.getDataUnchecked(InputBufferB);
-	float* const outputBufferSamples = buffers.getDataUnchecked(OutputBuffer);
 	
 	while(numSamplesToProcess > 0)
 	{
-		int bufferSamplesToProcess = length_ - bufferIndex;
-	
-		if(bufferSamplesToProcess > numSamplesToProcess)
-		{			
-			// buffer the inputs
-			memcpy(bufferASamples + bufferIndex, inputASamples, numSamplesToProcess * sizeof(float));
-			memcpy(bufferBSamples + bufferIndex, inputBSamples, numSamplesToProcess * sizeof(float));
+		const int samplesThisTime = ugen::min(numSamplesToProcess, samplesUntilCorrelation);
+		
+		// the inputs go into a ring of the last length_ samples
+		int samplesRemaining = samplesThisTime;
+		
+		while(samplesRemaining > 0)
+		{
+			const int samplesToCopy = ugen::min(samplesRemaining, length_ - bufferIndex);
+			memcpy(bufferASamples + bufferIndex, inputASamples, samplesToCopy * sizeof(float));
+			memcpy(bufferBSamples + bufferIndex, inputBSamples, samplesToCopy * sizeof(float));
 			
-            bufferIndex += numSamplesToProcess;
-			inputASamples += numSamplesToProcess;
-			inputBSamples += numSamplesToProcess;
-
-			// ...and the output - output the lockedIndexOfMax into the outputSamples 
-            outputIndex(outputSamples, numSamplesToProcess);
-//            outputBuffer(outputSamples, numSamplesToProcess);
-//            outputScore(outputSamples, numSamplesToProcess);
-            
-			outputSamples += numSamplesToProcess;
-			numSamplesToProcess = 0;
+			inputASamples += samplesToCopy;
+			inputBSamples += samplesToCopy;
+			samplesRemaining -= samplesToCopy;
+			bufferIndex += samplesToCopy;
+			
+			if(bufferIndex >= length_)
+				bufferIndex = 0;
 		}
-		else
+		
+		numSamplesToProcess -= samplesThisTime;
+		samplesUntilCorrelation -= samplesThisTime;
+		
+		if(samplesUntilCorrelation == 0)
 		{
-			numSamplesToProcess -= bufferSamplesToProcess;
+			correlate();
+			samplesUntilCorrelation = hopSize_;
+		}
+		
+		// output the lockedIndexOfMax into the outputSamples 
+		outputIndex(outputSamples, samplesThisTime);
+		outputSamples += samplesThisTime;
+	}
+}
 
-			memcpy(bufferASamples + bufferIndex, inputASamples, bufferSamplesToProcess * sizeof(float));
-			memcpy(bufferBSamples + bufferIndex, inputBSamples, bufferSamplesToProcess * sizeof(float));
-			memset(outputBufferSamples, 0, (length_ + length_) * sizeof(float));
-            
-            //apply windows
-            
-            for (int i = 0; i < length_; i++)
-            {
-                bufferASamples[i] *= windowsSamples[i];
-                bufferBSamples[i] *= windowsSamples[i];
-            }
-            
-			bufferIndex += bufferSamplesToProcess;
-			inputASamples += bufferSamplesToProcess;
-			inputBSamples += bufferSamplesToProcess;
+void CorrelationUGenInternal::correlate() throw()
+{
+	const float* const windowSamples = window.getDataUnchecked(0);
+	const float* const bufferASamples = buffers.getDataUnchecked(InputBufferA);
+	const float* const bufferBSamples = buffers.getDataUnchecked(InputBufferB);
+	float* const timeSamples = transforms.getDataUnchecked(TimeBuffer);
+	float* const scoreSamples = score.getDataUnchecked(0);
+	float* const lagCurveSamples = lagCurve.getDataUnchecked(0);
+	const int fftSizeHalved = fftSize / 2;
+	
+	DSPSplitComplex spectrumA, spectrumB, product;
+	spectrumA.realp = transforms.getDataUnchecked(SpectrumA);
+	spectrumA.imagp = spectrumA.realp + fftSizeHalved;
+	spectrumB.realp = transforms.getDataUnchecked(SpectrumB);
+	spectrumB.imagp = spectrumB.realp + fftSizeHalved;
+	product.realp = transforms.getDataUnchecked(Product);
+	product.imagp = product.realp + fftSizeHalved;
+	
+	// unwrap the rings (oldest sample first) applying the window, the rest of the time buffer is zero padding
+	const int firstPart = length_ - bufferIndex;
+	memset(timeSamples + length_, 0, (fftSize - length_) * sizeof(float));
+	
+	SIMD::multiply(bufferASamples + bufferIndex, windowSamples, timeSamples, firstPart);
+	SIMD::multiply(bufferASamples, windowSamples + firstPart, timeSamples + firstPart, bufferIndex);
+	fftEngine.getInternal()->fft(spectrumA, timeSamples);
+	
+	SIMD::multiply(bufferBSamples + bufferIndex, windowSamples, timeSamples, firstPart);
+	SIMD::multiply(bufferBSamples, windowSamples + firstPart, timeSamples + firstPart, bufferIndex);
+	fftEngine.getInternal()->fft(spectrumB, timeSamples);
+	
+	// A times the conjugate of B is the transform of sum(A[t+n] * B[t]) at lag n,
+	// the first real and imaginary values are the DC and Nyquist bins which are both real
+	memset(product.realp, 0, fftSize * sizeof(float));
+	product.realp[0] = spectrumA.realp[0] * spectrumB.realp[0];
+	product.imagp[0] = spectrumA.imagp[0] * spectrumB.imagp[0];
+	
+	SIMD::neg(spectrumB.imagp + 1, spectrumB.imagp + 1, fftSizeHalved - 1);
+	SIMD::complexMultiplyAccumulate(spectrumA.realp + 1, spectrumA.imagp + 1, 
+									spectrumB.realp + 1, spectrumB.imagp + 1, 
+									product.realp + 1, product.imagp + 1, fftSizeHalved - 1);
+	
+	fftEngine.getInternal()->ifft(timeSamples, product);
+	SIMD::multiply(timeSamples, 1.f / fftSize, lagCurveSamples, length_);
+	
+	for (int i = 0; i < length_; i++)
+		scoreSamples[i] *= 0.9f;
+	
+	indexOfMax = findPeak(lagCurveSamples, length_);
+	
+	if ((indexOfMax >= 0) && (indexOfMax < length_))
+	{
+		if (lockedIndexOfMax >= 0)
+		{
+			int diff = indexOfMax - lockedIndexOfMax;
 			
-			vDSP_conv (bufferASamples, 1, 
-                       bufferBSamples, 1,			
-					   outputBufferSamples, 1, 
-					   length_, length_);
-                        
-            for (int i = 0; i < length_; i++)
-                scoreSamples[i] *= 0.9f;
-            
-            indexOfMax = findPeak(outputBufferSamples, length_);
-            
-            if ((indexOfMax >= 0) && (indexOfMax < length_))
-            {
-                if (lockedIndexOfMax >= 0)
-                {
-                    int diff = indexOfMax - lockedIndexOfMax;
-                    
-                    if (diff < 0)
-                        diff = -diff;
-                    
-                    int maximum = length_ / 4;
-                    diff = ugen::min(diff, maximum);
-                    
-                    int score = maximum - diff;
-                    
-                    float fScore = (float)score / maximum;
-                    fScore = ugen::cubed(fScore);
-                    
-                    scoreSamples[indexOfMax] += fScore;
-                }
-                else
-                {
-                    scoreSamples[indexOfMax] += 1.f;
-                }
-            }
-                        
-            lockedIndexOfMax = findPeak(scoreSamples, length_);            
-            
-            // output the lockedIndexOfMax into the outputSamples 
-            outputIndex(outputSamples, bufferSamplesToProcess);
-//            outputBuffer(outputSamples, bufferSamplesToProcess);
-//            outputScore(outputSamples, bufferSamplesToProcess);
-
-            outputSamples += bufferSamplesToProcess;
-			bufferSamplesToProcess = 0;
-			bufferIndex = 0;
+			if (diff < 0)
+				diff = -diff;
+			
+			int maximum = length_ / 4;
+			diff = ugen::min(diff, maximum);
+			
+			int score = maximum - diff;
+			
+			float fScore = maximum > 0 ? (float)score / maximum : 1.f;
+			fScore = ugen::cubed(fScore);
+			
+			scoreSamples[indexOfMax] += fScore;
+		}
+		else
+		{
+			scoreSamples[indexOfMax] += 1.f;
 		}
 	}
+	
+	lockedIndexOfMax = findPeak(scoreSamples, length_);
+	
+	sendBuffer(lagCurve, lockedIndexOfMax, indexOfMax);
 }
 
-int CorrelationUGenInternal::findPeak(float* buffer, int length)
+int CorrelationUGenInternal::findPeak(const float* buffer, int length)
 {
     int indexOfMax = -1; 
     float currentMax = 0.f;	
@@ -230,9 +252,10 @@ int CorrelationUGenInternal::findPeak(float* buffer, int length)
 Correlation::Correlation(UGen const& inputA, 
                          UGen const& inputB, 
                          const int length, 
-                         const int initialDelay) throw()
+                         const int initialDelay,
+						 const int hopSize) throw()
 {	
-	const int lengthChecked = ugen::clip(length, 1, 2044);
+	const int lengthChecked = ugen::clip(length, 1, 65536);
 
 	const int numInputChannels = ugen::max(inputA.getNumChannels(), inputB.getNumChannels());
 	initInternal(numInputChannels);
@@ -242,7 +265,8 @@ Correlation::Correlation(UGen const& inputA,
 		internalUGens[i] = new CorrelationUGenInternal(inputA, 
                                                        inputB, 
                                                        lengthChecked, 
-                                                       initialDelay);
+                                                       initialDelay,
+													   hopSize);
 	}
 }
 
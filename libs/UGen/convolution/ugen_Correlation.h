@@ -38,46 +38,80 @@
 #define _UGEN_ugen_Correlation_H_
 
 #include "../core/ugen_UGen.h"
-#include "../fft/ugen_FFTEngineInternal.h"
+#include "../buffers/ugen_Buffer.h"
+#include "../fft/ugen_FFTEngine.h"
 
-class CorrelationUGenInternal : public UGenInternal
+/** A UGenInternal which tracks the lag between two signals by FFT cross-correlation.
+ 
+ Every hopSize samples the last length samples of each input are windowed and 
+ cross-correlated using an FFTEngine twice the length (rounded up to a power of 2) 
+ so lags from 0 to length-1 don't wrap around. The lag of the peak in each window 
+ adds to a decaying score and the output is the lag with the highest score. 
+ 
+ This is also a BufferSender, each window the lag curve (length samples, index n 
+ being the sum of A[t+n] * B[t]) is sent to any receivers with the locked lag as 
+ value1 and the lag of the peak in this window as value2. This happens on the audio 
+ thread and the Buffer is reused for the next window so receivers should copy it 
+ if they keep it.
+ @ingroup UGenInternals
+ @see Correlation */
+class CorrelationUGenInternal :	public UGenInternal,
+								public BufferSender
 {
 public:
 	CorrelationUGenInternal(UGen const& inputA, 
                             UGen const& inputB, 
                             const int length, 
-                            const int initialDelay) throw();
+                            const int initialDelay,
+							const int hopSize) throw();
 	~CorrelationUGenInternal();
 	UGenInternal* getChannel(const int channel) throw();
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
 	
     void outputIndex(float* outputSamples, int numSamplesToProcess);
-    void outputBuffer(float* outputSamples, int numSamplesToProcess);
-    void outputScore(float* outputSamples, int numSamplesToProcess);
     
-    static int findPeak(float* buffer, int length);
+    static int findPeak(const float* buffer, int length);
     
 	enum Inputs { InputA, InputB, NumInputs };
-	enum Buffers { InputBufferA, InputBufferB, OutputBuffer, NumBuffers };
+	enum Buffers { InputBufferA, InputBufferB, NumBuffers };
+	enum Transforms { TimeBuffer, SpectrumA, SpectrumB, Product, NumTransforms };
 	
 	
 protected:
+	void correlate() throw();
+	
     const int length_;
-	const int bufferSize_;
 	const int initialDelay_;
+	const int hopSize_;
+	FFTEngine fftEngine;
+	const int fftSize;
 	Buffer buffers;
+	Buffer transforms;
     Buffer window;
     Buffer score;
+	Buffer lagCurve;
 	int bufferIndex;
+	int samplesUntilCorrelation;
     int indexOfMax;
     int lockedIndexOfMax;
 };
 
+#define Correlation_Docs	@param inputA		The first signal.																		\
+							@param inputB		The second signal, the output is the lag by which @c inputA follows this.				\
+							@param length		The window size and the number of lags tracked (up to 65536).							\
+							@param initialDelay	Delay the first window by this many samples, e.g., to stagger several Correlation		\
+												UGens.																					\
+							@param hopSize		The number of samples between windows, 0 (the default) uses @c length so the			\
+												windows do not overlap.
 
+/** Tracks the delay between two signals by cross-correlation.
+ The output is the lag in samples (0 to length-1) by which @c inputA follows @c inputB.
+ Add a BufferReceiver (see UGen::addBufferReceiver()) to receive the whole lag curve each window.
+ @ingroup AllUGens FFTUGens */
 UGenSublcassDeclaration(Correlation, 
-						(inputA, inputB, length, initialDelay),
-						(UGen const& inputA, UGen const& inputB, const int length = 512, const int initialDelay = 0), 
-						COMMON_UGEN_DOCS);
+						(inputA, inputB, length, initialDelay, hopSize),
+						(UGen const& inputA, UGen const& inputB, const int length = 512, const int initialDelay = 0, const int hopSize = 0), 
+						COMMON_UGEN_DOCS Correlation_Docs);
 
 //UGenSublcassDeclaration(OverlapCorrelation, 
 //						(inputA, inputB, fftSize, overlap),
@@ -0,0 +1,567 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#if defined(UGEN_CONVOLUTION) && UGEN_CONVOLUTION
+
+#if defined(__APPLE__) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
+	#include <Accelerate/Accelerate.h>
+#endif
+#include "../core/ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_PartitionedConvolver.h"
+#include "../fft/ugen_FFTEngineInternal.h"
+#include "../core/ugen_SIMD.h"
+#include "../core/ugen_Thread.h"
+#include "../core/ugen_Arrays.h"
+
+PartitionedImpulse::PartitionedImpulse(const float* impulse, const int lengthToUse, const int blockSize) throw()
+:	length(ugen::max(0, lengthToUse)),
+	headSize(ugen::clip((int)Bits::nextPowerOf2(ugen::max(1, blockSize)), (int)MinimumHeadSize, (int)MaximumHeadSize)),
+	head(new float[headSize]),
+	numStages(0),
+	stages(0)
+{
+	const int headLength = ugen::min(headSize, length);
+	memcpy(head, impulse, headLength * sizeof(float));
+	memset(head + headLength, 0, (headSize - headLength) * sizeof(float));
+	
+	// the first stage starts one partition in, giving it 2 * PartitionsPerStage - 1 partitions 
+	// makes the next stage start PartitionsPerStage of its own partitions in, as do all the others
+	Stage layout[32];
+	int partitionSize = headSize;
+	int startPoint = headSize;
+	int partitionsPerStage = 2 * PartitionsPerStage - 1;
+	
+	while(startPoint < length)
+	{
+		const int remaining = length - startPoint;
+		const bool isLast = (partitionSize >= MaximumPartitionSize) || (remaining <= partitionsPerStage * partitionSize);
+		
+		Stage& stage = layout[numStages++];
+		stage.partitionSize = partitionSize;
+		stage.startPoint = startPoint;
+		stage.numPartitions = isLast ? (remaining + partitionSize - 1) / partitionSize : partitionsPerStage;
+		stage.isBackground = (startPoint >= 2 * partitionSize) &&
+							 (partitionSize >= MinimumBackgroundPartitionSize) &&
+							 (partitionSize >= BackgroundBlocksPerPartition * blockSize);
+		stage.spectra = 0;
+		
+		startPoint += stage.numPartitions * partitionSize;
+		partitionSize *= 2;
+		partitionsPerStage = PartitionsPerStage;
+	}
+	
+	stages = new Stage[ugen::max(1, numStages)];
+	
+	for(int i = 0; i < numStages; i++)
+	{
+		Stage& stage = stages[i];
+		stage = layout[i];
+		
+		const int fftSize = stage.partitionSize * 2;
+		FFTEngine fftEngine(fftSize);
+		float* timeBuffer = new float[fftSize];
+		stage.spectra = new float[stage.numPartitions * fftSize];
+		
+		for(int partition = 0; partition < stage.numPartitions; partition++)
+		{
+			const int offset = stage.startPoint + partition * stage.partitionSize;
+			const int numSamples = ugen::min(stage.partitionSize, length - offset);
+			
+			memcpy(timeBuffer, impulse + offset, numSamples * sizeof(float));
+			memset(timeBuffer + numSamples, 0, (fftSize - numSamples) * sizeof(float));
+			
+			DSPSplitComplex spectrum;
+			spectrum.realp = stage.spectra + partition * fftSize;
+			spectrum.imagp = spectrum.realp + stage.partitionSize;
+			fftEngine.getInternal()->fft(spectrum, timeBuffer);
+		}
+		
+		delete [] timeBuffer;
+	}
+}
+
+PartitionedImpulse::~PartitionedImpulse()
+{
+	for(int i = 0; i < numStages; i++)
+		delete [] stages[i].spectra;
+	
+	delete [] stages;
+	delete [] head;
+}
+
+/** The state of one stage of a PartitionedConvolver. 
+ 
+ A stage is triggered each time a partition's worth of input has arrived, it transforms the last 
+ two partitions of input, adds this to its frequency domain delay line and multiplies the delay 
+ line by the impulse spectra. The output of the job triggered at the end of partition j is played 
+ from the start of partition j + startPoint / partitionSize so the outputs are kept in a ring of 
+ that many partitions. 
+ 
+ Jobs are computed in order, one at a time. If the output ring is at least three partitions 
+ long a job may still be in flight when the next is triggered and need only be done by the 
+ trigger after that, so a worker has a whole extra partition (at least BackgroundBlocksPerPartition 
+ blocks) before the audio thread has to wait for it. The input ring holds at least four partitions
+ so the input isn't overwritten in that time. */
+class PartitionedConvolverStage
+{
+public:
+	enum Constants { MaximumJobsInFlight = 2 };
+	
+	PartitionedConvolverStage(PartitionedImpulse::Stage const& layoutToUse, const float* inputRingToUse, const int inputRingSizeToUse) throw()
+	:	layout(layoutToUse),
+		partitionSize(layout.partitionSize),
+		fftSize(partitionSize * 2),
+		numOutputs(layout.startPoint / partitionSize),
+		inputRing(inputRingToUse),
+		inputRingSize(inputRingSizeToUse),
+		fftEngine(fftSize),
+		timeBuffer(new float[fftSize]),
+		accumulator(new float[fftSize]),
+		delayLine(new float[layout.numPartitions * fftSize]),
+		delayLinePosition(0),
+		outputs(new float[numOutputs * partitionSize]),
+		maximumJobsInFlight(numOutputs > MaximumJobsInFlight ? (int)MaximumJobsInFlight : 1),
+		numTriggered(0),
+		numClaimed(0),
+		numDone(0)
+	{
+		ugen_assert(layout.startPoint % partitionSize == 0);
+		ugen_assert(inputRingSize % (numOutputs * partitionSize) == 0);
+		
+		memset(delayLine, 0, layout.numPartitions * fftSize * sizeof(float));
+		memset(outputs, 0, numOutputs * partitionSize * sizeof(float));
+	}
+	
+	~PartitionedConvolverStage()
+	{
+		delete [] outputs;
+		delete [] delayLine;
+		delete [] accumulator;
+		delete [] timeBuffer;
+	}
+	
+	inline bool isBackground() const throw()	{ return layout.isBackground; }
+	inline int getPartitionSize() const throw()	{ return partitionSize; }
+	
+	/** The output for the given input ring position, valid up to the end of the partition. */
+	inline const float* getOutput(const int position) const throw()
+	{
+		const int slot = (position / partitionSize) % numOutputs;
+		return outputs + slot * partitionSize + (position & (partitionSize - 1));
+	}
+	
+	/** Start the job for the partition ending at this input ring position, called on the audio thread. */
+	void trigger(const int position) throw()
+	{
+		const int job = numTriggered;
+		
+		// its position slot is reused by this job
+		finish(job + 1 - maximumJobsInFlight);
+		
+		jobPositions[job % MaximumJobsInFlight] = position;
+		atomicSet(numTriggered, job + 1);
+		
+		if(!layout.isBackground || PartitionedConvolver::getNumBackgroundThreads() == 0)
+			finish(job + 1);
+	}
+	
+	/** Make sure the first numJobs jobs are done, computing any no worker has claimed. */
+	void finish(const int numJobs) throw()
+	{
+		for(int spins = 0; atomicGet(numDone) < numJobs; spins++)
+		{
+			if(runIfPending())
+				continue;
+			
+			// a worker is computing it, this is only reached if the workers are a whole partition behind
+			if(spins < 64)
+				atomicPause();
+			else
+				BackgroundThread::sleep(0);
+		}
+	}
+	
+	/** Compute the next job if it is pending and nothing else has claimed it. */
+	bool runIfPending() throw()
+	{
+		if(!claim())
+			return false;
+		
+		run();
+		return true;
+	}
+	
+	/** Take the next pending job so nothing else computes it, it must then be computed with run(). 
+	 This fails while the job before is still being computed. */
+	inline bool claim() throw()
+	{
+		const int job = atomicGet(numDone);
+		return job < atomicGet(numTriggered) && atomicCompareAndSwap(numClaimed, job, job + 1);
+	}
+	
+	/** Compute a job taken with claim(). */
+	void run() throw()
+	{
+		const int job = numDone;
+		compute(jobPositions[job % MaximumJobsInFlight]);
+		atomicSet(numDone, job + 1);
+	}
+	
+	/** Wait for a claimed job to finish, once the stage can no longer be claimed by a worker. */
+	void cancel() throw()
+	{
+		while(atomicGet(numClaimed) != atomicGet(numDone)) 
+			BackgroundThread::sleep(0);
+	}
+	
+private:
+	void compute(const int jobPosition) throw()
+	{
+		const int numPartitions = layout.numPartitions;
+		
+		// the last two partitions of input, these aren't overwritten until after the next trigger
+		const int start = (jobPosition - fftSize + inputRingSize) & (inputRingSize - 1);
+		const int firstPart = ugen::min(fftSize, inputRingSize - start);
+		memcpy(timeBuffer, inputRing + start, firstPart * sizeof(float));
+		memcpy(timeBuffer + firstPart, inputRing, (fftSize - firstPart) * sizeof(float));
+		
+		DSPSplitComplex input;
+		input.realp = delayLine + delayLinePosition * fftSize;
+		input.imagp = input.realp + partitionSize;
+		fftEngine.getInternal()->fft(input, timeBuffer);
+		
+		// the first real and imaginary values are the DC and Nyquist bins which are both real
+		memset(accumulator, 0, fftSize * sizeof(float));
+		float* const accumulatorReal = accumulator;
+		float* const accumulatorImag = accumulator + partitionSize;
+		
+		for(int partition = 0; partition < numPartitions; partition++)
+		{
+			const int index = (delayLinePosition - partition + numPartitions) % numPartitions;
+			const float* inputReal = delayLine + index * fftSize;
+			const float* inputImag = inputReal + partitionSize;
+			const float* impulseReal = layout.spectra + partition * fftSize;
+			const float* impulseImag = impulseReal + partitionSize;
+			
+			accumulatorReal[0] += inputReal[0] * impulseReal[0];
+			accumulatorImag[0] += inputImag[0] * impulseImag[0];
+			
+			SIMD::complexMultiplyAccumulate(inputReal + 1, inputImag + 1, impulseReal + 1, impulseImag + 1, 
+											accumulatorReal + 1, accumulatorImag + 1, partitionSize - 1);
+		}
+		
+		if(++delayLinePosition >= numPartitions)
+			delayLinePosition = 0;
+		
+		DSPSplitComplex output;
+		output.realp = accumulatorReal;
+		output.imagp = accumulatorImag;
+		fftEngine.getInternal()->ifft(timeBuffer, output);
+		
+		// overlap-save, the second half is valid
+		const int partition = jobPosition / partitionSize + inputRingSize / partitionSize - 1;
+		float* slot = outputs + (partition % numOutputs) * partitionSize;
+		SIMD::multiply(timeBuffer + partitionSize, 1.f / fftSize, slot, partitionSize);
+	}
+	
+	PartitionedImpulse::Stage const& layout;
+	const int partitionSize;
+	const int fftSize;
+	const int numOutputs;
+	const float* const inputRing;
+	const int inputRingSize;
+	FFTEngine fftEngine;
+	float* const timeBuffer;
+	float* const accumulator;
+	float* const delayLine;
+	int delayLinePosition;
+	float* const outputs;
+	const int maximumJobsInFlight;
+	int jobPositions[MaximumJobsInFlight];
+	volatile int numTriggered;
+	volatile int numClaimed;
+	volatile int numDone;
+	
+	PartitionedConvolverStage (const PartitionedConvolverStage&);
+	const PartitionedConvolverStage& operator= (const PartitionedConvolverStage&);
+};
+
+/** Computes pending background stages. */
+class PartitionedConvolverThread : public BackgroundThread
+{
+public:
+	PartitionedConvolverThread() throw()	{ }
+	~PartitionedConvolverThread()			{ stopThread(); }
+	
+private:
+	void run();
+};
+
+/** The background stages of all the convolvers and the threads which share their work.
+ 
+ The audio thread never takes the lock, it just adds a pending job to a stage. The workers hold 
+ the lock only while they find a stage and claim its next job, the job is 
+ computed after the lock is released. remove() waits for a claimed job to finish before the 
+ stage can be deleted and a stage which has been removed can't be claimed again. */
+class PartitionedConvolverPool
+{
+public:
+	PartitionedConvolverPool() throw()
+	:	numThreads(ugen::max(1, BackgroundThread::getNumProcessors() - 1)),
+		nextIndex(0)
+	{
+	}
+	
+	~PartitionedConvolverPool()
+	{
+		setNumThreads(0);
+	}
+	
+	void add(PartitionedConvolverStage* stage) throw()
+	{
+		lock.enter();
+		stages.add(stage);
+		lock.exit();
+		
+		// the threads are started once there is something for them to do
+		if(threads.length() < numThreads)
+			startThreads();
+	}
+	
+	void remove(PartitionedConvolverStage* stage) throw()
+	{
+		lock.enter();
+		stages.removeItem(stage);
+		lock.exit();
+		
+		stage->cancel();
+	}
+	
+	/** Claim and compute one pending stage. @return @c false if there were none. */
+	bool runPending() throw()
+	{
+		PartitionedConvolverStage* claimed = 0;
+		
+		lock.enter();
+		
+		const int size = stages.length();
+		
+		for(int i = 0; i < size && claimed == 0; i++)
+		{
+			PartitionedConvolverStage* stage = stages[(nextIndex + i) % size];
+			
+			if(stage->claim() == false)
+				continue;
+			
+			claimed = stage;
+			nextIndex = (nextIndex + i + 1) % size; // don't always favour the same convolver
+		}
+		
+		lock.exit();
+		
+		if(claimed == 0)
+			return false;
+		
+		// the other workers can look for jobs while this one is computed
+		claimed->run();
+		return true;
+	}
+	
+	void setNumThreads(const int numThreadsToUse) throw()
+	{
+		numThreads = ugen::max(0, numThreadsToUse);
+		
+		while(threads.length() > numThreads)
+		{
+			const int last = threads.length() - 1;
+			delete threads[last];
+			threads.remove(last);
+		}
+		
+		lock.enter();
+		const bool hasStages = stages.length() > 0;
+		lock.exit();
+		
+		if(hasStages)
+			startThreads();
+	}
+	
+	inline int getNumThreads() const throw() { return numThreads; }
+	
+private:
+	void startThreads() throw()
+	{
+		while(threads.length() < numThreads)
+		{
+			PartitionedConvolverThread* thread = new PartitionedConvolverThread();
+			thread->startThread();
+			threads.add(thread);
+		}
+	}
+	
+	SpinLock lock;
+	int numThreads;
+	int nextIndex;
+	ObjectArray<PartitionedConvolverStage*> stages;
+	ObjectArray<PartitionedConvolverThread*> threads;
+};
+
+static PartitionedConvolverPool& getPartitionedConvolverPool() throw()
+{
+	static PartitionedConvolverPool pool;
+	return pool;
+}
+
+void PartitionedConvolverThread::run()
+{
+	while(!threadShouldExit())
+	{
+		if(getPartitionedConvolverPool().runPending() == false)
+			sleep(1);
+	}
+}
+
+static int calculateInputRingSize(PartitionedImpulse const* impulse) throw()
+{
+	const int numStages = impulse->getNumStages();
+	const int largest = numStages > 0 ? impulse->getStage(numStages - 1).partitionSize : impulse->getHeadSize();
+	
+	// enough for two partitions of input being read while the next partition arrives, 
+	// and a whole number of every stage's output ring
+	return ugen::max(largest, impulse->getHeadSize()) * PartitionedImpulse::PartitionsPerStage;
+}
+
+PartitionedConvolver::PartitionedConvolver(PartitionedImpulse* impulseToUse) throw()
+:	impulse(impulseToUse),
+	headSize(impulse->getHeadSize()),
+	inputRingSize(calculateInputRingSize(impulse)),
+	inputRing(new float[inputRingSize]),
+	headHistory(new float[headSize * 2]),
+	position(0),
+	numStages(impulse->getNumStages()),
+	stages(new PartitionedConvolverStage*[ugen::max(1, numStages)])
+{
+	impulse->incrementRefCount();
+	
+	memset(inputRing, 0, inputRingSize * sizeof(float));
+	memset(headHistory, 0, headSize * 2 * sizeof(float));
+	
+	for(int i = 0; i < numStages; i++)
+	{
+		stages[i] = new PartitionedConvolverStage(impulse->getStage(i), inputRing, inputRingSize);
+		
+		if(stages[i]->isBackground())
+			getPartitionedConvolverPool().add(stages[i]);
+	}
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+	for(int i = 0; i < numStages; i++)
+	{
+		if(stages[i]->isBackground())
+			getPartitionedConvolverPool().remove(stages[i]);
+		
+		delete stages[i];
+	}
+	
+	delete [] stages;
+	delete [] headHistory;
+	delete [] inputRing;
+	
+	impulse->decrementRefCount();
+}
+
+void PartitionedConvolver::process(const float* input, float* output, const int numSamples) throw()
+{
+	const float* const headTaps = impulse->getHead();
+	float* const history = headHistory + headSize - 1; // the previous headSize - 1 inputs are before this
+	int numSamplesRemaining = numSamples;
+	
+	while(numSamplesRemaining > 0)
+	{
+		// never cross a head boundary, every stage's partitions are a multiple of the head size
+		const int numSamplesThisTime = ugen::min(numSamplesRemaining, headSize - (position & (headSize - 1)));
+		
+		memcpy(inputRing + position, input, numSamplesThisTime * sizeof(float));
+		memcpy(history, input, numSamplesThisTime * sizeof(float));
+		
+		// the head in the time domain, one multiply-accumulate per tap over the whole chunk
+		SIMD::multiply(history, headTaps[0], output, numSamplesThisTime);
+		
+		for(int tap = 1; tap < headSize; tap++)
+			SIMD::multiplyAccumulate(history - tap, headTaps[tap], output, numSamplesThisTime);
+		
+		memmove(headHistory, headHistory + numSamplesThisTime, (headSize - 1) * sizeof(float));
+		
+		for(int i = 0; i < numStages; i++)
+			SIMD::add(output, stages[i]->getOutput(position), output, numSamplesThisTime);
+		
+		position = (position + numSamplesThisTime) & (inputRingSize - 1);
+		
+		if((position & (headSize - 1)) == 0)
+		{
+			for(int i = 0; i < numStages; i++)
+			{
+				if((position & (stages[i]->getPartitionSize() - 1)) == 0)
+					stages[i]->trigger(position);
+			}
+		}
+		
+		input += numSamplesThisTime;
+		output += numSamplesThisTime;
+		numSamplesRemaining -= numSamplesThisTime;
+	}
+}
+
+void PartitionedConvolver::setNumBackgroundThreads(const int numThreads) throw()
+{
+	getPartitionedConvolverPool().setNumThreads(numThreads);
+}
+
+int PartitionedConvolver::getNumBackgroundThreads() throw()
+{
+	return getPartitionedConvolverPool().getNumThreads();
+}
+
+
+END_UGEN_NAMESPACE
+
+#endif // UGEN_CONVOLUTION
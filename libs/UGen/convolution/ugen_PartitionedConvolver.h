@@ -0,0 +1,151 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef _UGEN_ugen_PartitionedConvolver_H_
+#define _UGEN_ugen_PartitionedConvolver_H_
+
+
+#include "../core/ugen_SmartPointer.h"
+#include "../fft/ugen_FFTEngine.h"
+
+
+/** One channel of an impulse response split into non-uniform partitions.
+ 
+ The first few samples (the "head") are kept in the time domain and convolved directly 
+ so there is no latency. The rest is split into stages, each a run of equal sized partitions 
+ which are twice the size of those in the stage before. The head size comes from the host 
+ block size and the stages keep doubling until the remaining impulse fits in one stage or 
+ the partitions reach MaximumPartitionSize. Every stage starts at a whole number of its own 
+ partitions (one for the first stage, PartitionsPerStage for the others) which gives the larger 
+ stages a partition's worth of time to compute their output, so those whose partitions span 
+ several blocks are marked to run on a background thread.
+ 
+ The spectra are computed once and shared by each PartitionedConvolver using this channel.
+ 
+ @see PartitionedConvolver, ZeroLatencyConvolve */
+class PartitionedImpulse : public SmartPointer
+{
+public:
+	/** Partition a channel of an impulse response.
+	 @param impulse		The impulse response samples, these are copied.
+	 @param length		The number of samples in the impulse response.
+	 @param blockSize	The host block size, e.g., UGen::getEstimatedBlockSize(). */
+	PartitionedImpulse(const float* impulse, const int length, const int blockSize) throw();
+	~PartitionedImpulse();
+	
+	/** A run of uniform partitions. */
+	struct Stage
+	{
+		int partitionSize;		///< The number of impulse samples in each partition (the FFT size is twice this).
+		int startPoint;			///< The first impulse sample in the stage, always a multiple of partitionSize.
+		int numPartitions;
+		bool isBackground;		///< Whether the stage should be computed on a background thread.
+		float* spectra;			///< The split real and imaginary spectrum of each partition in turn, each partitionSize * 2 floats.
+	};
+	
+	inline int getLength() const throw()						{ return length;			}
+	inline int getHeadSize() const throw()						{ return headSize;			}
+	inline const float* getHead() const throw()					{ return head;				}
+	inline int getNumStages() const throw()						{ return numStages;			}
+	inline Stage const& getStage(const int index) const throw()	{ return stages[index];		}
+	
+	enum Constants
+	{
+		MinimumHeadSize = 32,
+		MaximumHeadSize = 128,
+		MaximumPartitionSize = 16384,
+		PartitionsPerStage = 4,
+		MinimumBackgroundPartitionSize = 1024,
+		BackgroundBlocksPerPartition = 4
+	};
+	
+private:
+	const int length;
+	const int headSize;
+	float* head;
+	int numStages;
+	Stage* stages;
+	
+	PartitionedImpulse (const PartitionedImpulse&);
+	const PartitionedImpulse& operator= (const PartitionedImpulse&);
+};
+
+class PartitionedConvolverStage;
+
+/** Zero latency convolution of a single channel with a PartitionedImpulse.
+ 
+ The head is convolved directly and each stage uses uniformly partitioned overlap-save 
+ convolution with a frequency domain delay line, all the multiply-accumulates use the SIMD 
+ kernels. Stages marked as background are computed on a shared pool of BackgroundThread workers 
+ in the time it takes to play two of their partitions. If a worker hasn't started a stage by 
+ then the audio thread computes it itself (and only waits if a worker is still computing it), 
+ so the output is always the same just the cost moves. 
+ 
+ process() may be called with any number of samples. */
+class PartitionedConvolver
+{
+public:
+	PartitionedConvolver(PartitionedImpulse* impulse) throw();
+	~PartitionedConvolver();
+	
+	/** Convolve the next numSamples of the input. The output may be the same array as the input. */
+	void process(const float* input, float* output, const int numSamples) throw();
+	
+	/** Set the number of threads the background stages of all convolvers share.
+	 The default is one less than the number of processors (but at least one). If this is 0
+	 the background stages are computed on the audio thread when their output is needed 
+	 (e.g., to render offline deterministically). Call this from the main thread. */
+	static void setNumBackgroundThreads(const int numThreads) throw();
+	static int getNumBackgroundThreads() throw();
+	
+private:
+	PartitionedImpulse* impulse;
+	const int headSize;
+	const int inputRingSize;
+	float* inputRing;
+	float* headHistory;
+	int position;
+	int numStages;
+	PartitionedConvolverStage** stages;
+	
+	PartitionedConvolver (const PartitionedConvolver&);
+	const PartitionedConvolver& operator= (const PartitionedConvolver&);
+};
+
+
+
+#endif // _UGEN_ugen_PartitionedConvolver_H_
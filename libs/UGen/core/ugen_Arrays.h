@@ -51,6 +51,7 @@ class ObjectArrayInternal : public SmartPointer
 public:	
 	ObjectArrayInternal(const int size, const bool isNullTerminated)
 	:	size_(size <= 0 ? 0 : size), 
+		capacity_(size_),
 		array(size_ == 0 ? 0 : new ObjectType[size_]),
 		arrayIsNullTerminated(isNullTerminated),
 		ownsTheData(true)
@@ -59,6 +60,7 @@ public:
 	
 	ObjectArrayInternal(const int size, ObjectType *dataToUse, const bool isNullTerminated)
 	:	size_(size <= 0 ? 0 : size), 
+		capacity_(size_),
 		array(size_ == 0 ? 0 : dataToUse),
 		arrayIsNullTerminated(isNullTerminated),
 		ownsTheData(size_ == 0 ? true : false)
@@ -80,93 +82,122 @@ public:
 			return arrayIsNullTerminated ? size_ - 1 : size_; 
 	}
 	
+	inline int capacity() const throw() { return capacity_; }
+	
 	inline ObjectType* getArray() throw() { return array; }
 	inline const ObjectType* getArray() const throw() { return array; }
 	inline bool isNullTerminated() const throw() { return arrayIsNullTerminated; }
 	inline void setNullTerminated(const bool state) throw() { arrayIsNullTerminated = state; } 
 	
+	/** Allocate storage for at least this many elements so the array can grow to that size 
+	 without allocating. Wrapped data is always copied into storage owned by the array. */
+	inline void reserve(const int capacity) throw()
+	{
+		if(capacity > capacity_ || ownsTheData == false)
+			reallocate(capacity > size_ ? capacity : size_);
+	}
+	
+	/** Free any storage beyond the current size. */
+	inline void shrinkToFit() throw()
+	{
+		if(capacity_ > size_)
+			reallocate(size_);
+	}
+	
 	inline void add(ObjectType const& item) throw()
 	{
-		const int newSize = size_ + 1;
-		ObjectType *newArray = new ObjectType[newSize];
-		
-		if(arrayIsNullTerminated)
+		if(size_ == capacity_ || ownsTheData == false)
 		{
-			const int length = size_ - 1;
-			
-			newArray[size_] = array[length];
-			newArray[length] = item;
-			
-			for(int i = 0; i < length; i++)
-			{
-				newArray[i] = array[i];
-			}
+			// copy the item first in case it is in the storage being replaced
+			const ObjectType copy = item;
+			reallocate(size_ < 2 ? 4 : size_ * 2);
+			addInPlace(copy);
 		}
 		else
 		{
-			const int length = size_;
-			newArray[size_] = item;
-			
-			for(int i = 0; i < length; i++)
-			{
-				newArray[i] = array[i];
-			}
+			addInPlace(item);
 		}
-		
-		if(ownsTheData)
-			delete [] array;
-		
-		ownsTheData = true;
-		
-		size_ = newSize;
-		array = newArray;
 	}
 		
 	inline void remove(const int index) throw()
 	{		
 		if(index < 0 || index >= size_) return;
 		
-		if(size_ == 1)
-		{
-			if(ownsTheData)
-			{
-				delete [] array;
-				array = 0;
-			}
-			
-			size_ = 0;
-		}
-		else
+		if(ownsTheData == false)
+			reallocate(size_);
+		
+		const int newSize = size_ - 1;
+		
+		for(int i = index; i < newSize; i++)
 		{
-			const int newSize = size_ - 1;
-			ObjectType *newArray = new ObjectType[newSize];
-			
-			for(int i = 0; i < index; i++)
-			{
-				newArray[i] = array[i];
-			}
-			
-			for(int i = index; i < newSize; i++)
-			{
-				newArray[i] = array[i+1];
-			}
-			
-			if(ownsTheData)
-				delete [] array;
-			
-			ownsTheData = true;
-			
-			size_ = newSize;
-			array = newArray;
+			array[i] = array[i+1];
 		}
+		
+		array[newSize] = ObjectType();
+		size_ = newSize;
+	}
+	
+	/** Remove an item by moving the last item (before any null terminator) into its place. */
+	inline void removeSwap(const int index) throw()
+	{
+		const int last = length() - 1;
+		
+		if(index < 0 || index > last) return;
+		
+		if(ownsTheData == false)
+			reallocate(size_);
+		
+		const int newSize = size_ - 1;
+		
+		array[index] = array[last];
+		array[last] = array[newSize]; // the null terminator, if there is one
+		array[newSize] = ObjectType();
+		size_ = newSize;
 	}
 	
 private:
 	int size_;
+	int capacity_;
 	ObjectType *array;
 	bool arrayIsNullTerminated : 1;
 	bool ownsTheData : 1;
-
+	
+	inline void addInPlace(ObjectType const& item) throw()
+	{
+		ugen_assert(size_ < capacity_);
+		
+		if(arrayIsNullTerminated && size_ > 0)
+		{
+			array[size_] = array[size_ - 1];
+			array[size_ - 1] = item;
+		}
+		else
+		{
+			array[size_] = item;
+		}
+		
+		size_++;
+	}
+	
+	void reallocate(const int newCapacity) throw()
+	{
+		ugen_assert(newCapacity >= size_);
+		
+		ObjectType *newArray = newCapacity == 0 ? 0 : new ObjectType[newCapacity];
+		
+		for(int i = 0; i < size_; i++)
+		{
+			newArray[i] = array[i];
+		}
+		
+		if(ownsTheData)
+			delete [] array;
+		
+		ownsTheData = true;
+		
+		capacity_ = newCapacity;
+		array = newArray;
+	}
 	
 	ObjectArrayInternal();
 	ObjectArrayInternal (const ObjectArrayInternal&);
@@ -719,7 +750,27 @@ public:
 	
 	ObjectArrayConcatOperatorsDefine(ObjectArray, ObjectType);
 	
-	/** Adds an item in-place. */
+	/** The number of elements there is storage for, the array can grow to this size without allocating. */
+	inline int capacity() const throw() { return this->getInternal()->capacity(); }
+	
+	/** Allocate storage for at least this many elements (including the null terminator if there is one). 
+	 Use this before the array is used on the audio thread so adding items there doesn't allocate. */
+	ObjectArray<ObjectType>& reserve(const int capacity) throw()
+	{
+		this->getInternal()->reserve(capacity);
+		return *this;
+	}
+	
+	/** Free any storage beyond the current size. */
+	ObjectArray<ObjectType>& shrinkToFit() throw()
+	{
+		this->getInternal()->shrinkToFit();
+		return *this;
+	}
+	
+	/** Adds an item in-place. 
+	 The storage grows geometrically so adding N items one at a time is O(N) overall, it is only
+	 reallocated when the capacity is used up. */
 	ObjectArray<ObjectType>& add(ObjectType const& item) throw()
 	{ 
 		this->getInternal()->add(item); 
@@ -746,6 +797,14 @@ public:
 		return *this;
 	}
 	
+	/** Removes an item at the given index in-place by moving the last item into its place.
+	 This is O(1) but doesn't keep the order of the items. Indices out of range will be ignored. */
+	ObjectArray<ObjectType>& removeSwap(const int index) throw()
+	{ 
+		this->getInternal()->removeSwap(index); 
+		return *this;
+	}
+	
 	/** Places an item at the given index. 
 	 Indices out of range will be ignored. */
 	ObjectArray<ObjectType>& put(const int index, ObjectType const& item) throw()
@@ -0,0 +1,119 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_ATOMIC_H
+#define UGEN_ATOMIC_H
+
+/** @name Atomic operations
+ 
+ Minimal atomic integer and pointer operations for sharing counters and indices
+ between an audio thread and other threads without taking a lock. These use the 
+ compiler intrinsics so they are available on all GCC/Clang targets (Mac, iPhone, 
+ Linux, Android) and MSVC. Each operation acts as a full memory barrier. */
+/// @{
+
+#if defined(_MSC_VER)
+
+/** Increment an int and return the new value. */
+inline int atomicIncrement(volatile int& value) throw()											{ return (int)_InterlockedIncrement((volatile long*)&value);						}
+/** Decrement an int and return the new value. */
+inline int atomicDecrement(volatile int& value) throw()											{ return (int)_InterlockedDecrement((volatile long*)&value);						}
+/** Add to an int and return the new value. */
+inline int atomicAdd(volatile int& value, const int amount) throw()								{ return (int)_InterlockedExchangeAdd((volatile long*)&value, amount) + amount;	}
+/** Set an int to newValue only if it currently equals oldValue. @return true if the swap took place. */
+inline bool atomicCompareAndSwap(volatile int& value, const int oldValue, const int newValue) throw()	
+{ 
+	return _InterlockedCompareExchange((volatile long*)&value, newValue, oldValue) == oldValue;	
+}
+/** Set a pointer to newValue only if it currently equals oldValue. @return true if the swap took place. */
+inline bool atomicCompareAndSwapPtr(void* volatile& value, void* oldValue, void* newValue) throw()	
+{ 
+	return _InterlockedCompareExchangePointer(&value, newValue, oldValue) == oldValue;	
+}
+/** Issue a full memory barrier. */
+inline void atomicMemoryBarrier() throw()															{ long barrier = 0; _InterlockedExchange(&barrier, 0);	}
+/** Tell the processor this is a spin-wait loop (so it saves power and doesn't starve a hyper-thread). */
+#if defined(_M_IX86) || defined(_M_X64)
+inline void atomicPause() throw()																	{ _mm_pause();											}
+#else
+inline void atomicPause() throw()																	{ }
+#endif
+
+#else
+
+/** Increment an int and return the new value. */
+inline int atomicIncrement(volatile int& value) throw()											{ return __sync_add_and_fetch(&value, 1);					}
+/** Decrement an int and return the new value. */
+inline int atomicDecrement(volatile int& value) throw()											{ return __sync_sub_and_fetch(&value, 1);					}
+/** Add to an int and return the new value. */
+inline int atomicAdd(volatile int& value, const int amount) throw()								{ return __sync_add_and_fetch(&value, amount);				}
+/** Set an int to newValue only if it currently equals oldValue. @return true if the swap took place. */
+inline bool atomicCompareAndSwap(volatile int& value, const int oldValue, const int newValue) throw()	
+{ 
+	return __sync_bool_compare_and_swap(&value, oldValue, newValue);	
+}
+/** Set a pointer to newValue only if it currently equals oldValue. @return true if the swap took place. */
+inline bool atomicCompareAndSwapPtr(void* volatile& value, void* oldValue, void* newValue) throw()	
+{ 
+	return __sync_bool_compare_and_swap(&value, oldValue, newValue);	
+}
+/** Issue a full memory barrier. */
+inline void atomicMemoryBarrier() throw()															{ __sync_synchronize();										}
+/** Tell the processor this is a spin-wait loop (so it saves power and doesn't starve a hyper-thread). */
+#if defined(__i386__) || defined(__x86_64__)
+inline void atomicPause() throw()																	{ __asm__ __volatile__ ("pause");							}
+#elif defined(__aarch64__) || defined(__ARM_ARCH_7A__)
+inline void atomicPause() throw()																	{ __asm__ __volatile__ ("yield");							}
+#else
+inline void atomicPause() throw()																	{ }
+#endif
+
+#endif
+
+/** Read an int written by another thread, reads after this see everything written before the matching atomicSet(). */
+inline int atomicGet(volatile int const& value) throw()											{ const int result = value; atomicMemoryBarrier(); return result; }
+/** Write an int which will be read by another thread, writes before this are visible before the new value. */
+inline void atomicSet(volatile int& value, const int newValue) throw()							{ atomicMemoryBarrier(); value = newValue;					}
+/** Read a pointer written by another thread, as atomicGet(). */
+inline void* atomicGetPtr(void* volatile const& value) throw()									{ void* const result = value; atomicMemoryBarrier(); return result; }
+/** Write a pointer which will be read by another thread, as atomicSet(). */
+inline void atomicSetPtr(void* volatile& value, void* newValue) throw()							{ atomicMemoryBarrier(); value = newValue;					}
+
+/// @} <!-- end Atomic operations -->
+
+
+#endif // UGEN_ATOMIC_H
@@ -0,0 +1,120 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_BackgroundDeleter.h"
+#include "ugen_SmartPointer.h"
+
+BackgroundDeleter::BackgroundDeleter(const int intervalMillisToUse) throw()
+:	intervalMillis(intervalMillisToUse < 1 ? 1 : intervalMillisToUse),
+	pendingHead(0),
+	numPending(0),
+	numDeleted(0)
+{
+	startThread();
+}
+
+BackgroundDeleter::~BackgroundDeleter() throw()
+{
+	stopThread();
+	flush();
+}
+
+void BackgroundDeleter::deleteInternal(SmartPointer* internalToDelete) throw()
+{
+	atomicIncrement(numPending);
+	
+	void* head;
+	
+	do
+	{
+		head = pendingHead;
+		internalToDelete->nextToDelete = (SmartPointer*)head;
+	}
+	while(!atomicCompareAndSwapPtr(pendingHead, head, internalToDelete));
+}
+
+int BackgroundDeleter::deletePending() throw()
+{
+	// take the whole list at once, so there is no ABA problem even with several deleting threads
+	void* head;
+	
+	do
+	{
+		head = pendingHead;
+	}
+	while(head != 0 && !atomicCompareAndSwapPtr(pendingHead, head, 0));
+	
+	SmartPointer* internalToDelete = (SmartPointer*)head;
+	int count = 0;
+	
+	while(internalToDelete != 0)
+	{
+		SmartPointer* next = internalToDelete->nextToDelete;
+		delete internalToDelete;
+		internalToDelete = next;
+		count++;
+	}
+	
+	if(count > 0)
+	{
+		atomicAdd(numPending, -count);
+		atomicAdd(numDeleted, count);
+	}
+	
+	return count;
+}
+
+void BackgroundDeleter::run()
+{
+	while(!threadShouldExit())
+	{
+		if(deletePending() == 0)
+			sleep(intervalMillis);
+	}
+}
+
+void BackgroundDeleter::flush() throw()
+{
+	while(deletePending() > 0) { }
+}
+
+
+END_UGEN_NAMESPACE
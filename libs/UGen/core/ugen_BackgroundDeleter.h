@@ -0,0 +1,95 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_BACKGROUNDDELETER_H
+#define UGEN_BACKGROUNDDELETER_H
+
+#include "ugen_Deleter.h"
+#include "ugen_Thread.h"
+
+/** Deletes SmartPointer objects on a low priority background thread.
+ 
+ This is the non-Juce equivalent of JuceTimerDeleter. deleteInternal() pushes the
+ object onto a lock-free list (it never allocates or blocks so it is safe to call
+ on the audio thread, or several threads at once) and a BackgroundThread deletes
+ everything on the list every few milliseconds. Deleting an object often releases
+ others (e.g., the inputs of a UGenInternal), these are simply added to the list
+ again and deleted on the next pass.
+ 
+ @code
+ BackgroundDeleter deleter;
+ UGen::setDeleter(&deleter);
+ // ...
+ UGen::shutdown(); // flushes the deleter and restores the default Deleter
+ @endcode
+ 
+ @see UGen::setDeleter(), JuceTimerDeleter */
+class BackgroundDeleter :	public Deleter,
+							public BackgroundThread
+{
+public:
+	/** Create and start the deleter.
+	 @param intervalMillis	How often the background thread checks for objects to delete. */
+	BackgroundDeleter(const int intervalMillis = 5) throw();
+	~BackgroundDeleter() throw();
+	
+	/** Adds an item to the list to be deleted on the background thread.
+	 @param internalToDelete The item to be deleted. */
+	void deleteInternal(SmartPointer* internalToDelete) throw();
+	
+	/** Deletes all of the pending items now on the calling thread.
+	 This is useful during shutdown for example. */
+	void flush() throw();
+	
+	/** @return The number of items waiting to be deleted. */
+	int getNumPending() const throw()	{ return atomicGet(numPending);		}
+	
+	/** @return The total number of items this deleter has deleted. */
+	int getNumDeleted() const throw()	{ return atomicGet(numDeleted);		}
+	
+private:
+	void run();
+	int deletePending() throw();
+	
+	const int intervalMillis;
+	void* volatile pendingHead;
+	volatile int numPending;
+	volatile int numDeleted;
+};
+
+
+#endif // UGEN_BACKGROUNDDELETER_H
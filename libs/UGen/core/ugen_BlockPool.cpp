@@ -0,0 +1,543 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_BlockPool.h"
+#include "ugen_UGen.h"
+#include "ugen_Thread.h"
+
+const int BlockPool::HeaderSize = (sizeof(BlockPool::Header) + BlockPool::Alignment - 1) & ~(BlockPool::Alignment - 1);
+
+/** Grows the pool and frees retired memory off the audio thread. */
+class BlockPool::Grower : public BackgroundThread
+{
+public:
+	Grower(BlockPool& poolToGrow) throw() : pool(poolToGrow) { }
+	~Grower() { stopThread(); }
+	
+private:
+	void run()
+	{
+		while(!threadShouldExit())
+		{
+			pool.grow();
+			sleep(GrowIntervalMillis);
+		}
+	}
+	
+	BlockPool& pool;
+};
+
+BlockPool& BlockPool::getInstance() throw()
+{
+	// never deleted since static UGen objects may free their blocks during static destruction
+	static BlockPool* instance = new BlockPool();
+	return *instance;
+}
+
+BlockPool::BlockPool() throw()
+:	freeList(0),
+	chunks(0),
+	retiredChunks(0),
+	retiredOversizeBlocks(0),
+	fallback(0),
+	fallbackSize(0),
+	grower(0),
+	growing(0),
+	requestedBlockSize(0),
+	spinLock(0),
+	blockSize(UGen::getEstimatedBlockSize()),
+	numBlocks(0),
+	numFreeBlocks(0),
+	numBlocksInUse(0),
+	highWaterMark(0),
+	numGrowths(0),
+	numOversizeBlocks(0),
+	numFallbacks(0)
+{
+}
+
+void BlockPool::lock() throw()
+{
+	// the lock is only held for a few pointer assignments so spin a little before yielding
+	for(int spins = 0; !atomicCompareAndSwap(spinLock, 0, 1); spins++)
+	{
+		if(spins < 64)
+			atomicPause();
+		else
+			BackgroundThread::sleep(0);
+	}
+}
+
+BlockPool::Chunk* BlockPool::createChunk(const int numBlocksInChunk, const int capacity) throw()
+{
+	ugen_assert(numBlocksInChunk > 0);
+	
+	// called without the lock, the blocks are linked ready to be spliced into the free list
+	const int offset = roundUp(sizeof(Chunk));
+	const int stride = HeaderSize + capacity * sizeof(float);
+	
+	char* allocation = (char*)malloc(offset + stride * numBlocksInChunk + Alignment);
+	
+	if(allocation == 0) return 0;
+	
+	Chunk* chunk = (Chunk*)allocation;
+	char* aligned = (char*)(((size_t)allocation + offset + Alignment - 1) & ~(size_t)(Alignment - 1));
+	Header* next = 0;
+	
+	for(int i = numBlocksInChunk - 1; i >= 0; i--)
+	{
+		Header* header = (Header*)(aligned + i * stride);
+		header->next = next;
+		header->allocation = chunk;
+		header->capacity = capacity;
+		header->pooled = 1;
+		next = header;
+	}
+	
+	chunk->next = 0;
+	chunk->firstBlock = next;
+	chunk->lastBlock = (Header*)(aligned + (numBlocksInChunk - 1) * stride);
+	chunk->capacity = capacity;
+	chunk->numBlocks = numBlocksInChunk;
+	chunk->numBlocksInUse = 0;
+	chunk->retired = 0;
+	
+	return chunk;
+}
+
+void BlockPool::freeChunks(Chunk* chunk) throw()
+{
+	// called without the lock
+	while(chunk != 0)
+	{
+		Chunk* next = chunk->next;
+		::free(chunk);
+		chunk = next;
+	}
+}
+
+BlockPool::Header* BlockPool::createOversizeBlock(const int minimumSize) throw()
+{
+	const int capacity = getPooledCapacity(minimumSize);
+	void* allocation = malloc(HeaderSize + capacity * sizeof(float) + Alignment);
+	
+	if(allocation == 0) return 0;
+	
+	Header* header = (Header*)(((size_t)allocation + Alignment - 1) & ~(size_t)(Alignment - 1));
+	header->next = 0;
+	header->allocation = allocation;
+	header->capacity = capacity;
+	header->pooled = 0;
+	
+	return header;
+}
+
+void BlockPool::freeOversizeBlocks(Header* header) throw()
+{
+	// called without the lock
+	while(header != 0)
+	{
+		Header* next = header->next;
+		::free(header->allocation);
+		header = next;
+	}
+}
+
+void BlockPool::insertChunk(Chunk* chunk) throw()
+{
+	// called with the lock held
+	chunk->lastBlock->next = freeList;
+	freeList = chunk->firstBlock;
+	
+	chunk->next = chunks;
+	chunks = chunk;
+	
+	atomicAdd(numBlocks, chunk->numBlocks);
+	atomicAdd(numFreeBlocks, chunk->numBlocks);
+}
+
+BlockPool::Header* BlockPool::popFreeBlock() throw()
+{
+	// called with the lock held
+	Header* header = freeList;
+	
+	if(header != 0)
+	{
+		freeList = header->next;
+		((Chunk*)header->allocation)->numBlocksInUse++;
+		atomicDecrement(numFreeBlocks);
+	}
+	
+	return header;
+}
+
+void BlockPool::addBlocks(const int numBlocksToAdd) throw()
+{
+	// allocate without holding the lock so other threads don't spin while malloc runs
+	Chunk* chunk = createChunk(numBlocksToAdd, getPooledCapacity(getBlockSize()));
+	
+	if(chunk == 0) return;
+	
+	Chunk* unused = 0;
+	
+	lock();
+	
+	// prepare() may have increased the block size in the meantime
+	if(chunk->capacity >= blockSize)
+		insertChunk(chunk);
+	else
+		unused = chunk;
+	
+	unlock();
+	
+	freeChunks(unused);
+}
+
+float* BlockPool::getFallback(const int minimumSize, int& allocatedSize) throw()
+{
+	atomicIncrement(numFallbacks);
+	
+	// a size of 0 makes UGenOutput ask again on its next block
+	allocatedSize = 0;
+	
+	if(minimumSize > fallbackSize)
+	{
+		ugen_assertfalse;
+		return 0;
+	}
+	
+	return fallback;
+}
+
+float* BlockPool::allocate(const int minimumSize, int& allocatedSize) throw()
+{
+	ugen_assert(minimumSize > 0);
+	
+	const bool realTime = atomicGet(growing) != 0 && BackgroundThread::isAudioThread();
+	
+	if(minimumSize > blockSize)
+	{
+		if(realTime)
+		{
+			// the host's blocks are larger than its estimate, have the grower increase the block size
+			int requested;
+			
+			do
+			{
+				requested = requestedBlockSize;
+			}
+			while(minimumSize > requested && !atomicCompareAndSwap(requestedBlockSize, requested, minimumSize));
+			
+			return getFallback(minimumSize, allocatedSize);
+		}
+		
+		Header* header = createOversizeBlock(minimumSize);
+		
+		if(header == 0)
+		{
+			allocatedSize = 0;
+			return 0;
+		}
+		
+		atomicIncrement(numOversizeBlocks);
+		allocatedSize = header->capacity;
+		return getBlock(header);
+	}
+	
+	lock();
+	Header* header = popFreeBlock();
+	unlock();
+	
+	if(header == 0 && realTime)
+		return getFallback(minimumSize, allocatedSize);
+	
+	while(header == 0)
+	{
+		// not the audio thread (or not prepared yet) so it's safe to grow here
+		const int numBlocksBefore = getNumBlocks();
+		
+		atomicIncrement(numGrowths);
+		addBlocks(ChunkNumBlocks);
+		
+		lock();
+		header = popFreeBlock();
+		unlock();
+		
+		if(header == 0 && getNumBlocks() == numBlocksBefore) break;
+	}
+	
+	if(header == 0)
+	{
+		allocatedSize = 0;
+		return 0;
+	}
+	
+	const int inUse = atomicIncrement(numBlocksInUse);
+	int mark;
+	
+	do
+	{
+		mark = highWaterMark;
+	}
+	while(inUse > mark && !atomicCompareAndSwap(highWaterMark, mark, inUse));
+	
+	header->next = 0;
+	allocatedSize = header->capacity;
+	return getBlock(header);
+}
+
+void BlockPool::free(float* block) throw()
+{
+	if(block == 0 || block == fallback) return;
+	
+	const bool realTime = atomicGet(growing) != 0 && BackgroundThread::isAudioThread();
+	Header* header = getHeader(block);
+	
+	if(header->pooled == 0)
+	{
+		atomicDecrement(numOversizeBlocks);
+		
+		if(realTime)
+		{
+			// the grower frees it
+			lock();
+			header->next = retiredOversizeBlocks;
+			retiredOversizeBlocks = header;
+			unlock();
+		}
+		else
+		{
+			::free(header->allocation);
+		}
+		
+		return;
+	}
+	
+	atomicDecrement(numBlocksInUse);
+	
+	Chunk* chunk = (Chunk*)header->allocation;
+	Chunk* unused = 0;
+	
+	lock();
+	
+	chunk->numBlocksInUse--;
+	
+	if(chunk->retired == 0)
+	{
+		header->next = freeList;
+		freeList = header;
+		atomicIncrement(numFreeBlocks);
+	}
+	else if(chunk->numBlocksInUse == 0)
+	{
+		// the last block of a chunk from before the block size increased
+		if(realTime)
+		{
+			chunk->next = retiredChunks;
+			retiredChunks = chunk;
+		}
+		else
+		{
+			unused = chunk;
+		}
+	}
+	
+	unlock();
+	
+	freeChunks(unused);
+}
+
+void BlockPool::resize(const int newBlockSize) throw()
+{
+	Chunk* unused = 0;
+	
+	lock();
+	
+	if(newBlockSize > blockSize)
+	{
+		// drop the free blocks which are now too small
+		Header** link = &freeList;
+		
+		while(*link != 0)
+		{
+			Header* header = *link;
+			
+			if(header->capacity < newBlockSize)
+			{
+				*link = header->next;
+				atomicDecrement(numFreeBlocks);
+			}
+			else
+			{
+				link = &header->next;
+			}
+		}
+		
+		// retire their chunks, those with blocks still in use are freed when the last one is returned
+		Chunk** chunkLink = &chunks;
+		
+		while(*chunkLink != 0)
+		{
+			Chunk* chunk = *chunkLink;
+			
+			if(chunk->capacity < newBlockSize)
+			{
+				*chunkLink = chunk->next;
+				chunk->retired = 1;
+				atomicAdd(numBlocks, -chunk->numBlocks);
+				
+				if(chunk->numBlocksInUse == 0)
+				{
+					chunk->next = unused;
+					unused = chunk;
+				}
+				else
+				{
+					chunk->next = 0;
+				}
+			}
+			else
+			{
+				chunkLink = &chunk->next;
+			}
+		}
+	}
+	
+	// larger blocks already in the pool can still be used if the size decreases
+	atomicSet(blockSize, newBlockSize);
+	
+	unlock();
+	
+	freeChunks(unused);
+}
+
+void BlockPool::prepare(const int newBlockSize, const int numBlocksToReserve) throw()
+{
+	ugen_assert(newBlockSize > 0);
+	
+	resize(newBlockSize);
+	
+	atomicSet(numGrowths, 0);
+	atomicSet(requestedBlockSize, 0);
+	
+	const int newFallbackSize = newBlockSize > FallbackBlockSize ? newBlockSize : (int)FallbackBlockSize;
+	
+	if(newFallbackSize > fallbackSize)
+	{
+		// nothing should be rendering yet so nothing is using the old one
+		if(fallback != 0)
+			::free(getHeader(fallback)->allocation);
+		
+		Header* header = createOversizeBlock(newFallbackSize);
+		fallback = header == 0 ? 0 : getBlock(header);
+		fallbackSize = header == 0 ? 0 : header->capacity;
+	}
+	
+	reserve(numBlocksToReserve);
+	
+	if(grower == 0)
+		grower = new Grower(*this);
+	
+	if(grower->startThread())
+		atomicSet(growing, 1);
+}
+
+void BlockPool::reserve(const int numBlocksToReserve) throw()
+{
+	const int numBlocksNeeded = numBlocksToReserve - getNumBlocks();
+	
+	if(numBlocksNeeded > 0)
+		addBlocks(numBlocksNeeded);
+}
+
+void BlockPool::stopGrowing() throw()
+{
+	atomicSet(growing, 0);
+	
+	if(grower != 0)
+		grower->stopThread();
+	
+	freeRetired();
+}
+
+void BlockPool::freeRetired() throw()
+{
+	lock();
+	Chunk* unusedChunks = retiredChunks;
+	Header* unusedOversizeBlocks = retiredOversizeBlocks;
+	retiredChunks = 0;
+	retiredOversizeBlocks = 0;
+	unlock();
+	
+	freeChunks(unusedChunks);
+	freeOversizeBlocks(unusedOversizeBlocks);
+}
+
+void BlockPool::grow() throw()
+{
+	// called on the grower thread
+	freeRetired();
+	
+	const int requested = atomicGet(requestedBlockSize);
+	
+	if(requested > getBlockSize() && requested <= fallbackSize)
+	{
+		// the blocks in use will each be asked for again at the new size
+		resize(requested);
+		atomicIncrement(numGrowths);
+		addBlocks(getNumBlocksInUse() + LowWaterNumBlocks);
+	}
+	
+	if(atomicGet(numFreeBlocks) < LowWaterNumBlocks)
+	{
+		atomicIncrement(numGrowths);
+		addBlocks(ChunkNumBlocks);
+	}
+}
+
+void BlockPool::report() const throw()
+{
+	printf("UGen++ BlockPool: block size %d, %d blocks (%d in use, high water mark %d), %d growths, %d oversize blocks, %d fallbacks\n",
+		   getBlockSize(), getNumBlocks(), getNumBlocksInUse(), getHighWaterMark(), getNumGrowths(), getNumOversizeBlocks(), getNumFallbacks());
+}
+
+
+END_UGEN_NAMESPACE
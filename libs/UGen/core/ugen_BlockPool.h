@@ -0,0 +1,194 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_BLOCKPOOL_H
+#define UGEN_BLOCKPOOL_H
+
+#include "ugen_Atomic.h"
+
+/** A pool of aligned sample blocks for UGenOutput.
+ 
+ Blocks of the pool's block size are carved out of large chunks and recycled
+ through a free list when a UGenInternal is deleted, so they stay close together
+ in memory. UGen::prepareToPlay() sets the block size from estimatedSamplesPerBlock, 
+ reserves the initial blocks and starts a low priority thread which keeps at least 
+ LowWaterNumBlocks free blocks in the pool.
+ 
+ Once that thread is running allocate() never calls the system allocator on a thread
+ marked with BackgroundThread::setAudioThread() (it may be called there, e.g., by Spawn 
+ creating voices). If the free list is empty, or the block needed is larger than the 
+ block size, it returns a shared fallback block with an allocatedSize of 0 so UGenOutput 
+ asks again on its next block, by which time the thread has grown the pool (or increased 
+ the block size). getNumFallbacks() counts these, a non-zero count means prepare() or 
+ reserve() should be given larger numbers. Memory returned on the audio thread which must 
+ go back to the system is freed by the same thread. Other threads grow the pool themselves.
+ 
+ All blocks are aligned to Alignment bytes. allocate() and free() may be called
+ from any thread, the free list is guarded by a spin lock held only for a couple
+ of pointer assignments. */
+class BlockPool
+{
+public:
+	enum Constants
+	{
+		Alignment = 64,
+		DefaultNumBlocks = 256,
+		ChunkNumBlocks = 64,
+		LowWaterNumBlocks = 64,
+		FallbackBlockSize = 8192,
+		GrowIntervalMillis = 2
+	};
+	
+	/** Get the shared pool. */
+	static BlockPool& getInstance() throw();
+	
+	/** Get a block of at least minimumSize samples.
+	 @param minimumSize		The number of samples needed.
+	 @param allocatedSize	Is set to the actual capacity of the block, which may be larger.
+	 @return				The block, aligned to Alignment bytes. This is the fallback block
+							(and allocatedSize is 0) if the pool could not supply one
+							without calling the system allocator. */
+	float* allocate(const int minimumSize, int& allocatedSize) throw();
+	
+	/** Return a block obtained from allocate(). */
+	void free(float* block) throw();
+	
+	/** Set the block size and make sure at least numBlocks are available.
+	 If the size increases, blocks at the old size are no longer recycled and their 
+	 chunks are freed when the last of their blocks is returned. This also starts the
+	 thread which grows the pool, so it should be called before rendering starts. */
+	void prepare(const int blockSize, const int numBlocks = DefaultNumBlocks) throw();
+	
+	/** Make sure at least numBlocks blocks have been allocated. */
+	void reserve(const int numBlocks) throw();
+	
+	/** Stop the thread started by prepare(), the pool grows on the calling thread again. */
+	void stopGrowing() throw();
+	
+	/// @name Statistics
+	/// @{
+	
+	inline int getBlockSize() const throw()				{ return atomicGet(blockSize);			}
+	inline int getNumBlocks() const throw()				{ return atomicGet(numBlocks);			}
+	inline int getNumBlocksInUse() const throw()		{ return atomicGet(numBlocksInUse);		}
+	/** The largest number of pooled blocks that have been in use at the same time. */
+	inline int getHighWaterMark() const throw()			{ return atomicGet(highWaterMark);		}
+	inline void resetHighWaterMark() throw()			{ atomicSet(highWaterMark, getNumBlocksInUse()); }
+	/** The number of times the pool has had to grow since it was last prepared. */
+	inline int getNumGrowths() const throw()			{ return atomicGet(numGrowths);			}
+	/** The number of blocks too large for the pool currently allocated separately. */
+	inline int getNumOversizeBlocks() const throw()		{ return atomicGet(numOversizeBlocks);	}
+	/** The number of requests which have been given the fallback block. */
+	inline int getNumFallbacks() const throw()			{ return atomicGet(numFallbacks);		}
+	
+	/** Print the statistics above. */
+	void report() const throw();
+	
+	/// @}
+	
+private:
+	struct Header
+	{
+		Header* next;
+		void* allocation;
+		int capacity;
+		int pooled;
+	};
+	
+	/** The start of each allocation the pooled blocks are carved from, the counts are changed with the lock held. */
+	struct Chunk
+	{
+		Chunk* next;
+		Header* firstBlock;
+		Header* lastBlock;
+		int capacity;
+		int numBlocks;
+		int numBlocksInUse;
+		int retired;
+	};
+	
+	class Grower;
+	friend class Grower;
+	
+	BlockPool() throw();
+	
+	static Chunk* createChunk(const int numBlocksInChunk, const int capacity) throw();
+	static void freeChunks(Chunk* chunk) throw();
+	static Header* createOversizeBlock(const int minimumSize) throw();
+	static void freeOversizeBlocks(Header* header) throw();
+	void insertChunk(Chunk* chunk) throw();
+	void addBlocks(const int numBlocksToAdd) throw();
+	Header* popFreeBlock() throw();
+	void resize(const int newBlockSize) throw();
+	void freeRetired() throw();
+	void grow() throw();
+	float* getFallback(const int minimumSize, int& allocatedSize) throw();
+	void lock() throw();
+	inline void unlock() throw()						{ atomicSet(spinLock, 0);				}
+	
+	static inline float* getBlock(Header* header) throw()		{ return (float*)((char*)header + HeaderSize); }
+	static inline Header* getHeader(float* block) throw()		{ return (Header*)((char*)block - HeaderSize); }
+	static inline int roundUp(const int size) throw()			{ return (size + Alignment - 1) & ~(Alignment - 1); }
+	static inline int getPooledCapacity(const int size) throw()	{ return roundUp(size * sizeof(float)) / sizeof(float); }
+	
+	static const int HeaderSize;
+	
+	Header* freeList;
+	Chunk* chunks;
+	Chunk* retiredChunks;
+	Header* retiredOversizeBlocks;
+	float* fallback;
+	int fallbackSize;
+	Grower* grower;
+	volatile int growing;
+	volatile int requestedBlockSize;
+	volatile int spinLock;
+	volatile int blockSize;
+	volatile int numBlocks;
+	volatile int numFreeBlocks;
+	volatile int numBlocksInUse;
+	volatile int highWaterMark;
+	volatile int numGrowths;
+	volatile int numOversizeBlocks;
+	volatile int numFallbacks;
+	
+	BlockPool (const BlockPool&);
+	const BlockPool& operator= (const BlockPool&);
+};
+
+
+#endif // UGEN_BLOCKPOOL_H
@@ -43,16 +43,77 @@
 #include "ugen_Arrays.h"
 #include "ugen_Text.h"
 
+/** Hashes Dictionary keys. 
+ Key types without a specialisation aren't hashed and the Dictionary searches its keys in turn.
+ A specialisation must give equal hashes for keys which compare equal with operator==. */
+template<class KeyType>
+class DictionaryKeyHash
+{
+public:
+	enum { IsHashable = 0 };
+	static unsigned int hash(KeyType const& /*key*/) throw() { return 0; }
+};
+
+/** Text keys are hashed on their characters (FNV-1a). */
+template<>
+class DictionaryKeyHash<Text>
+{
+public:
+	enum { IsHashable = 1 };
+	
+	static unsigned int hash(Text const& key) throw()
+	{
+		const char* chars = key.getArray();
+		const int size = key.size();
+		unsigned int hash = 2166136261u;
+		
+		for(int i = 0; i < size; i++)
+		{
+			hash ^= (unsigned char)chars[i];
+			hash *= 16777619u;
+		}
+		
+		return hash;
+	}
+};
+
+#define DictionaryKeyHashIntegerDefine(Type)									\
+	template<>																	\
+	class DictionaryKeyHash<Type>												\
+	{																			\
+	public:																		\
+		enum { IsHashable = 1 };												\
+		static unsigned int hash(Type const& key) throw()						\
+		{																		\
+			unsigned int hash = (unsigned int)key * 2654435761u;				\
+			return hash ^ (hash >> 16);											\
+		}																		\
+	};
+
+DictionaryKeyHashIntegerDefine(char)
+DictionaryKeyHashIntegerDefine(unsigned char)
+DictionaryKeyHashIntegerDefine(short)
+DictionaryKeyHashIntegerDefine(unsigned short)
+DictionaryKeyHashIntegerDefine(int)
+DictionaryKeyHashIntegerDefine(unsigned int)
+
+/** Holds the keys and values of a Dictionary in the order they were added.
+ If the key type is hashable (see DictionaryKeyHash) there is also an open addressing hash
+ table (with linear probing) of indices into the arrays and the hash of each key is kept, so
+ looking up a key is O(1) rather than a search through the keys. */
 template<class ValueType, class KeyType = Text>
 class DictionaryInternal : public SmartPointer
 {
 public:
 	DictionaryInternal() throw()
+	:	slots(0),
+		numSlots(0)
 	{
 	}
 	
 	~DictionaryInternal() throw()
 	{
+		delete [] slots;
 	}
 	
 	ObjectArray<ValueType>& getValues() throw()
@@ -75,9 +136,100 @@ public:
 		return keys;
 	}
 	
+	/** The index of a key in the arrays or -1 if it isn't there. */
+	int indexOf(KeyType const& key) const throw()
+	{
+		if(DictionaryKeyHash<KeyType>::IsHashable == 0)
+			return keys.indexOf(key);
+		
+		if(numSlots == 0) 
+			return -1;
+		
+		const unsigned int hash = DictionaryKeyHash<KeyType>::hash(key);
+		const unsigned int mask = numSlots - 1;
+		
+		for(unsigned int slot = hash & mask; ; slot = (slot + 1) & mask)
+		{
+			const int entry = slots[slot];
+			
+			if(entry == 0) 
+				return -1;
+			
+			const int index = entry - 1;
+			
+			if(hashes[index] == hash && keys[index] == key)
+				return index;
+		}
+	}
+	
+	/** Add a key which isn't already in the dictionary. */
+	void add(KeyType const& key, ValueType const& value) throw()
+	{
+		keys.add(key);
+		values.add(value);
+		
+		if(DictionaryKeyHash<KeyType>::IsHashable == 0)
+			return;
+		
+		hashes.add(DictionaryKeyHash<KeyType>::hash(key));
+		
+		const int length = keys.length();
+		
+		if(length * 2 > numSlots)
+			rehash(numSlots < 8 ? 16 : numSlots * 2); // keep the table no more than half full
+		else
+			insert(length - 1);
+	}
+	
+	void remove(const int index) throw()
+	{
+		keys.remove(index);
+		values.remove(index);
+		
+		if(DictionaryKeyHash<KeyType>::IsHashable == 0)
+			return;
+		
+		hashes.remove(index);
+		rehash(numSlots); // the later indices have all moved down
+	}
+	
 private:
 	ObjectArray<ValueType> values;
 	ObjectArray<KeyType> keys;
+	ObjectArray<unsigned int> hashes;
+	int* slots; // index + 1 into the arrays or 0 for an empty slot
+	int numSlots;
+	
+	void insert(const int index) throw()
+	{
+		const unsigned int mask = numSlots - 1;
+		unsigned int slot = hashes[index] & mask;
+		
+		while(slots[slot] != 0)
+			slot = (slot + 1) & mask;
+		
+		slots[slot] = index + 1;
+	}
+	
+	void rehash(const int newNumSlots) throw()
+	{
+		if(newNumSlots != numSlots)
+		{
+			delete [] slots;
+			numSlots = newNumSlots;
+			slots = new int[numSlots];
+		}
+		
+		memset(slots, 0, numSlots * sizeof(int));
+		
+		const int length = keys.length();
+		
+		for(int i = 0; i < length; i++)
+			insert(i);
+	}
+	
+	DictionaryInternal (const DictionaryInternal&);
+	const DictionaryInternal& operator= (const DictionaryInternal&);
 };
 
 
@@ -105,7 +257,9 @@ private:
 
 /** A dictionary class for storing key/value pairs.
  Items are stored in an array and accessed via their key. By default the key is a Text string but
- can be any appropriate type. */
+ can be any appropriate type. Text and integer keys are found through a hash table, other 
+ key types are searched for in turn (see DictionaryKeyHash). The keys and values stay in
+ the order they were added. Don't change a key through key(), it won't be found again. */
 template<class ValueType, class KeyType = Text>
 class Dictionary : public SmartPointerContainer< DictionaryInternal<ValueType,KeyType> >
 {
@@ -160,20 +314,18 @@ public:
 	ValueType put(KeyType const& key, ValueType const& value) throw()
 	{
 		ObjectArray<ValueType>& values = this->getInternal()->getValues();
-		ObjectArray<KeyType>& keys = this->getInternal()->getKeys();
 
-		int index = keys.indexOf(key);
+		int index = this->getInternal()->indexOf(key);
 		
 		if(index >= 0)
 		{
-			ValueType& oldValue = values[index];
+			ValueType oldValue = values[index];
 			values.put(index, value);
 			return oldValue;
 		}
 		else
 		{
-			keys.add(key);
-			values.add(value);
+			this->getInternal()->add(key, value);
 			return ObjectArray<ValueType>::getNull();
 		}
 	}
@@ -196,10 +348,9 @@ public:
 	 If the key is not found then a "null" version of the value is returned. */
 	ValueType& at(KeyType const& key) throw()
 	{
-		ObjectArray<ValueType>& values = getValues();
-		ObjectArray<KeyType>& keys = getKeys();
+		ObjectArray<ValueType>& values = this->getInternal()->getValues();
 		
-		int index = keys.indexOf(key);
+		int index = this->getInternal()->indexOf(key);
 		return values[index];
 	}
 	
@@ -208,9 +359,8 @@ public:
 	const ValueType& at(KeyType const& key) const throw()
 	{
 		ObjectArray<ValueType> const& values = getValues();
-		ObjectArray<KeyType> const& keys = getKeys();
 		
-		int index = keys.indexOf(key);
+		int index = this->getInternal()->indexOf(key);
 		return values[index];
 	}
 	
@@ -219,9 +369,8 @@ public:
 	ValueType& operator[](KeyType const& key) throw()
 	{
 		ObjectArray<ValueType>& values = this->getInternal()->getValues();
-		ObjectArray<KeyType>& keys = this->getInternal()->getKeys();
 		
-		int index = keys.indexOf(key);
+		int index = this->getInternal()->indexOf(key);
 		return values[index];
 	}
 	
@@ -230,9 +379,8 @@ public:
 	const ValueType& operator[](KeyType const& key) const throw()
 	{
 		ObjectArray<ValueType> const& values = getValues();
-		ObjectArray<KeyType> const& keys = getKeys();
 		
-		int index = keys.indexOf(key);
+		int index = this->getInternal()->indexOf(key);
 		return values[index];
 	}
 	
@@ -241,15 +389,13 @@ public:
 	ValueType remove(KeyType const& key) throw()
 	{
 		ObjectArray<ValueType>& values = this->getInternal()->getValues();
-		ObjectArray<KeyType>& keys = this->getInternal()->getKeys();
 		
-		int index = keys.indexOf(key);
+		int index = this->getInternal()->indexOf(key);
 		
 		if(index >= 0)
 		{
 			ValueType removed = values[index];
-			keys.remove(index);
-			values.remove(index);
+			this->getInternal()->remove(index);
 			return removed;
 		}
 		else
@@ -271,13 +417,13 @@ public:
 	/** Get a key at a particular index. */
 	KeyType& key(const int index) throw()
 	{
-		return getKeys()[index];
+		return this->getInternal()->getKeys()[index];
 	}
 	
 	/** Get a value at a particular index. */
 	ValueType& value(const int index) throw()
 	{
-		return getValues()[index];
+		return this->getInternal()->getValues()[index];
 	}
 	
 	/** Get a key at a particular index. */
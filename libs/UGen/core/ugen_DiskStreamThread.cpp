@@ -0,0 +1,110 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+#include "ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_DiskStreamThread.h"
+
+DiskStreamThread::DiskStreamThread() throw()
+:	newStreams(MaximumNewStreams)
+{
+}
+
+DiskStreamThread::~DiskStreamThread()
+{
+	stopThread();
+	
+	// flush anything still waiting to be written, streams still in use are left to leak
+	DiskStream* stream;
+	while(newStreams.pop(stream))
+		streams.add(stream);
+	
+	serviceStreams();
+}
+
+DiskStreamThread& DiskStreamThread::getInstance() throw()
+{
+	static DiskStreamThread thread;
+	return thread;
+}
+
+void DiskStreamThread::add(DiskStream* stream) throw()
+{
+	ugen_assert(stream != 0);
+	
+	DiskStreamThread& thread = getInstance();
+	SpinLock::ScopedLock lock(thread.addLock); // the fifo takes one producer at a time
+	
+	while(!thread.newStreams.push(stream))
+		sleep(ServiceInterval);
+	
+	thread.startThread();
+}
+
+void DiskStreamThread::run()
+{
+	while(!threadShouldExit())
+	{
+		DiskStream* stream;
+		while(newStreams.pop(stream))
+			streams.add(stream);
+		
+		serviceStreams();
+		sleep(ServiceInterval);
+	}
+}
+
+void DiskStreamThread::serviceStreams() throw()
+{
+	for(int i = streams.length() - 1; i >= 0; i--)
+	{
+		DiskStream* stream = streams[i];
+		
+		// check this first so everything pushed before the release is serviced
+		const bool released = stream->isReleased();
+		stream->service();
+		
+		if(released)
+		{
+			streams.remove(i);
+			delete stream;
+		}
+	}
+}
+
+END_UGEN_NAMESPACE
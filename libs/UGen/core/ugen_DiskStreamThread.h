@@ -0,0 +1,98 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+#ifndef UGEN_DISKSTREAMTHREAD_H
+#define UGEN_DISKSTREAMTHREAD_H
+
+#include "ugen_Thread.h"
+#include "ugen_LockFreeFifo.h"
+#include "ugen_Arrays.h"
+
+/** A file being read or written on the DiskStreamThread, e.g., by DiskIn, DiskOut or DataRecorder.
+ 
+ The audio thread and the DiskStreamThread normally exchange data through LockFreeFifo objects 
+ owned by the stream. Streams are owned by the thread once they've been added to it. Whatever is
+ using a stream calls release() when it has finished with it and the thread deletes it after 
+ servicing it once more, so anything pushed before release() is still written. */
+class DiskStream
+{
+public:
+	DiskStream() throw() : released(0) { }
+	virtual ~DiskStream() { }
+	
+	/** Called regularly on the DiskStreamThread to read or write whatever is waiting. */
+	virtual void service() throw() = 0;
+	
+	inline void release() throw()				{ atomicSet(released, 1);			}
+	inline bool isReleased() const throw()		{ return atomicGet(released) != 0;	}
+	
+private:
+	volatile int released;
+	
+	DiskStream (const DiskStream&);
+	const DiskStream& operator= (const DiskStream&);
+};
+
+/** The one background thread which does the file I/O for every DiskStream. */
+class DiskStreamThread : public BackgroundThread
+{
+public:
+	enum Constants
+	{
+		ServiceInterval = 2,		///< Milliseconds to sleep between servicing the streams.
+		MaximumNewStreams = 256
+	};
+	
+	/** Hand a stream over to the thread, starting the thread if necessary. Don't call this on the audio thread. */
+	static void add(DiskStream* stream) throw();
+	
+	~DiskStreamThread();
+	
+protected:
+	void run();
+	
+private:
+	DiskStreamThread() throw();
+	static DiskStreamThread& getInstance() throw();
+	void serviceStreams() throw();
+	
+	LockFreeFifo<DiskStream*> newStreams;
+	SpinLock addLock;
+	ObjectArray<DiskStream*> streams;
+};
+
+
+#endif // UGEN_DISKSTREAMTHREAD_H
@@ -0,0 +1,138 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_LOCKFREEFIFO_H
+#define UGEN_LOCKFREEFIFO_H
+
+#include "ugen_Atomic.h"
+#include "ugen_Bits.h"
+
+/** A single-producer/single-consumer lock-free FIFO.
+ 
+ One thread (e.g., a GUI or control thread) pushes items and one other thread 
+ (e.g., the audio thread) pops them. Neither side ever blocks or takes a lock so 
+ this is safe to use from an audio callback. If more than one thread needs to push 
+ items they must be serialised with a lock on the producer side only.
+ 
+ The capacity is rounded up to a power of two and is fixed on construction. Popped 
+ slots are reset to a default constructed ItemType so any objects referenced by an 
+ item (e.g., UGen instances) are released by the consumer as the item is popped.
+ 
+ @tparam ItemType	The item type, this must have a default constructor and be assignable. */
+template<class ItemType>
+class LockFreeFifo
+{
+public:
+	/** Construct a FIFO. 
+	 @param capacity	The minimum number of items the FIFO can hold. */
+	LockFreeFifo(const int capacity = 1024) throw()
+	:	size_((int)Bits::nextPowerOf2(capacity < 2 ? 2 : capacity)),
+		indexMask(size_ * 2 - 1),
+		items(new ItemType[size_]),
+		readIndex(0),
+		writeIndex(0)
+	{
+	}
+	
+	~LockFreeFifo()
+	{
+		delete [] items;
+	}
+	
+	/** The maximum number of items the FIFO can hold. */
+	inline int getCapacity() const throw()	{ return size_;							}
+	
+	/** The number of items waiting to be popped. */
+	inline int getNumReady() const throw()	{ return (atomicGet(writeIndex) - atomicGet(readIndex)) & indexMask;	}
+	
+	/** The number of items which can be pushed before the FIFO is full. */
+	inline int getFreeSpace() const throw()	{ return size_ - getNumReady();			}
+	
+	inline bool isEmpty() const throw()		{ return getNumReady() == 0;			}
+	inline bool isFull() const throw()		{ return getNumReady() == size_;		}
+	
+	/** Push an item, only call this from the producer thread.
+	 @return @c true if the item was added, @c false if the FIFO was full. */
+	bool push(ItemType const& item) throw()
+	{
+		const int write = writeIndex; // only this thread changes writeIndex
+		
+		if(((write - atomicGet(readIndex)) & indexMask) >= size_) 
+			return false;
+		
+		items[write & (size_ - 1)] = item;
+		atomicSet(writeIndex, (write + 1) & indexMask);
+		return true;
+	}
+	
+	/** Pop an item, only call this from the consumer thread.
+	 @param item	Receives the item if one was available.
+	 @return		@c true if an item was popped, @c false if the FIFO was empty. */
+	bool pop(ItemType& item) throw()
+	{
+		const int read = readIndex; // only this thread changes readIndex
+		
+		if(atomicGet(writeIndex) == read)
+			return false;
+		
+		ItemType& slot = items[read & (size_ - 1)];
+		item = slot;
+		slot = ItemType();
+		atomicSet(readIndex, (read + 1) & indexMask);
+		return true;
+	}
+	
+	/** Discard all the waiting items, only call this from the consumer thread. */
+	void clear() throw()
+	{
+		ItemType item;
+		while(pop(item)) { }
+	}
+	
+private:
+	const int size_;
+	const int indexMask; // indices run over twice the size so full and empty can be told apart
+	ItemType* const items;
+	volatile int readIndex;
+	volatile int writeIndex;
+	
+	LockFreeFifo (const LockFreeFifo&);
+	const LockFreeFifo& operator= (const LockFreeFifo&);
+};
+
+
+#endif // UGEN_LOCKFREEFIFO_H
@@ -0,0 +1,583 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "ugen_StandardHeader.h"
+
+#ifdef UGEN_SIMD
+	#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define UGEN_SIMD_X86 1
+		#include <immintrin.h>
+		#if defined(__GNUC__) || defined(__clang__)
+			#define UGEN_SIMD_AVX2_TARGET __attribute__((target("avx2")))
+		#else
+			#include <intrin.h>
+			#define UGEN_SIMD_AVX2_TARGET
+		#endif
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define UGEN_SIMD_ARM 1
+		#include <arm_neon.h>
+		#if defined(__aarch64__) || defined(_M_ARM64)
+			#define UGEN_SIMD_ARM64 1 // armv7 has no exact vector divide or square root
+		#endif
+	#endif
+#endif
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_SIMD.h"
+#include "../basics/ugen_InlineUnaryOps.h"
+#include "../basics/ugen_InlineBinaryOps.h"
+
+// the scalar operations, these are the same as the plain loops in the operator UGens
+
+static inline float addOp(const float a, const float b) throw()			{ return a + b;					}
+static inline float subtractOp(const float a, const float b) throw()	{ return a - b;					}
+static inline float multiplyOp(const float a, const float b) throw()	{ return a * b;					}
+static inline float divideOp(const float a, const float b) throw()		{ return a / b;					}
+static inline float minOp(const float a, const float b) throw()			{ return ugen::min(a, b);		}
+static inline float maxOp(const float a, const float b) throw()			{ return ugen::max(a, b);		}
+static inline float clip2Op(const float a, const float b) throw()		{ return ugen::clip2(a, b);		}
+static inline float negOp(const float a) throw()						{ return ugen::neg(a);			}
+static inline float absOp(const float a) throw()						{ return ugen::abs(a);			}
+static inline float squaredOp(const float a) throw()					{ return ugen::squared(a);		}
+static inline float cubedOp(const float a) throw()						{ return ugen::cubed(a);		}
+static inline float reciprocalOp(const float a) throw()					{ return ugen::reciprocal(a);	}
+static inline float sqrtOp(const float a) throw()						{ return ugen::sqrt(a);			}
+
+// kernel generators, ISA is the prefix of the vector type and operation macros below
+
+#define SIMDBinaryKernel(ISA, NAME, VECTOROP, SCALAROP)																	\
+	static ISA##_TARGET void ISA##_##NAME(const float* a, const float* b, float* out, const int size)					\
+	{																													\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V x = ISA##_LOAD(a + i);																		\
+			const ISA##_V y = ISA##_LOAD(b + i);																		\
+			ISA##_STORE(out + i, ISA##_##VECTOROP(x, y));																\
+		}																												\
+		for(; i < size; i++)																							\
+			out[i] = SCALAROP(a[i], b[i]);																				\
+	}
+
+#define SIMDVectorScalarKernel(ISA, NAME, VECTOROP, SCALAROP)															\
+	static ISA##_TARGET void ISA##_##NAME(const float* a, const float b, float* out, const int size)					\
+	{																													\
+		const ISA##_V y = ISA##_SET1(b);																				\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V x = ISA##_LOAD(a + i);																		\
+			ISA##_STORE(out + i, ISA##_##VECTOROP(x, y));																\
+		}																												\
+		for(; i < size; i++)																							\
+			out[i] = SCALAROP(a[i], b);																					\
+	}
+
+#define SIMDScalarVectorKernel(ISA, NAME, VECTOROP, SCALAROP)															\
+	static ISA##_TARGET void ISA##_##NAME(const float a, const float* b, float* out, const int size)					\
+	{																													\
+		const ISA##_V x = ISA##_SET1(a);																				\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V y = ISA##_LOAD(b + i);																		\
+			ISA##_STORE(out + i, ISA##_##VECTOROP(x, y));																\
+		}																												\
+		for(; i < size; i++)																							\
+			out[i] = SCALAROP(a, b[i]);																					\
+	}
+
+#define SIMDUnaryKernel(ISA, NAME, VECTOROP, SCALAROP)																	\
+	static ISA##_TARGET void ISA##_##NAME(const float* a, float* out, const int size)									\
+	{																													\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V x = ISA##_LOAD(a + i);																		\
+			ISA##_STORE(out + i, ISA##_##VECTOROP(x));																	\
+		}																												\
+		for(; i < size; i++)																							\
+			out[i] = SCALAROP(a[i]);																					\
+	}
+
+#define SIMDMulAddKernels(ISA)																							\
+	static ISA##_TARGET void ISA##_mulAdd(const float* in, const float* mul, const float* add, float* out, const int size)	\
+	{																													\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V product = ISA##_MUL(ISA##_LOAD(in + i), ISA##_LOAD(mul + i));									\
+			ISA##_STORE(out + i, ISA##_ADD(product, ISA##_LOAD(add + i)));												\
+		}																												\
+		for(; i < size; i++)																							\
+			out[i] = in[i] * mul[i] + add[i];																			\
+	}																													\
+																														\
+	static ISA##_TARGET void ISA##_mulAddScalar(const float* in, const float mul, const float add, float* out, const int size)	\
+	{																													\
+		const ISA##_V mulVector = ISA##_SET1(mul);																		\
+		const ISA##_V addVector = ISA##_SET1(add);																		\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V product = ISA##_MUL(ISA##_LOAD(in + i), mulVector);											\
+			ISA##_STORE(out + i, ISA##_ADD(product, addVector));														\
+		}																												\
+		for(; i < size; i++)																							\
+			out[i] = in[i] * mul + add;																					\
+	}																													\
+																														\
+	static ISA##_TARGET void ISA##_multiplyAccumulate(const float* in, const float mul, float* out, const int size)		\
+	{																													\
+		const ISA##_V mulVector = ISA##_SET1(mul);																		\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V product = ISA##_MUL(ISA##_LOAD(in + i), mulVector);											\
+			ISA##_STORE(out + i, ISA##_ADD(ISA##_LOAD(out + i), product));												\
+		}																												\
+		for(; i < size; i++)																							\
+			out[i] = out[i] + in[i] * mul;																				\
+	}
+
+#define SIMDComplexKernels(ISA)																							\
+	static ISA##_TARGET void ISA##_complexMultiplyAccumulate(const float* aReal, const float* aImag,					\
+															 const float* bReal, const float* bImag,					\
+															 float* outReal, float* outImag, const int size)			\
+	{																													\
+		int i = 0;																										\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {																\
+			const ISA##_V ar = ISA##_LOAD(aReal + i);																	\
+			const ISA##_V ai = ISA##_LOAD(aImag + i);																	\
+			const ISA##_V br = ISA##_LOAD(bReal + i);																	\
+			const ISA##_V bi = ISA##_LOAD(bImag + i);																	\
+			const ISA##_V real = ISA##_SUB(ISA##_MUL(ar, br), ISA##_MUL(ai, bi));										\
+			const ISA##_V imag = ISA##_ADD(ISA##_MUL(ar, bi), ISA##_MUL(ai, br));										\
+			ISA##_STORE(outReal + i, ISA##_ADD(ISA##_LOAD(outReal + i), real));										\
+			ISA##_STORE(outImag + i, ISA##_ADD(ISA##_LOAD(outImag + i), imag));										\
+		}																												\
+		for(; i < size; i++) {																							\
+			outReal[i] = outReal[i] + (aReal[i] * bReal[i] - aImag[i] * bImag[i]);										\
+			outImag[i] = outImag[i] + (aReal[i] * bImag[i] + aImag[i] * bReal[i]);										\
+		}																												\
+	}																												\
+																													\
+	static ISA##_TARGET void ISA##_splitRadixCombine(float* real, float* imag, const float* twiddles, const int quarterSize)	\
+	{																												\
+		const float* cos1 = twiddles;																				\
+		const float* sin1 = twiddles + quarterSize;																	\
+		const float* cos3 = twiddles + quarterSize * 2;																\
+		const float* sin3 = twiddles + quarterSize * 3;																\
+		float* real1 = real + quarterSize;																			\
+		float* imag1 = imag + quarterSize;																			\
+		float* real2 = real + quarterSize * 2;																		\
+		float* imag2 = imag + quarterSize * 2;																		\
+		float* real3 = real + quarterSize * 3;																		\
+		float* imag3 = imag + quarterSize * 3;																		\
+		int i = 0;																									\
+		for(; i <= quarterSize - ISA##_WIDTH; i += ISA##_WIDTH) {													\
+			const ISA##_V c1 = ISA##_LOAD(cos1 + i), s1 = ISA##_LOAD(sin1 + i);										\
+			const ISA##_V c3 = ISA##_LOAD(cos3 + i), s3 = ISA##_LOAD(sin3 + i);										\
+			const ISA##_V ar = ISA##_LOAD(real2 + i), ai = ISA##_LOAD(imag2 + i);									\
+			const ISA##_V br = ISA##_LOAD(real3 + i), bi = ISA##_LOAD(imag3 + i);									\
+			const ISA##_V zr = ISA##_SUB(ISA##_MUL(ar, c1), ISA##_MUL(ai, s1));										\
+			const ISA##_V zi = ISA##_ADD(ISA##_MUL(ar, s1), ISA##_MUL(ai, c1));										\
+			const ISA##_V yr = ISA##_SUB(ISA##_MUL(br, c3), ISA##_MUL(bi, s3));										\
+			const ISA##_V yi = ISA##_ADD(ISA##_MUL(br, s3), ISA##_MUL(bi, c3));										\
+			const ISA##_V sr = ISA##_ADD(zr, yr), si = ISA##_ADD(zi, yi);											\
+			const ISA##_V dr = ISA##_SUB(zr, yr), di = ISA##_SUB(zi, yi);											\
+			const ISA##_V ur = ISA##_LOAD(real + i), ui = ISA##_LOAD(imag + i);										\
+			const ISA##_V vr = ISA##_LOAD(real1 + i), vi = ISA##_LOAD(imag1 + i);									\
+			ISA##_STORE(real + i, ISA##_ADD(ur, sr));																\
+			ISA##_STORE(imag + i, ISA##_ADD(ui, si));																\
+			ISA##_STORE(real2 + i, ISA##_SUB(ur, sr));																\
+			ISA##_STORE(imag2 + i, ISA##_SUB(ui, si));																\
+			ISA##_STORE(real1 + i, ISA##_ADD(vr, di));																\
+			ISA##_STORE(imag1 + i, ISA##_SUB(vi, dr));																\
+			ISA##_STORE(real3 + i, ISA##_SUB(vr, di));																\
+			ISA##_STORE(imag3 + i, ISA##_ADD(vi, dr));																\
+		}																											\
+		for(; i < quarterSize; i++) {																				\
+			const float zr = real2[i] * cos1[i] - imag2[i] * sin1[i];												\
+			const float zi = real2[i] * sin1[i] + imag2[i] * cos1[i];												\
+			const float yr = real3[i] * cos3[i] - imag3[i] * sin3[i];												\
+			const float yi = real3[i] * sin3[i] + imag3[i] * cos3[i];												\
+			const float sr = zr + yr, si = zi + yi;																	\
+			const float dr = zr - yr, di = zi - yi;																	\
+			const float ur = real[i], ui = imag[i];																	\
+			const float vr = real1[i], vi = imag1[i];																\
+			real[i] = ur + sr;																						\
+			imag[i] = ui + si;																						\
+			real2[i] = ur - sr;																						\
+			imag2[i] = ui - si;																						\
+			real1[i] = vr + di;																						\
+			imag1[i] = vi - dr;																						\
+			real3[i] = vr - di;																						\
+			imag3[i] = vi + dr;																						\
+		}																											\
+	}																												\
+																													\
+	static ISA##_TARGET void ISA##_splitRadixCombineInterleaved(float* real, float* imag, const float* twiddles, const int quarterSize)	\
+	{																												\
+		const int lanes = SIMD::InterleavedTransforms;																\
+		const int quarterStride = quarterSize * lanes;																\
+		for(int k = 0; k < quarterSize; k++) {																		\
+			const ISA##_V c1 = ISA##_SET1(twiddles[k]);																\
+			const ISA##_V s1 = ISA##_SET1(twiddles[k + quarterSize]);												\
+			const ISA##_V c3 = ISA##_SET1(twiddles[k + quarterSize * 2]);											\
+			const ISA##_V s3 = ISA##_SET1(twiddles[k + quarterSize * 3]);											\
+			for(int lane = 0; lane < lanes; lane += ISA##_WIDTH) {													\
+				float* const r0 = real + k * lanes + lane;															\
+				float* const i0 = imag + k * lanes + lane;															\
+				float* const r1 = r0 + quarterStride;																\
+				float* const i1 = i0 + quarterStride;																\
+				float* const r2 = r1 + quarterStride;																\
+				float* const i2 = i1 + quarterStride;																\
+				float* const r3 = r2 + quarterStride;																\
+				float* const i3 = i2 + quarterStride;																\
+				const ISA##_V ar = ISA##_LOAD(r2), ai = ISA##_LOAD(i2);												\
+				const ISA##_V br = ISA##_LOAD(r3), bi = ISA##_LOAD(i3);												\
+				const ISA##_V zr = ISA##_SUB(ISA##_MUL(ar, c1), ISA##_MUL(ai, s1));									\
+				const ISA##_V zi = ISA##_ADD(ISA##_MUL(ar, s1), ISA##_MUL(ai, c1));									\
+				const ISA##_V yr = ISA##_SUB(ISA##_MUL(br, c3), ISA##_MUL(bi, s3));									\
+				const ISA##_V yi = ISA##_ADD(ISA##_MUL(br, s3), ISA##_MUL(bi, c3));									\
+				const ISA##_V sr = ISA##_ADD(zr, yr), si = ISA##_ADD(zi, yi);										\
+				const ISA##_V dr = ISA##_SUB(zr, yr), di = ISA##_SUB(zi, yi);										\
+				const ISA##_V ur = ISA##_LOAD(r0), ui = ISA##_LOAD(i0);												\
+				const ISA##_V vr = ISA##_LOAD(r1), vi = ISA##_LOAD(i1);												\
+				ISA##_STORE(r0, ISA##_ADD(ur, sr));																	\
+				ISA##_STORE(i0, ISA##_ADD(ui, si));																	\
+				ISA##_STORE(r2, ISA##_SUB(ur, sr));																	\
+				ISA##_STORE(i2, ISA##_SUB(ui, si));																	\
+				ISA##_STORE(r1, ISA##_ADD(vr, di));																	\
+				ISA##_STORE(i1, ISA##_SUB(vi, dr));																	\
+				ISA##_STORE(r3, ISA##_SUB(vr, di));																	\
+				ISA##_STORE(i3, ISA##_ADD(vi, dr));																	\
+			}																										\
+		}																											\
+	}
+
+#define SIMDConversionKernels(ISA)																					\
+	static ISA##_TARGET void ISA##_intToFloat(const int* in, const float scale, float* out, const int size)			\
+	{																												\
+		const ISA##_V scaleVector = ISA##_SET1(scale);																\
+		int i = 0;																									\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {															\
+			const ISA##_V x = ISA##_TOFLOAT(ISA##_LOADI(in + i));													\
+			ISA##_STORE(out + i, ISA##_MUL(x, scaleVector));														\
+		}																											\
+		for(; i < size; i++)																						\
+			out[i] = (float)in[i] * scale;																			\
+	}																												\
+																													\
+	static ISA##_TARGET void ISA##_floatToInt(const float* in, const float scale, const float limit, int* out, const int size)	\
+	{																												\
+		const ISA##_V scaleVector = ISA##_SET1(scale);																\
+		const ISA##_V limitVector = ISA##_SET1(limit);																\
+		int i = 0;																									\
+		for(; i <= size - ISA##_WIDTH; i += ISA##_WIDTH) {															\
+			const ISA##_V x = ISA##_CLIP2(ISA##_MUL(ISA##_LOAD(in + i), scaleVector), limitVector);					\
+			ISA##_STOREI(out + i, ISA##_TOINT(x));																	\
+		}																											\
+		for(; i < size; i++)																						\
+			out[i] = (int)clip2Op(in[i] * scale, limit);															\
+	}
+
+#define SIMDKernels(ISA, DIVIDE_OP, SQRT_OP)																			\
+	SIMDBinaryKernel(ISA, add,						ADD,		addOp)													\
+	SIMDBinaryKernel(ISA, subtract,					SUB,		subtractOp)												\
+	SIMDBinaryKernel(ISA, multiply,					MUL,		multiplyOp)												\
+	SIMDBinaryKernel(ISA, divide,					DIVIDE_OP,	divideOp)												\
+	SIMDBinaryKernel(ISA, min,						MIN,		minOp)													\
+	SIMDBinaryKernel(ISA, max,						MAX,		maxOp)													\
+	SIMDBinaryKernel(ISA, clip2,					CLIP2,		clip2Op)												\
+	SIMDVectorScalarKernel(ISA, addScalar,			ADD,		addOp)													\
+	SIMDVectorScalarKernel(ISA, multiplyScalar,		MUL,		multiplyOp)												\
+	SIMDScalarVectorKernel(ISA, subtractFromScalar,	SUB,		subtractOp)												\
+	SIMDScalarVectorKernel(ISA, divideScalar,		DIVIDE_OP,	divideOp)												\
+	SIMDMulAddKernels(ISA)																								\
+	SIMDUnaryKernel(ISA, neg,						NEG,		negOp)													\
+	SIMDUnaryKernel(ISA, abs,						ABS,		absOp)													\
+	SIMDUnaryKernel(ISA, squared,					SQUARED,	squaredOp)												\
+	SIMDUnaryKernel(ISA, cubed,						CUBED,		cubedOp)												\
+	SIMDUnaryKernel(ISA, reciprocal,				RECIPROCAL,	reciprocalOp)											\
+	SIMDUnaryKernel(ISA, sqrt,						SQRT_OP,	sqrtOp)												\
+	SIMDConversionKernels(ISA)																							\
+	SIMDComplexKernels(ISA)
+
+#define SIMDKernelTable(ISA, LEVEL)																						\
+	{																													\
+		LEVEL,																											\
+		ISA##_add, ISA##_subtract, ISA##_multiply, ISA##_divide, ISA##_min, ISA##_max, ISA##_clip2,						\
+		ISA##_mulAdd,																									\
+		ISA##_addScalar, ISA##_multiplyScalar, ISA##_multiplyAccumulate,												\
+		ISA##_subtractFromScalar, ISA##_divideScalar,																	\
+		ISA##_mulAddScalar,																								\
+		ISA##_neg, ISA##_abs, ISA##_squared, ISA##_cubed, ISA##_reciprocal, ISA##_sqrt,								\
+		ISA##_intToFloat, ISA##_floatToInt,																			\
+		ISA##_complexMultiplyAccumulate,																				\
+		ISA##_splitRadixCombine, ISA##_splitRadixCombineInterleaved														\
+	}
+
+// plain C, the compiler is free to vectorise these itself
+
+#define Plain_TARGET
+#define Plain_V								float
+#define Plain_WIDTH							1
+#define Plain_LOAD(p)						(*(p))
+#define Plain_STORE(p, x)					(*(p) = (x))
+#define Plain_SET1(x)						(x)
+#define Plain_ADD(x, y)						addOp(x, y)
+#define Plain_SUB(x, y)						subtractOp(x, y)
+#define Plain_MUL(x, y)						multiplyOp(x, y)
+#define Plain_DIV(x, y)						divideOp(x, y)
+#define Plain_MIN(x, y)						minOp(x, y)
+#define Plain_MAX(x, y)						maxOp(x, y)
+#define Plain_CLIP2(x, y)					clip2Op(x, y)
+#define Plain_NEG(x)						negOp(x)
+#define Plain_ABS(x)						absOp(x)
+#define Plain_SQUARED(x)					squaredOp(x)
+#define Plain_CUBED(x)						cubedOp(x)
+#define Plain_RECIPROCAL(x)					reciprocalOp(x)
+#define Plain_SQRT(x)						sqrtOp(x)
+#define Plain_LOADI(p)						(*(p))
+#define Plain_STOREI(p, x)					(*(p) = (x))
+#define Plain_TOFLOAT(x)					((float)(x))
+#define Plain_TOINT(x)						((int)(x))
+
+SIMDKernels(Plain, DIV, SQRT)
+
+#if defined(UGEN_SIMD_X86)
+
+// minps/maxps return their second operand unless the comparison is true, swapping
+// the operands gives the same results as ugen::min() and ugen::max() including for NaNs
+
+#define SSE2_TARGET
+#define SSE2_V								__m128
+#define SSE2_WIDTH							4
+#define SSE2_LOAD(p)						_mm_loadu_ps(p)
+#define SSE2_STORE(p, x)					_mm_storeu_ps(p, x)
+#define SSE2_SET1(x)						_mm_set1_ps(x)
+#define SSE2_ADD(x, y)						_mm_add_ps(x, y)
+#define SSE2_SUB(x, y)						_mm_sub_ps(x, y)
+#define SSE2_MUL(x, y)						_mm_mul_ps(x, y)
+#define SSE2_DIV(x, y)						_mm_div_ps(x, y)
+#define SSE2_MIN(x, y)						_mm_min_ps(y, x)
+#define SSE2_MAX(x, y)						_mm_max_ps(y, x)
+#define SSE2_CLIP2(x, y)					_mm_min_ps(y, _mm_max_ps(x, SSE2_NEG(y)))
+#define SSE2_NEG(x)							_mm_xor_ps(x, _mm_set1_ps(-0.f))
+#define SSE2_ABS(x)							_mm_andnot_ps(_mm_set1_ps(-0.f), x)
+#define SSE2_SQUARED(x)						_mm_mul_ps(x, x)
+#define SSE2_CUBED(x)						_mm_mul_ps(_mm_mul_ps(x, x), x)
+#define SSE2_RECIPROCAL(x)					_mm_div_ps(_mm_set1_ps(1.f), x)
+#define SSE2_SQRT(x)						_mm_sqrt_ps(x)
+#define SSE2_LOADI(p)						_mm_loadu_si128((const __m128i*)(p))
+#define SSE2_STOREI(p, x)					_mm_storeu_si128((__m128i*)(p), x)
+#define SSE2_TOFLOAT(x)						_mm_cvtepi32_ps(x)
+#define SSE2_TOINT(x)						_mm_cvttps_epi32(x)
+
+SIMDKernels(SSE2, DIV, SQRT)
+
+#define AVX2_TARGET							UGEN_SIMD_AVX2_TARGET
+#define AVX2_V								__m256
+#define AVX2_WIDTH							8
+#define AVX2_LOAD(p)						_mm256_loadu_ps(p)
+#define AVX2_STORE(p, x)					_mm256_storeu_ps(p, x)
+#define AVX2_SET1(x)						_mm256_set1_ps(x)
+#define AVX2_ADD(x, y)						_mm256_add_ps(x, y)
+#define AVX2_SUB(x, y)						_mm256_sub_ps(x, y)
+#define AVX2_MUL(x, y)						_mm256_mul_ps(x, y)
+#define AVX2_DIV(x, y)						_mm256_div_ps(x, y)
+#define AVX2_MIN(x, y)						_mm256_min_ps(y, x)
+#define AVX2_MAX(x, y)						_mm256_max_ps(y, x)
+#define AVX2_CLIP2(x, y)					_mm256_min_ps(y, _mm256_max_ps(x, AVX2_NEG(y)))
+#define AVX2_NEG(x)							_mm256_xor_ps(x, _mm256_set1_ps(-0.f))
+#define AVX2_ABS(x)							_mm256_andnot_ps(_mm256_set1_ps(-0.f), x)
+#define AVX2_SQUARED(x)						_mm256_mul_ps(x, x)
+#define AVX2_CUBED(x)						_mm256_mul_ps(_mm256_mul_ps(x, x), x)
+#define AVX2_RECIPROCAL(x)					_mm256_div_ps(_mm256_set1_ps(1.f), x)
+#define AVX2_SQRT(x)						_mm256_sqrt_ps(x)
+#define AVX2_LOADI(p)						_mm256_loadu_si256((const __m256i*)(p))
+#define AVX2_STOREI(p, x)					_mm256_storeu_si256((__m256i*)(p), x)
+#define AVX2_TOFLOAT(x)						_mm256_cvtepi32_ps(x)
+#define AVX2_TOINT(x)						_mm256_cvttps_epi32(x)
+
+SIMDKernels(AVX2, DIV, SQRT)
+
+static bool isAVX2Supported() throw()
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_cpu_init(); // this may run before libgcc has initialised the cpu model
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	int info[4];
+	__cpuid(info, 0);
+	
+	if(info[0] < 7) 
+		return false;
+	
+	__cpuid(info, 1);
+	
+	const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+	const bool hasAVX = (info[2] & (1 << 28)) != 0;
+	
+	// the OS must save the ymm registers too
+	if(!hasOSXSAVE || !hasAVX || (_xgetbv(0) & 6) != 6) 
+		return false;
+	
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#endif
+}
+
+#elif defined(UGEN_SIMD_ARM)
+
+// vminq_f32/vmaxq_f32 treat NaNs differently to ugen::min() and ugen::max() so these compare and select
+
+#define NEON_TARGET
+#define NEON_V								float32x4_t
+#define NEON_WIDTH							4
+#define NEON_LOAD(p)						vld1q_f32(p)
+#define NEON_STORE(p, x)					vst1q_f32(p, x)
+#define NEON_SET1(x)						vdupq_n_f32(x)
+#define NEON_ADD(x, y)						vaddq_f32(x, y)
+#define NEON_SUB(x, y)						vsubq_f32(x, y)
+#define NEON_MUL(x, y)						vmulq_f32(x, y)
+#define NEON_MIN(x, y)						vbslq_f32(vcgtq_f32(x, y), y, x)
+#define NEON_MAX(x, y)						vbslq_f32(vcltq_f32(x, y), y, x)
+#define NEON_CLIP2(x, y)					NEON_MIN(NEON_MAX(vnegq_f32(y), x), y)
+#define NEON_NEG(x)							vnegq_f32(x)
+#define NEON_ABS(x)							vabsq_f32(x)
+#define NEON_SQUARED(x)						vmulq_f32(x, x)
+#define NEON_CUBED(x)						vmulq_f32(vmulq_f32(x, x), x)
+#define NEON_LOADI(p)						vld1q_s32(p)
+#define NEON_STOREI(p, x)					vst1q_s32(p, x)
+#define NEON_TOFLOAT(x)						vcvtq_f32_s32(x)
+#define NEON_TOINT(x)						vcvtq_s32_f32(x)
+
+#if defined(UGEN_SIMD_ARM64)
+	#define NEON_DIV(x, y)					vdivq_f32(x, y)
+	#define NEON_RECIPROCAL(x)				vdivq_f32(vdupq_n_f32(1.f), x)
+	#define NEON_SQRT(x)					vsqrtq_f32(x)
+	
+	SIMDKernels(NEON, DIV, SQRT)
+#else
+	// the estimates armv7 has aren't exact so divide and square root stay scalar
+	#define NEON_SCALARDIV(x, y)			applyToLanes(divideOp, x, y)
+	#define NEON_RECIPROCAL(x)				applyToLanes(divideOp, vdupq_n_f32(1.f), x)
+	#define NEON_SCALARSQRT(x)				applyToLanes(sqrtOp, x)
+	
+	static inline float32x4_t applyToLanes(float (*op)(const float, const float), float32x4_t x, float32x4_t y) throw()
+	{
+		float a[4], b[4];
+		vst1q_f32(a, x);
+		vst1q_f32(b, y);
+		for(int i = 0; i < 4; i++) a[i] = op(a[i], b[i]);
+		return vld1q_f32(a);
+	}
+	
+	static inline float32x4_t applyToLanes(float (*op)(const float), float32x4_t x) throw()
+	{
+		float a[4];
+		vst1q_f32(a, x);
+		for(int i = 0; i < 4; i++) a[i] = op(a[i]);
+		return vld1q_f32(a);
+	}
+	
+	SIMDKernels(NEON, SCALARDIV, SCALARSQRT)
+#endif
+
+#endif // UGEN_SIMD_ARM
+
+
+static const SIMD::Kernels plainKernels = SIMDKernelTable(Plain, SIMD::Scalar);
+
+#if defined(UGEN_SIMD_X86)
+static const SIMD::Kernels sse2Kernels = SIMDKernelTable(SSE2, SIMD::SSE2);
+static const SIMD::Kernels avx2Kernels = SIMDKernelTable(AVX2, SIMD::AVX2);
+SIMD::Kernels SIMD::kernels = SIMDKernelTable(SSE2, SIMD::SSE2);
+#elif defined(UGEN_SIMD_ARM)
+static const SIMD::Kernels neonKernels = SIMDKernelTable(NEON, SIMD::NEON);
+SIMD::Kernels SIMD::kernels = SIMDKernelTable(NEON, SIMD::NEON);
+#else
+SIMD::Kernels SIMD::kernels = SIMDKernelTable(Plain, SIMD::Scalar);
+#endif
+
+SIMD::Level SIMD::getMaxLevel() throw()
+{
+#if defined(UGEN_SIMD_X86)
+	static const Level maxLevel = isAVX2Supported() ? AVX2 : SSE2;
+	return maxLevel;
+#elif defined(UGEN_SIMD_ARM)
+	return NEON;
+#else
+	return Scalar;
+#endif
+}
+
+SIMD::Level SIMD::getLevel() throw()
+{
+	return kernels.level;
+}
+
+bool SIMD::setLevel(const Level level) throw()
+{
+	switch(level)
+	{
+		case Scalar:	kernels = plainKernels; return true;
+#if defined(UGEN_SIMD_X86)
+		case SSE2:		kernels = sse2Kernels; return true;
+		case AVX2:		if(getMaxLevel() != AVX2) return false;
+						kernels = avx2Kernels; return true;
+#elif defined(UGEN_SIMD_ARM)
+		case NEON:		kernels = neonKernels; return true;
+#endif
+		default:		return false;
+	}
+}
+
+const char* SIMD::getLevelName(const Level level) throw()
+{
+	switch(level)
+	{
+		case Scalar:	return "Scalar";
+		case SSE2:		return "SSE2";
+		case AVX2:		return "AVX2";
+		case NEON:		return "NEON";
+		default:		return "Unknown";
+	}
+}
+
+// pick the best kernels as the library is loaded, before UGen::initialise()
+static const bool simdInitialised = SIMD::setLevel(SIMD::getMaxLevel());
+
+
+END_UGEN_NAMESPACE
@@ -0,0 +1,213 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_SIMD_H
+#define UGEN_SIMD_H
+
+/** Vector kernels for the basic arithmetic UGens.
+ 
+ When UGEN_SIMD is defined (the default when building for SSE2 or NEON targets without
+ vDSP, define UGEN_NOSIMD to disable it) the binary and unary operator UGens use these 
+ rather than their plain loops. On x86 each kernel has an SSE2 version and an AVX2 version
+ which is chosen at runtime if the CPU supports it, ARM uses NEON and anything else uses 
+ plain C. Every version gives exactly the same results as the plain loops, so fused 
+ multiply-adds and reciprocal or square root estimates are never used.
+ 
+ The kernels don't require aligned arrays and the output may be the same array as any 
+ of the inputs. */
+class SIMD
+{
+public:
+	enum Level
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON
+	};
+	
+	enum Constants
+	{
+		InterleavedTransforms = 8 ///< A multiple of the widest vector so no lanes are left over
+	};
+	
+	/** The kernels currently in use. */
+	static Level getLevel() throw();
+	
+	/** The best kernels supported by this build and CPU. */
+	static Level getMaxLevel() throw();
+	
+	/** Choose the kernels to use, e.g., to compare them. 
+	 Don't call this while audio is being rendered.
+	 @return @c false if the level isn't supported. */
+	static bool setLevel(const Level level) throw();
+	
+	static const char* getLevelName(const Level level) throw();
+	
+	/// @name Binary vector operations
+	/// @{
+	
+	static inline void add(const float* a, const float* b, float* out, const int size) throw()			{ kernels.add(a, b, out, size);			}
+	static inline void subtract(const float* a, const float* b, float* out, const int size) throw()		{ kernels.subtract(a, b, out, size);	}
+	static inline void multiply(const float* a, const float* b, float* out, const int size) throw()		{ kernels.multiply(a, b, out, size);	}
+	static inline void divide(const float* a, const float* b, float* out, const int size) throw()		{ kernels.divide(a, b, out, size);		}
+	static inline void min(const float* a, const float* b, float* out, const int size) throw()			{ kernels.min(a, b, out, size);			}
+	static inline void max(const float* a, const float* b, float* out, const int size) throw()			{ kernels.max(a, b, out, size);			}
+	static inline void clip2(const float* a, const float* b, float* out, const int size) throw()		{ kernels.clip2(a, b, out, size);		}
+	
+	/** out = in * mul + add */
+	static inline void mulAdd(const float* in, const float* mul, const float* add, float* out, const int size) throw()	
+	{ 
+		kernels.mulAdd(in, mul, add, out, size);		
+	}
+	
+	/// @} <!-- end Binary vector operations -->
+	
+	/// @name Vector and scalar operations
+	/// @{
+	
+	static inline void add(const float* a, const float b, float* out, const int size) throw()			{ kernels.addScalar(a, b, out, size);		}
+	static inline void subtract(const float* a, const float b, float* out, const int size) throw()		{ kernels.addScalar(a, -b, out, size);		}
+	static inline void subtract(const float a, const float* b, float* out, const int size) throw()		{ kernels.subtractFromScalar(a, b, out, size); }
+	static inline void multiply(const float* a, const float b, float* out, const int size) throw()		{ kernels.multiplyScalar(a, b, out, size);	}
+	static inline void divide(const float a, const float* b, float* out, const int size) throw()		{ kernels.divideScalar(a, b, out, size);	}
+	
+	/** out = in * mul + add */
+	static inline void mulAdd(const float* in, const float mul, const float add, float* out, const int size) throw()	
+	{ 
+		kernels.mulAddScalar(in, mul, add, out, size);		
+	}
+	
+	/** out += in * mul */
+	static inline void multiplyAccumulate(const float* in, const float mul, float* out, const int size) throw()
+	{ 
+		kernels.multiplyAccumulate(in, mul, out, size);	
+	}
+	
+	/// @} <!-- end Vector and scalar operations -->
+	
+	/// @name Complex vector operations
+	/// @{
+	
+	/** out += a * b where each complex array is split into real and imaginary parts, e.g., DSPSplitComplex. */
+	static inline void complexMultiplyAccumulate(const float* aReal, const float* aImag, 
+												 const float* bReal, const float* bImag, 
+												 float* outReal, float* outImag, const int size) throw()
+	{
+		kernels.complexMultiplyAccumulate(aReal, aImag, bReal, bImag, outReal, outImag, size);
+	}
+	
+	/** The last pass of a split-radix FFT of size quarterSize * 4, done in place.
+	 
+	 The first half of the arrays holds the transform of the even inputs and the last two quarters
+	 hold the transforms of the inputs at 4n+1 and 4n+3. The twiddles are cos(2pi k/N), -sin(2pi k/N),
+	 cos(6pi k/N) and -sin(6pi k/N) for k from 0 to quarterSize-1, one after the other. */
+	static inline void splitRadixCombine(float* real, float* imag, const float* twiddles, const int quarterSize) throw()
+	{
+		kernels.splitRadixCombine(real, imag, twiddles, quarterSize);
+	}
+	
+	/** As splitRadixCombine() but for InterleavedTransforms transforms done together, the arrays hold
+	 element 0 of each transform then element 1 of each and so on. */
+	static inline void splitRadixCombineInterleaved(float* real, float* imag, const float* twiddles, const int quarterSize) throw()
+	{
+		kernels.splitRadixCombineInterleaved(real, imag, twiddles, quarterSize);
+	}
+	
+	/// @} <!-- end Complex vector operations -->
+	
+	/// @name Unary vector operations
+	/// @{
+	
+	static inline void neg(const float* a, float* out, const int size) throw()			{ kernels.neg(a, out, size);		}
+	static inline void abs(const float* a, float* out, const int size) throw()			{ kernels.abs(a, out, size);		}
+	static inline void squared(const float* a, float* out, const int size) throw()		{ kernels.squared(a, out, size);	}
+	static inline void cubed(const float* a, float* out, const int size) throw()		{ kernels.cubed(a, out, size);		}
+	static inline void reciprocal(const float* a, float* out, const int size) throw()	{ kernels.reciprocal(a, out, size);	}
+	static inline void sqrt(const float* a, float* out, const int size) throw()			{ kernels.sqrt(a, out, size);		}
+	
+	/// @} <!-- end Unary vector operations -->
+	
+	/// @name Sample format conversions
+	/// @{
+	
+	/** out = in * scale, e.g., to convert integer samples from audio files. */
+	static inline void intToFloat(const int* in, const float scale, float* out, const int size) throw()	{ kernels.intToFloat(in, scale, out, size); }
+	
+	/** out = (int)clip2(in * scale, scale) rounding towards zero, e.g., to convert samples for audio files. 
+	 The limit is kept below 2^31 since a float scale of 0x7FFFFFFF rounds up to 2^31. */
+	static inline void floatToInt(const float* in, const float scale, int* out, const int size) throw()
+	{ 
+		kernels.floatToInt(in, scale, scale < 2147483520.f ? scale : 2147483520.f, out, size); 
+	}
+	
+	/// @} <!-- end Sample format conversions -->
+	
+	/** @internal */
+	struct Kernels
+	{
+		typedef void (*Binary)(const float* a, const float* b, float* out, const int size);
+		typedef void (*Ternary)(const float* a, const float* b, const float* c, float* out, const int size);
+		typedef void (*VectorScalar)(const float* a, const float b, float* out, const int size);
+		typedef void (*ScalarVector)(const float a, const float* b, float* out, const int size);
+		typedef void (*VectorScalarScalar)(const float* a, const float b, const float c, float* out, const int size);
+		typedef void (*Unary)(const float* a, float* out, const int size);
+		typedef void (*IntToFloat)(const int* in, const float scale, float* out, const int size);
+		typedef void (*FloatToInt)(const float* in, const float scale, const float limit, int* out, const int size);
+		typedef void (*ComplexTernary)(const float* aReal, const float* aImag, const float* bReal, const float* bImag, 
+									   float* outReal, float* outImag, const int size);
+		typedef void (*SplitRadix)(float* real, float* imag, const float* twiddles, const int quarterSize);
+		
+		Level level;
+		Binary add, subtract, multiply, divide, min, max, clip2;
+		Ternary mulAdd;
+		VectorScalar addScalar, multiplyScalar, multiplyAccumulate;
+		ScalarVector subtractFromScalar, divideScalar;
+		VectorScalarScalar mulAddScalar;
+		Unary neg, abs, squared, cubed, reciprocal, sqrt;
+		IntToFloat intToFloat;
+		FloatToInt floatToInt;
+		ComplexTernary complexMultiplyAccumulate;
+		SplitRadix splitRadixCombine, splitRadixCombineInterleaved;
+	};
+	
+private:
+	static Kernels kernels;
+};
+
+
+#endif // UGEN_SIMD_H
@@ -0,0 +1,249 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_ScratchBlocks.h"
+#include "ugen_UGen.h"
+#include "ugen_UGenInternal.h"
+#include "ugen_BlockPool.h"
+
+/** Assigns block indices to nodes during a simulated pull of a graph. */
+class ScratchBlocks::Allocator
+{
+public:
+	Allocator() throw() : numShared(0) { }
+	
+	void visitRoot(UGenInternal* root) throw()
+	{
+		visitSubtree(root);
+	}
+	
+	void assign(ScratchBlocks* scratchBlocks) throw()
+	{
+		for(int i = 0; i < nodes.size(); i++)
+			nodes[i]->getOutputRef().useScratchBlock(scratchBlocks, nodeBlocks[i]);
+	}
+	
+	inline int getNumBlocks() const throw() { return inUse.size(); }
+	inline int getNumShared() const throw() { return numShared; }
+	
+private:
+	/** Returns the only internal of an input which can be mapped, or 0. */
+	static UGenInternal* getCandidate(UGen const& input) throw()
+	{
+		// multichannel inputs may be pulled by other channels at other times
+		if(input.numInternalUGens != 1) 
+			return 0;
+		
+		UGenInternal* internal = input.internalUGens[0];
+		
+		if(internal->getRefCount() != 1 || !internal->hasSharableOutput())
+			return 0;
+		
+		// already using something other than its own block
+		if(!internal->getOutputRef().isUsingOwnBlock())
+			return 0;
+		
+		return internal;
+	}
+	
+	int allocate() throw()
+	{
+		for(int i = 0; i < inUse.size(); i++)
+		{
+			if(inUse[i] == 0)
+			{
+				inUse[i] = 1;
+				return i;
+			}
+		}
+		
+		inUse.add(1);
+		return inUse.size() - 1;
+	}
+	
+	void release(const int index) throw()
+	{
+		inUse[index] = 0;
+	}
+	
+	void add(UGenInternal* node, const int index) throw()
+	{
+		nodes.add(node);
+		nodeBlocks.add(index);
+		numShared++;
+	}
+	
+	/** Visits the inputs of node, appending the blocks given to the inputs themselves to childBlocks. */
+	void visitInputs(UGenInternal* node, ObjectArray<int>& childBlocks) throw()
+	{
+		const int numInputs = node->numInputs_;
+		
+		if(node->hasSharableOutput())
+		{
+			// inputs are pulled in order, each input's block is live from when
+			// it is written until this node has run
+			for(int i = 0; i < numInputs; i++)
+			{
+				UGenInternal* child = getCandidate(node->inputs[i]);
+				
+				if(child != 0)
+				{
+					const int index = visitAndAllocate(child);
+					add(child, index);
+					childBlocks.add(index);
+				}
+				else
+				{
+					visitOpaque(node->inputs[i]);
+				}
+			}
+		}
+		else
+		{
+			// the order the inputs are pulled in is unknown (some may not be pulled at all)
+			// so the inputs' blocks must be reserved before any of them are pulled
+			ObjectArray<UGenInternal*> children;
+			
+			for(int i = 0; i < numInputs; i++)
+			{
+				UGenInternal* child = getCandidate(node->inputs[i]);
+				children.add(child);
+				
+				if(child != 0)
+				{
+					const int index = allocate();
+					add(child, index);
+					childBlocks.add(index);
+				}
+			}
+			
+			for(int i = 0; i < numInputs; i++)
+			{
+				if(children[i] != 0)
+					visitSubtree(children[i]);
+				else
+					visitOpaque(node->inputs[i]);
+			}
+		}
+	}
+	
+	/** Visits the inputs of a node then gives it a block, its inputs' blocks are 
+	 released after that so the node never writes over its own inputs. */
+	int visitAndAllocate(UGenInternal* node) throw()
+	{
+		ObjectArray<int> childBlocks;
+		visitInputs(node, childBlocks);
+		
+		const int index = allocate();
+		
+		for(int i = 0; i < childBlocks.size(); i++)
+			release(childBlocks[i]);
+		
+		return index;
+	}
+	
+	void visitSubtree(UGenInternal* node) throw()
+	{
+		ObjectArray<int> childBlocks;
+		visitInputs(node, childBlocks);
+		
+		for(int i = 0; i < childBlocks.size(); i++)
+			release(childBlocks[i]);
+	}
+	
+	/** An input which keeps its own block, its own inputs may still be mapped.
+	 Inputs referenced elsewhere are not followed since they may be pulled at any time. */
+	void visitOpaque(UGen const& input) throw()
+	{
+		if(input.numInternalUGens == 1 && input.internalUGens[0]->getRefCount() == 1)
+			visitSubtree(input.internalUGens[0]);
+	}
+	
+	ObjectArray<UGenInternal*> nodes;
+	ObjectArray<int> nodeBlocks;
+	ObjectArray<int> inUse;
+	int numShared;
+};
+
+int ScratchBlocks::share(UGen const& graph, const int blockSize) throw()
+{
+	ugen_assert(blockSize > 0);
+	
+	Allocator allocator;
+	
+	// each channel of the graph is pulled separately
+	for(unsigned int channel = 0; channel < graph.numInternalUGens; channel++)
+		allocator.visitRoot(graph.internalUGens[channel]);
+	
+	if(allocator.getNumShared() == 0)
+		return 0;
+	
+	ScratchBlocks* scratchBlocks = new ScratchBlocks(allocator.getNumBlocks(), blockSize);
+	allocator.assign(scratchBlocks);
+	scratchBlocks->decrementRefCount();
+	
+	return allocator.getNumShared();
+}
+
+ScratchBlocks::ScratchBlocks(const int numBlocksToAllocate, const int blockSizeToUse) throw()
+:	numBlocks(numBlocksToAllocate),
+	blockSize(blockSizeToUse),
+	blocks(new float*[numBlocks])
+{
+	for(int i = 0; i < numBlocks; i++)
+	{
+		int allocatedSize;
+		blocks[i] = BlockPool::getInstance().allocate(blockSize, allocatedSize);
+		memset(blocks[i], 0, allocatedSize * sizeof(float));
+	}
+}
+
+ScratchBlocks::~ScratchBlocks()
+{
+	for(int i = 0; i < numBlocks; i++)
+		BlockPool::getInstance().free(blocks[i]);
+	
+	delete [] blocks;
+	blocks = 0;
+}
+
+
+END_UGEN_NAMESPACE
@@ -0,0 +1,94 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_SCRATCHBLOCKS_H
+#define UGEN_SCRATCHBLOCKS_H
+
+#include "ugen_SmartPointer.h"
+
+class UGen;
+class UGenInternal;
+
+/** A set of sample blocks shared by the nodes of a UGen graph.
+ 
+ Most nodes in a graph produce a result that is read once by a single consumer
+ during the same block and never again (e.g., the inner terms of 
+ SinOsc::AR(440) * EnvGen::AR(env) * 0.5). share() runs a liveness pass over a graph,
+ in the order the graph will be pulled, and maps the outputs of these nodes onto
+ a small number of blocks, much like a register allocator. The rest of the graph
+ keeps its own output blocks.
+ 
+ Only internals which return true from UGenInternal::hasSharableOutput() and are 
+ referenced by exactly one consumer (i.e., have a reference count of 1) are mapped. 
+ The graph's outputs and anything referenced elsewhere, for example a UGen kept
+ to call getValue() on from a GUI, are left alone. Don't take new references to
+ nodes inside a graph after it has been shared.
+ 
+ Each node using a block holds a reference to the ScratchBlocks so the blocks live
+ as long as the nodes do. A node which is later given a larger block size than the
+ scratch blocks simply goes back to using its own block.
+ 
+ @see UGen::shareOutputBlocks() */
+class ScratchBlocks : public SmartPointer
+{
+public:
+	/** Map the eligible nodes of a graph onto shared blocks.
+	 @param graph		The graph. This must not be being rendered on another thread.
+	 @param blockSize	The largest block size the graph will be rendered with.
+	 @return			The number of nodes now sharing blocks. */
+	static int share(UGen const& graph, const int blockSize) throw();
+	
+	ScratchBlocks(const int numBlocks, const int blockSize) throw();
+	~ScratchBlocks();
+	
+	inline int getNumBlocks() const throw()				{ return numBlocks;			}
+	inline int getBlockSize() const throw()				{ return blockSize;			}
+	inline float* getBlock(const int index) throw()		{ return blocks[index];		}
+	
+private:
+	class Allocator;
+	
+	int numBlocks;
+	int blockSize;
+	float** blocks;
+	
+	ScratchBlocks (const ScratchBlocks&);
+	const ScratchBlocks& operator= (const ScratchBlocks&);
+};
+
+
+#endif // UGEN_SCRATCHBLOCKS_H
@@ -52,7 +52,8 @@ static int allocationCount = 0;
 
 SmartPointer::SmartPointer() throw()
 :	refCount(1),
-	active(true)
+	active(true),
+	nextToDelete(0)
 {		
 #if DEBUG_SmartPointer	
 	printf("+++++++, %p, %d\n", this, ++allocationCount);
@@ -67,35 +68,16 @@ SmartPointer::~SmartPointer()
 	ugen_assert(refCount >= 0);
 }
 
-//#if defined(JUCE_VERSION) || defined(DOXYGEN)
-//void SmartPointer::incrementRefCount()  throw()
-//{	
-//	if(active) atomicIncrement (refCount);
-//}
-//
-//void SmartPointer::decrementRefCount()  throw()
-//{ 
-//	if(active)
-//	{
-//		if ((atomicDecrementAndReturn (refCount) == 0))
-//		{
-//			active = false;
-//			UGen::getDeleter()->deleteInternal(this);
-//		}
-//	}
-//}
-//#else
 void SmartPointer::incrementRefCount()  throw()
 {	
-	if(active) ++refCount; 
+	if(active) atomicIncrement(refCount);
 }
 
 void SmartPointer::decrementRefCount()  throw()
 { 
 	if(active)
 	{
-		--refCount; 
-		if(refCount == 0) 
+		if(atomicDecrement(refCount) == 0) 
 		{
 			active = false;
 			UGen::getDeleter()->deleteInternal(this);
@@ -118,11 +100,9 @@ void SmartPointer::setRefCout(const int newCount) throw()
 	}
 	else
 	{
-		refCount = newCount;
+		atomicSet(refCount, newCount);
 	}
 }
 
-//#endif
-
 
 END_UGEN_NAMESPACE
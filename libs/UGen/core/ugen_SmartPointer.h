@@ -38,8 +38,14 @@
 #ifndef _UGEN_ugen_SmartPointer_H_
 #define _UGEN_ugen_SmartPointer_H_
 
+#include "ugen_Atomic.h"
 
 
+/** A reference counted base class.
+ 
+ The reference count is updated atomically so UGen graphs can be shared between
+ a control thread and the audio thread (e.g., when passed through a LockFreeFifo)
+ without a lock. */
 class SmartPointer
 {
 public:
@@ -62,12 +68,15 @@ public:
 	/// @} <!-- end Miscellaneous -->
 	
 	friend class NullUGenInternal;
+	friend class BackgroundDeleter;
 	
 protected:
-	int refCount;
+	volatile int refCount;
 	bool active : 1;
 	
 private:
+	SmartPointer* nextToDelete; // used by BackgroundDeleter to link pending items without allocating
+	
 	void setRefCout(const int newCount) throw(); 
 	
 	SmartPointer (const SmartPointer&);
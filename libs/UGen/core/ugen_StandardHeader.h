@@ -186,6 +186,10 @@ END_UGEN_NAMESPACE
 	#include <iostream>
 #endif
 
+#ifdef _MSC_VER
+	#include <intrin.h> // for the atomic intrinsics in ugen_Atomic.h
+#endif
+
 #if (defined (_WIN32) || defined (_WIN64))
 	#define snprintf _snprintf
 	#pragma warning(disable : 4244) // loss of precision
@@ -241,6 +245,13 @@ END_UGEN_NAMESPACE
 #include <Accelerate/Accelerate.h>
 #endif
 
+// portable SSE2/AVX2/NEON kernels for the basic operators (see ugen_SIMD.h), define UGEN_NOSIMD to use plain loops
+#if !defined(UGEN_VDSP) && !defined(UGEN_VFP) && !defined(UGEN_NEON) && !defined(UGEN_NOSIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define UGEN_SIMD 1
+	#endif
+#endif
+
 #define UGEN_MAJOR_VERSION      0
 #define UGEN_MINOR_VERSION      1
 #define UGEN_BUILDNUMBER        6
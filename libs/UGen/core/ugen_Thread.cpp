@@ -0,0 +1,246 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "ugen_StandardHeader.h"
+
+#if defined (_WIN32) || defined (_WIN64)
+	#include <windows.h>
+	#include <process.h>
+#else
+	#include <pthread.h>
+	#include <sched.h>
+	#include <unistd.h>
+	#include <time.h>
+	#ifdef __APPLE__
+		#include <mach/mach_time.h>
+	#endif
+#endif
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_Atomic.h"
+#include "ugen_Thread.h"
+
+#if defined (_WIN32) || defined (_WIN64)
+
+static unsigned int __stdcall backgroundThreadEntry(void* userData)
+{
+	BackgroundThread::threadEntryPoint((BackgroundThread*)userData);
+	return 0;
+}
+
+#else
+
+static void* backgroundThreadEntry(void* userData)
+{
+	BackgroundThread::threadEntryPoint((BackgroundThread*)userData);
+	return 0;
+}
+
+#endif
+
+#if defined (_WIN32) || defined (_WIN64)
+
+static volatile int audioThreadIndex = (int)TLS_OUT_OF_INDEXES;
+
+static DWORD getAudioThreadIndex() throw()
+{
+	if(atomicGet(audioThreadIndex) == (int)TLS_OUT_OF_INDEXES)
+	{
+		const DWORD index = TlsAlloc();
+		
+		if(!atomicCompareAndSwap(audioThreadIndex, (int)TLS_OUT_OF_INDEXES, (int)index))
+			TlsFree(index); // another thread got there first
+	}
+	
+	return (DWORD)atomicGet(audioThreadIndex);
+}
+
+#else
+
+static pthread_key_t audioThreadKey;
+static pthread_once_t audioThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+static void createAudioThreadKey()
+{
+	pthread_key_create(&audioThreadKey, 0);
+}
+
+#endif
+
+BackgroundThread::BackgroundThread() throw()
+:	handle(0),
+	shouldExit(0)
+{
+}
+
+BackgroundThread::~BackgroundThread()
+{
+	ugen_assert(handle == 0); // derived classes should have called stopThread()
+	stopThread();
+}
+
+bool BackgroundThread::startThread() throw()
+{
+	if(handle != 0) return true;
+	
+	atomicSet(shouldExit, 0);
+	
+#if defined (_WIN32) || defined (_WIN64)
+	HANDLE thread = (HANDLE)_beginthreadex(0, 0, backgroundThreadEntry, this, 0, 0);
+	
+	if(thread == 0) return false;
+	
+	SetThreadPriority(thread, THREAD_PRIORITY_BELOW_NORMAL);
+	handle = (void*)thread;
+#else
+	pthread_t* thread = new pthread_t;
+	
+	// don't inherit the scheduling of the creating thread in case it is a realtime (audio) thread
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setinheritsched(&attributes, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attributes, SCHED_OTHER);
+	
+	struct sched_param param;
+	param.sched_priority = sched_get_priority_min(SCHED_OTHER);
+	pthread_attr_setschedparam(&attributes, &param);
+	
+	const int result = pthread_create(thread, &attributes, backgroundThreadEntry, this);
+	pthread_attr_destroy(&attributes);
+	
+	if(result != 0)
+	{
+		delete thread;
+		return false;
+	}
+	
+	handle = (void*)thread;
+#endif
+	
+	return true;
+}
+
+void BackgroundThread::stopThread() throw()
+{
+	if(handle == 0) return;
+	
+	atomicSet(shouldExit, 1);
+	
+#if defined (_WIN32) || defined (_WIN64)
+	HANDLE thread = (HANDLE)handle;
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_t* thread = (pthread_t*)handle;
+	pthread_join(*thread, 0);
+	delete thread;
+#endif
+	
+	handle = 0;
+}
+
+void BackgroundThread::sleep(const int milliseconds) throw()
+{
+#if defined (_WIN32) || defined (_WIN64)
+	Sleep(milliseconds);
+#else
+	usleep(milliseconds * 1000);
+#endif
+}
+
+int BackgroundThread::getNumProcessors() throw()
+{
+#if defined (_WIN32) || defined (_WIN64)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const int numProcessors = (int)info.dwNumberOfProcessors;
+#else
+	const int numProcessors = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	
+	return numProcessors > 0 ? numProcessors : 1;
+}
+
+double BackgroundThread::getMillisecondCounterHiRes() throw()
+{
+#if defined (_WIN32) || defined (_WIN64)
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#elif defined(__APPLE__)
+	static mach_timebase_info_data_t timebase = { 0, 0 };
+	
+	if(timebase.denom == 0)
+		mach_timebase_info(&timebase);
+	
+	return (double)mach_absolute_time() * timebase.numer / timebase.denom * 1.0e-6;
+#else
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec * 1000.0 + time.tv_nsec * 1.0e-6;
+#endif
+}
+
+void BackgroundThread::setAudioThread(const bool isAudioThread) throw()
+{
+#if defined (_WIN32) || defined (_WIN64)
+	TlsSetValue(getAudioThreadIndex(), isAudioThread ? (void*)1 : 0);
+#else
+	pthread_once(&audioThreadKeyOnce, createAudioThreadKey);
+	pthread_setspecific(audioThreadKey, isAudioThread ? (void*)1 : 0);
+#endif
+}
+
+bool BackgroundThread::isAudioThread() throw()
+{
+#if defined (_WIN32) || defined (_WIN64)
+	return TlsGetValue(getAudioThreadIndex()) != 0;
+#else
+	pthread_once(&audioThreadKeyOnce, createAudioThreadKey);
+	return pthread_getspecific(audioThreadKey) != 0;
+#endif
+}
+
+void BackgroundThread::threadEntryPoint(BackgroundThread* thread) throw()
+{
+	thread->run();
+}
+
+
+END_UGEN_NAMESPACE
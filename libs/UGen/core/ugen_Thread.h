@@ -0,0 +1,141 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_THREAD_H
+#define UGEN_THREAD_H
+
+#include "ugen_Atomic.h"
+
+/** A minimal portable thread for background work in non-Juce hosts.
+ 
+ Derived classes implement run() which should return soon after threadShouldExit()
+ becomes true. The thread is started with a normal (non-realtime) priority so it
+ never competes with the audio callback. It uses pthreads, or the Win32 API on Windows.
+ 
+ Derived classes must call stopThread() in their destructor since run() may 
+ otherwise still be using the derived class.
+ 
+ @see BackgroundDeleter */
+class BackgroundThread
+{
+public:
+	BackgroundThread() throw();
+	virtual ~BackgroundThread();
+	
+	/** Start the thread. @return true if the thread was started (or was already running). */
+	bool startThread() throw();
+	
+	/** Ask the thread to exit and wait for run() to return. */
+	void stopThread() throw();
+	
+	/** @return true if the thread has been started and not yet stopped. */
+	bool isThreadRunning() const throw()	{ return handle != 0;					}
+	
+	/** run() should check this regularly and return when it becomes true. */
+	bool threadShouldExit() const throw()	{ return atomicGet(shouldExit) != 0;	}
+	
+	/** Suspend the calling thread. */
+	static void sleep(const int milliseconds) throw();
+	
+	/** The number of processors available, e.g., to decide how many threads to split some work over. */
+	static int getNumProcessors() throw();
+	
+	/** A high resolution clock which never goes backwards, e.g., for timing short pieces of work. */
+	static double getMillisecondCounterHiRes() throw();
+	
+	/** Mark the calling thread as one which renders audio (or clear the mark).
+	 Hosts call this from their audio callback, the BlockPool never calls the system 
+	 allocator on a marked thread once UGen::prepareToPlay() has been called. */
+	static void setAudioThread(const bool isAudioThread = true) throw();
+	
+	/** @return true if the calling thread has been marked with setAudioThread(). */
+	static bool isAudioThread() throw();
+	
+	/** @internal Called by the platform thread function. */
+	static void threadEntryPoint(BackgroundThread* thread) throw();
+	
+protected:
+	/** This must be implemented, it is called on the new thread. */
+	virtual void run() = 0;
+	
+private:
+	void* handle;
+	volatile int shouldExit;
+	
+	BackgroundThread (const BackgroundThread&);
+	const BackgroundThread& operator= (const BackgroundThread&);
+};
+
+/** A lock for short sections which are only ever entered off the audio thread (or where
+ the audio thread just tries it once). Waiting threads yield rather than block. */
+class SpinLock
+{
+public:
+	SpinLock() throw() : flag(0) { }
+	
+	inline void enter() throw()
+	{
+		while(!tryEnter()) 
+			BackgroundThread::sleep(0);
+	}
+	
+	inline bool tryEnter() throw()	{ return atomicCompareAndSwap(flag, 0, 1);	}
+	inline void exit() throw()		{ atomicSet(flag, 0);						}
+	
+	/** Holds a SpinLock for its lifetime. */
+	class ScopedLock
+	{
+	public:
+		ScopedLock(SpinLock& lockToUse) throw() : lock(lockToUse)	{ lock.enter();	}
+		~ScopedLock()												{ lock.exit();	}
+		
+	private:
+		SpinLock& lock;
+		
+		ScopedLock (const ScopedLock&);
+		const ScopedLock& operator= (const ScopedLock&);
+	};
+	
+private:
+	volatile int flag;
+	
+	SpinLock (const SpinLock&);
+	const SpinLock& operator= (const SpinLock&);
+};
+
+
+#endif // UGEN_THREAD_H
@@ -0,0 +1,163 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_TripleBuffer.h"
+
+TripleBufferInternal::TripleBufferInternal(const int maximumSizeToUse, const int numChannelsToUse) throw()
+:	maximumSize(maximumSizeToUse < 1 ? 1 : maximumSizeToUse),
+	numChannels(numChannelsToUse < 1 ? 1 : numChannelsToUse),
+	data(new float[NumSlots * numChannels * maximumSize]),
+	shared(1),
+	writeSlot(0),
+	readSlot(2),
+	numPublished(0)
+{
+	memset(data, 0, NumSlots * numChannels * maximumSize * sizeof(float));
+	
+	for(int i = 0; i < NumSlots; i++)
+	{
+		sizes[i] = 0;
+		values1[i] = 0.0;
+		values2[i] = 0;
+	}
+}
+
+TripleBufferInternal::~TripleBufferInternal()
+{
+	delete [] data;
+}
+
+TripleBuffer::TripleBuffer(const int maximumSize, const int numChannels) throw()
+:	SmartPointerContainer<TripleBufferInternal>(new TripleBufferInternal(maximumSize, numChannels))
+{
+}
+
+int TripleBuffer::getMaximumSize() const throw()
+{
+	return isNull() ? 0 : getInternal()->maximumSize;
+}
+
+int TripleBuffer::getNumChannels() const throw()
+{
+	return isNull() ? 0 : getInternal()->numChannels;
+}
+
+float* TripleBuffer::getWriteData(const int channel) throw()
+{
+	TripleBufferInternal* internal = getInternal();
+	ugen_assert(internal != 0);
+	ugen_assert(channel >= 0 && channel < internal->numChannels);
+	
+	return internal->data + (internal->writeSlot * internal->numChannels + channel) * internal->maximumSize;
+}
+
+void TripleBuffer::publish(const int size, const double value1, const int value2) throw()
+{
+	TripleBufferInternal* internal = getInternal();
+	if(internal == 0) return;
+	
+	const int slot = internal->writeSlot;
+	internal->sizes[slot] = size < internal->maximumSize ? size : internal->maximumSize;
+	internal->values1[slot] = value1;
+	internal->values2[slot] = value2;
+	
+	int previous;
+	
+	do 
+	{
+		previous = atomicGet(internal->shared);
+	} 
+	while(atomicCompareAndSwap(internal->shared, previous, slot | TripleBufferInternal::Fresh) == false);
+	
+	internal->writeSlot = previous & ~TripleBufferInternal::Fresh;
+	atomicIncrement(internal->numPublished);
+}
+
+bool TripleBuffer::update() throw()
+{
+	TripleBufferInternal* internal = getInternal();
+	if(internal == 0) return false;
+	
+	int previous;
+	
+	do 
+	{
+		previous = atomicGet(internal->shared);
+		
+		if((previous & TripleBufferInternal::Fresh) == 0)
+			return false;
+	} 
+	while(atomicCompareAndSwap(internal->shared, previous, internal->readSlot) == false);
+	
+	internal->readSlot = previous & ~TripleBufferInternal::Fresh;
+	return true;
+}
+
+const float* TripleBuffer::getReadData(const int channel) const throw()
+{
+	const TripleBufferInternal* internal = getInternal();
+	ugen_assert(internal != 0);
+	ugen_assert(channel >= 0 && channel < internal->numChannels);
+	
+	return internal->data + (internal->readSlot * internal->numChannels + channel) * internal->maximumSize;
+}
+
+int TripleBuffer::getReadSize() const throw()
+{
+	return isNull() ? 0 : getInternal()->sizes[getInternal()->readSlot];
+}
+
+double TripleBuffer::getReadValue1() const throw()
+{
+	return isNull() ? 0.0 : getInternal()->values1[getInternal()->readSlot];
+}
+
+int TripleBuffer::getReadValue2() const throw()
+{
+	return isNull() ? 0 : getInternal()->values2[getInternal()->readSlot];
+}
+
+int TripleBuffer::getNumPublished() const throw()
+{
+	return isNull() ? 0 : atomicGet(getInternal()->numPublished);
+}
+
+END_UGEN_NAMESPACE
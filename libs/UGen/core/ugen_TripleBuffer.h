@@ -0,0 +1,125 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef UGEN_TRIPLEBUFFER_H
+#define UGEN_TRIPLEBUFFER_H
+
+#include "ugen_SmartPointer.h"
+
+/** @internal The shared state of a TripleBuffer. */
+class TripleBufferInternal : public SmartPointer
+{
+public:
+	TripleBufferInternal(const int maximumSize, const int numChannels) throw();
+	~TripleBufferInternal();
+	
+	friend class TripleBuffer;
+	
+private:
+	enum Constants
+	{
+		NumSlots = 3,
+		Fresh = 4		///< Set in the shared index when the writer has published since the reader last looked.
+	};
+	
+	const int maximumSize;
+	const int numChannels;
+	float* const data;
+	int sizes[NumSlots];
+	double values1[NumSlots];
+	int values2[NumSlots];
+	
+	volatile int shared;	// the slot between the two threads, with the Fresh flag
+	int writeSlot;			// only the writer touches this
+	int readSlot;			// only the reader touches this
+	volatile int numPublished;
+};
+
+/** Passes the latest complete frame of multichannel data from one thread to another without locking.
+ 
+ There are three preallocated slots. The writer fills its slot and publish() swaps it with the 
+ shared slot, the reader's update() swaps the shared slot with its own if anything new was published.
+ Neither side waits for the other or allocates so the writer can be the audio thread. The reader 
+ always sees the most recent complete frame, frames it was too slow to read are skipped.
+ 
+ There must be only one writing thread and one reading thread. @see BufferSender */
+class TripleBuffer : public SmartPointerContainer<TripleBufferInternal>
+{
+public:
+	/** A null TripleBuffer. */
+	TripleBuffer() throw() { }
+	
+	/** Allocate the slots for frames of up to maximumSize samples in each channel. */
+	TripleBuffer(const int maximumSize, const int numChannels) throw();
+	
+	int getMaximumSize() const throw();
+	int getNumChannels() const throw();
+	
+	/// @name Writer
+	/// @{
+	
+	/** The writer's slot for a channel, this holds getMaximumSize() samples. */
+	float* getWriteData(const int channel) throw();
+	
+	/** Make the writer's slot the latest frame.
+	 @param size	The number of samples used in each channel.
+	 @param value1	Extra data passed along with the frame, as in BufferReceiver::handleBuffer().
+	 @param value2	Extra data passed along with the frame. */
+	void publish(const int size, const double value1 = 0.0, const int value2 = 0) throw();
+	
+	/// @} <!-- end Writer -->
+	
+	/// @name Reader
+	/// @{
+	
+	/** Take the latest frame if anything has been published since the last call.
+	 @return @c true if the read slot now holds a new frame. */
+	bool update() throw();
+	
+	const float* getReadData(const int channel) const throw();
+	int getReadSize() const throw();
+	double getReadValue1() const throw();
+	int getReadValue2() const throw();
+	
+	/// @} <!-- end Reader -->
+	
+	/** The number of frames published so far, this may be called from any thread. */
+	int getNumPublished() const throw();
+};
+
+
+#endif // UGEN_TRIPLEBUFFER_H
@@ -49,6 +49,7 @@ BEGIN_UGEN_NAMESPACE
 #include "../basics/ugen_Plug.h"
 #include "../basics/ugen_RawInputUGens.h"
 #include "../basics/ugen_WrapFold.h"
+#include "../basics/ugen_FusedExpression.h"
 #include "../basics/ugen_MappingUGens.h"
 #include "../filters/control/ugen_Lag.h"
 #include "../envelopes/ugen_EnvGen.h"
@@ -157,6 +158,21 @@ UGen& UGen::operator= (UGen const& other) throw()
     return *this;
 }
 
+void UGen::swapWith(UGen& other) throw()
+{
+	const int otherUserData = other.userData;
+	const unsigned int otherNumInternalUGens = other.numInternalUGens;
+	UGenInternal** otherInternalUGens = other.internalUGens;
+	
+	other.userData = userData;
+	other.numInternalUGens = numInternalUGens;
+	other.internalUGens = internalUGens;
+	
+	userData = otherUserData;
+	numInternalUGens = otherNumInternalUGens;
+	internalUGens = otherInternalUGens;
+}
+
 UGen::UGen(const float value) throw()
 :	userData(UGen::defaultUserData),
 	numInternalUGens(0),
@@ -830,6 +846,17 @@ bool UGen::isNotNull(const int index) const throw()
 	return ! isNull(index);
 }
 
+bool UGen::shouldBeDeletedNow(const unsigned int blockID) const throw()
+{
+	for(unsigned int i = 0; i < numInternalUGens; i++)
+	{
+		if(internalUGens[i]->shouldBeDeletedNow(blockID))
+			return true;
+	}
+	
+	return false;
+}
+
 bool UGen::isNullKr() const throw()
 {
 	if(isNull())
@@ -1083,6 +1110,16 @@ void UGen::setOutputs(float** block, const int blockSize, const int numChannels)
 	}
 }
 
+int UGen::fuse() throw()
+{
+	return FusedExpressionUGenInternal::fuse(*this);
+}
+
+int UGen::shareOutputBlocks(const int maxBlockSize) throw()
+{
+	return ScratchBlocks::share(*this, maxBlockSize > 0 ? maxBlockSize : estimatedSamplesPerBlock_);
+}
+
 bool UGen::setInput(const float* block, const int blockSize, const int channel) throw()
 {	
 	if(block == 0 || channel < 0 || (unsigned int)channel >= numInternalUGens) return false;
@@ -1557,6 +1594,8 @@ void UGen::prepareToPlay(const double sampleRate, const int estimatedSamplesPerB
 	if(estimatedSamplesPerBlock > 0)
 		estimatedSamplesPerBlock_ = estimatedSamplesPerBlock;
 	
+	BlockPool::getInstance().prepare(estimatedSamplesPerBlock_);
+	
 	if(newControlRateBlockSize > 0)
 		controlRateBlockSize = newControlRateBlockSize;
 }
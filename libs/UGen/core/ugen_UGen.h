@@ -262,6 +262,11 @@ public:
 	/** Assignment operator. */
 	UGen& operator= (UGen const& other) throw();
 	
+	/** Exchange the internals with another UGen.
+	 Unlike assignment this doesn't allocate or change any reference counts so it is safe
+	 on the audio thread, e.g., to move a UGen made on another thread into a UGenArray. */
+	void swapWith(UGen& other) throw();
+	
 	/** Scalar UGen. A UGen which generates a constant float value. 
 	 @param value	The float value to use. */
 	UGen(const float value) throw();
@@ -587,6 +592,12 @@ public:
 	/** Tests whether the UGen is null AND is control rate. */
 	bool isNullKr() const throw();
 	
+	/** Tests whether a DoneAction has scheduled this UGen for deletion.
+	 Arrays holding it will replace it with a null UGen when they are next prepared, this lets 
+	 other references to the same graph (e.g., a voice pool) see that it has finished.
+	 @param blockID		The block about to be rendered. */
+	bool shouldBeDeletedNow(const unsigned int blockID) const throw();
+	
 	/** Tests whether a UGen is a scalar UGen. 
 	 
 	 Scalar UGen classes include constants but also UGen instances created from pointers (where the value pointed
@@ -753,6 +764,32 @@ public:
 	 @param	numChannels	The number of pointers in block. */
 	void setOutputs(float** block, const int blockSize, const int numChannels) throw();
 	
+	/** Evaluate chains of arithmetic operators as single nodes.
+	 
+	 Trees of operators like SinOsc::AR(f) * amp * env + offset are replaced by a 
+	 FusedExpressionUGenInternal which runs all of the operations over small tiles of 
+	 each block rather than writing a whole block for every operator. The output is exactly
+	 the same. Call this once the graph is complete and before shareOutputBlocks() if 
+	 using that. This UGen is modified in place so other copies of it made before calling
+	 this will no longer refer to the same graph.
+	 
+	 @return	The number of fused nodes created.
+	 @see FusedExpressionUGenInternal */
+	int fuse() throw();
+	
+	/** Let the nodes of this graph share a few scratch output blocks.
+	 
+	 Intermediate results which are only read once (e.g., the inner terms of 
+	 SinOsc::AR(440) * EnvGen::AR(env) * 0.5) are mapped onto a small set of shared
+	 blocks rather than each node keeping its own. Call this once the graph is complete
+	 and before it is rendered. Nodes referenced from outside the graph are left alone.
+	 
+	 @param maxBlockSize	The largest block size the graph will be rendered with, 
+							-1 uses the estimated block size from prepareToPlay().
+	 @return				The number of nodes now sharing blocks.
+	 @see ScratchBlocks */
+	int shareOutputBlocks(const int maxBlockSize = -1) throw();
+	
 	/** Attempts to set the input data source of a particular UGenInternal. 
 	 
 	 This only works if the UGen contains RawInputUGenInternal class, usually created
@@ -931,7 +968,10 @@ public:
 	 @param		estimatedSamplesPerBlock	An estimate of the host block size.
 	 @param		newControlRateBlockSize		The control rate block size (default 64). This may be larger or
 											smaller than the hardware block size. A value of -1 leaves the
-											control rate block size as is. */
+											control rate block size as is. 
+	 
+	 This also sets the block size of the BlockPool used for UGenOutput sample data,
+	 reserves its initial blocks and starts the thread which grows it. */
 	static void prepareToPlay(const double sampleRate = 44100.0, const int estimatedSamplesPerBlock = 64, const int newControlRateBlockSize = -1) throw();
 	
 	/** Create a UGen with a number of empty (null) channels.
@@ -1006,6 +1046,7 @@ public:
 	{ 
 		getDeleter()->flush();
 		setDeleter(&defaultDeleter);
+		BlockPool::getInstance().stopGrowing();
 		
 #ifdef JUCE_VERSION
 //		#include "../juce/io/ugen_JuceMIDIInputBroadcaster.h"
@@ -1280,6 +1321,8 @@ protected:
 	
 	
 private:
+	friend class ScratchBlocks;
+	friend class FusedExpressionUGenInternal;
 	
 	void incrementInternals() const throw();
 	void decrementInternals() const throw();
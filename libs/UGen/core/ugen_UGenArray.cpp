@@ -62,27 +62,19 @@ UGenArray::Internal::~Internal() throw()
 
 void UGenArray::Internal::add(UGen const& item) throw()
 {
-	if(allocatedSize > size_)
+	if(allocatedSize <= size_)
 	{
-		array[size_] = item;
-		size_++;
+		// copy the item first in case it is in the array being replaced
+		const UGen copy = item;
+		reallocate(size_ < 2 ? 4 : size_ * 2);
+		array[size_] = copy;
 	}
 	else
 	{
-		UGen *newArray = new UGen[size_ +  1];
-		
-		for(int i = 0; i < size_; i++)
-		{
-			newArray[i] = array[i];
-		}
-		
-		newArray[size_] = item;
-		
-		delete [] array;
-		size_++;
-		array = newArray;
-		allocatedSize = size_;
+		array[size_] = item;
 	}
+	
+	size_++;
 }
 
 void UGenArray::Internal::add(const int numItems, const UGen* items) throw()
@@ -92,32 +84,33 @@ void UGenArray::Internal::add(const int numItems, const UGen* items) throw()
 	
 	const int newSize = size_ +  numItems;
 	
-	if(allocatedSize >= newSize)
+	if(allocatedSize < newSize)
 	{
-		for(int i = size_; i < newSize; i++)
+		if(items >= array && items < array + size_)
 		{
-			array[i] = *items++;
-		}		
-	}
-	else 
-	{
-		UGen *newArray = new UGen[size_ +  numItems];
-		
-		for(int i = 0; i < size_; i++)
-		{
-			newArray[i] = array[i];
-		}
-		
-		for(int i = size_; i < newSize; i++)
-		{
-			newArray[i] = *items++;
+			// adding items from this array to itself
+			UGen *copies = new UGen[numItems];
+			
+			for(int i = 0; i < numItems; i++)
+			{
+				copies[i] = items[i];
+			}
+			
+			reallocate(ugen::max(newSize, size_ * 2));
+			add(numItems, copies);
+			delete [] copies;
+			return;
 		}
 		
-		delete [] array;
-		size_ = newSize;
-		array = newArray;	
-		allocatedSize = size_;
+		reallocate(ugen::max(newSize, size_ * 2));
 	}
+	
+	for(int i = size_; i < newSize; i++)
+	{
+		array[i] = *items++;
+	}
+	
+	size_ = newSize;
 }
 
 void UGenArray::Internal::remove(const int index, const bool reallocate) throw()
@@ -141,6 +134,41 @@ void UGenArray::Internal::remove(const int index, const bool reallocate) throw()
 	}
 }
 
+void UGenArray::Internal::removeSwap(const int index) throw()
+{	
+	if(index < 0 || index >= size_) return;
+	
+	size_--;
+	array[index] = array[size_];
+	array[size_] = UGen::getNull();
+}
+
+void UGenArray::Internal::swapIn(UGen& item) throw()
+{
+	if(allocatedSize <= size_)
+	{
+		add(item);
+		return;
+	}
+	
+	array[size_].swapWith(item);
+	size_++;
+}
+
+void UGenArray::Internal::swapOut(const int index, UGen& removed) throw()
+{
+	if(index < 0 || index >= size_) return;
+	
+	size_--;
+	
+	for(int i = index; i < size_; i++)
+	{
+		array[i].swapWith(array[i+1]);
+	}
+	
+	array[size_].swapWith(removed);
+}
+
 void UGenArray::Internal::removeNulls(const bool reallocate) throw()
 {
 	int numNull = 0;
@@ -202,19 +230,45 @@ void UGenArray::Internal::removeNulls(const bool reallocate) throw()
 
 void UGenArray::Internal::reallocate() throw()
 {
-	if(size_ > 0)
+	if(allocatedSize > size_)
+		reallocate(size_);
+}
+
+void UGenArray::Internal::reserve(const int capacity) throw()
+{
+	if(capacity > allocatedSize)
+		reallocate(capacity);
+}
+
+void UGenArray::Internal::swapStorage(Internal& other) throw()
+{
+	const int otherSize = other.size_;
+	const int otherAllocatedSize = other.allocatedSize;
+	UGen *otherArray = other.array;
+	
+	other.size_ = size_;
+	other.allocatedSize = allocatedSize;
+	other.array = array;
+	
+	size_ = otherSize;
+	allocatedSize = otherAllocatedSize;
+	array = otherArray;
+}
+
+void UGenArray::Internal::reallocate(const int newAllocatedSize) throw()
+{
+	ugen_assert(newAllocatedSize >= size_);
+	
+	UGen *newArray = newAllocatedSize > 0 ? new UGen[newAllocatedSize] : 0;
+	
+	for(int i = 0; i < size_; i++)
 	{
-		UGen *newArray = new UGen[size_];
-		
-		for(int i = 0; i < size_; i++)
-		{
-			newArray[i] = array[i];
-		}
-		
-		delete [] array;
-		array = newArray;
-		allocatedSize = size_;
+		newArray[i] = array[i];
 	}
+	
+	delete [] array;
+	array = newArray;
+	allocatedSize = newAllocatedSize;
 }
 
 void UGenArray::Internal::clear() throw()
@@ -433,6 +487,22 @@ int UGenArray::findMaxNumChannels() const throw()
 	return maxNumChannels;
 }
 
+void UGenArray::reserve(const int capacity) throw()
+{
+	internal->reserve(capacity);
+}
+
+void UGenArray::shrinkToFit() throw()
+{
+	internal->reallocate();
+}
+
+void UGenArray::swapStorage(UGenArray& other) throw()
+{
+	if(internal != other.internal)
+		internal->swapStorage(*other.internal);
+}
+
 void UGenArray::add(UGen const& other) throw()
 {
 	internal->add(other);
@@ -450,6 +520,13 @@ UGen UGenArray::remove(const int index, const bool reallocate) throw()
 	return item;
 }
 
+UGen UGenArray::removeSwap(const int index) throw()
+{
+	UGen item = this->at(index);
+	internal->removeSwap(index);
+	return item;
+}
+
 void UGenArray::removeItem(UGen const& item, const bool reallocate) throw()
 {
 	int index = indexOf(item);
@@ -460,6 +537,22 @@ void UGenArray::removeItem(UGen const& item, const bool reallocate) throw()
 	}
 }
 
+void UGenArray::swapIn(UGen& item) throw()
+{
+	internal->swapIn(item);
+}
+
+bool UGenArray::swapOut(UGen const& item, UGen& removed) throw()
+{
+	const int index = indexOf(item);
+	
+	if(index < 0)
+		return false;
+	
+	internal->swapOut(index, removed);
+	return true;
+}
+
 void UGenArray::removeNulls() throw()
 {
 	internal->removeNulls();
@@ -102,13 +102,19 @@ public:
 		~Internal() throw();
 		
 		inline const int& size() const throw() { return size_; }
+		inline int capacity() const throw() { return allocatedSize; }
 		inline const UGen* getArray() const throw() { return array; }
 		inline UGen* getArray() throw() { return array; }
 		
 		void add(UGen const& item) throw();
 		void add(const int numItems, const UGen* items) throw();
 		void remove(const int index, const bool reallocate) throw();
+		void removeSwap(const int index) throw();
+		void swapIn(UGen& item) throw();
+		void swapOut(const int index, UGen& removed) throw();
 		void removeNulls(const bool reallocate = false) throw();
+		void reserve(const int capacity) throw();
+		void swapStorage(Internal& other) throw();
 		void reallocate() throw();
 		void clear() throw();
 		void clearQuick() throw();
@@ -118,6 +124,8 @@ public:
 		int allocatedSize;
 		UGen* array;
 		
+		void reallocate(const int newAllocatedSize) throw();
+		
 		Internal (const Internal&);
 		const Internal& operator= (const Internal&);
 	};
@@ -157,7 +165,23 @@ public:
 	 @return The maximum number of channels. */
 	int findMaxNumChannels() const throw();
 	
-	/** Adds an item in-place. */
+	/** The number of slots allocated, the array can grow to this size without allocating. */
+	inline int capacity() const throw()				{ return internal->capacity(); }
+	
+	/** Allocate at least this many slots so adding items up to this size doesn't allocate, 
+	 e.g., before the array is used on the audio thread. */
+	void reserve(const int capacity) throw();
+	
+	/** Free any slots beyond the current size. */
+	void shrinkToFit() throw();
+	
+	/** Exchange the items and allocated slots with another UGenArray without allocating. 
+	 Copies of each UGenArray (e.g., the one held by a Mix) see the exchanged items, so a 
+	 larger array can be reserved on another thread and swapped in on the audio thread. */
+	void swapStorage(UGenArray& other) throw();
+	
+	/** Adds an item in-place. 
+	 The allocation grows geometrically so adding N items one at a time is O(N) overall. */
 	void add(UGen const& other) throw();
 	
 	/** Add one or more items in-place. */
@@ -167,9 +191,25 @@ public:
 	 This doesn't reallocate memory, items at the end of the array are set to null. */
 	UGen remove(const int index, const bool reallocate = false) throw();
 	
+	/** Remove an item at the index by moving the last item into its place. 
+	 This is O(1) and doesn't reallocate memory but doesn't keep the order of the items. */
+	UGen removeSwap(const int index) throw();
+	
 	/** Removes a particular UGen from the UGenArray - in-place. */
 	void removeItem(UGen const& item, const bool reallocate = false) throw();
 	
+	/** Add an item by exchanging it with the spare slot after the last item.
+	 The item is left holding the null UGen from that slot. Nothing is allocated or freed 
+	 if there is a slot reserved so this can be used on the audio thread, the item is 
+	 copied into a larger allocation (as add() does) otherwise. */
+	void swapIn(UGen& item) throw();
+	
+	/** Remove a particular UGen by exchanging it with another (normally null) UGen.
+	 The later items are moved down by exchanging them too so nothing is allocated or 
+	 freed, the removed UGen ends up in @c removed to be freed on another thread.
+	 @return @c true if the item was found. */
+	bool swapOut(UGen const& item, UGen& removed) throw();
+	
 	/** Removes all UGen instances which are null - in-place. */
 	void removeNulls() throw();
 	
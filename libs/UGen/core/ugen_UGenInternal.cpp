@@ -49,10 +49,11 @@ BEGIN_UGEN_NAMESPACE
 
 UGenOutput::UGenOutput() throw()
 :	blockSize(UGen::getEstimatedBlockSize()),
-	allocatedBlockSize(blockSize),
-	block(blockSize <= 0 ? 0 : new float[blockSize]),
+	allocatedBlockSize(0),
+	block(blockSize <= 0 ? 0 : BlockPool::getInstance().allocate(blockSize, allocatedBlockSize)),
 	usingExternalOutput(false),
-	externalOutput(0)
+	externalOutput(0),
+	scratchBlocks(0)
 {
 	ugen_assert(blockSize > 0);
 	initValue(0.f);
@@ -60,8 +61,7 @@ UGenOutput::UGenOutput() throw()
 
 UGenOutput::~UGenOutput()
 {
-	if(usingExternalOutput == false)
-		delete [] block;
+	freeBlock();
 	
 	block = 0;
 	blockSize = 0;
@@ -84,10 +84,11 @@ void UGenOutput::useExternalOutput(UGenOutput* externalOutputToUse)
 		if(block)
 			value = block[blockSize-1];
 		
+		freeBlock();
+		
 		usingExternalOutput = false;
 		blockSize = UGen::getEstimatedBlockSize();
-		allocatedBlockSize = blockSize;
-		block = new float[blockSize];
+		block = BlockPool::getInstance().allocate(blockSize, allocatedBlockSize);
 		externalOutput = 0;
 		
 		initValue(value);
@@ -99,8 +100,7 @@ void UGenOutput::useExternalOutput(UGenOutput* externalOutputToUse)
 		if(block)
 			value = block[blockSize-1];
 		
-		if(usingExternalOutput == false)
-			delete [] block;
+		freeBlock();
 		
 		usingExternalOutput = true;
 		block = externalOutputToUse->block;
@@ -123,10 +123,11 @@ void UGenOutput::useExternalOutput(float* externalOutputToUse, const int externa
 		if(block)
 			value = block[blockSize-1];
 		
+		freeBlock();
+		
 		usingExternalOutput = false;
 		blockSize = UGen::getEstimatedBlockSize();
-		allocatedBlockSize = blockSize;
-		block = new float[blockSize];
+		block = BlockPool::getInstance().allocate(blockSize, allocatedBlockSize);
 		externalOutput = 0;
 		
 		initValue(value);
@@ -138,8 +139,7 @@ void UGenOutput::useExternalOutput(float* externalOutputToUse, const int externa
 		if(block)
 			value = block[blockSize-1];
 		
-		if(usingExternalOutput == false)
-			delete [] block;
+		freeBlock();
 		
 		usingExternalOutput = true;
 		block = externalOutputToUse;
@@ -153,6 +153,53 @@ void UGenOutput::useExternalOutput(float* externalOutputToUse, const int externa
 }
 
 
+void UGenOutput::useScratchBlock(ScratchBlocks* scratchBlocksToUse, const int index) throw()
+{
+	ugen_assert(scratchBlocksToUse != 0);
+	ugen_assert(externalOutput == 0);
+	
+	float value = 0.f;
+	
+	if(block)
+		value = block[blockSize-1];
+	
+	scratchBlocksToUse->incrementRefCount();
+	freeBlock();
+	
+	usingExternalOutput = false;
+	scratchBlocks = scratchBlocksToUse;
+	block = scratchBlocks->getBlock(index);
+	allocatedBlockSize = scratchBlocks->getBlockSize();
+	
+	if(blockSize > allocatedBlockSize)
+		blockSize = allocatedBlockSize;
+	
+	initValue(value);
+}
+
+void UGenOutput::useOwnBlock(const int actualBlockSize) throw()
+{
+	freeBlock();
+	
+	blockSize = actualBlockSize;
+	block = BlockPool::getInstance().allocate(blockSize, allocatedBlockSize);
+}
+
+void UGenOutput::freeBlock() throw()
+{
+	if(scratchBlocks != 0)
+	{
+		scratchBlocks->decrementRefCount();
+		scratchBlocks = 0;
+	}
+	else if(usingExternalOutput == false)
+	{
+		BlockPool::getInstance().free(block);
+	}
+	
+	block = 0;
+}
+
 
 //=========================== UGenInternal ==================================
 
@@ -386,19 +433,11 @@ ProxyOwnerUGenInternal::~ProxyOwnerUGenInternal()// throw()
 	//proxies = 0; //can't do this if proxies is **const
 }
 
-//#if defined(JUCE_VERSION) || defined(DOXYGEN)
-//void ProxyOwnerUGenInternal::decrementRefCount() throw()
-//{
-//	atomicDecrement(refCount);
-//	deleteIfOnlyMutualReferencesRemain();
-//}
-//#else
 void ProxyOwnerUGenInternal::decrementRefCount()  throw()
 {
-	refCount--;
+	atomicDecrement(refCount);
 	deleteIfOnlyMutualReferencesRemain();
 }
-//#endif
 
 void ProxyOwnerUGenInternal::deleteIfOnlyMutualReferencesRemain() throw()
 {
@@ -482,23 +521,13 @@ ProxyUGenInternal::~ProxyUGenInternal() throw()
 	// not sure if I should be decrementing ref counts here, I thought I'd checked this though...
 }
 
-//#if defined(JUCE_VERSION) || defined(DOXYGEN)
-//void ProxyUGenInternal::decrementRefCount() throw()
-//{
-//	ugen_assert(refCount > 0);
-//	
-//	atomicDecrement(refCount);
-//	owner_->deleteIfOnlyMutualReferencesRemain();
-//}
-//#else
 void ProxyUGenInternal::decrementRefCount() throw()
 {
 	ugen_assert(refCount > 0);
 	
-	refCount--;
+	atomicDecrement(refCount);
 	owner_->deleteIfOnlyMutualReferencesRemain();
 }
-//#endif
 
 int ProxyUGenInternal::getProxyChannel() throw()					
 { 
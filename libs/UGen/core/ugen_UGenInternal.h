@@ -40,6 +40,8 @@
 
 
 #include "ugen_Arrays.h"
+#include "ugen_BlockPool.h"
+#include "ugen_ScratchBlocks.h"
 
 #ifdef Value // Juce has a Value class too now!
 #undef Value
@@ -65,15 +67,21 @@ public:
 			blockSize = externalOutput->getBlockSize();
 			block = externalOutput->getSampleData();
 		}
+		else if(scratchBlocks != 0)
+		{
+			if(actualBlockSize <= allocatedBlockSize)
+				blockSize = actualBlockSize;
+			else
+				useOwnBlock(actualBlockSize);
+		}
 		else if(!usingExternalOutput)
 		{
 			blockSize = actualBlockSize;
 			
 			if(actualBlockSize > allocatedBlockSize)
 			{		
-				delete [] block;
-				allocatedBlockSize = blockSize;
-				block = new float[allocatedBlockSize];
+				BlockPool::getInstance().free(block);
+				block = BlockPool::getInstance().allocate(blockSize, allocatedBlockSize);
 			}
 		}
 	}
@@ -87,12 +95,20 @@ public:
 	void useExternalOutput(UGenOutput* externalOutputToUse);
 	void useExternalOutput(float* externalOutputToUse, const int externalBlockSize);
 	
+	/** Render into one of a set of blocks shared with other nodes. @see ScratchBlocks */
+	void useScratchBlock(ScratchBlocks* scratchBlocksToUse, const int index) throw();
+	inline bool isUsingOwnBlock() const throw()			{ return !usingExternalOutput && scratchBlocks == 0; }
+	
 private:
+	void useOwnBlock(const int actualBlockSize) throw();
+	void freeBlock() throw();
+	
 	int blockSize;
 	int allocatedBlockSize;
 	float *block;
 	bool usingExternalOutput:1;
 	UGenOutput* externalOutput;
+	ScratchBlocks* scratchBlocks;
 };
 
 
@@ -147,6 +163,14 @@ public:
 	virtual inline bool isConst() const throw()			{ return false;							}
 	virtual inline bool isNull() const throw()			{ return false;							}
 	
+	/** Whether the output block can be shared with other nodes.
+	 
+	 Return true only if processBlock() pulls each input once, in input order, before
+	 writing anything, writes only to this internal's own output and getValue() doesn't 
+	 read the output block (i.e., it is computed from the inputs' values). 
+	 @see ScratchBlocks, UGen::shareOutputBlocks() */
+	virtual bool hasSharableOutput() const throw()		{ return false;							}
+	
 	/// @} <!-- end Tests -->
 	
 	/// @name Rate
@@ -273,6 +297,9 @@ protected:
 	UGenOutput uGenOutput;
 	
 private:
+	friend class ScratchBlocks;
+	friend class FusedExpressionUGenInternal;
+	
 	UGenInternal (const UGenInternal&);
     const UGenInternal& operator= (const UGenInternal&);
 	
@@ -0,0 +1,1330 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#if defined(__APPLE__) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
+	#include <Accelerate/Accelerate.h>
+#endif
+
+#include "../core/ugen_StandardHeader.h"
+
+#ifdef UGEN_FFTW
+	#include <fftw3.h>
+#endif
+
+#ifdef UGEN_PFFFT
+	#include <pffft.h>
+#endif
+
+#ifndef UGEN_NOEXTGPL
+	#include "../fftreal/FFTReal.h"
+#endif
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_FFTEngineInternal.h"
+#include "../core/ugen_SIMD.h"
+#include "../core/ugen_Thread.h"
+
+/** The plans in use and the windows made so far. */
+class FFTPlanCacheEntries
+{
+public:
+	FFTPlanCacheEntries() throw() { }
+	
+	struct Entry
+	{
+		FFTPlanCache::CreateFunction create;
+		int fftSize;
+		FFTPlan* plan;
+		int numUsers;
+	};
+	
+	SpinLock lock;
+	ObjectArray<Entry*> entries;
+	Buffer windows[FFTPlanCache::NumWindowTypes][FFTBackendRegistry::MaximumSizeLog2 + 1];
+};
+
+static FFTPlanCacheEntries& getFFTPlanCacheEntries() throw()
+{
+	static FFTPlanCacheEntries cache;
+	return cache;
+}
+
+const FFTPlan* FFTPlanCache::acquire(CreateFunction create, const int fftSize) throw()
+{
+	ugen_assert(create != 0);
+	ugen_assert(Bits::isPowerOf2(fftSize));
+	
+	FFTPlanCacheEntries& cache = getFFTPlanCacheEntries();
+	SpinLock::ScopedLock scopedLock(cache.lock);
+	
+	for(int i = 0; i < cache.entries.length(); i++)
+	{
+		FFTPlanCacheEntries::Entry* const entry = cache.entries[i];
+		
+		if((entry->create == create) && (entry->fftSize == fftSize))
+		{
+			entry->numUsers++;
+			return entry->plan;
+		}
+	}
+	
+	FFTPlanCacheEntries::Entry* const entry = new FFTPlanCacheEntries::Entry;
+	entry->create = create;
+	entry->fftSize = fftSize;
+	entry->plan = create(fftSize);
+	entry->numUsers = 1;
+	cache.entries.add(entry);
+	
+	return entry->plan;
+}
+
+void FFTPlanCache::release(const FFTPlan* plan) throw()
+{
+	FFTPlanCacheEntries& cache = getFFTPlanCacheEntries();
+	SpinLock::ScopedLock scopedLock(cache.lock);
+	
+	for(int i = 0; i < cache.entries.length(); i++)
+	{
+		FFTPlanCacheEntries::Entry* const entry = cache.entries[i];
+		
+		if(entry->plan == plan)
+		{
+			if(--entry->numUsers == 0)
+			{
+				delete entry->plan;
+				delete entry;
+				cache.entries.remove(i);
+			}
+			
+			return;
+		}
+	}
+	
+	ugen_assertfalse; // not from this cache
+}
+
+Buffer FFTPlanCache::getWindow(const int fftSize, const WindowType type) throw()
+{
+	ugen_assert(Bits::isPowerOf2(fftSize));
+	ugen_assert((type >= 0) && (type < NumWindowTypes));
+	
+	FFTPlanCacheEntries& cache = getFFTPlanCacheEntries();
+	SpinLock::ScopedLock scopedLock(cache.lock);
+	
+	Buffer& window = cache.windows[type][Bits::countTrailingZeros(fftSize)];
+	
+	if(window.size() == 0)
+	{
+		switch(type)
+		{
+			case Hamming:	window = Buffer::hammingWindow(fftSize);	break;
+			case Blackman:	window = Buffer::blackmanWindow(fftSize);	break;
+			case Bartlett:	window = Buffer::bartlettWindow(fftSize);	break;
+			case Triangle:	window = Buffer::triangleWindow(fftSize);	break;
+			default:		window = Buffer::hannWindow(fftSize);		break;
+		}
+	}
+	
+	return window;
+}
+
+/** The tables for a SplitRadixFFTBackend of one size. */
+class SplitRadixFFTPlan : public FFTPlan
+{
+public:
+	SplitRadixFFTPlan(const int fftSize) throw()
+	:	complexSize(fftSize >> 1),
+		order(new int[complexSize]),
+		twiddles(new float[complexSize * 2]), // the passes need 4 + 8 + ... + complexSize
+		unpackCos(new float[complexSize / 2 + 1]),
+		unpackSin(new float[complexSize / 2 + 1])
+	{
+		ugen_assert(complexSize >= 2);
+		
+		// where each sample is when the recursion reaches it
+		int* const visited = new int[complexSize];
+		int count = 0;
+		buildOrder(visited, count, 0, 1, complexSize);
+		
+		for(int i = 0; i < complexSize; i++)
+			order[visited[i]] = i;
+		
+		delete [] visited;
+		
+		// the twiddles for each pass of size n (4, 8, ... complexSize) start at n - 4
+		for(int n = 4; n <= complexSize; n <<= 1)
+		{
+			const int quarterSize = n >> 2;
+			float* const passTwiddles = twiddles + n - 4;
+			
+			for(int k = 0; k < quarterSize; k++)
+			{
+				const double angle = 2.0 * pi * k / n;
+				passTwiddles[k]						= (float)cos(angle);
+				passTwiddles[k + quarterSize]		= (float)-sin(angle);
+				passTwiddles[k + quarterSize * 2]	= (float)cos(3.0 * angle);
+				passTwiddles[k + quarterSize * 3]	= (float)-sin(3.0 * angle);
+			}
+		}
+		
+		for(int k = 0; k <= complexSize / 2; k++)
+		{
+			const double angle = 2.0 * pi * k / fftSize;
+			unpackCos[k] = (float)cos(angle);
+			unpackSin[k] = (float)sin(angle);
+		}
+	}
+	
+	~SplitRadixFFTPlan()
+	{
+		delete [] order;
+		delete [] twiddles;
+		delete [] unpackCos;
+		delete [] unpackSin;
+	}
+	
+	static FFTPlan* create(const int fftSize) throw()
+	{
+		return new SplitRadixFFTPlan(fftSize);
+	}
+	
+	const int complexSize;
+	int* const order;
+	float* const twiddles;
+	float* const unpackCos;
+	float* const unpackSin;
+	
+private:
+	static void buildOrder(int* visited, int& count, const int start, const int stride, const int n) throw()
+	{
+		if(n == 1)
+		{
+			visited[count++] = start;
+		}
+		else if(n == 2)
+		{
+			visited[count++] = start;
+			visited[count++] = start + stride;
+		}
+		else
+		{
+			buildOrder(visited, count, start, stride * 2, n / 2);
+			buildOrder(visited, count, start + stride, stride * 4, n / 4);
+			buildOrder(visited, count, start + stride * 3, stride * 4, n / 4);
+		}
+	}
+};
+
+/** A real FFT done as a complex FFT of half the size followed by a pass separating the 
+ transforms of the even and odd samples.
+ 
+ The complex FFT is a conjugate split-radix decimation in time. The input is scattered once 
+ into the order the recursion visits it so that each sub-transform is contiguous and each 
+ combining pass (which is where nearly all the work is) runs through SIMD::splitRadixCombine(). 
+ The inverse uses the same transform with the real and imaginary parts swapped. */
+class SplitRadixFFTBackend : public FFTBackend
+{
+public:
+	SplitRadixFFTBackend(const int fftSizeToUse) throw()
+	:	FFTBackend(fftSizeToUse),
+		plan(*static_cast<const SplitRadixFFTPlan*> (FFTPlanCache::acquire(SplitRadixFFTPlan::create, fftSizeToUse))),
+		complexSize(fftSizeHalved),
+		order(plan.order),
+		twiddles(plan.twiddles),
+		unpackCos(plan.unpackCos),
+		unpackSin(plan.unpackSin),
+		workReal(new float[complexSize]),
+		workImag(new float[complexSize]),
+		batchReal(0),
+		batchImag(0)
+	{
+	}
+	
+	~SplitRadixFFTBackend()
+	{
+		delete [] workReal;
+		delete [] workImag;
+		delete [] batchReal;
+		delete [] batchImag;
+		FFTPlanCache::release(&plan);
+	}
+	
+	static FFTBackend* create(const int fftSize) throw()
+	{
+		return fftSize >= 4 ? new SplitRadixFFTBackend(fftSize) : 0;
+	}
+	
+	void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer) throw()
+	{
+		// pairs of samples are complex samples
+		for(int i = 0; i < complexSize; i++)
+		{
+			const int index = order[i];
+			workReal[index] = inputBuffer[i * 2];
+			workImag[index] = inputBuffer[i * 2 + 1];
+		}
+		
+		transform(workReal, workImag, complexSize);
+		
+		float* const outputReal = outputBuffer.realp;
+		float* const outputImag = outputBuffer.imagp;
+		
+		outputReal[0] = workReal[0] + workImag[0];
+		outputImag[0] = workReal[0] - workImag[0]; // nyquist
+		
+		for(int k = 1; k <= complexSize / 2; k++)
+		{
+			const int j = complexSize - k;
+			
+			// the transforms of the even and odd samples
+			const float evenReal = 0.5f * (workReal[k] + workReal[j]);
+			const float evenImag = 0.5f * (workImag[k] - workImag[j]);
+			const float oddReal  = 0.5f * (workImag[k] + workImag[j]);
+			const float oddImag  = 0.5f * (workReal[j] - workReal[k]);
+			
+			const float rotatedReal = oddReal * unpackCos[k] + oddImag * unpackSin[k];
+			const float rotatedImag = oddImag * unpackCos[k] - oddReal * unpackSin[k];
+			
+			outputReal[k] = evenReal + rotatedReal;
+			outputImag[k] = evenImag + rotatedImag;
+			outputReal[j] = evenReal - rotatedReal;
+			outputImag[j] = rotatedImag - evenImag;
+		}
+	}
+	
+	void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer) throw()
+	{
+		const float* const inputReal = inputBuffer.realp;
+		const float* const inputImag = inputBuffer.imagp;
+		
+		// rebuild the half size complex spectrum with its real and imaginary parts swapped
+		workImag[order[0]] = inputReal[0] + inputImag[0];
+		workReal[order[0]] = inputReal[0] - inputImag[0];
+		
+		for(int k = 1; k <= complexSize / 2; k++)
+		{
+			const int j = complexSize - k;
+			
+			const float evenReal = inputReal[k] + inputReal[j];
+			const float evenImag = inputImag[k] - inputImag[j];
+			const float diffReal = inputReal[k] - inputReal[j];
+			const float diffImag = inputImag[k] + inputImag[j];
+			const float oddReal = diffReal * unpackCos[k] - diffImag * unpackSin[k];
+			const float oddImag = diffReal * unpackSin[k] + diffImag * unpackCos[k];
+			
+			workImag[order[k]] = evenReal - oddImag;
+			workReal[order[k]] = evenImag + oddReal;
+			workImag[order[j]] = evenReal + oddImag;
+			workReal[order[j]] = oddReal - evenImag;
+		}
+		
+		transform(workReal, workImag, complexSize);
+		
+		for(int i = 0; i < complexSize; i++)
+		{
+			outputBuffer[i * 2]		= workImag[i];
+			outputBuffer[i * 2 + 1] = workReal[i];
+		}
+	}
+	
+	void fftBatch(DSPSplitComplex* const outputBuffers, const float* const* inputBuffers, const int numTransforms) throw()
+	{
+		int first = 0;
+		
+		// only full groups are interleaved, the padding in a part filled group costs more than 
+		// doing the rest one at a time, as is everything if prepareBatch() hasn't been called
+		while((batchReal != 0) && ((numTransforms - first) >= Lanes))
+		{
+			fftInterleaved(outputBuffers + first, inputBuffers + first, Lanes);
+			first += Lanes;
+		}
+		
+		for(; first < numTransforms; first++)
+			fft(outputBuffers[first], inputBuffers[first]);
+	}
+	
+	void ifftBatch(float* const* outputBuffers, DSPSplitComplex const* inputBuffers, const int numTransforms) throw()
+	{
+		int first = 0;
+		
+		while((batchReal != 0) && ((numTransforms - first) >= Lanes))
+		{
+			ifftInterleaved(outputBuffers + first, inputBuffers + first, Lanes);
+			first += Lanes;
+		}
+		
+		for(; first < numTransforms; first++)
+			ifft(outputBuffers[first], inputBuffers[first]);
+	}
+	
+	/** The interleaved working memory is only needed if the batch calls are used. */
+	void prepareBatch() throw()
+	{
+		if(batchReal != 0)
+			return;
+		
+		// another thread may already be using the batch calls, batchReal is the one they check
+		batchImag = new float[complexSize * Lanes];
+		float* const real = new float[complexSize * Lanes];
+		atomicMemoryBarrier();
+		batchReal = real;
+	}
+	
+private:
+	enum Constants
+	{
+		Lanes = SIMD::InterleavedTransforms
+	};
+	
+	/** Transforms up to Lanes signals together, the working arrays hold sample 0 of each
+	 transform, then sample 1 of each and so on. Unused lanes are zeroed and thrown away. */
+	void fftInterleaved(DSPSplitComplex* const outputBuffers, const float* const* inputBuffers, const int numLanes) throw()
+	{
+		for(int lane = 0; lane < Lanes; lane++)
+		{
+			if(lane < numLanes)
+			{
+				const float* const inputBuffer = inputBuffers[lane];
+				
+				for(int i = 0; i < complexSize; i++)
+				{
+					const int index = order[i] * Lanes + lane;
+					batchReal[index] = inputBuffer[i * 2];
+					batchImag[index] = inputBuffer[i * 2 + 1];
+				}
+			}
+			else
+			{
+				for(int i = 0; i < complexSize; i++)
+					batchReal[i * Lanes + lane] = batchImag[i * Lanes + lane] = 0.f;
+			}
+		}
+		
+		transformInterleaved(batchReal, batchImag, complexSize);
+		
+		for(int lane = 0; lane < numLanes; lane++)
+		{
+			const float* const real = batchReal + lane;
+			const float* const imag = batchImag + lane;
+			float* const outputReal = outputBuffers[lane].realp;
+			float* const outputImag = outputBuffers[lane].imagp;
+			
+			outputReal[0] = real[0] + imag[0];
+			outputImag[0] = real[0] - imag[0];
+			
+			for(int k = 1; k <= complexSize / 2; k++)
+			{
+				const int j = complexSize - k;
+				const float realK = real[k * Lanes], imagK = imag[k * Lanes];
+				const float realJ = real[j * Lanes], imagJ = imag[j * Lanes];
+				
+				const float evenReal = 0.5f * (realK + realJ);
+				const float evenImag = 0.5f * (imagK - imagJ);
+				const float oddReal  = 0.5f * (imagK + imagJ);
+				const float oddImag  = 0.5f * (realJ - realK);
+				
+				const float rotatedReal = oddReal * unpackCos[k] + oddImag * unpackSin[k];
+				const float rotatedImag = oddImag * unpackCos[k] - oddReal * unpackSin[k];
+				
+				outputReal[k] = evenReal + rotatedReal;
+				outputImag[k] = evenImag + rotatedImag;
+				outputReal[j] = evenReal - rotatedReal;
+				outputImag[j] = rotatedImag - evenImag;
+			}
+		}
+	}
+	
+	void ifftInterleaved(float* const* outputBuffers, DSPSplitComplex const* inputBuffers, const int numLanes) throw()
+	{
+		for(int lane = 0; lane < Lanes; lane++)
+		{
+			float* const real = batchReal + lane;
+			float* const imag = batchImag + lane;
+			
+			if(lane < numLanes)
+			{
+				const float* const inputReal = inputBuffers[lane].realp;
+				const float* const inputImag = inputBuffers[lane].imagp;
+				
+				imag[order[0] * Lanes] = inputReal[0] + inputImag[0];
+				real[order[0] * Lanes] = inputReal[0] - inputImag[0];
+				
+				for(int k = 1; k <= complexSize / 2; k++)
+				{
+					const int j = complexSize - k;
+					
+					const float evenReal = inputReal[k] + inputReal[j];
+					const float evenImag = inputImag[k] - inputImag[j];
+					const float diffReal = inputReal[k] - inputReal[j];
+					const float diffImag = inputImag[k] + inputImag[j];
+					const float oddReal = diffReal * unpackCos[k] - diffImag * unpackSin[k];
+					const float oddImag = diffReal * unpackSin[k] + diffImag * unpackCos[k];
+					
+					imag[order[k] * Lanes] = evenReal - oddImag;
+					real[order[k] * Lanes] = evenImag + oddReal;
+					imag[order[j] * Lanes] = evenReal + oddImag;
+					real[order[j] * Lanes] = oddReal - evenImag;
+				}
+			}
+			else
+			{
+				for(int i = 0; i < complexSize; i++)
+					real[i * Lanes] = imag[i * Lanes] = 0.f;
+			}
+		}
+		
+		transformInterleaved(batchReal, batchImag, complexSize);
+		
+		for(int lane = 0; lane < numLanes; lane++)
+		{
+			float* const outputBuffer = outputBuffers[lane];
+			
+			for(int i = 0; i < complexSize; i++)
+			{
+				outputBuffer[i * 2]		= batchImag[i * Lanes + lane];
+				outputBuffer[i * 2 + 1] = batchReal[i * Lanes + lane];
+			}
+		}
+	}
+	
+	/** transform() for Lanes interleaved transforms. */
+	void transformInterleaved(float* real, float* imag, const int n) const throw()
+	{
+		if(n == 2)
+		{
+			for(int lane = 0; lane < Lanes; lane++)
+			{
+				const float r0 = real[lane], i0 = imag[lane];
+				real[lane] = r0 + real[Lanes + lane];	imag[lane] = i0 + imag[Lanes + lane];
+				real[Lanes + lane] = r0 - real[Lanes + lane];	imag[Lanes + lane] = i0 - imag[Lanes + lane];
+			}
+		}
+		else if(n >= 4)
+		{
+			const int halfSize = n >> 1;
+			const int quarterSize = n >> 2;
+			
+			transformInterleaved(real, imag, halfSize);
+			transformInterleaved(real + halfSize * Lanes, imag + halfSize * Lanes, quarterSize);
+			transformInterleaved(real + (halfSize + quarterSize) * Lanes, imag + (halfSize + quarterSize) * Lanes, quarterSize);
+			
+			SIMD::splitRadixCombineInterleaved(real, imag, twiddles + n - 4, quarterSize);
+		}
+	}
+	
+	void transform(float* real, float* imag, const int n) const throw()
+	{
+		if(n == 2)
+		{
+			const float r0 = real[0], i0 = imag[0];
+			real[0] = r0 + real[1];	imag[0] = i0 + imag[1];
+			real[1] = r0 - real[1];	imag[1] = i0 - imag[1];
+		}
+		else if(n == 4)
+		{
+			const float sr = real[0] + real[1], si = imag[0] + imag[1];
+			const float dr = real[0] - real[1], di = imag[0] - imag[1];
+			const float ar = real[2] + real[3], ai = imag[2] + imag[3];
+			const float br = real[2] - real[3], bi = imag[2] - imag[3];
+			real[0] = sr + ar;	imag[0] = si + ai;
+			real[2] = sr - ar;	imag[2] = si - ai;
+			real[1] = dr + bi;	imag[1] = di - br;
+			real[3] = dr - bi;	imag[3] = di + br;
+		}
+		else if(n > 4)
+		{
+			const int halfSize = n >> 1;
+			const int quarterSize = n >> 2;
+			
+			transform(real, imag, halfSize);
+			transform(real + halfSize, imag + halfSize, quarterSize);
+			transform(real + halfSize + quarterSize, imag + halfSize + quarterSize, quarterSize);
+			
+			SIMD::splitRadixCombine(real, imag, twiddles + n - 4, quarterSize);
+		}
+	}
+	
+	const SplitRadixFFTPlan& plan;
+	const int complexSize;
+	const int* const order;
+	const float* const twiddles;
+	const float* const unpackCos;
+	const float* const unpackSin;
+	float* const workReal;
+	float* const workImag;
+	float* batchReal;
+	float* batchImag;
+};
+
+#ifndef UGEN_NOEXTGPL
+
+/** FFTReal, which is in the source tree. Its output is already packed but the imaginary parts 
+ have the opposite sign to vDSP and FFTW. Its tables can't be shared since each FFTReal 
+ object also holds the working memory it needs. */
+class FFTRealFFTBackend : public FFTBackend
+{
+public:
+	FFTRealFFTBackend(const int fftSizeToUse) throw()
+	:	FFTBackend(fftSizeToUse),
+		fftReal(fftSizeToUse),
+		transformBuffer(new float[fftSizeToUse])
+	{
+	}
+	
+	~FFTRealFFTBackend()
+	{
+		delete [] transformBuffer;
+	}
+	
+	static FFTBackend* create(const int fftSize) throw()
+	{
+		return fftSize >= 4 ? new FFTRealFFTBackend(fftSize) : 0;
+	}
+	
+	void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer) throw()
+	{
+		fftReal.do_fft(transformBuffer, inputBuffer);
+		memcpy(outputBuffer.realp, transformBuffer, fftSizeHalved * sizeof(float));
+		outputBuffer.imagp[0] = transformBuffer[fftSizeHalved];
+		SIMD::neg(transformBuffer + fftSizeHalved + 1, outputBuffer.imagp + 1, fftSizeHalved - 1);
+	}
+	
+	void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer) throw()
+	{
+		memcpy(transformBuffer, inputBuffer.realp, fftSizeHalved * sizeof(float));
+		transformBuffer[fftSizeHalved] = inputBuffer.imagp[0];
+		SIMD::neg(inputBuffer.imagp + 1, transformBuffer + fftSizeHalved + 1, fftSizeHalved - 1);
+		fftReal.do_ifft(transformBuffer, outputBuffer);
+	}
+	
+private:
+	FFTReal<float> fftReal;
+	float* const transformBuffer;
+};
+
+#endif // UGEN_NOEXTGPL
+
+#ifdef UGEN_FFTW
+
+/** FFTW plans can be executed on other arrays (with the same alignment) from any thread, 
+ it's only making them that isn't thread safe. */
+class FFTWFFTPlan : public FFTPlan
+{
+public:
+	FFTWFFTPlan(const int fftSize) throw()
+	{
+		float* const buffer = (float*)fftwf_malloc((fftSize + 2) * sizeof(float));
+		fftwPlan = fftwf_plan_dft_r2c_1d(fftSize, buffer, (fftwf_complex*)buffer, FFTW_ESTIMATE);
+		ifftwPlan = fftwf_plan_dft_c2r_1d(fftSize, (fftwf_complex*)buffer, buffer, FFTW_ESTIMATE);
+		fftwf_free(buffer);
+	}
+	
+	~FFTWFFTPlan()
+	{
+		fftwf_destroy_plan(fftwPlan);
+		fftwf_destroy_plan(ifftwPlan);
+	}
+	
+	static FFTPlan* create(const int fftSize) throw()
+	{
+		return new FFTWFFTPlan(fftSize);
+	}
+	
+	fftwf_plan fftwPlan, ifftwPlan;
+};
+
+class FFTWFFTBackend : public FFTBackend
+{
+public:
+	FFTWFFTBackend(const int fftSizeToUse) throw()
+	:	FFTBackend(fftSizeToUse),
+		plan(*static_cast<const FFTWFFTPlan*> (FFTPlanCache::acquire(FFTWFFTPlan::create, fftSizeToUse))),
+		transformBuffer((float*)fftwf_malloc((fftSizeToUse + 2) * sizeof(float)))
+	{
+	}
+	
+	~FFTWFFTBackend()
+	{
+		fftwf_free(transformBuffer);
+		FFTPlanCache::release(&plan);
+	}
+	
+	static FFTBackend* create(const int fftSize) throw()
+	{
+		return new FFTWFFTBackend(fftSize);
+	}
+	
+	void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer) throw()
+	{
+		memcpy(transformBuffer, inputBuffer, fftSize * sizeof(float));
+		fftwf_execute_dft_r2c(plan.fftwPlan, transformBuffer, (fftwf_complex*)transformBuffer);
+		
+		const float nyquist = transformBuffer[fftSize]; // remember nyquist val
+		const float *interleavedSamples = transformBuffer;
+		
+		// deinterleave
+		for(int j = 0; j < fftSizeHalved; j++)
+		{
+			outputBuffer.realp[j] = *interleavedSamples++;
+			outputBuffer.imagp[j] = *interleavedSamples++;
+		}
+		
+		outputBuffer.imagp[0] = nyquist; // pack nyquist in
+	}
+	
+	void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer) throw()
+	{
+		float *interleavedSamples = transformBuffer;
+		
+		for(int j = 0; j < fftSizeHalved; j++)
+		{
+			*interleavedSamples++ = inputBuffer.realp[j];
+			*interleavedSamples++ = inputBuffer.imagp[j];
+		}
+		
+		transformBuffer[fftSize  ] = transformBuffer[1]; // nyquist
+		transformBuffer[fftSize+1] = 0.f; // nyquist imag always zero
+		transformBuffer[1        ] = 0.f; // DC imag always zero
+		
+		fftwf_execute_dft_c2r(plan.ifftwPlan, (fftwf_complex*)transformBuffer, transformBuffer);
+		memcpy(outputBuffer, transformBuffer, fftSize * sizeof(float));
+	}
+	
+private:
+	const FFTWFFTPlan& plan;
+	float* const transformBuffer;
+};
+
+#endif // UGEN_FFTW
+
+#ifdef UGEN_PFFFT
+
+/** A PFFFT setup is read only once it's made so it can be shared between threads. */
+class PFFFTFFTPlan : public FFTPlan
+{
+public:
+	PFFFTFFTPlan(const int fftSize) throw()
+	:	setup(pffft_new_setup(fftSize, PFFFT_REAL))
+	{
+	}
+	
+	~PFFFTFFTPlan()
+	{
+		pffft_destroy_setup(setup);
+	}
+	
+	static FFTPlan* create(const int fftSize) throw()
+	{
+		return new PFFFTFFTPlan(fftSize);
+	}
+	
+	PFFFT_Setup* const setup;
+};
+
+/** PFFFT's ordered real output is interleaved with the nyquist bin in the second place. */
+class PFFFTFFTBackend : public FFTBackend
+{
+public:
+	PFFFTFFTBackend(const int fftSizeToUse) throw()
+	:	FFTBackend(fftSizeToUse),
+		plan(*static_cast<const PFFFTFFTPlan*> (FFTPlanCache::acquire(PFFFTFFTPlan::create, fftSizeToUse))),
+		transformBuffer((float*)pffft_aligned_malloc(fftSizeToUse * sizeof(float))),
+		workBuffer((float*)pffft_aligned_malloc(fftSizeToUse * sizeof(float)))
+	{
+	}
+	
+	~PFFFTFFTBackend()
+	{
+		pffft_aligned_free(workBuffer);
+		pffft_aligned_free(transformBuffer);
+		FFTPlanCache::release(&plan);
+	}
+	
+	static FFTBackend* create(const int fftSize) throw()
+	{
+		return fftSize >= 32 ? new PFFFTFFTBackend(fftSize) : 0; // the smallest real size it supports
+	}
+	
+	void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer) throw()
+	{
+		memcpy(transformBuffer, inputBuffer, fftSize * sizeof(float));
+		pffft_transform_ordered(plan.setup, transformBuffer, transformBuffer, workBuffer, PFFFT_FORWARD);
+		
+		for(int j = 0; j < fftSizeHalved; j++)
+		{
+			outputBuffer.realp[j] = transformBuffer[j * 2];
+			outputBuffer.imagp[j] = transformBuffer[j * 2 + 1];
+		}
+	}
+	
+	void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer) throw()
+	{
+		for(int j = 0; j < fftSizeHalved; j++)
+		{
+			transformBuffer[j * 2]		= inputBuffer.realp[j];
+			transformBuffer[j * 2 + 1]	= inputBuffer.imagp[j];
+		}
+		
+		pffft_transform_ordered(plan.setup, transformBuffer, transformBuffer, workBuffer, PFFFT_BACKWARD);
+		memcpy(outputBuffer, transformBuffer, fftSize * sizeof(float));
+	}
+	
+private:
+	const PFFFTFFTPlan& plan;
+	float* const transformBuffer;
+	float* const workBuffer;
+};
+
+#endif // UGEN_PFFFT
+
+#ifdef UGEN_VDSP
+
+/** vDSP FFT setups only hold tables so they can be shared between threads. */
+class VDSPFFTPlan : public FFTPlan
+{
+public:
+	VDSPFFTPlan(const int fftSize) throw()
+	:	fftSizeLog2((int)Bits::countTrailingZeros(fftSize)),
+		fftvDSP(vDSP_create_fftsetup(fftSizeLog2, 0))
+	{
+	}
+	
+	~VDSPFFTPlan()
+	{
+		vDSP_destroy_fftsetup(fftvDSP);
+	}
+	
+	static FFTPlan* create(const int fftSize) throw()
+	{
+		return new VDSPFFTPlan(fftSize);
+	}
+	
+	const int fftSizeLog2;
+	FFTSetup fftvDSP;
+};
+
+class VDSPFFTBackend : public FFTBackend
+{
+public:
+	VDSPFFTBackend(const int fftSizeToUse) throw()
+	:	FFTBackend(fftSizeToUse),
+		plan(*static_cast<const VDSPFFTPlan*> (FFTPlanCache::acquire(VDSPFFTPlan::create, fftSizeToUse))),
+		transformBuffer(new float[fftSizeToUse])
+	{
+		transformBufferSplit.realp = transformBuffer;
+		transformBufferSplit.imagp = transformBuffer + fftSizeHalved;
+	}
+	
+	~VDSPFFTBackend()
+	{
+		delete [] transformBuffer;
+		FFTPlanCache::release(&plan);
+	}
+	
+	static FFTBackend* create(const int fftSize) throw()
+	{
+		return new VDSPFFTBackend(fftSize);
+	}
+	
+	void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer) throw()
+	{
+		static float scale = 0.5f;
+		vDSP_vsmul(inputBuffer, 1, &scale, transformBuffer, 1, fftSize);
+		vDSP_ctoz ((COMPLEX *) transformBuffer, 2, &outputBuffer, 1, fftSizeHalved);
+		vDSP_fft_zrip (plan.fftvDSP, &outputBuffer, 1, plan.fftSizeLog2, FFT_FORWARD);
+	}
+	
+	void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer) throw()
+	{
+		memcpy(transformBufferSplit.realp, inputBuffer.realp, fftSizeHalved * sizeof(float));
+		memcpy(transformBufferSplit.imagp, inputBuffer.imagp, fftSizeHalved * sizeof(float));
+		vDSP_fft_zrip (plan.fftvDSP, &transformBufferSplit, 1, plan.fftSizeLog2, FFT_INVERSE);
+		vDSP_ztoc (&transformBufferSplit, 1, (COMPLEX *) outputBuffer, 2, fftSizeHalved);
+	}
+	
+private:
+	const VDSPFFTPlan& plan;
+	float* const transformBuffer;
+	DSPSplitComplex transformBufferSplit;
+};
+
+#endif // UGEN_VDSP
+
+/** The registered types and the choices made for each size. */
+class FFTBackendTypes
+{
+public:
+	FFTBackendTypes() throw()
+	:	numTypes(0),
+		forcedType(-1),
+		savesPlans(false)
+	{
+		for(int i = 0; i <= FFTBackendRegistry::MaximumSizeLog2; i++)
+			choices[i] = -1;
+		
+		// the first which supports a size is used until that size has been timed (see warmUp())
+#ifdef UGEN_VDSP
+		add("vDSP", VDSPFFTBackend::create);
+#endif
+#ifdef UGEN_FFTW
+		add("FFTW", FFTWFFTBackend::create);
+#endif
+#ifdef UGEN_PFFFT
+		add("PFFFT", PFFFTFFTBackend::create);
+#endif
+		add("SplitRadix", SplitRadixFFTBackend::create);
+#ifndef UGEN_NOEXTGPL
+		add("FFTReal", FFTRealFFTBackend::create);
+#endif
+	}
+	
+	bool add(const char* name, FFTBackendRegistry::CreateFunction create) throw()
+	{
+		if((numTypes >= FFTBackendRegistry::MaximumTypes) || (indexOf(name) >= 0))
+			return false;
+		
+		strncpy(names[numTypes], name, FFTBackendRegistry::MaximumNameLength - 1);
+		names[numTypes][FFTBackendRegistry::MaximumNameLength - 1] = '\0';
+		creators[numTypes] = create;
+		numTypes++;
+		
+		return true;
+	}
+	
+	int indexOf(const char* name) const throw()
+	{
+		for(int i = 0; i < numTypes; i++)
+			if(strcmp(names[i], name) == 0)
+				return i;
+		
+		return -1;
+	}
+	
+	/** Time the first numTypesToTry types, without the lock since types are only ever appended. 
+	 @return The index of the fastest type which supports this size. */
+	int measure(const int fftSize, const int numTypesToTry) const throw()
+	{
+		enum { NumTrials = 3 };
+		
+		const double minimumTrialTime = 0.5; // ms
+		
+		float* const input = new float[fftSize];
+		float* const output = new float[fftSize];
+		DSPSplitComplex spectrum = { output, output + fftSize / 2 };
+		
+		for(int i = 0; i < fftSize; i++)
+			input[i] = (float)sin(i * 0.1) * 0.5f;
+		
+		int fastest = -1;
+		double fastestTime = 0.0;
+		
+		for(int type = 0; type < numTypesToTry; type++)
+		{
+			FFTBackend* const backend = creators[type](fftSize);
+			
+			if(backend == 0) 
+				continue;
+			
+			// warm up then find the best time per transform pair
+			backend->fft(spectrum, input);
+			backend->ifft(output, spectrum);
+			
+			double bestTime = 0.0;
+			
+			for(int trial = 0; trial < NumTrials; trial++)
+			{
+				int numTransforms = 0;
+				const double start = BackgroundThread::getMillisecondCounterHiRes();
+				double elapsed = 0.0;
+				
+				do 
+				{
+					backend->fft(spectrum, input);
+					backend->ifft(output, spectrum);
+					numTransforms++;
+					elapsed = BackgroundThread::getMillisecondCounterHiRes() - start;
+				} while(elapsed < minimumTrialTime);
+				
+				const double time = elapsed / numTransforms;
+				
+				if((trial == 0) || (time < bestTime))
+					bestTime = time;
+			}
+			
+			delete backend;
+			
+			if((fastest < 0) || (bestTime < fastestTime))
+			{
+				fastest = type;
+				fastestTime = bestTime;
+			}
+		}
+		
+		delete [] input;
+		delete [] output;
+		
+		return fastest;
+	}
+	
+	/** Write a copy of the choices taken with the lock held, the file is written without it. */
+	bool save(const char* path, const int* choicesToSave) const throw()
+	{
+		FILE* file = fopen(path, "w");
+		
+		if(file == 0)
+		{
+			printf("FFTBackendRegistry: can't write the plan file %s\n", path);
+			return false;
+		}
+		
+		fprintf(file, "# UGen++ FFT plans: size backend\n");
+		
+		for(int i = 0; i <= FFTBackendRegistry::MaximumSizeLog2; i++)
+			if(choicesToSave[i] >= 0)
+				fprintf(file, "%d %s\n", 1 << i, names[choicesToSave[i]]);
+		
+		fclose(file);
+		return true;
+	}
+	
+	/** Read a plan file into loadedChoices (-1 for sizes it doesn't mention), without the lock. */
+	bool load(const char* path, int* loadedChoices) const throw()
+	{
+		for(int i = 0; i <= FFTBackendRegistry::MaximumSizeLog2; i++)
+			loadedChoices[i] = -1;
+		
+		FILE* file = fopen(path, "r");
+		
+		if(file == 0)
+			return false;
+		
+		char line[256];
+		
+		while(fgets(line, sizeof(line), file) != 0)
+		{
+			int fftSize;
+			char name[FFTBackendRegistry::MaximumNameLength];
+			
+			if((line[0] == '#') || (sscanf(line, "%d %31s", &fftSize, name) != 2))
+				continue;
+			
+			const int type = indexOf(name);
+			
+			if((type >= 0) && (fftSize > 0) && Bits::isPowerOf2(fftSize))
+				loadedChoices[(int)Bits::countTrailingZeros(fftSize)] = type;
+		}
+		
+		fclose(file);
+		return true;
+	}
+	
+	SpinLock lock;
+	int numTypes;
+	char names[FFTBackendRegistry::MaximumTypes][FFTBackendRegistry::MaximumNameLength];
+	FFTBackendRegistry::CreateFunction creators[FFTBackendRegistry::MaximumTypes];
+	int choices[FFTBackendRegistry::MaximumSizeLog2 + 1];
+	int forcedType;
+	Text planFile;
+	bool savesPlans;
+};
+
+static FFTBackendTypes& getFFTBackendTypes() throw()
+{
+	static FFTBackendTypes types;
+	return types;
+}
+
+static inline int getSizeLog2(const int fftSize) throw()
+{
+	ugen_assert(Bits::isPowerOf2(fftSize));
+	return (int)Bits::countTrailingZeros(fftSize);
+}
+
+/** Times the types on a size and records the fastest, the lock is only held to read and write the choice. */
+static int chooseType(FFTBackendTypes& types, const int fftSize) throw()
+{
+	int numTypes;
+	
+	{
+		SpinLock::ScopedLock scopedLock(types.lock);
+		numTypes = types.numTypes;
+	}
+	
+	const int type = types.measure(fftSize, numTypes);
+	
+	SpinLock::ScopedLock scopedLock(types.lock);
+	types.choices[getSizeLog2(fftSize)] = type;
+	
+	return type;
+}
+
+/** Writes the choices to the plan file set by setPlanFile(), if there is one. */
+static void savePlanFile(FFTBackendTypes& types) throw()
+{
+	int choices[FFTBackendRegistry::MaximumSizeLog2 + 1];
+	Text path;
+	
+	{
+		SpinLock::ScopedLock scopedLock(types.lock);
+		
+		if(!types.savesPlans)
+			return;
+		
+		memcpy(choices, types.choices, sizeof(choices));
+		path = types.planFile;
+	}
+	
+	types.save(path.getArray(), choices);
+}
+
+bool FFTBackendRegistry::addType(const char* name, CreateFunction create) throw()
+{
+	ugen_assert(name != 0);
+	ugen_assert(create != 0);
+	
+	FFTBackendTypes& types = getFFTBackendTypes();
+	SpinLock::ScopedLock scopedLock(types.lock);
+	
+	return types.add(name, create);
+}
+
+int FFTBackendRegistry::getNumTypes() throw()
+{
+	FFTBackendTypes& types = getFFTBackendTypes();
+	SpinLock::ScopedLock scopedLock(types.lock);
+	
+	return types.numTypes;
+}
+
+const char* FFTBackendRegistry::getTypeName(const int index) throw()
+{
+	FFTBackendTypes& types = getFFTBackendTypes();
+	SpinLock::ScopedLock scopedLock(types.lock);
+	
+	return (index >= 0) && (index < types.numTypes) ? types.names[index] : 0;
+}
+
+FFTBackend* FFTBackendRegistry::create(const int fftSize) throw()
+{
+	FFTBackendTypes& types = getFFTBackendTypes();
+	
+	int forcedType, type, numTypes;
+	
+	{
+		SpinLock::ScopedLock scopedLock(types.lock);
+		forcedType = types.forcedType;
+		type = types.choices[getSizeLog2(fftSize)];
+		numTypes = types.numTypes;
+	}
+	
+	if(forcedType >= 0)
+	{
+		FFTBackend* const backend = types.creators[forcedType](fftSize);
+		
+		if(backend != 0) 
+		{
+			backend->setName(types.names[forcedType]);
+			return backend;
+		}
+	}
+	
+	if(type >= 0)
+	{
+		FFTBackend* const backend = types.creators[type](fftSize);
+		
+		if(backend != 0)
+		{
+			backend->setName(types.names[type]);
+			return backend;
+		}
+	}
+	
+	// this size hasn't been timed (see warmUp()), use the first type which supports it
+	// rather than timing them here as this may be on the audio thread
+	for(int i = 0; i < numTypes; i++)
+	{
+		FFTBackend* const backend = types.creators[i](fftSize);
+		
+		if(backend != 0)
+		{
+			backend->setName(types.names[i]);
+			return backend;
+		}
+	}
+	
+	return 0;
+}
+
+const char* FFTBackendRegistry::getChoice(const int fftSize) throw()
+{
+	FFTBackendTypes& types = getFFTBackendTypes();
+	int type;
+	
+	{
+		SpinLock::ScopedLock scopedLock(types.lock);
+		type = types.choices[getSizeLog2(fftSize)];
+	}
+	
+	if(type < 0)
+	{
+		type = chooseType(types, fftSize);
+		savePlanFile(types);
+	}
+	
+	return type >= 0 ? types.names[type] : 0;
+}
+
+const char* FFTBackendRegistry::benchmark(const int fftSize) throw()
+{
+	FFTBackendTypes& types = getFFTBackendTypes();
+	
+	const int type = chooseType(types, fftSize);
+	savePlanFile(types);
+	
+	return type >= 0 ? types.names[type] : 0;
+}
+
+void FFTBackendRegistry::warmUp(const int minimumSize, const int maximumSize) throw()
+{
+	ugen_assert(minimumSize > 0);
+	ugen_assert(maximumSize >= minimumSize);
+	
+	FFTBackendTypes& types = getFFTBackendTypes();
+	bool chosen = false;
+	
+	for(int fftSize = (int)Bits::nextPowerOf2(minimumSize); fftSize <= maximumSize; fftSize *= 2)
+	{
+		int type;
+		
+		{
+			SpinLock::ScopedLock scopedLock(types.lock);
+			type = types.choices[getSizeLog2(fftSize)];
+		}
+		
+		if(type < 0)
+		{
+			chooseType(types, fftSize);
+			chosen = true;
+		}
+	}
+	
+	if(chosen)
+		savePlanFile(types);
+}
+
+bool FFTBackendRegistry::setForcedType(const char* name) throw()
+{
+	FFTBackendTypes& types = getFFTBackendTypes();
+	SpinLock::ScopedLock scopedLock(types.lock);
+	
+	if(name == 0)
+	{
+		types.forcedType = -1;
+		return true;
+	}
+	
+	const int type = types.indexOf(name);
+	
+	if(type < 0) 
+		return false;
+	
+	types.forcedType = type;
+	return true;
+}
+
+bool FFTBackendRegistry::loadPlans(const char* path) throw()
+{
+	ugen_assert(path != 0);
+	
+	FFTBackendTypes& types = getFFTBackendTypes();
+	int loadedChoices[MaximumSizeLog2 + 1];
+	
+	if(!types.load(path, loadedChoices))
+		return false;
+	
+	SpinLock::ScopedLock scopedLock(types.lock);
+	
+	for(int i = 0; i <= MaximumSizeLog2; i++)
+		if(loadedChoices[i] >= 0)
+			types.choices[i] = loadedChoices[i];
+	
+	return true;
+}
+
+bool FFTBackendRegistry::savePlans(const char* path) throw()
+{
+	ugen_assert(path != 0);
+	
+	FFTBackendTypes& types = getFFTBackendTypes();
+	int choices[MaximumSizeLog2 + 1];
+	
+	{
+		SpinLock::ScopedLock scopedLock(types.lock);
+		memcpy(choices, types.choices, sizeof(choices));
+	}
+	
+	return types.save(path, choices);
+}
+
+bool FFTBackendRegistry::setPlanFile(const char* path) throw()
+{
+	FFTBackendTypes& types = getFFTBackendTypes();
+	
+	if(path == 0)
+	{
+		SpinLock::ScopedLock scopedLock(types.lock);
+		types.savesPlans = false;
+		return true;
+	}
+	
+	const bool loaded = loadPlans(path);
+	
+	{
+		SpinLock::ScopedLock scopedLock(types.lock);
+		types.planFile = path;
+		types.savesPlans = true;
+	}
+	
+	// time the common sizes the file didn't have now rather than when they're first created
+	warmUp(WarmUpMinimumSize, WarmUpMaximumSize);
+	
+	return loaded;
+}
+
+
+END_UGEN_NAMESPACE
@@ -0,0 +1,218 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef _UGEN_ugen_FFTBackend_H_
+#define _UGEN_ugen_FFTBackend_H_
+
+/** Read only data for one size of one type of FFTBackend, e.g., twiddle and bit reversal tables. 
+ 
+ Every backend of that type and size shares one plan (whichever thread it is used on) through 
+ the FFTPlanCache, each backend only allocates its own working memory. */
+class FFTPlan
+{
+public:
+	FFTPlan() throw() { }
+	virtual ~FFTPlan() { }
+	
+private:
+	FFTPlan (const FFTPlan&);
+	const FFTPlan& operator= (const FFTPlan&);
+};
+
+/** A process wide, thread safe cache of FFTPlan objects and FFT windows keyed by size. */
+class FFTPlanCache
+{
+public:
+	/** Returns a new plan for a power of 2 size. */
+	typedef FFTPlan* (*CreateFunction)(const int fftSize);
+	
+	/** Get the plan the create function makes for this size, making it if nothing is using one yet.
+	 Each call must be matched by a call to release(). */
+	static const FFTPlan* acquire(CreateFunction create, const int fftSize) throw();
+	
+	/** Finish with a plan, it is deleted once nothing is using it. */
+	static void release(const FFTPlan* plan) throw();
+	
+	enum WindowType
+	{
+		Hann,
+		Hamming,
+		Blackman,
+		Bartlett,
+		Triangle,
+		NumWindowTypes
+	};
+	
+	/** Get a window for a power of 2 size. This is shared by everything which asks for it so
+	 it must not be modified. Windows are kept until the application exits. */
+	static Buffer getWindow(const int fftSize, const WindowType type) throw();
+};
+
+/** One implementation of a real FFT of a particular size.
+ 
+ Every backend uses the packed split format the rest of the FFT code expects: the N/2 real parts 
+ followed by the N/2 imaginary parts with the real Nyquist bin stored in place of the DC bin's 
+ imaginary part (which is always zero). The forward transform is the unscaled DFT with a negative
+ exponent (as vDSP and FFTW) and the inverse returns N times the original signal. Both may be done in place, i.e., with the input and
+ output the same memory. Backends keep their own working memory so an instance must only 
+ be used by one thread at a time.
+ 
+ @see FFTBackendRegistry */
+class FFTBackend
+{
+public:
+	FFTBackend(const int fftSizeToUse) throw() 
+	:	fftSize(fftSizeToUse), 
+		fftSizeHalved(fftSizeToUse >> 1),
+		name("")
+	{ 
+	}
+	
+	virtual ~FFTBackend() { }
+	
+	inline int size() const throw()					{ return fftSize;	}
+	
+	/** The name this type of backend was registered with. */
+	inline const char* getName() const throw()		{ return name;		}
+	
+	/** @internal Called by the FFTBackendRegistry. */
+	inline void setName(const char* nameToUse) throw() { name = nameToUse;	}
+	
+	virtual void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer) throw() = 0;
+	virtual void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer) throw() = 0;
+
+	/** Forward transform several signals in one call, e.g., the channels of a Buffer or a run of
+	 frames. Each output may be the same memory as its own input. This does them one after another,
+	 backends which can run several transforms in lockstep override it. */
+	virtual void fftBatch(DSPSplitComplex* const outputBuffers,
+						  const float* const* inputBuffers,
+						  const int numTransforms) throw()
+	{
+		for(int i = 0; i < numTransforms; i++)
+			fft(outputBuffers[i], inputBuffers[i]);
+	}
+
+	/** Inverse transform several spectra in one call. @see fftBatch() */
+	virtual void ifftBatch(float* const* outputBuffers,
+						   DSPSplitComplex const* inputBuffers,
+						   const int numTransforms) throw()
+	{
+		for(int i = 0; i < numTransforms; i++)
+			ifft(outputBuffers[i], inputBuffers[i]);
+	}
+	
+	/** Allocate any working memory the batch calls need, call this before they are used on the 
+	 audio thread. Backends which need it transform one at a time until this has been called. */
+	virtual void prepareBatch() throw() { }
+
+protected:
+	const int fftSize;
+	const int fftSizeHalved;
+	
+private:
+	const char* name;
+	
+	FFTBackend (const FFTBackend&);
+	const FFTBackend& operator= (const FFTBackend&);
+};
+
+/** Creates FFTBackend instances and chooses which implementation to use for each size.
+ 
+ Several backends can be built into one binary. "SplitRadix" (portable, uses the SIMD kernels)
+ and "FFTReal" are always available (FFTReal is left out if UGEN_NOEXTGPL is defined), "vDSP", 
+ "FFTW" and "PFFFT" are added if UGEN_VDSP, UGEN_FFTW or UGEN_PFFFT are defined and the library 
+ is available to link against. Others can be added with addType().
+ 
+ The first time a size is needed each backend is timed on a few transforms of that size and 
+ the fastest is used from then on. This takes a few milliseconds per size so the choices can be 
+ saved in a plan file and loaded at startup. A backend can also be forced with setForcedType(). */
+class FFTBackendRegistry
+{
+public:
+	/** Returns a new backend for a power of 2 size, or 0 if this size isn't supported. */
+	typedef FFTBackend* (*CreateFunction)(const int fftSize);
+	
+	enum Constants
+	{
+		MaximumTypes = 16,
+		MaximumNameLength = 32,
+		MaximumSizeLog2 = 30,
+		WarmUpMinimumSize = 64,
+		WarmUpMaximumSize = 32768
+	};
+	
+	/** Add a type of backend. @return @c false if the name is already used or there are too many types. */
+	static bool addType(const char* name, CreateFunction create) throw();
+	
+	static int getNumTypes() throw();
+	static const char* getTypeName(const int index) throw();
+	
+	/** Create the chosen backend for a power of 2 size. 
+	 This never times the backends, if no choice has been made for this size yet it uses 
+	 the first backend which supports it. @see warmUp() */
+	static FFTBackend* create(const int fftSize) throw();
+	
+	/** The name of the backend chosen for a power of 2 size, choosing one first if necessary. */
+	static const char* getChoice(const int fftSize) throw();
+	
+	/** Time the backends on each power of 2 size in this range which doesn't have a choice yet,
+	 e.g., at startup before creating FFT UGens. setPlanFile() does this for the default range. */
+	static void warmUp(const int minimumSize = WarmUpMinimumSize, const int maximumSize = WarmUpMaximumSize) throw();
+	
+	/** Time every backend on a size and choose the fastest, even if a choice was already made. 
+	 @return The name of the chosen backend. */
+	static const char* benchmark(const int fftSize) throw();
+	
+	/** Use one backend for every size it supports rather than the chosen ones.
+	 Pass 0 to go back to the chosen backends. 
+	 @return @c false if there is no backend with this name. */
+	static bool setForcedType(const char* name) throw();
+	
+	/** Read choices saved by savePlans(), lines with a size and a backend name. 
+	 Choices for backends which aren't in this build are ignored. */
+	static bool loadPlans(const char* path) throw();
+	
+	/** Write the choices made so far. */
+	static bool savePlans(const char* path) throw();
+	
+	/** Load the choices from a plan file (if it exists), time the sizes it doesn't have with 
+	 warmUp() and save them there whenever a new choice is made. Pass 0 to stop saving. */
+	static bool setPlanFile(const char* path) throw();
+};
+
+
+#endif // _UGEN_ugen_FFTBackend_H_
@@ -35,7 +35,7 @@
  ==============================================================================
  */
 
-#if !defined(WIN32) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
+#if defined(__APPLE__) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
 	#include <Accelerate/Accelerate.h>
 	#include <CoreServices/CoreServices.h>
 #endif
@@ -90,6 +90,17 @@ Buffer& FFTEngine::getFFTWindow() throw()					{ return internal->getFFTWindow();
 Buffer& FFTEngine::getIFFTWindow() throw()					{ return internal->getIFFTWindow(); }
 void FFTEngine::setFFTWindow(Buffer const& window) throw()	{ internal->setFFTWindow(window);	}
 void FFTEngine::setIFFTWindow(Buffer const& window) throw() { internal->setIFFTWindow(window);	}
+const char* FFTEngine::getBackendName() const throw()		{ return internal->getBackendName(); }
+
+bool FFTEngine::setBackend(const char* name) throw()
+{
+	return FFTBackendRegistry::setForcedType(name);
+}
+
+bool FFTEngine::setPlanFile(const char* path) throw()
+{
+	return FFTBackendRegistry::setPlanFile(path);
+}
 
 void FFTEngine::fft(Buffer const& outputBuffer, 
 					Buffer const& inputBuffer, 
@@ -133,6 +144,26 @@ void FFTEngine::ifft(Buffer const& outputBuffer,
 	internal->ifft(outputBuffer, inputBuffer, applyWindow, applyScaling, outputChannel, inputChannel, outputOffset, inputOffset);
 }
 
+void FFTEngine::fftBatch(Buffer const& outputBuffer, 
+						 Buffer const& inputBuffer, 
+						 const bool applyWindow) throw()
+{
+	internal->fftBatch(outputBuffer, inputBuffer, applyWindow);
+}
+
+void FFTEngine::ifftBatch(Buffer const& outputBuffer, 
+						  Buffer const& inputBuffer, 
+						  const bool applyWindow, 
+						  const bool applyScaling) throw()
+{
+	internal->ifftBatch(outputBuffer, inputBuffer, applyWindow, applyScaling);
+}
+
+void FFTEngine::prepareBatch() throw()
+{
+	internal->prepareBatch();
+}
+
 Buffer FFTEngine::rawToRealImagRawSplit(Buffer const& raw) throw()
 {
 	return internal->rawToRealImagRawSplit(raw);
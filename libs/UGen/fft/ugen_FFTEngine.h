@@ -60,11 +60,27 @@ public:
 	/** Get the FFT size. */
 	int size() const throw();
 	FFTEngineInternal* getInternal() throw() { return internal; }
+	
+	/** The windows used when applyWindow is true, a Hann window by default. This is shared 
+	 with other engines of the same size so use setFFTWindow() or setIFFTWindow() to change 
+	 it rather than writing to it. */
 	Buffer& getFFTWindow() throw();
 	Buffer& getIFFTWindow() throw();
 	void setFFTWindow(Buffer const& window) throw();
 	void setIFFTWindow(Buffer const& window) throw();
 	
+	/** The name of the FFTBackend doing this engine's transforms. */
+	const char* getBackendName() const throw();
+	
+	/** Use one FFT backend (e.g., "SplitRadix" or "FFTReal") for engines created from now on.
+	 Pass 0 to go back to using the fastest backend for each size. @see FFTBackendRegistry */
+	static bool setBackend(const char* name) throw();
+	
+	/** Load the backends chosen for each size from a plan file, time the common sizes it doesn't 
+	 have and save new choices to it. This avoids timing the backends again each time the application 
+	 starts. Sizes which haven't been timed use a default backend. @see FFTBackendRegistry */
+	static bool setPlanFile(const char* path) throw();
+	
 	/** Perform an FFT. */
 	void fft(Buffer const& outputBuffer, 
 			 Buffer const& inputBuffer, 
@@ -100,6 +116,24 @@ public:
 			  const int outputOffset,
 			  const int inputOffset) throw();
 
+	/** Perform an FFT of every channel of the input Buffer, into the same channels of the output.
+	 This is quicker than calling fft() for each channel as several transforms are done at once 
+	 (in lockstep across the SIMD lanes if the backend supports it). The two Buffers may be the same. */
+	void fftBatch(Buffer const& outputBuffer, 
+				  Buffer const& inputBuffer, 
+				  const bool applyWindow = false) throw();
+	
+	/** Perform an inverse FFT of every channel of the input Buffer. @see fftBatch() */
+	void ifftBatch(Buffer const& outputBuffer, 
+				   Buffer const& inputBuffer, 
+				   const bool applyWindow = false, 
+				   const bool applyScaling = false) throw();
+	
+	/** Allocate the working memory for fftBatch() and ifftBatch(), e.g., in a UGen's constructor 
+	 so it isn't allocated on the audio thread. Until then the batch calls may transform one 
+	 channel at a time. */
+	void prepareBatch() throw();
+
 	Buffer rawToRealImagRawSplit(Buffer const& raw) throw();	
 	Buffer rawToRealImagUnpacked(Buffer const& raw) throw();
 	Buffer rawToRealImagUnpacked(Buffer const& raw, const int firstBin, const int numBins) throw();
@@ -35,7 +35,7 @@
  ==============================================================================
  */
 
-#if !defined(WIN32) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
+#if defined(__APPLE__) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
 	#include <Accelerate/Accelerate.h>
 	#include <CoreServices/CoreServices.h>
 #endif
@@ -45,20 +45,14 @@
 BEGIN_UGEN_NAMESPACE
 
 #include "ugen_FFTEngineInternal.h"
+#include "../core/ugen_SIMD.h"
 
 FFTEngineInternal::FFTEngineInternal(const int fftSizeToUse) throw()
 :	fftSize(Bits::isPowerOf2(fftSizeToUse) ? fftSizeToUse : Bits::nextPowerOf2(fftSizeToUse)),
 	fftSizeHalved(fftSize>>1),
-	fftSizeBytes(fftSize * sizeof(float)),
-	fftSizeHalvedBytes(fftSizeHalved * sizeof(float)),
 	ifftScaling(1.f/(float)fftSize),
-#ifdef UGEN_FFTW
-	transformBuffer(BufferSpec(fftSize + 2, 1, false)),
-#else
-	transformBuffer(BufferSpec(fftSize, 1, false)),
-#endif
-	transformBufferSamples(transformBuffer.getData()),
-	fftWindow(Buffer::hannWindow(fftSize)),
+	backend(FFTBackendRegistry::create(fftSize)),
+	fftWindow(FFTPlanCache::getWindow(fftSize, FFTPlanCache::Hann)),
 	ifftWindow(fftWindow),
 	fftWindowSamples(fftWindow.getData()),
 	ifftWindowSamples(ifftWindow.getData()),
@@ -66,41 +60,13 @@ FFTEngineInternal::FFTEngineInternal(const int fftSizeToUse) throw()
 	windowingBuffer(BufferSpec(fftSize, 1, false)),
 	windowingBufferSamples(windowingBuffer.getData())
 {
-	static int announced = 0;
-	
 	ugen_assert(fftSizeToUse == fftSize); // fftSizeToUse should be a power of 2
-	
-	transformBufferSplit.realp = transformBufferSamples;
-	transformBufferSplit.imagp = transformBufferSamples + fftSizeHalved;
-	
-#ifdef UGEN_FFTW
-	if(!announced) printf("FFTEngine using FFTW\n"); announced = 1;
-	fftwPlan = fftwf_plan_dft_r2c_1d(fftSize, transformBufferSamples, (fftwf_complex*) transformBufferSamples, FFTW_ESTIMATE);
-	ifftwPlan = fftwf_plan_dft_c2r_1d(fftSize, (fftwf_complex*) transformBufferSamples, transformBufferSamples, FFTW_ESTIMATE);
-#elif defined(UGEN_FFTREAL)
-	if(!announced) printf("FFTEngine using FFTReal\n"); announced = 1;
-	fftReal = new FFTReal<float>(fftSize);
-#else
-	if(!announced) printf("FFTEngine using vDSP\n"); announced = 1;
-	fftSizeLog2 = 4;
-	while((1 << fftSizeLog2) < fftSize)
-		fftSizeLog2++;
-	fftvDSP = vDSP_create_fftsetup (fftSizeLog2, 0);
-#endif
-	
-	//printf("fftsize=%d\n", fftSize);
+	ugen_assert(backend != 0);
 }
 
 FFTEngineInternal::~FFTEngineInternal()
 {
-#ifdef UGEN_FFTW
-	fftwf_destroy_plan(fftwPlan);
-	fftwf_destroy_plan(ifftwPlan);
-#elif defined(UGEN_FFTREAL)
-	delete fftReal;
-#else
-	vDSP_destroy_fftsetup(fftvDSP);
-#endif		
+	delete backend;
 }
 
 void FFTEngineInternal::dispose()
@@ -232,6 +198,88 @@ void FFTEngineInternal::ifft(float* const outputBuffer, DSPSplitComplex const& i
 	}
 }
 
+void FFTEngineInternal::fftBatch(Buffer const& outputBuffer, 
+								 Buffer const& inputBuffer, 
+								 const bool applyWindow) throw()
+{
+	const int numChannels = inputBuffer.getNumChannels();
+	
+	if((outputBuffer.size() < fftSize) || (inputBuffer.size() < fftSize) || (outputBuffer.getNumChannels() < numChannels))
+	{
+		printf("FFTEngineInternal::fftBatch() - buffer(s) too small\n");
+		return;
+	}
+	
+	Buffer output(outputBuffer);
+	DSPSplitComplex fftBuffers[BatchChunkSize];
+	const float* inputs[BatchChunkSize];
+	
+	for(int firstChannel = 0; firstChannel < numChannels; firstChannel += BatchChunkSize)
+	{
+		const int numTransforms = ugen::min((int)BatchChunkSize, numChannels - firstChannel);
+		
+		for(int i = 0; i < numTransforms; i++)
+		{
+			float* const outputSamples = output.getData(firstChannel + i);
+			const float* inputSamples = inputBuffer.getData(firstChannel + i);
+			
+			// window straight into the output then transform that in place
+			if(applyWindow)
+			{
+				SIMD::multiply(inputSamples, fftWindowSamples, outputSamples, fftSize);
+				inputSamples = outputSamples;
+			}
+			
+			fftBuffers[i].realp = outputSamples;
+			fftBuffers[i].imagp = outputSamples + fftSizeHalved;
+			inputs[i] = inputSamples;
+		}
+		
+		fftBatch(fftBuffers, inputs, numTransforms);
+	}
+}
+
+void FFTEngineInternal::ifftBatch(Buffer const& outputBuffer, 
+								  Buffer const& inputBuffer, 
+								  const bool applyWindow, 
+								  const bool applyScaling) throw()
+{
+	const int numChannels = inputBuffer.getNumChannels();
+	
+	if((outputBuffer.size() < fftSize) || (inputBuffer.size() < fftSize) || (outputBuffer.getNumChannels() < numChannels))
+	{
+		ugen_assertfalse; // buffer(s) too small
+		return;
+	}
+	
+	Buffer output(outputBuffer);
+	float* outputs[BatchChunkSize];
+	DSPSplitComplex fftBuffers[BatchChunkSize];
+	
+	for(int firstChannel = 0; firstChannel < numChannels; firstChannel += BatchChunkSize)
+	{
+		const int numTransforms = ugen::min((int)BatchChunkSize, numChannels - firstChannel);
+		
+		for(int i = 0; i < numTransforms; i++)
+		{
+			outputs[i] = output.getData(firstChannel + i);
+			fftBuffers[i].realp = (float*)inputBuffer.getData(firstChannel + i);
+			fftBuffers[i].imagp = fftBuffers[i].realp + fftSizeHalved;
+		}
+		
+		ifftBatch(outputs, fftBuffers, numTransforms);
+		
+		for(int i = 0; i < numTransforms; i++)
+		{
+			if(applyWindow)
+				SIMD::multiply(outputs[i], ifftWindowSamples, outputs[i], fftSize);
+			
+			if(applyScaling)
+				SIMD::multiply(outputs[i], ifftScaling, outputs[i], fftSize);
+		}
+	}
+}
+
 Buffer FFTEngineInternal::rawToRealImagRawSplit(Buffer const& raw) throw()
 {
 	if(raw.size() != fftSize) 
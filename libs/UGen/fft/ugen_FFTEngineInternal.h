@@ -50,7 +50,7 @@
 //#define UGEN_FFTW 1		// best for windows
 							// otherwise use vDSP on the Mac (fastest of all)
 
-#if (defined (_WIN32) || defined (_WIN64) || defined(UGEN_IPHONE) || defined(UGEN_ANDROID)) // make this so it is "not mac" rather than "is windows"...
+#if (!defined(__APPLE__) || defined(UGEN_IPHONE) || defined(UGEN_ANDROID)) // anything other than the Mac desktop
 	#ifndef UGEN_NEON
 		typedef struct _vFloat {
 			float f[4];
@@ -160,45 +160,41 @@
 	#endif
 #endif
 
-#ifdef UGEN_FFTW
-	END_UGEN_NAMESPACE
-		#include <fftw3.h>
-	BEGIN_UGEN_NAMESPACE
-#elif !defined(UGEN_VDSP)
+#if !defined(UGEN_FFTW) && !defined(UGEN_VDSP)
 	#define UGEN_FFTREAL 1
-	END_UGEN_NAMESPACE
-		#include "../fftreal/FFTReal.h"
-	BEGIN_UGEN_NAMESPACE
-	// e.g. fftsize=8
-	//            | Positive FFT   | Negative FFT
-	//Bin         | Real part      | imaginary part  | imaginary part
-	//------------+----------------+-----------------+----------------0 
-	//0  dc       | f [0]          | 0               | 0
-	//1           | f [1]          | f [5]           | -f [5]
-	//2           | f [2],         | f [6]           | -f [6]
-	//3           | f [3]          | f [7]           | -f [7]
-	//4  nyquist  | f [4]          | 0               | 0
-	//
-	//... mirror:
-	//
-	//5           | f [3]          | -f [7]          | f [7]
-	//6           | f [2]          | -f [6]          | f [6]
-	//7           | f [1]          | -f [5]          | f [5]
 #endif
 
-#if defined(UGEN_NOEXTGPL) && (defined(UGEN_FFTW) || defined(UGEN_FFTREAL))
-#warning UGEN_NOEXTGPL: FFT Real and FFTW are GPL!
+#if defined(UGEN_NOEXTGPL) && defined(UGEN_FFTW)
+#warning UGEN_NOEXTGPL: FFTW is GPL!
 #endif
 
+// The packed format every FFTBackend uses, e.g. fftsize=8
+//            | Positive FFT   | Negative FFT
+//Bin         | Real part      | imaginary part  | imaginary part
+//------------+----------------+-----------------+----------------0 
+//0  dc       | f [0]          | 0               | 0
+//1           | f [1]          | f [5]           | -f [5]
+//2           | f [2],         | f [6]           | -f [6]
+//3           | f [3]          | f [7]           | -f [7]
+//4  nyquist  | f [4]          | 0               | 0
+//
+//... mirror:
+//
+//5           | f [3]          | -f [7]          | f [7]
+//6           | f [2]          | -f [6]          | f [6]
+//7           | f [1]          | -f [5]          | f [5]
+
+#include "ugen_FFTBackend.h"
 
 /**
  Provides real to complex FFT and complex to real IFFT processes using a selection of underlying libraries.
  
- The fastest on the Mac is vDSP but you need to define UGEN_VDSP equalt to 1 as a preprocessor macro. FFTReal (which is 
- in the source code tree and doesn't need to be downloaded separately) is used by default. You can use FFTW if you have it
- installed and define UGEN_FFTW equal to 1 before this file (e.g., doing this in preprocessor macros should ensure this).
- 
- FFTReal is the slowest but at least it's available. FFTW on Windows compares well with vDSP on the Mac.
+ The transforms themselves are done by an FFTBackend. Several may be built in (see FFTBackendRegistry)
+ and the fastest one for each size is chosen the first time that size is used. FFTReal (which is 
+ in the source code tree) and a portable split-radix FFT using the SIMD kernels are always available.
+ vDSP on the Mac needs UGEN_VDSP defined equal to 1, FFTW or PFFFT can be used if they are installed
+ and UGEN_FFTW or UGEN_PFFFT is defined equal to 1 before this file (e.g., doing this in preprocessor 
+ macros should ensure this).
  */
 class FFTEngineInternal : public SmartPointer
 {
@@ -209,6 +205,7 @@ public:
 	void dispose();
 	
 	inline int size() const throw() { return fftSize; }
+	inline const char* getBackendName() const throw() { return backend->getName(); }
 	inline Buffer& getFFTWindow() throw() { return fftWindow; }
 	inline Buffer& getIFFTWindow() throw() { return ifftWindow; }
 	inline void setFFTWindow(Buffer const& window) throw() 
@@ -241,33 +238,7 @@ public:
 	inline void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer) throw()
 	{
 		ugen_assert(inputBuffer != 0);
-		
-#ifdef UGEN_FFTW
-		memcpy(transformBufferSamples, inputBuffer, fftSizeBytes);
-		fftwf_execute(fftwPlan);
-
-		float nyquist = transformBufferSamples[fftSize]; // remember nyquist val
-		float *interleavedSamples = transformBufferSamples;
-		// deinteleave
-		for(int j = 0; j < fftSizeHalved; j++)
-		{
-			outputBuffer.realp[j] = *interleavedSamples++;
-			outputBuffer.imagp[j] = *interleavedSamples++;
-		}
-		outputBuffer.imagp[0] = nyquist; // pack nyquist in
-		
-#elif defined(UGEN_FFTREAL)
-		fftReal->do_fft(transformBufferSamples, inputBuffer);
-		memcpy(outputBuffer.realp, transformBufferSplit.realp, fftSizeHalvedBytes);
-		memcpy(outputBuffer.imagp, transformBufferSplit.imagp, fftSizeHalvedBytes);
-		
-#else
-		static float scale = 0.5f;
-		vDSP_vsmul(inputBuffer, 1, &scale, transformBufferSamples, 1, fftSize);
-		vDSP_ctoz ((COMPLEX *) transformBufferSamples, 2, &outputBuffer, 1, fftSizeHalved);
-		vDSP_fft_zrip (fftvDSP, &outputBuffer, 1, fftSizeLog2, FFT_FORWARD);
-		
-#endif
+		backend->fft(outputBuffer, inputBuffer);
 	}
 	
 	void fft(DSPSplitComplex& outputBuffer, const float* const inputBuffer, const bool applyWindow) throw();
@@ -291,45 +262,34 @@ public:
 	inline void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer) throw()
 	{
 		ugen_assert(outputBuffer != 0);
-		
-#ifdef UGEN_FFTW	
-		LOCAL_DECLARE(const int, fftSize);
-		LOCAL_DECLARE(const int, fftSizeHalved);
-		LOCAL_DECLARE(const int, fftSizeBytes);
-		LOCAL_DECLARE(const int, fftSizeHalvedBytes);
-		
-		LOCAL_DECLARE(float * const, transformBufferSamples);
-		LOCAL_DECLARE(DSPSplitComplex&, transformBufferSplit);
-
-		float *interleavedSamples = transformBufferSamples;
-		for(int j = 0; j < fftSizeHalved; j++)
-		{
-			*interleavedSamples++ = inputBuffer.realp[j];
-			*interleavedSamples++ = inputBuffer.imagp[j];
-		}
-		transformBufferSamples[fftSize  ] = transformBufferSamples[1]; // nyquist
-		transformBufferSamples[fftSize+1] = 0.f; // nyquist imag always zero
-		transformBufferSamples[1        ] = 0.f; // DC imag always zero
-		
-		fftwf_execute(ifftwPlan);
-		memcpy(outputBuffer, transformBufferSamples, fftSizeBytes);
-#elif defined(UGEN_FFTREAL)
-		memcpy(transformBufferSplit.realp, inputBuffer.realp, fftSizeBytes);
-		fftReal->do_ifft(transformBufferSamples, outputBuffer);
-#else
-//	#ifdef UGEN_IPHONE
-//		cblas_ccopy(fftSize, inputBuffer.realp, 1, transformBufferSplit.realp, 1);
-//	#else
-//		vScopy(fftSize, (const vFloat*)inputBuffer.realp, (vFloat*)transformBufferSplit.realp);
-//	#endif			
-		memcpy(transformBufferSplit.realp, inputBuffer.realp, fftSizeBytes);
-		vDSP_fft_zrip (fftvDSP, &transformBufferSplit, 1, fftSizeLog2, FFT_INVERSE);
-		vDSP_ztoc (&transformBufferSplit, 1, (COMPLEX *) outputBuffer, 2, fftSizeHalved);
-#endif		
+		backend->ifft(outputBuffer, inputBuffer);
 	}
 	
 	void ifft(float* const outputBuffer, DSPSplitComplex const& inputBuffer, const bool applyWindow, const bool applyScaling) throw();
 	
+	void fftBatch(Buffer const& outputBuffer, 
+				  Buffer const& inputBuffer, 
+				  const bool applyWindow = false) throw();
+	
+	inline void fftBatch(DSPSplitComplex* const outputBuffers, const float* const* inputBuffers, const int numTransforms) throw()
+	{
+		ugen_assert(numTransforms >= 0);
+		backend->fftBatch(outputBuffers, inputBuffers, numTransforms);
+	}
+	
+	void ifftBatch(Buffer const& outputBuffer, 
+				   Buffer const& inputBuffer, 
+				   const bool applyWindow = false, 
+				   const bool applyScaling = false) throw();
+	
+	inline void ifftBatch(float* const* outputBuffers, DSPSplitComplex const* inputBuffers, const int numTransforms) throw()
+	{
+		ugen_assert(numTransforms >= 0);
+		backend->ifftBatch(outputBuffers, inputBuffers, numTransforms);
+	}
+	
+	inline void prepareBatch() throw()						{ backend->prepareBatch();		}
+	
 	Buffer rawToRealImagRawSplit(Buffer const& raw) throw();
 	Buffer rawToRealImagUnpacked(Buffer const& raw) throw();
 	Buffer rawToRealImagUnpacked(Buffer const& raw, const int firstBin, const int numBins) throw();
@@ -349,24 +309,16 @@ public:
 	Buffer rawToPhase(Buffer const& raw, const int firstBin, const int numBins) throw();
 	
 private:
-#ifdef UGEN_FFTW
-	fftwf_plan fftwPlan, ifftwPlan;
-#elif defined(UGEN_FFTREAL)
-	FFTReal<float> *fftReal;
-#else
-    FFTSetup fftvDSP;
-	int fftSizeLog2;
-#endif	
+	enum Constants
+	{
+		BatchChunkSize = 32 ///< Channels passed to the backend per call by the Buffer versions of fftBatch() and ifftBatch()
+	};
 	
 	const int fftSize;
 	const int fftSizeHalved;
-	const int fftSizeBytes;
-	const int fftSizeHalvedBytes;
 	const float ifftScaling;
 	
-	Buffer transformBuffer;
-	float * const transformBufferSamples;
-	DSPSplitComplex transformBufferSplit;
+	FFTBackend* const backend;
 	
 	Buffer fftWindow, ifftWindow;
 	float* fftWindowSamples;
@@ -0,0 +1,229 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "../core/ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_STFT.h"
+#include "../core/ugen_Bits.h"
+#include "../core/ugen_SIMD.h"
+
+STFTUGenInternal::STFTUGenInternal(UGen const& input, 
+								   FFTEngine const& fft, 
+								   SpectralProcess const& processToUse, 
+								   const int overlap, 
+								   Buffer const& window) throw()
+:	ProxyOwnerUGenInternal(NumInputs + processToUse.getParameters().size(), input.getNumChannels() - 1),
+	fftEngine(fft),
+	fftSize(fftEngine.size()),
+	fftSizeHalved(fftSize / 2),
+	numBins(fftSizeHalved + 1),
+	hopSize(fftSize / overlap),
+	overlapSize(fftSize - hopSize),
+	numChannels(input.getNumChannels()),
+	process(processToUse.copy()),
+	numParameters(processToUse.getParameters().size()),
+	analysisWindow(window.size() == 0 ? Buffer::hannWindow(fftSize) : window.size() == fftSize ? window : window.resample(fftSize)),
+	synthesisWindow(BufferSpec(fftSize, 1, false)),
+	frameScale(1.f),
+	inputBuffer(BufferSpec(fftSize, numChannels, true)),
+	spectra(BufferSpec(fftSize, numChannels, true)),
+	outputBuffer(BufferSpec(fftSize, numChannels, true)),
+	frame(numBins, true),
+	bufferIndex(overlapSize),
+	inputSampleData(new const float*[numChannels]),
+	outputSampleData(new float*[numChannels])
+{
+	ugen_assert(hopSize > 0);
+	
+	inputs[Input] = input;
+	
+	UGenArray parameters = process.getParameters();
+	for(int i = 0; i < numParameters; i++)
+		inputs[NumInputs + i] = parameters[i];
+	
+	process.prepare(numChannels, fftSize, hopSize);
+	fftEngine.prepareBatch();
+	
+	// frames are scaled so a sinusoid centred on a bin has its amplitude as the bin's magnitude
+	const float* analysisSamples = analysisWindow.getData();
+	float windowSum = 0.f, windowSquaredSum = 0.f;
+	
+	for(int i = 0; i < fftSize; i++)
+	{
+		windowSum += analysisSamples[i];
+		windowSquaredSum += analysisSamples[i] * analysisSamples[i];
+	}
+	
+	if(windowSum > 0.f)
+		frameScale = 2.f / windowSum;
+	
+	// the synthesis window also undoes the IFFT's gain and the gain of the overlapping windows
+	const float overlapGain = windowSquaredSum / hopSize;
+	const float synthesisScale = overlapGain > 0.f ? 1.f / (fftSize * overlapGain) : 0.f;
+	SIMD::multiply(analysisSamples, synthesisScale, synthesisWindow.getData(), fftSize);
+}
+
+STFTUGenInternal::~STFTUGenInternal()
+{
+	delete [] inputSampleData;
+	delete [] outputSampleData;
+}
+
+void STFTUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int /*channel*/) throw()
+{
+	const int blockSize = uGenOutput.getBlockSize();
+	
+	for(int channel = 0; channel < numChannels; channel++)
+	{
+		inputSampleData[channel] = inputs[Input].processBlock(shouldDelete, blockID, channel);
+		outputSampleData[channel] = proxies[channel]->getSampleData();
+		
+		// the processes read the latest values when a frame is ready
+		for(int i = 0; i < numParameters; i++)
+			inputs[NumInputs + i].processBlock(shouldDelete, blockID, channel);
+	}
+	
+	int offset = 0;
+	
+	while(offset < blockSize)
+	{
+		const int numSamples = ugen::min(blockSize - offset, fftSize - bufferIndex);
+		
+		for(int channel = 0; channel < numChannels; channel++)
+		{
+			memcpy(inputBuffer.getDataUnchecked(channel) + bufferIndex, 
+				   inputSampleData[channel] + offset, 
+				   numSamples * sizeof(float));
+			memcpy(outputSampleData[channel] + offset, 
+				   outputBuffer.getDataUnchecked(channel) + bufferIndex - overlapSize, 
+				   numSamples * sizeof(float));
+		}
+		
+		offset += numSamples;
+		bufferIndex += numSamples;
+		
+		if(bufferIndex == fftSize)
+		{
+			processFrames();
+			bufferIndex = overlapSize;
+		}
+	}
+}
+
+void STFTUGenInternal::processFrames() throw()
+{
+	const float* const analysisSamples = analysisWindow.getData();
+	const float* const synthesisSamples = synthesisWindow.getData();
+	
+	for(int channel = 0; channel < numChannels; channel++)
+	{
+		float* const inputSamples = inputBuffer.getDataUnchecked(channel);
+		
+		SIMD::multiply(inputSamples, analysisSamples, spectra.getDataUnchecked(channel), fftSize);
+		
+		if(overlapSize > 0)
+			memmove(inputSamples, inputSamples + hopSize, overlapSize * sizeof(float));
+	}
+	
+	fftEngine.fftBatch(spectra, spectra);
+	
+	if(process.isNotNull())
+	{
+		float* const frameReal = frame.getDataReal();
+		float* const frameImag = frame.getDataImag();
+		const float inverseFrameScale = 1.f / frameScale;
+		
+		for(int channel = 0; channel < numChannels; channel++)
+		{
+			// unpack the packed spectrum into DC to Nyquist inclusive and back
+			float* const packedReal = spectra.getDataUnchecked(channel);
+			float* const packedImag = packedReal + fftSizeHalved;
+			
+			SIMD::multiply(packedReal, frameScale, frameReal, fftSizeHalved);
+			SIMD::multiply(packedImag, frameScale, frameImag, fftSizeHalved);
+			frameReal[fftSizeHalved] = packedImag[0] * frameScale;
+			frameImag[0] = frameImag[fftSizeHalved] = 0.f;
+			
+			process.processFrame(frame, channel);
+			
+			SIMD::multiply(frameImag, inverseFrameScale, packedImag, fftSizeHalved);
+			SIMD::multiply(frameReal, inverseFrameScale, packedReal, fftSizeHalved);
+			packedImag[0] = frameReal[fftSizeHalved] * inverseFrameScale;
+		}
+	}
+	
+	fftEngine.ifftBatch(spectra, spectra);
+	
+	for(int channel = 0; channel < numChannels; channel++)
+	{
+		float* const frameSamples = spectra.getDataUnchecked(channel);
+		float* const outputSamples = outputBuffer.getDataUnchecked(channel);
+		
+		// the first hop has been output, shift the rest along and add the new frame
+		if(overlapSize > 0)
+			memmove(outputSamples, outputSamples + hopSize, overlapSize * sizeof(float));
+		
+		memset(outputSamples + overlapSize, 0, hopSize * sizeof(float));
+		
+		SIMD::multiply(frameSamples, synthesisSamples, frameSamples, fftSize);
+		SIMD::add(outputSamples, frameSamples, outputSamples, fftSize);
+	}
+}
+
+STFT::STFT(UGen const& input, 
+		   FFTEngine const& fft, 
+		   SpectralProcess const& process, 
+		   const int overlap, 
+		   Buffer const& window) throw()
+{
+	const int overlapChecked = Bits::isPowerOf2(overlap) ? overlap : Bits::nextPowerOf2(overlap);
+	
+	ugen_assert(overlap == overlapChecked); // should be power of 2
+	
+	STFTUGenInternal* stft = new STFTUGenInternal(input, 
+												  fft, 
+												  process, 
+												  ugen::clip(overlapChecked, 1, fft.size()), 
+												  window);
+	
+	initInternal(input.getNumChannels());
+	generateFromProxyOwner(stft);
+}
+
+END_UGEN_NAMESPACE
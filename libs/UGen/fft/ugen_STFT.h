@@ -0,0 +1,120 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef _UGEN_ugen_STFT_H_
+#define _UGEN_ugen_STFT_H_
+
+#include "../core/ugen_UGen.h"
+#include "ugen_FFTEngine.h"
+#include "ugen_SpectralProcess.h"
+
+/** Overlap-add analysis and resynthesis of every channel of its input.
+ 
+ Each time a hop of input has arrived the last fftSize samples of every channel are windowed 
+ and transformed together (see FFTEngine::fftBatch()), each channel's frame is passed through 
+ the SpectralProcess, then the frames are transformed back, windowed again and overlap-added 
+ to the output. Nothing is done per sample other than copying so the cost of the processes only
+ depends on the hop size. */
+class STFTUGenInternal : public ProxyOwnerUGenInternal
+{
+public:
+	STFTUGenInternal(UGen const& input, 
+					 FFTEngine const& fft, 
+					 SpectralProcess const& process, 
+					 const int overlap, 
+					 Buffer const& window) throw();
+	~STFTUGenInternal();
+	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	
+	enum Inputs { Input, NumInputs }; // followed by the parameters of the process
+	
+protected:
+	void processFrames() throw();
+	
+	FFTEngine fftEngine;
+	const int fftSize;
+	const int fftSizeHalved;
+	const int numBins;
+	const int hopSize;
+	const int overlapSize;
+	const int numChannels;
+	SpectralProcess process;
+	const int numParameters;
+	Buffer analysisWindow, synthesisWindow;
+	float frameScale;
+	Buffer inputBuffer, spectra, outputBuffer;
+	ComplexBuffer frame;
+	int bufferIndex;
+	const float** inputSampleData;
+	float** outputSampleData;
+};
+
+#define STFT_Docs	@param input		The input signal, each channel is processed separately.			\
+					@param fft			The FFTEngine to use. This can be just an int which will be		\
+										used to create an FFTEngine or you can pass in an existing		\
+										FFTEngine object. The FFT size should be a power of 2			\
+										(if not, it will be rounded up to the next power of 2).			\
+					@param process		The SpectralProcess to apply to each frame, if this is null		\
+										the input is just resynthesised.								\
+					@param overlap		Overlap factor, the hop size is the FFT size divided by this.	\
+										This should be a power of 2 and at least 4 for the				\
+										resynthesis to be flat with a Hann window.						\
+					@param window		The analysis and resynthesis window, e.g., Buffer::hannWindow()	\
+										or Buffer::hammingWindow(). This is resampled to the FFT size	\
+										if necessary, if it is empty a Hann window is used.
+
+/** Short time Fourier transform analysis, processing and resynthesis.
+ 
+ The output has the same number of channels as the input and is delayed by the FFT size.
+ 
+ @code
+ UGen shifted = STFT::AR(input, 2048, SpectralGate(0.001) >> SpectralPitchShift(1.5));
+ @endcode
+ 
+ @see SpectralProcess
+ @ingroup FFTUGens */
+UGenSublcassDeclarationNoDefault(STFT, 
+								 (input, fft, process, overlap, window), 
+								 (UGen const& input, 
+								  FFTEngine const& fft, 
+								  SpectralProcess const& process = SpectralProcess(), 
+								  const int overlap = 4, 
+								  Buffer const& window = Buffer()), 
+								 COMMON_UGEN_DOCS STFT_Docs);
+
+
+#endif // _UGEN_ugen_STFT_H_
@@ -0,0 +1,347 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "../core/ugen_StandardHeader.h"
+
+BEGIN_UGEN_NAMESPACE
+
+#include "ugen_SpectralProcess.h"
+#include "../core/ugen_Constants.h"
+
+/** Runs two processes one after the other, the result of SpectralProcess::operator>>. */
+class SpectralChainInternal : public SpectralProcessInternal
+{
+public:
+	SpectralChainInternal(SpectralProcess const& firstToUse, SpectralProcess const& secondToUse) throw()
+	:	first(firstToUse),
+		second(secondToUse)
+	{
+		parameters.add(first.getParameters());
+		parameters.add(second.getParameters());
+	}
+	
+	void prepare(const int numChannels, const int fftSize, const int hopSize) throw()
+	{
+		SpectralProcessInternal::prepare(numChannels, fftSize, hopSize);
+		first.prepare(numChannels, fftSize, hopSize);
+		second.prepare(numChannels, fftSize, hopSize);
+	}
+	
+	void processFrame(ComplexBuffer& frame, const int channel) throw()
+	{
+		first.processFrame(frame, channel);
+		second.processFrame(frame, channel);
+	}
+	
+	SpectralProcessInternal* copy() const throw()
+	{
+		return new SpectralChainInternal(first.copy(), second.copy());
+	}
+	
+private:
+	SpectralProcess first, second;
+};
+
+SpectralProcess SpectralProcess::operator>> (SpectralProcess const& next) const throw()
+{
+	if(isNull())
+		return next;
+	else if(next.isNull())
+		return *this;
+	else
+		return SpectralProcess(new SpectralChainInternal(*this, next));
+}
+
+/** Wrap a phase to between -pi and pi. */
+static inline float wrapPhase(const float phase) throw()
+{
+	return phase - (float)twoPi * ::floorf((phase + (float)pi) * (float)oneOverTwoPi);
+}
+
+SpectralProcessInternal::SpectralProcessInternal() throw()
+:	numChannels(0),
+	fftSize(0),
+	hopSize(0),
+	numBins(0)
+{
+}
+
+void SpectralProcessInternal::prepare(const int numChannelsToUse, const int fftSizeToUse, const int hopSizeToUse) throw()
+{
+	numChannels = numChannelsToUse;
+	fftSize = fftSizeToUse;
+	hopSize = hopSizeToUse;
+	numBins = fftSize / 2 + 1;
+}
+
+void SpectralProcessInternal::addParameter(UGen const& parameter) throw()
+{
+	parameters.add(parameter);
+}
+
+void SpectralProcessInternal::toPolar(ComplexBuffer& frame) throw()
+{
+	float* const real = frame.getDataReal();
+	float* const imag = frame.getDataImag();
+	const int size = frame.size();
+	
+	for(int i = 0; i < size; i++)
+	{
+		const float magnitude = ugen::sqrt(real[i] * real[i] + imag[i] * imag[i]);
+		imag[i] = ugen::atan2(imag[i], real[i]);
+		real[i] = magnitude;
+	}
+}
+
+void SpectralProcessInternal::toCartesian(ComplexBuffer& frame) throw()
+{
+	float* const real = frame.getDataReal();
+	float* const imag = frame.getDataImag();
+	const int size = frame.size();
+	
+	for(int i = 0; i < size; i++)
+	{
+		const float magnitude = real[i];
+		real[i] = magnitude * ugen::cos(imag[i]);
+		imag[i] = magnitude * ugen::sin(imag[i]);
+	}
+}
+
+SpectralGateInternal::SpectralGateInternal(UGen const& threshold) throw()
+{
+	addParameter(threshold);
+}
+
+SpectralProcessInternal* SpectralGateInternal::copy() const throw()
+{
+	return new SpectralGateInternal(parameters[Threshold]);
+}
+
+void SpectralGateInternal::processFrame(ComplexBuffer& frame, const int channel) throw()
+{
+	const float threshold = parameters[Threshold].getValue(channel);
+	const float thresholdSquared = threshold * threshold;
+	float* const real = frame.getDataReal();
+	float* const imag = frame.getDataImag();
+	
+	for(int i = 0; i < numBins; i++)
+	{
+		if((real[i] * real[i] + imag[i] * imag[i]) < thresholdSquared)
+			real[i] = imag[i] = 0.f;
+	}
+}
+
+SpectralFreezeInternal::SpectralFreezeInternal(UGen const& freeze) throw()
+:	frozen(0)
+{
+	addParameter(freeze);
+}
+
+SpectralProcessInternal* SpectralFreezeInternal::copy() const throw()
+{
+	return new SpectralFreezeInternal(parameters[Freeze]);
+}
+
+SpectralFreezeInternal::~SpectralFreezeInternal()
+{
+	delete [] frozen;
+}
+
+void SpectralFreezeInternal::prepare(const int numChannelsToUse, const int fftSizeToUse, const int hopSizeToUse) throw()
+{
+	SpectralProcessInternal::prepare(numChannelsToUse, fftSizeToUse, hopSizeToUse);
+	
+	previousPhases = Buffer(BufferSpec(numBins, numChannels, true));
+	frozenMagnitudes = Buffer(BufferSpec(numBins, numChannels, true));
+	phaseIncrements = Buffer(BufferSpec(numBins, numChannels, true));
+	outputPhases = Buffer(BufferSpec(numBins, numChannels, true));
+	
+	delete [] frozen;
+	frozen = new bool[numChannels];
+	
+	for(int i = 0; i < numChannels; i++)
+		frozen[i] = false;
+}
+
+void SpectralFreezeInternal::processFrame(ComplexBuffer& frame, const int channel) throw()
+{
+	toPolar(frame);
+	
+	float* const magnitudes = frame.getDataReal();
+	float* const phases = frame.getDataImag();
+	float* const previous = previousPhases.getDataUnchecked(channel);
+	float* const frozenMagnitude = frozenMagnitudes.getDataUnchecked(channel);
+	float* const increments = phaseIncrements.getDataUnchecked(channel);
+	float* const output = outputPhases.getDataUnchecked(channel);
+	
+	if(parameters[Freeze].getValue(channel) >= 0.5f)
+	{
+		if(!frozen[channel])
+		{
+			// hold this frame and keep each bin turning at the rate it was
+			frozen[channel] = true;
+			
+			for(int i = 0; i < numBins; i++)
+			{
+				frozenMagnitude[i] = magnitudes[i];
+				increments[i] = wrapPhase(phases[i] - previous[i]);
+				output[i] = phases[i];
+			}
+		}
+		else
+		{
+			for(int i = 0; i < numBins; i++)
+				output[i] = wrapPhase(output[i] + increments[i]);
+		}
+		
+		for(int i = 0; i < numBins; i++)
+		{
+			previous[i] = phases[i];
+			magnitudes[i] = frozenMagnitude[i];
+			phases[i] = output[i];
+		}
+	}
+	else
+	{
+		frozen[channel] = false;
+		memcpy(previous, phases, numBins * sizeof(float));
+	}
+	
+	toCartesian(frame);
+}
+
+SpectralPitchShiftInternal::SpectralPitchShiftInternal(UGen const& ratio) throw()
+{
+	addParameter(ratio);
+}
+
+SpectralProcessInternal* SpectralPitchShiftInternal::copy() const throw()
+{
+	return new SpectralPitchShiftInternal(parameters[Ratio]);
+}
+
+void SpectralPitchShiftInternal::prepare(const int numChannelsToUse, const int fftSizeToUse, const int hopSizeToUse) throw()
+{
+	SpectralProcessInternal::prepare(numChannelsToUse, fftSizeToUse, hopSizeToUse);
+	
+	previousPhases = Buffer(BufferSpec(numBins, numChannels, true));
+	outputPhases = Buffer(BufferSpec(numBins, numChannels, true));
+	shiftedMagnitudes = Buffer(BufferSpec(numBins, 1, true));
+	shiftedFrequencies = Buffer(BufferSpec(numBins, 1, true));
+}
+
+void SpectralPitchShiftInternal::processFrame(ComplexBuffer& frame, const int channel) throw()
+{
+	const float ratio = parameters[Ratio].getValue(channel);
+	
+	toPolar(frame);
+	
+	float* const magnitudes = frame.getDataReal();
+	float* const phases = frame.getDataImag();
+	float* const previous = previousPhases.getDataUnchecked(channel);
+	float* const output = outputPhases.getDataUnchecked(channel);
+	float* const shiftedMagnitude = shiftedMagnitudes.getDataUnchecked(0);
+	float* const shiftedFrequency = shiftedFrequencies.getDataUnchecked(0);
+	
+	// the phase a bin's centre frequency advances by in one hop
+	const float expectedIncrement = (float)(twoPi * hopSize / fftSize);
+	
+	memset(shiftedMagnitude, 0, numBins * sizeof(float));
+	memset(shiftedFrequency, 0, numBins * sizeof(float));
+	
+	for(int i = 0; i < numBins; i++)
+	{
+		// the difference from the expected increment gives the bin's frequency (in bins)
+		const float deviation = wrapPhase(phases[i] - previous[i] - i * expectedIncrement);
+		const float frequency = i + deviation / expectedIncrement;
+		previous[i] = phases[i];
+		
+		const int target = (int)(i * ratio + 0.5f);
+		
+		if(target >= 0 && target < numBins)
+		{
+			shiftedMagnitude[target] += magnitudes[i];
+			shiftedFrequency[target] = frequency * ratio;
+		}
+	}
+	
+	for(int i = 0; i < numBins; i++)
+	{
+		output[i] = wrapPhase(output[i] + shiftedFrequency[i] * expectedIncrement);
+		magnitudes[i] = shiftedMagnitude[i];
+		phases[i] = output[i];
+	}
+	
+	toCartesian(frame);
+}
+
+SpectralBlurInternal::SpectralBlurInternal(UGen const& amount) throw()
+{
+	addParameter(amount);
+}
+
+SpectralProcessInternal* SpectralBlurInternal::copy() const throw()
+{
+	return new SpectralBlurInternal(parameters[Amount]);
+}
+
+void SpectralBlurInternal::prepare(const int numChannelsToUse, const int fftSizeToUse, const int hopSizeToUse) throw()
+{
+	SpectralProcessInternal::prepare(numChannelsToUse, fftSizeToUse, hopSizeToUse);
+	magnitudes = Buffer(BufferSpec(numBins, numChannels, true));
+}
+
+void SpectralBlurInternal::processFrame(ComplexBuffer& frame, const int channel) throw()
+{
+	const float amount = ugen::clip(parameters[Amount].getValue(channel), 0.f, 1.f);
+	
+	toPolar(frame);
+	
+	float* const frameMagnitudes = frame.getDataReal();
+	float* const blurred = magnitudes.getDataUnchecked(channel);
+	const float amountRemaining = 1.f - amount;
+	
+	for(int i = 0; i < numBins; i++)
+	{
+		blurred[i] = blurred[i] * amount + frameMagnitudes[i] * amountRemaining;
+		frameMagnitudes[i] = blurred[i];
+	}
+	
+	toCartesian(frame);
+}
+
+END_UGEN_NAMESPACE
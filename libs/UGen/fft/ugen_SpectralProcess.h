@@ -0,0 +1,242 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#ifndef _UGEN_ugen_SpectralProcess_H_
+#define _UGEN_ugen_SpectralProcess_H_
+
+#include "../core/ugen_UGen.h"
+#include "../core/ugen_UGenArray.h"
+#include "../core/ugen_SmartPointer.h"
+#include "../buffers/ugen_Buffer.h"
+
+/** Processes the frames of an STFT one at a time.
+ 
+ A frame is a ComplexBuffer with one bin for each frequency from DC to Nyquist inclusive 
+ (i.e., fftSize / 2 + 1 bins) and is processed in place. Frames are scaled so that a sinusoid 
+ of amplitude A centred on a bin has a magnitude of A.
+ 
+ Parameters are UGen objects added with addParameter(), the STFT pulls these every block
+ and processFrame() reads their latest value with UGen::getValue(channel). Each process keeps 
+ state for every channel of the STFT it is prepared for so each STFT prepares its own copy(), 
+ the same SpectralProcess can be passed to several STFTs.
+ 
+ @see SpectralProcess, STFT */
+class SpectralProcessInternal : public SmartPointer
+{
+public:
+	SpectralProcessInternal() throw();
+	
+	/** Called by the STFT before any frames are processed, subclasses should call this
+	 before allocating their per channel state. */
+	virtual void prepare(const int numChannels, const int fftSize, const int hopSize) throw();
+	
+	virtual void processFrame(ComplexBuffer& frame, const int channel) throw() = 0;
+	
+	/** A new unprepared process of the same class with the same parameters. */
+	virtual SpectralProcessInternal* copy() const throw() = 0;
+	
+	inline UGenArray const& getParameters() const throw() { return parameters; }
+	
+	/** Convert a frame from real and imaginary parts to magnitudes and phases, in place. */
+	static void toPolar(ComplexBuffer& frame) throw();
+	
+	/** Convert a frame from magnitudes and phases to real and imaginary parts, in place. */
+	static void toCartesian(ComplexBuffer& frame) throw();
+	
+protected:
+	void addParameter(UGen const& parameter) throw();
+	
+	UGenArray parameters;
+	int numChannels;
+	int fftSize;
+	int hopSize;
+	int numBins;
+};
+
+/** Zeros bins quieter than a threshold. */
+class SpectralGateInternal : public SpectralProcessInternal
+{
+public:
+	SpectralGateInternal(UGen const& threshold) throw();
+	void processFrame(ComplexBuffer& frame, const int channel) throw();
+	SpectralProcessInternal* copy() const throw();
+	
+	enum Parameters { Threshold, NumParameters };
+};
+
+/** Holds the spectrum while the freeze parameter is on, advancing the phase of each bin at 
+ the rate it was advancing when the freeze began. */
+class SpectralFreezeInternal : public SpectralProcessInternal
+{
+public:
+	SpectralFreezeInternal(UGen const& freeze) throw();
+	~SpectralFreezeInternal();
+	void prepare(const int numChannels, const int fftSize, const int hopSize) throw();
+	void processFrame(ComplexBuffer& frame, const int channel) throw();
+	SpectralProcessInternal* copy() const throw();
+	
+	enum Parameters { Freeze, NumParameters };
+	
+private:
+	Buffer previousPhases, frozenMagnitudes, phaseIncrements, outputPhases;
+	bool* frozen;
+};
+
+/** Shifts the pitch of the signal using a phase vocoder, each bin's instantaneous 
+ frequency is measured from its phase difference from the previous frame. */
+class SpectralPitchShiftInternal : public SpectralProcessInternal
+{
+public:
+	SpectralPitchShiftInternal(UGen const& ratio) throw();
+	void prepare(const int numChannels, const int fftSize, const int hopSize) throw();
+	void processFrame(ComplexBuffer& frame, const int channel) throw();
+	SpectralProcessInternal* copy() const throw();
+	
+	enum Parameters { Ratio, NumParameters };
+	
+private:
+	Buffer previousPhases, outputPhases;
+	Buffer shiftedMagnitudes, shiftedFrequencies;
+};
+
+/** Smears the magnitude of each bin over time with a one pole filter. */
+class SpectralBlurInternal : public SpectralProcessInternal
+{
+public:
+	SpectralBlurInternal(UGen const& amount) throw();
+	void prepare(const int numChannels, const int fftSize, const int hopSize) throw();
+	void processFrame(ComplexBuffer& frame, const int channel) throw();
+	SpectralProcessInternal* copy() const throw();
+	
+	enum Parameters { Amount, NumParameters };
+	
+private:
+	Buffer magnitudes;
+};
+
+/** A per frame operation for an STFT, or a chain of them.
+ 
+ Processes are chained with operator>>, e.g.,
+ @code
+ SpectralProcess process = SpectralGate(0.001) >> SpectralPitchShift(1.5) >> SpectralBlur(0.8);
+ UGen output = STFT::AR(input, 2048, process);
+ @endcode
+ 
+ @see STFT, SpectralProcessInternal */
+class SpectralProcess : public SmartPointerContainer<SpectralProcessInternal>
+{
+public:
+	SpectralProcess(SpectralProcessInternal* internalToUse = 0) throw()
+	:	SmartPointerContainer<SpectralProcessInternal>(internalToUse)
+	{
+	}
+	
+	/** Returns a process which runs this one then the next one on each frame. */
+	SpectralProcess operator>> (SpectralProcess const& next) const throw();
+	
+	/** Returns a new process with the same parameters but its own state. */
+	inline SpectralProcess copy() const throw()
+	{
+		if(getInternal() != 0)
+			return SpectralProcess(getInternal()->copy());
+		else
+			return SpectralProcess();
+	}
+	
+	inline void prepare(const int numChannels, const int fftSize, const int hopSize) throw()
+	{
+		if(getInternal() != 0)
+			getInternal()->prepare(numChannels, fftSize, hopSize);
+	}
+	
+	inline void processFrame(ComplexBuffer& frame, const int channel) throw()
+	{
+		if(getInternal() != 0)
+			getInternal()->processFrame(frame, channel);
+	}
+	
+	inline UGenArray getParameters() const throw()
+	{
+		if(getInternal() != 0)
+			return getInternal()->getParameters();
+		else 
+			return UGenArray();
+	}
+};
+
+/** Zeros every bin with a magnitude below the threshold. */
+class SpectralGate : public SpectralProcess
+{
+public:
+	SpectralGate(UGen const& threshold = 0.001f) throw()
+	:	SpectralProcess(new SpectralGateInternal(threshold))
+	{
+	}
+};
+
+/** Holds the spectrum while freeze is 0.5 or more. */
+class SpectralFreeze : public SpectralProcess
+{
+public:
+	SpectralFreeze(UGen const& freeze) throw()
+	:	SpectralProcess(new SpectralFreezeInternal(freeze))
+	{
+	}
+};
+
+/** Shifts the pitch by a frequency ratio (e.g., 2 is up an octave), the duration is unchanged. */
+class SpectralPitchShift : public SpectralProcess
+{
+public:
+	SpectralPitchShift(UGen const& ratio) throw()
+	:	SpectralProcess(new SpectralPitchShiftInternal(ratio))
+	{
+	}
+};
+
+/** Smears the magnitudes over time, amount is between 0 (no effect) and 1 (hold forever). */
+class SpectralBlur : public SpectralProcess
+{
+public:
+	SpectralBlur(UGen const& amount) throw()
+	:	SpectralProcess(new SpectralBlurInternal(amount))
+	{
+	}
+};
+
+
+#endif // _UGEN_ugen_SpectralProcess_H_
@@ -35,7 +35,7 @@
  ==============================================================================
  */
 
-#if !defined(WIN32) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
+#if defined(__APPLE__) && !defined(UGEN_IPHONE) && !defined(UGEN_ANDROID)
 	#include <Accelerate/Accelerate.h>
 	#include <CoreServices/CoreServices.h>
 #endif
@@ -72,7 +72,8 @@ ScopeGUI::ScopeGUI(const ScopeStyles style)
 	textSizeY(9.f),
 	textSizeChannel(11.f),
 	labelChannels(true),
-	channelLabelOffset(0)
+	channelLabelOffset(0),
+	pollsSnapshots(false)
 {
 	colours[Background] =	RGBAColour(0.2, 0.2, 0.2);
 	colours[TopLine] =		RGBAColour(0.6, 0.6, 0.6);
@@ -246,6 +247,51 @@ void ScopeGUI::handleBuffer(Buffer const& buffer, const double offset, const int
 	setAudioBuffer(buffer, offset, fftSize);
 }
 
+bool ScopeGUI::handleSnapshots(TripleBuffer const& snapshots) throw()
+{
+	if(pollsSnapshots == false) return false;
+	
+	lock();
+	snapshotSources.add(snapshots);
+	unlock();
+	
+	return true;
+}
+
+bool ScopeGUI::pollSnapshots() throw()
+{
+	lock();
+	ObjectArray<TripleBuffer> sources = snapshotSources;
+	unlock();
+	
+	bool changed = false;
+	
+	for(int i = 0; i < sources.size(); i++)
+	{
+		TripleBuffer& snapshots = sources[i];
+		
+		if(snapshots.update() == false) 
+			continue;
+		
+		const int size = snapshots.getReadSize();
+		const int numChannels = snapshots.getNumChannels();
+		
+		if(size < 1) 
+			continue;
+		
+		if((snapshotBuffer.size() != size) || (snapshotBuffer.getNumChannels() != numChannels))
+			snapshotBuffer = Buffer::withSize(size, numChannels, false);
+		
+		for(int channel = 0; channel < numChannels; channel++)
+			memcpy(snapshotBuffer.getData(channel), snapshots.getReadData(channel), size * sizeof(float));
+		
+		setAudioBuffer(snapshotBuffer, snapshots.getReadValue1(), snapshots.getReadValue2());
+		changed = true;
+	}
+	
+	return changed;
+}
+
 void ScopeGUI::setWrap(const double amount) throw()
 {
 	lock();
@@ -573,9 +619,8 @@ void ScopeGUI::resizedGUI()
 //	internalUGens[0] = new ScopeUGenInternal(scopeGUI, input, duration.mix());
 //}
 
-BufferSenderUGenInternal::BufferSenderUGenInternal(UGen const& input, UGen const& duration) throw()
+BufferSenderUGenInternal::BufferSenderUGenInternal(UGen const& input, UGen const& duration, const float maximumDuration) throw()
 :	UGenInternal(NumInputs),
-	audioBuffer(Buffer::withSize((int)(UGen::getSampleRate()), input.getNumChannels(), true)),
 	bufferIndex(0),
 	audioBufferSizeUsed(0),
 	samplesProcessed(0)
@@ -584,47 +629,34 @@ BufferSenderUGenInternal::BufferSenderUGenInternal(UGen const& input, UGen const
 	inputs[Duration] = duration;
 	
 	audioBufferSizeUsed = max(1, (int)(duration.getValue() * UGen::getSampleRate() + 0.5));
+	
+	const int maximumSize = max(audioBufferSizeUsed, (int)(maximumDuration * UGen::getSampleRate() + 0.5));
+	audioBuffer = Buffer::withSize(maximumSize, input.getNumChannels(), true);
+	enableSnapshots(maximumSize, input.getNumChannels());
 }
 
+void BufferSenderUGenInternal::sendAudioBuffer() throw()
+{
+	publishSnapshot(audioBuffer, audioBufferSizeUsed, samplesProcessed);
+	
+	if(receivers.size() > 0)
+	{
+		if(audioBufferSizeUsed == audioBuffer.size())
+			sendBuffer(audioBuffer, samplesProcessed);
+		else
+			sendBuffer(audioBuffer.getRegion(0, audioBufferSizeUsed-1), samplesProcessed);
+	}
+	
+	bufferIndex = 0;
+}
 
 void BufferSenderUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int /*channel*/) throw()
 {
 	float duration = *(inputs[Duration].processBlock(shouldDelete, blockID, 0));	
-	int audioBufferSizeRequired = max(1, (int)(duration * UGen::getSampleRate() + 0.5));
-	int audioBufferAllocatedSize = audioBuffer.size();			  
+	audioBufferSizeUsed = clip((int)(duration * UGen::getSampleRate() + 0.5), 1, audioBuffer.size());
 	
-	if(audioBufferSizeRequired > audioBufferAllocatedSize)
-	{
-		if((audioBufferAllocatedSize > 1) && (bufferIndex >= audioBufferAllocatedSize))
-		{
-			sendBuffer(audioBuffer.getRegion(0, audioBufferAllocatedSize-1), samplesProcessed);
-		}
-		
-		audioBufferAllocatedSize = audioBufferSizeRequired;
-		audioBuffer = Buffer::withSize(audioBufferAllocatedSize, inputs[Input].getNumChannels(), false);
-		audioBufferSizeUsed = audioBufferSizeRequired;
-		bufferIndex = 0;
-	}
-	else if(audioBufferSizeRequired < audioBufferAllocatedSize)
-	{
-		audioBufferSizeUsed = audioBufferSizeRequired;
-		
-		if(bufferIndex >= audioBufferSizeUsed)
-		{
-			if(audioBufferSizeUsed == audioBuffer.size())
-			{
-				sendBuffer(audioBuffer, samplesProcessed);
-			}
-			else
-			{
-				sendBuffer(audioBuffer.getRegion(0, audioBufferSizeUsed-1), samplesProcessed);
-				audioBufferAllocatedSize = audioBufferSizeRequired;
-				audioBuffer = Buffer::withSize(audioBufferAllocatedSize, inputs[Input].getNumChannels(), false);
-			}
-			
-			bufferIndex = 0;
-		}
-	}
+	if(bufferIndex >= audioBufferSizeUsed)
+		sendAudioBuffer();
 	
 	int numSamplesRemaining = uGenOutput.getBlockSize();
 	int offset = 0;
@@ -650,27 +682,14 @@ void BufferSenderUGenInternal::processBlock(bool& shouldDelete, const unsigned i
 		offset += numSamplesThisTime;
 		
 		if(bufferIndex >= audioBufferSizeUsed)
-		{
-			if(audioBufferSizeUsed == audioBuffer.size())
-			{
-				sendBuffer(audioBuffer, samplesProcessed);
-			}
-			else
-			{
-				sendBuffer(audioBuffer.getRegion(0, audioBufferSizeUsed-1), samplesProcessed);
-				audioBufferAllocatedSize = audioBufferSizeRequired;
-				audioBuffer = Buffer::withSize(audioBufferAllocatedSize, inputs[Input].getNumChannels(), false);
-			}			
-			
-			bufferIndex = 0;
-		}	
+			sendAudioBuffer();
 	}	
 }
 
-Sender::Sender(UGen const& input, UGen const& duration) throw()
+Sender::Sender(UGen const& input, UGen const& duration, const float maximumDuration) throw()
 {
 	initInternal(1);
-	internalUGens[0] = new BufferSenderUGenInternal(input, duration.mix());
+	internalUGens[0] = new BufferSenderUGenInternal(input, duration.mix(), maximumDuration);
 }
 
 //SpectralScopeUGenInternal::SpectralScopeUGenInternal(ScopeGUIPtrPtr scopeGUI, 
@@ -849,6 +868,8 @@ FFTSenderUGenInternal::FFTSenderUGenInternal(UGen const& input,
 //	ugen_assert(numBins == numBins_);	// should be in range	
 	
 	inputs[Input] = input;	
+	
+	fftEngine.prepareBatch();
 }
 
 void FFTSenderUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int /*channel*/) throw()
@@ -885,10 +906,7 @@ void FFTSenderUGenInternal::processBlock(bool& shouldDelete, const unsigned int
 	if(bufferIndex == 0)
 	{
 		// do fft and send
-		for(int channel = 0; channel < inputBuffer.getNumChannels(); channel++)
-		{				
-			fftEngine.fft(outputBuffer, inputBuffer, true, channel, channel);
-		}
+		fftEngine.fftBatch(outputBuffer, inputBuffer, true);
 		
 		switch(mode_)
 		{
@@ -186,6 +186,19 @@ public:
 	const TextArray& getChannelLabels() const throw() { return channelLabels; }
 	int getChannelLabelOffset() const throw() { return channelLabelOffset; }
 	
+	/** Read buffers from Sender UGens as snapshots rather than being sent them on the audio thread.
+	 This only affects senders this is added to afterwards. When it is on, the thread which draws the
+	 scope (e.g., in an openFrameworks app's draw()) must call pollSnapshots() before drawing. 
+	 The default is off as the Juce and iPhone scopes are redrawn when a buffer is sent. */
+	void setPollsSnapshots(const bool state) throw() { pollsSnapshots = state; }
+	bool getPollsSnapshots() const throw() { return pollsSnapshots; }
+	
+	/** Display the latest complete buffer from each sender if a new one has been published.
+	 @return @c true if the displayed buffer changed. */
+	bool pollSnapshots() throw();
+	
+	bool handleSnapshots(TripleBuffer const& snapshots) throw();
+	
 	virtual int getDisplayBufferSize() const = 0;
 	//virtual int getHeight() const = 0;
 	virtual void updateGUI() = 0;
@@ -227,6 +240,10 @@ protected:
 	TextArray channelLabels;
 	int channelLabelOffset;
 	
+	bool pollsSnapshots;
+	ObjectArray<TripleBuffer> snapshotSources;
+	Buffer snapshotBuffer;
+	
 	void calculateBuffers();
 	void resizedGUI();
 };
@@ -269,12 +286,14 @@ class BufferSenderUGenInternal :	public UGenInternal,
 									public BufferSender
 {
 public:
-	BufferSenderUGenInternal(UGen const& input, UGen const& duration) throw();	
+	BufferSenderUGenInternal(UGen const& input, UGen const& duration, const float maximumDuration) throw();	
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
 	
 	enum Inputs { Input, Duration, NumInputs };
 	
 private:
+	void sendAudioBuffer() throw();
+	
 	Buffer audioBuffer;
 	int bufferIndex;
 	int audioBufferSizeUsed;
@@ -284,10 +303,16 @@ private:
 /** Collects samples and sends them as a Buffer to one or more receivers.
  This can be used to send data to a oscilloscope (e.g., ScopeComponent) or
  for other purposes (e.g., analysis). 
+ 
+ The buffer is allocated for the maximum duration when the UGen is created, the duration 
+ is limited to this. Receivers which accept snapshots (e.g., a ScopeGUI with setPollsSnapshots()
+ turned on) read the latest complete buffer from a TripleBuffer on their own thread. Other 
+ receivers are still sent buffers on the audio thread and if the duration is less than the 
+ maximum this makes a Buffer for the region each time.
  @see FFTSender */
 UGenSublcassDeclarationNoDefault(Sender, 
-								 (input, duration), 
-								 (UGen const& input, UGen const& duration = 0.1), COMMON_UGEN_DOCS);
+								 (input, duration, maximumDuration), 
+								 (UGen const& input, UGen const& duration = 0.1, const float maximumDuration = 1.f), COMMON_UGEN_DOCS);
 
 ///** @ingroup UGenInternals GUITools */
 //class SpectralScopeUGenInternal :	public UGenInternal // this SHOULDN'T be a ProxyOwner so that
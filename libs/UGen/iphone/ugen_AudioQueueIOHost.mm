@@ -288,6 +288,7 @@ inline void AQOutputBufferCallback(void					*in,
 	{
         outQB->mAudioDataByteSize = aqc->outputInfo.dataFormat.mBytesPerPacket * numFramesToProcess;
         
+		BackgroundThread::setAudioThread();
 		int blockID = UGen::getNextBlockID(numFramesToProcess);
 		
 		for(int channel = 0; channel < aqc->outputInfo.dataFormat.mChannelsPerFrame; channel++)
@@ -455,6 +455,7 @@ static inline void audioShortToFloatChannels(AudioBufferList* src, float* dst[],
 		floatBuffer = new float[inNumberFrames * NUM_CHANNELS];
 	}
 	
+	BackgroundThread::setAudioThread();
 	long blockID = UGen::getNextBlockID(inNumberFrames);
 	
 	float *floatBufferData[2];
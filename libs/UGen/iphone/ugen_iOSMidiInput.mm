@@ -700,7 +700,7 @@ void VoicerUGenInternal::processBlock(bool& shouldDelete, const unsigned int blo
 	
 	lock();
 	{
-		SpawnBaseUGenInternal::processBlock(shouldDelete, blockID, -1);
+		VoicerBaseUGenInternal::processBlock(shouldDelete, blockID, -1);
 	}
 	unlock();
 }
@@ -336,6 +336,7 @@ inline void JuceIOHostInternal::audioDeviceIOCallback (const float** inputChanne
 	// may need to be a bit cleverer with the channels in here..
 	const ScopedLock sl(lock);
 	
+	BackgroundThread::setAudioThread();
 	int blockID = UGen::getNextBlockID(numSamples);
 	
 	owner_->preTick(numSamples, blockID);
@@ -160,7 +160,7 @@ void VoicerUGenInternal::processBlock(bool& shouldDelete, const unsigned int blo
 	if(midiMessages.isEmpty() == true)
 	{
 		const ScopedLock sl(lock);
-		SpawnBaseUGenInternal::processBlock(shouldDelete, blockID, -1);
+		VoicerBaseUGenInternal::processBlock(shouldDelete, blockID, -1);
 	}
 	else
 	{
@@ -174,6 +174,11 @@ void VoicerUGenInternal::processBlock(bool& shouldDelete, const unsigned int blo
 		const int numChannels = getNumChannels();
 		const int midiChannel = midiChannel_;
 		
+		{
+			const ScopedLock sl(lock);
+			pool.removeFinished(blockID);
+		}
+		
 		while(iter.getNextEvent(message, samplePos) && (samplePos < blockSize))
 		{
 			const ScopedLock sl(lock);
@@ -205,32 +210,23 @@ void VoicerUGenInternal::processBlock(bool& shouldDelete, const unsigned int blo
 										
 					if(velocity > 0)
 					{
-						if(numVoices_ > 0)
-						{
-							const int voicesUsed = countNonstealingVoices();
-							if(voicesUsed >= numVoices_)
-							{
-								UGen stealee = chooseStealee();
-								
-								if(stealee.isNotNull())
-								{
-									stealee.userData = stealingUserData;
-									stealee.steal(forcedSteal_);
-								}
-							}
-						}
+						if(numVoices_ > 0 && countNonstealingVoices() >= numVoices_)
+							stealOldestVoice();
 						
 						// stop double notes, AU lab was sending two ons but one off - seems fixed in Au Lab 2.2
 						//stealNote(midiChannel, midiNote, false, true); 
 						
 						UGen newEvent = spawnEvent(*this, currentEventIndex++, midiChannel, midiNote, velocity);
-						newEvent.userData = createUserData(midiChannel, midiNote);
-						events.add(newEvent);
+						
+						if(newEvent.isNotNull())
+						{
+							newEvent.userData = createUserData(midiChannel, midiNote);
+							addVoice(newEvent, midiChannel, midiNote);
+						}
 					}
 					else
 					{
-						UGen releasee = chooseReleasee(midiChannel, midiNote);
-						if(releasee.isNotNull()) releasee.release();
+						releaseVoice(midiChannel, midiNote);
 					}
 				}
 				else if(message.isController())
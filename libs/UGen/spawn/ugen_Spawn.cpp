@@ -55,7 +55,8 @@ SpawnBaseUGenInternal::SpawnBaseUGenInternal(const int numInputs, const int _num
 	ugen_assert(numChannels > 0);
 	ugen_assert(maxRepeats >= 0);
 	initEvents();
-	mixer = Mix(events, false);
+	events.reserve(InitialEventCapacity);
+	mixer = Mix(events, false, true, numChannels); // the events are empty now so give the channels rather than let Mix count them
 }
 
 SpawnBaseUGenInternal::~SpawnBaseUGenInternal()// throw()
@@ -95,7 +96,7 @@ void SpawnBaseUGenInternal::stealInternal() throw()
 
 void SpawnBaseUGenInternal::initEvents() throw()
 {
-	events.clear();
+	events.clear(false); // keep the allocation, this may be on the audio thread
 	stopEvents = false;
 }
 
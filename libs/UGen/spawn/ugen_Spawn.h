@@ -52,11 +52,13 @@ public:
 	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
 	void releaseInternal() throw();
 	void stealInternal() throw();
-	void initEvents() throw();
+	virtual void initEvents() throw();
 	bool stopAllEvents() throw();
 	bool shouldStopAllEvents() { return stopEvents; }
 	
 	inline UGenArray& getEvents() { return events; }
+	
+	enum Constants { InitialEventCapacity = 16 };
 		
 protected:	
 	const int numChannels;
@@ -46,15 +46,193 @@ BEGIN_UGEN_NAMESPACE
 #include "../core/ugen_UGenArray.h"
 
 
+VoicePool::VoicePool(const int initialCapacity) throw()
+:	slots(0),
+	capacity(0),
+	firstFree(-1),
+	numSounding(0),
+	oldest(-1),
+	newest(-1)
+{
+	ugen_assert(initialCapacity > 0);
+	
+	for(int i = 0; i < NumBuckets; i++)
+		newestWithKey[i] = -1;
+	
+	capacity = initialCapacity;
+	slots = new Slot[capacity];
+	
+	for(int i = capacity - 1; i >= 0; i--)
+	{
+		slots[i].state = Free;
+		slots[i].newer = firstFree;
+		firstFree = i;
+	}
+}
+
+VoicePool::~VoicePool()
+{
+	delete [] slots;
+}
+
+void VoicePool::grow() throw()
+{
+	// only when more voices are fading out than expected, the indices stay the same
+	const int newCapacity = capacity * 2;
+	Slot* newSlots = new Slot[newCapacity];
+	
+	for(int i = 0; i < capacity; i++)
+		newSlots[i] = slots[i];
+	
+	for(int i = newCapacity - 1; i >= capacity; i--)
+	{
+		newSlots[i].state = Free;
+		newSlots[i].newer = firstFree;
+		firstFree = i;
+	}
+	
+	delete [] slots;
+	slots = newSlots;
+	capacity = newCapacity;
+}
+
+int VoicePool::add(UGen const& voice, const int midiChannel, const int midiNote) throw()
+{
+	if(firstFree < 0) grow();
+	
+	const int index = firstFree;
+	Slot& slot = slots[index];
+	firstFree = slot.newer;
+	
+	slot.voice = voice;
+	slot.midiChannel = midiChannel;
+	slot.midiNote = midiNote;
+	slot.state = Sounding;
+	
+	slot.older = newest;
+	slot.newer = -1;
+	if(newest >= 0) slots[newest].newer = index;
+	else oldest = index;
+	newest = index;
+	
+	const int bucket = getBucket(midiChannel, midiNote);
+	slot.olderWithKey = newestWithKey[bucket];
+	slot.newerWithKey = -1;
+	if(slot.olderWithKey >= 0) slots[slot.olderWithKey].newerWithKey = index;
+	newestWithKey[bucket] = index;
+	
+	numSounding++;
+	
+	return index;
+}
+
+void VoicePool::unlink(const int index) throw()
+{
+	Slot& slot = slots[index];
+	
+	if(slot.older >= 0) slots[slot.older].newer = slot.newer;
+	else oldest = slot.newer;
+	
+	if(slot.newer >= 0) slots[slot.newer].older = slot.older;
+	else newest = slot.older;
+	
+	if(slot.olderWithKey >= 0) slots[slot.olderWithKey].newerWithKey = slot.newerWithKey;
+	
+	if(slot.newerWithKey >= 0) slots[slot.newerWithKey].olderWithKey = slot.olderWithKey;
+	else newestWithKey[getBucket(slot.midiChannel, slot.midiNote)] = slot.olderWithKey;
+	
+	numSounding--;
+}
+
+void VoicePool::markStolen(const int index) throw()
+{
+	ugen_assert(index >= 0 && index < capacity);
+	
+	if(slots[index].state == Sounding)
+	{
+		unlink(index);
+		slots[index].state = Stolen;
+	}
+}
+
+void VoicePool::freeSlot(const int index) throw()
+{
+	Slot& slot = slots[index];
+	
+	if(slot.state == Sounding) unlink(index);
+	
+	slot.voice = UGen::getNull();
+	slot.state = Free;
+	slot.newer = firstFree;
+	firstFree = index;
+}
+
+void VoicePool::removeFinished(const unsigned int blockID) throw()
+{
+	for(int i = 0; i < capacity; i++)
+	{
+		if(slots[i].state != Free && slots[i].voice.shouldBeDeletedNow(blockID))
+			freeSlot(i);
+	}
+}
+
+void VoicePool::clear() throw()
+{
+	for(int i = 0; i < capacity; i++)
+	{
+		if(slots[i].state != Free)
+			freeSlot(i);
+	}
+}
+
+int VoicePool::findNewest(const int midiChannel, const int midiNote) const throw()
+{
+	for(int i = newestWithKey[getBucket(midiChannel, midiNote)]; i >= 0; i = slots[i].olderWithKey)
+	{
+		if(slots[i].midiChannel == midiChannel && slots[i].midiNote == midiNote)
+			return i;
+	}
+	
+	return -1;
+}
+
+int VoicePool::findOldest(const int midiChannel, const int midiNote) const throw()
+{
+	int found = -1;
+	
+	for(int i = newestWithKey[getBucket(midiChannel, midiNote)]; i >= 0; i = slots[i].olderWithKey)
+	{
+		if(slots[i].midiChannel == midiChannel && slots[i].midiNote == midiNote)
+			found = i;
+	}
+	
+	return found;
+}
+
 VoicerBaseUGenInternal::VoicerBaseUGenInternal(const int numChannels, const int numVoices, const bool forcedSteal) throw()
 :	SpawnBaseUGenInternal(0, numChannels, 0),
 	numVoices_(numVoices),
 	stealMode_(StealOldest),
 	forcedSteal_(forcedSteal),
-	ageCounter(0)
+	ageCounter(0),
+	pool(numVoices > 0 ? numVoices * 2 : (int)InitialEventCapacity) // room for the stolen voices to fade out
 {
 	ugen_assert(numChannels > 0);
 	ugen_assert(numVoices >= 0);
+	
+	events.reserve(pool.getCapacity());
+}
+
+void VoicerBaseUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	pool.removeFinished(blockID);
+	SpawnBaseUGenInternal::processBlock(shouldDelete, blockID, channel);
+}
+
+void VoicerBaseUGenInternal::initEvents() throw()
+{
+	SpawnBaseUGenInternal::initEvents();
+	pool.clear();
 }
 
 bool VoicerBaseUGenInternal::sendMidiNote(const int midiChannel, 
@@ -68,20 +246,8 @@ bool VoicerBaseUGenInternal::sendMidiNote(const int midiChannel,
 
 	if(velocity > 0)
 	{
-		if(numVoices_ > 0)
-		{
-			const int voicesUsed = countNonstealingVoices();
-			if(voicesUsed >= numVoices_)
-			{
-				UGen stealee = chooseStealee();
-					
-				if(stealee.isNotNull())
-				{
-					stealee.userData = stealingUserData;
-					stealee.steal(forcedSteal_);
-				}
-			}
-		}
+		if(numVoices_ > 0 && pool.getNumSounding() >= numVoices_)
+			stealOldestVoice();
 		
 		// stop double notes, AU lab was sending two ons but only one off 
 		// stealNote(midiChannel, midiNote, false, true);  // let's only do this in the Juce version..
@@ -91,18 +257,12 @@ bool VoicerBaseUGenInternal::sendMidiNote(const int midiChannel,
         if(newEvent.isNotNull())
         {
             newEvent.userData = userData;
-            events.add(newEvent);
+            addVoice(newEvent, midiChannel, midiNote);
         }        
 	}
 	else
 	{
-		UGen releasee = chooseReleasee(midiChannel, midiNote);
-		
-		if(releasee.isNotNull())
-		{
-			//releasee.userData = UGen::defaultUserData; // need to rethink why I really wanted to do this
-			releasee.release();
-		}
+		releaseVoice(midiChannel, midiNote);
 	}
 	
 	return true;
@@ -113,54 +273,66 @@ bool VoicerBaseUGenInternal::stealNote(const int midiChannel,
 									   const bool forcedSteal,
 									   const bool stealAll) throw()
 {
-	const int userData = createUserData(midiChannel, midiNote);
 	bool didSteal = false;
+	int index = stealAll ? pool.findNewest(midiChannel, midiNote) : pool.findOldest(midiChannel, midiNote);
 	
-	for(int i = 0; i < events.size(); i++)
+	while(index >= 0)
 	{
-		UGen& event = events[i];
-		if(event.userData == userData)
-		{
-			event.userData = stealingUserData;
-			event.steal(forcedSteal);
-			if(stealAll)
-				didSteal = true;
-			else
-				return true;
-		}
+		UGen& event = pool.getVoice(index);
+		event.userData = stealingUserData;
+		event.steal(forcedSteal);
+		pool.markStolen(index);
+		didSteal = true;
+		
+		if(stealAll == false)
+			break;
+		
+		index = pool.findNewest(midiChannel, midiNote);
 	}
 	
 	return didSteal;
 }
 
-int VoicerBaseUGenInternal::countNonstealingVoices() const throw()
+void VoicerBaseUGenInternal::addVoice(UGen const& voice, const int midiChannel, const int midiNote) throw()
+{
+	events.add(voice);
+	pool.add(voice, midiChannel, midiNote);
+}
+
+void VoicerBaseUGenInternal::stealOldestVoice() throw()
 {
-	const int numEvents = events.size();
-	int nonStealingVoices = 0;
+	const int index = pool.getOldest();
 	
-	for(int i = 0; i < numEvents; i++)
+	if(index >= 0)
 	{
-		if(events[i].userData != stealingUserData)
-			nonStealingVoices++;
+		UGen& stealee = pool.getVoice(index);
+		stealee.userData = stealingUserData;
+		stealee.steal(forcedSteal_);
+		pool.markStolen(index);
 	}
-	
-	return nonStealingVoices;
 }
 
-const UGen& VoicerBaseUGenInternal::chooseStealee() throw()
+void VoicerBaseUGenInternal::releaseVoice(const int midiChannel, const int midiNote) throw()
 {
-	// could use different methods in here to select the voice to steal
+	const int index = pool.findNewest(midiChannel, midiNote);
 	
-	const int numEvents = events.size();
-	
-	for(int i = 0; i < numEvents; i++)
+	if(index >= 0)
 	{
-		UGen& stealee = events[i];
-		if(stealee.userData != stealingUserData && stealee.isNotNull())
-			return stealee;
+		//releasee.userData = UGen::defaultUserData; // need to rethink why I really wanted to do this
+		pool.getVoice(index).release();
 	}
-	
-	return UGen::getNull();
+}
+
+int VoicerBaseUGenInternal::countNonstealingVoices() const throw()
+{
+	return pool.getNumSounding();
+}
+
+const UGen& VoicerBaseUGenInternal::chooseStealee() throw()
+{
+	// could use different methods in here to select the voice to steal
+	const int index = pool.getOldest();
+	return index >= 0 ? pool.getVoice(index) : UGen::getNull();
 }
 
 const UGen& VoicerBaseUGenInternal::chooseReleasee(const int midiChannel, const int midiNote) throw()
@@ -168,22 +340,8 @@ const UGen& VoicerBaseUGenInternal::chooseReleasee(const int midiChannel, const
 	ugen_assert(midiChannel == char(midiChannel));
 	ugen_assert(midiNote == char(midiNote));
 
-	const int numEvents = events.size();
-	
-	for(int i = numEvents-1; i >= 0; i--) // release in reverse ?
-	{
-		UGen& releasee = events[i];
-		VoicerUserDataStruct data = getUserData(releasee.userData);
-		if((data.midiChannel == midiChannel)
-		   && (data.midiNote == midiNote) 
-		   // && (releasee.isReleasing() == false // something like this would be useful but tricky to implement
-		   )
-		{
-			return releasee;
-		}
-	}
-	
-	return UGen::getNull();
+	const int index = pool.findNewest(midiChannel, midiNote);
+	return index >= 0 ? pool.getVoice(index) : UGen::getNull();
 }
 
 int VoicerBaseUGenInternal::createUserData(const int midiChannel, const int midiNote) throw()
@@ -55,11 +55,83 @@ typedef union VoicerUserDataUnion
 	int i;
 } VoicerUserDataUnion;
 
+/** Keeps track of the voices of a VoicerBaseUGenInternal.
+ 
+ Each voice has a slot which holds a reference to its graph along with its MIDI channel and note.
+ Free slots are kept on a free list, sounding voices are linked in order of age and into a hash
+ table by MIDI channel and note, so starting, stealing and releasing a voice doesn't search the
+ voices. The slots are allocated up front and only grow if more voices are fading out after being
+ stolen than there is room for. Slots are freed the block after their voices' DoneActions. */
+class VoicePool
+{
+public:
+	VoicePool(const int initialCapacity) throw();
+	~VoicePool();
+	
+	/** Add a voice and return its slot. */
+	int add(UGen const& voice, const int midiChannel, const int midiNote) throw();
+	
+	/** Take a voice out of the sounding voices, it keeps its slot until it finishes. */
+	void markStolen(const int index) throw();
+	
+	/** Free the slots of voices which were deleted by a DoneAction. */
+	void removeFinished(const unsigned int blockID) throw();
+	
+	/** Free all the slots. */
+	void clear() throw();
+	
+	/** The most recent sounding voice with this MIDI channel and note, or -1. */
+	int findNewest(const int midiChannel, const int midiNote) const throw();
+	
+	/** The earliest sounding voice with this MIDI channel and note, or -1. */
+	int findOldest(const int midiChannel, const int midiNote) const throw();
+	
+	inline int getOldest() const throw()					{ return oldest;				}
+	inline int getNumSounding() const throw()				{ return numSounding;			}
+	inline int getCapacity() const throw()					{ return capacity;				}
+	inline UGen& getVoice(const int index) throw()			{ return slots[index].voice;	}
+	
+	enum Constants { NumBuckets = 2048 };
+	
+private:
+	enum State { Free, Sounding, Stolen };
+	
+	struct Slot
+	{
+		UGen voice;
+		int midiChannel, midiNote;
+		int state;
+		int older, newer;					// age order while sounding, newer is the free list link
+		int olderWithKey, newerWithKey;		// hash bucket order while sounding
+	};
+	
+	static inline int getBucket(const int midiChannel, const int midiNote) throw()
+	{
+		return ((midiChannel << 7) + midiNote) & (NumBuckets - 1);
+	}
+	
+	void grow() throw();
+	void unlink(const int index) throw();
+	void freeSlot(const int index) throw();
+	
+	Slot* slots;
+	int capacity;
+	int firstFree;
+	int numSounding;
+	int oldest, newest;
+	int newestWithKey[NumBuckets];
+	
+	VoicePool (const VoicePool&);
+    const VoicePool& operator= (const VoicePool&);
+};
+
 /** @ingroup UGenInternals */
 class VoicerBaseUGenInternal : public SpawnBaseUGenInternal
 {
 public:
 	VoicerBaseUGenInternal(const int numChannels, const int numVoices, const bool forcedSteal) throw();
+	void processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw();
+	void initEvents() throw();
 
 	/** Send a MIDI note message to the voicer.
 	 This should spawn a new voice if it is a note on (velocity is not zero), or release a voice if
@@ -117,6 +189,17 @@ protected:
 	
 	static const int stealingUserData;
 	
+	VoicePool pool;
+	
+	/** Add a voice spawned for a note on. */
+	void addVoice(UGen const& voice, const int midiChannel, const int midiNote) throw();
+	
+	/** Steal the oldest sounding voice, if there is one. */
+	void stealOldestVoice() throw();
+	
+	/** Release the most recent voice started by this note. */
+	void releaseVoice(const int midiChannel, const int midiNote) throw();
+	
 	int countNonstealingVoices() const throw();
 	const UGen& chooseStealee() throw();
 	const UGen& chooseReleasee(const int midiChannel, const int midiNote) throw();
@@ -0,0 +1,62 @@
+// $Id$
+// $HeadURL$
+
+/*
+ ==============================================================================
+ 
+ This file is part of the UGEN++ library
+ Copyright 2008-11 The University of the West of England.
+ by Martin Robinson
+ 
+ ------------------------------------------------------------------------------
+ 
+ UGEN++ can be redistributed and/or modified under the terms of the
+ GNU General Public License, as published by the Free Software Foundation;
+ either version 2 of the License, or (at your option) any later version.
+ 
+ UGEN++ is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with UGEN++; if not, visit www.gnu.org/licenses or write to the
+ Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ Boston, MA 02111-1307 USA
+ 
+ The idea for this project and code in the UGen implementations is
+ derived from SuperCollider which is also released under the 
+ GNU General Public License:
+ 
+ SuperCollider real time audio synthesis system
+ Copyright (c) 2002 James McCartney. All rights reserved.
+ http://www.audiosynth.com
+ 
+ ==============================================================================
+ */
+
+#include "../core/ugen_StandardHeader.h"
+
+#ifdef UGEN_SIMD
+
+BEGIN_UGEN_NAMESPACE
+
+#include "../basics/ugen_MulAdd.h"
+#include "../core/ugen_SIMD.h"
+
+// SSE2/AVX2/NEON versions of some of the UGen processing functions, see ugen_SIMD.h
+
+void MulAddUGenInternal::processBlock(bool& shouldDelete, const unsigned int blockID, const int channel) throw()
+{
+	const int numSamplesToProcess = uGenOutput.getBlockSize();
+	float* const outputSamples = uGenOutput.getSampleData();
+	const float* const inputSamples = inputs[Input].processBlock(shouldDelete, blockID, channel);
+	const float* const mulSamples = inputs[Mul].processBlock(shouldDelete, blockID, channel);
+	const float* const addSamples = inputs[Add].processBlock(shouldDelete, blockID, channel);	
+	SIMD::mulAdd(inputSamples, mulSamples, addSamples, outputSamples, numSamplesToProcess);
+}
+
+
+END_UGEN_NAMESPACE
+
+#endif
@@ -82,15 +82,37 @@ Server& Server::get()
 	return *_instance;
 }
 
-Server::Server()
+Server::Server() : output_buffer(NULL), renderer(NULL), latest_renderer(NULL), num_render_threads(1), fuse_graphs(false), share_output_blocks(false), num_output(0), buffer_size(0), commands(4096), retired_arrays(64), array_capacity(0), num_blocks_rendered(0), num_playing(0), num_adds_received(0), num_adds_sent(0)
 {
 	UGen::initialise();
+	UGen::setDeleter(&deleter);
 }
 
 Server::~Server()
 {
 	close();
 	
+	// the audio thread has stopped so free anything still queued for it here
+	Command command;
+	while (commands.pop(command))
+	{
+		if (command.ugens)
+			command.ugens->decrementRefCount();
+		
+		delete command.storage;
+	}
+	
+	UGenArray *storage;
+	while (retired_arrays.pop(storage))
+		delete storage;
+	
+	delete renderer;
+	renderer = NULL;
+	
+	for (int i = 0; i < retired_renderers.size(); i++)
+		delete retired_renderers[i];
+	retired_renderers.clear();
+	
 	UGen::shutdown();
 }
 
@@ -100,26 +122,40 @@ void Server::audioIn(float *input, int bufferSize, int nChannels)
 
 void Server::audioOut(float *output, int bufferSize, int nChannels)
 {
-	if (mutex.tryLock())
+	// the device may change the callback thread so mark it each time
+	BackgroundThread::setAudioThread();
+	
+	processCommands();
+	
+	if (renderer)
 	{
-		if (!out.isNull())
-		{
-			int blockID = UGen::getNextBlockID(bufferSize);
-			
-			out.setOutputs(output_buffer->getSeparatedBuffer(), bufferSize, nChannels);
-			out.prepareAndProcessBlock(bufferSize, blockID, -1);
-		}
-
-		mutex.unlock();
+		int blockID = UGen::getNextBlockID(bufferSize);
+		
+		renderer->process(array, output_buffer->getSeparatedBuffer(), bufferSize, nChannels, blockID);
+	}
+	else if (!out.isNull())
+	{
+		int blockID = UGen::getNextBlockID(bufferSize);
+		
+		out.setOutputs(output_buffer->getSeparatedBuffer(), bufferSize, nChannels);
+		out.prepareAndProcessBlock(bufferSize, blockID, -1);
 	}
 	
 	output_buffer->updateInterlevaedBuffer();
 	
 	memcpy(output, output_buffer->getInterleavedBuffer(), sizeof(float) * bufferSize * nChannels);
+	
+	atomicSet(num_playing, array.size());
+	atomicIncrement(num_blocks_rendered);
 }
 
 void Server::setup(int num_output, int num_input, float sample_rate, int buffer_size)
 {
+	this->num_output = num_output;
+	this->buffer_size = buffer_size;
+	
+	UGen::prepareToPlay(sample_rate, buffer_size);
+	
 	if (num_input)
 	{
 		num_input = 0;
@@ -127,16 +163,35 @@ void Server::setup(int num_output, int num_input, float sample_rate, int buffer_
 		// stream.setInput(this);
 	}
 	
-	if (num_output)
 	{
-		stream.setOutput(this);
-		output_buffer = new BufferBlock(buffer_size, num_output);
-		out = Pan2::AR(Lag::AR(0), Lag::AR(0));
+		// commands are run directly until the stream has started
+		OFXUGEN_SCOPED_LOCK;
+		
+		processCommands();
+		
+		UGenArray playing = array;
+		
+		if (num_output)
+		{
+			stream.setOutput(this);
+			output_buffer = new BufferBlock(buffer_size, num_output);
+			out = Pan2::AR(Lag::AR(0), Lag::AR(0));
+		}
+		
+		array = UGenArray(UGen::emptyChannels(num_output));
+		out = Mix(array, false);
+		array.clear();
+		
+		if (playing.size())
+			array.add(playing);
+		
+		array_capacity = max(array_capacity, array.size());
+		array.reserve(array_capacity);
+		
+		// a renderer made before this had no block size to reserve scratch for
+		if (latest_renderer)
+			latest_renderer->reserve(array_capacity, buffer_size, num_output);
 	}
-	
-	array = UGenArray(UGen::emptyChannels(num_output));
-	out = Mix(array, false);
-	array.clear();
 
 	stream.setup(num_output, num_input, sample_rate, buffer_size, 4);
 }
@@ -145,3 +200,257 @@ void Server::close()
 {
 	stream.close();
 }
+
+void Server::setNumRenderThreads(int num_threads)
+{
+	num_threads = max(num_threads, 1);
+	
+	ParallelRenderer *old_renderer = NULL;
+	
+	{
+		OFXUGEN_SCOPED_LOCK;
+		
+		if (num_threads == num_render_threads)
+			return;
+		
+		num_render_threads = num_threads;
+		
+		// start the worker threads here rather than on the audio thread
+		ParallelRenderer *new_renderer = NULL;
+		
+		if (num_threads > 1)
+		{
+			new_renderer = new ParallelRenderer(num_threads);
+			
+			// before setup() the sizes aren't known yet, setup() reserves the scratch instead
+			if (buffer_size > 0 && num_output > 0)
+				new_renderer->reserve(getNumPlayingEstimate(), buffer_size, num_output);
+		}
+		
+		old_renderer = latest_renderer;
+		latest_renderer = new_renderer;
+		
+		if (output_buffer == NULL)
+		{
+			renderer = new_renderer;
+		}
+		else
+		{
+			Command command;
+			command.type = Command::SetRenderer;
+			command.renderer = new_renderer;
+			enqueue(command);
+		}
+	}
+	
+	// stopping the worker threads can take a while so the lock isn't held from here on
+	if (old_renderer == NULL)
+		return;
+	
+	if (output_buffer == NULL)
+	{
+		delete old_renderer;
+		return;
+	}
+	
+	// once two blocks have finished, one has started after the command was queued
+	// and the audio thread can't be using the old renderer any more
+	const int num_blocks = atomicGet(num_blocks_rendered);
+	
+	for (int i = 0; i < 1000; i++)
+	{
+		if (atomicGet(num_blocks_rendered) - num_blocks >= 2)
+		{
+			delete old_renderer;
+			return;
+		}
+		
+		ofSleepMillis(1);
+	}
+	
+	// the stream has stalled, keep it until the Server is destroyed
+	OFXUGEN_SCOPED_LOCK;
+	retired_renderers.push_back(old_renderer);
+}
+
+void Server::play(UGen &ugen)
+{
+	// the graph isn't being rendered yet so this is safe to do here
+	if (fuse_graphs)
+		ugen.fuse();
+	
+	if (share_output_blocks)
+		ugen.shareOutputBlocks(buffer_size);
+	
+	Command command;
+	command.type = Command::Add;
+	command.ugens = new CommandUGens(ugen);
+	
+	OFXUGEN_SCOPED_LOCK;
+	
+	num_adds_sent++;
+	
+	const int num_playing_estimate = getNumPlayingEstimate();
+	reserveArray(num_playing_estimate);
+	
+	// the renderer never allocates on the audio thread, it renders serially what doesn't fit
+	if (latest_renderer)
+		latest_renderer->reserve(num_playing_estimate, buffer_size, num_output);
+	
+	enqueue(command);
+}
+
+void Server::stop(UGen &ugen)
+{
+	Command command;
+	command.type = Command::Remove;
+	command.ugens = new CommandUGens(ugen);
+	send(command);
+}
+
+void Server::release(UGen &ugen)
+{
+	Command command;
+	command.type = Command::Release;
+	command.ugens = new CommandUGens(ugen);
+	send(command);
+}
+
+void Server::setControl(float *control, float value)
+{
+	Command command;
+	command.type = Command::SetControl;
+	command.control = control;
+	command.value = value;
+	send(command);
+}
+
+void Server::setSource(UGen &plug, const UGen &source, bool release_previous, float fade_time)
+{
+	Command command;
+	command.type = Command::ReplaceSource;
+	command.ugens = new CommandUGens(plug, source);
+	command.release_previous = release_previous;
+	command.fade_time = fade_time;
+	send(command);
+}
+
+void Server::send(const Command &command)
+{
+	OFXUGEN_SCOPED_LOCK;
+	enqueue(command);
+}
+
+void Server::enqueue(const Command &command)
+{
+	while (!commands.push(command))
+	{
+		if (output_buffer == NULL)
+		{
+			// no audio thread to drain the queue yet
+			processCommands();
+			continue;
+		}
+		
+		// the queue is full, wait for the audio thread instead of blocking it
+		ofSleepMillis(1);
+	}
+}
+
+void Server::processCommands()
+{
+	Command command;
+	int num_added = 0;
+	
+	while (commands.pop(command))
+	{
+		switch (command.type)
+		{
+			case Command::Add:
+				// the spare slot reserved by reserveArray() takes the synth, the null UGen from it is freed with the command
+				array.swapIn(command.ugens->ugen);
+				num_added++;
+				break;
+				
+			case Command::Remove:
+				array.swapOut(command.ugens->ugen, command.ugens->source);
+				break;
+				
+			case Command::Release:
+				command.ugens->ugen.release();
+				break;
+				
+			case Command::SetControl:
+				*command.control = command.value;
+				break;
+				
+			case Command::ReplaceSource:
+				command.ugens->ugen.setSource(command.ugens->source, command.release_previous, command.fade_time);
+				break;
+				
+			case Command::SetRenderer:
+				renderer = command.renderer;
+				break;
+				
+			case Command::ReserveArray:
+				// move the synths into the larger storage from reserveArray() and hand the old storage back to be freed,
+				// the old slots are left holding the null UGens from the new ones
+				for (int i = 0; i < array.size(); i++)
+					command.storage->swapIn(array[i]);
+				
+				array.swapStorage(*command.storage);
+				
+				// the control side frees these on each play() so the fifo shouldn't fill up, but don't leak if it does
+				if (!retired_arrays.push(command.storage))
+					delete command.storage;
+				break;
+				
+			default:
+				break;
+		}
+		
+		// the BackgroundDeleter frees these (and any synth swapped into them) on its own thread
+		if (command.ugens)
+			command.ugens->decrementRefCount();
+	}
+	
+	if (num_added)
+	{
+		atomicSet(num_playing, array.size());
+		atomicSet(num_adds_received, num_adds_received + num_added);
+	}
+}
+
+void Server::reserveArray(int size)
+{
+	// free the storage the audio thread has finished with
+	UGenArray *storage;
+	while (retired_arrays.pop(storage))
+		delete storage;
+	
+	if (size <= array_capacity)
+		return;
+	
+	// leave some headroom so adding one synth at a time doesn't reallocate every time
+	array_capacity = size * 2;
+	
+	if (output_buffer == NULL)
+	{
+		// no audio thread yet
+		array.reserve(array_capacity);
+		return;
+	}
+	
+	Command command;
+	command.type = Command::ReserveArray;
+	command.storage = new UGenArray;
+	command.storage->reserve(array_capacity);
+	enqueue(command);
+}
+
+int Server::getNumPlayingEstimate() const
+{
+	// read the count first, num_playing then includes at least the adds it counts
+	const int num_pending = num_adds_sent - atomicGet(num_adds_received);
+	return atomicGet(num_playing) + num_pending;
+}
@@ -5,7 +5,9 @@
 #include "UGen.h"
 
 #include "ofxUGenUtils.h"
+#include "ofxUGenParallelRenderer.h"
 
+// the audio thread never takes this lock, it only serialises threads sending commands to the Server
 #define OFXUGEN_SCOPED_LOCK ofxUGen::ScopedLock __lock__(Server::get().mutex)
 
 namespace ofxUGen
@@ -29,6 +31,45 @@ class ofxUGen::Server : public ofBaseSoundInput, public ofBaseSoundOutput
 	Server(const Server &);
 	Server& operator=(const Server&);
 	
+	// the UGens a command refers to, copied on the control thread and handed to the BackgroundDeleter
+	// by the audio thread, which only swaps UGens so it never new[]s or delete[]s their internals
+	class CommandUGens : public SmartPointer
+	{
+	public:
+		
+		CommandUGens(const UGen &ugen, const UGen &source = UGen::getNull()) : ugen(ugen), source(source) {}
+		
+		UGen ugen;
+		UGen source; // the new source of a Plug, or receives the synth a Remove takes out of the array
+	};
+	
+	// control messages are queued in a lock-free fifo and run at the start of the next audio block
+	struct Command
+	{
+		enum Type
+		{
+			None,
+			Add,
+			Remove,
+			Release,
+			SetControl,
+			ReplaceSource,
+			SetRenderer,
+			ReserveArray
+		};
+		
+		Command() : type(None), ugens(NULL), control(NULL), value(0), release_previous(false), fade_time(0), renderer(NULL), storage(NULL) {}
+		
+		Type type;
+		CommandUGens *ugens;
+		float *control;
+		float value;
+		bool release_previous;
+		float fade_time;
+		ParallelRenderer *renderer;
+		UGenArray *storage;
+	};
+	
 public:
 	
 	static Server& get();
@@ -46,26 +87,73 @@ public:
 	void lock() { mutex.lock(); }
 	void unlock() { mutex.unlock(); }
 
-	void play(UGen &ugen)
-	{
-		OFXUGEN_SCOPED_LOCK;
-		array.add(ugen);
-	}
+	// render the synths on num_threads cores (including the audio thread), 1 renders everything on the audio thread
+	void setNumRenderThreads(int num_threads);
+	int getNumRenderThreads() const { return num_render_threads; }
+	
+	// evaluate the chains of arithmetic operators in each graph passed to play() as single nodes (see UGen::fuse)
+	// play() replaces the graph with its fused version so pass the same UGen to stop() and release()
+	void setFuseGraphs(bool yn) { fuse_graphs = yn; }
+	bool getFuseGraphs() const { return fuse_graphs; }
+	
+	// map the intermediate results of each graph passed to play() onto a few shared blocks (see UGen::shareOutputBlocks)
+	void setShareOutputBlocks(bool yn) { share_output_blocks = yn; }
+	bool getShareOutputBlocks() const { return share_output_blocks; }
+
+	// these never block the audio thread, they take effect at the start of the next block
+	void play(UGen &ugen);
+	void stop(UGen &ugen);
+	void release(UGen &ugen);
 	
-	void stop(UGen &ugen)
-	{
-		OFXUGEN_SCOPED_LOCK;
-		array.removeItem(ugen);
-	}
+	// write a value read by a UGen(float const*) control, all the values sent before a block change together
+	void setControl(float *control, float value);
+	
+	// set the source of a Plug
+	void setSource(UGen &plug, const UGen &source, bool release_previous = false, float fade_time = 0);
+	
+	// finished synths are deleted on this thread rather than the audio thread
+	const BackgroundDeleter& getDeleter() const { return deleter; }
 
 protected:
 	
+	void send(const Command &command);
+	void enqueue(const Command &command); // the caller must hold the lock
+	void processCommands();
+	void reserveArray(int size); // the caller must hold the lock
+	int getNumPlayingEstimate() const; // the caller must hold the lock
+	
+	BackgroundDeleter deleter;
+	
 	ofSoundStream stream;
 	BufferBlock *output_buffer;
+	ParallelRenderer *renderer;
+	ParallelRenderer *latest_renderer; // the renderer last sent to the audio thread, only used under the lock
+	int num_render_threads;
+	bool fuse_graphs;
+	bool share_output_blocks;
+	
+	int num_output;
+	int buffer_size;
 	
 	UGenArray array;
 	Mix out;
 	
+	LockFreeFifo<Command> commands;
+	
+	// array storage replaced by a ReserveArray command, the audio thread hands it back here to be freed
+	LockFreeFifo<UGenArray*> retired_arrays;
+	int array_capacity;
+	
+	volatile int num_blocks_rendered;
+	
+	// published by the audio thread after running the commands so the control side can reserve space for the synths
+	volatile int num_playing;
+	volatile int num_adds_received;
+	int num_adds_sent;
+	
+	// renderers which the audio thread may still have been using when they were replaced
+	vector<ParallelRenderer*> retired_renderers;
+	
 	ofMutex mutex;
 };
 
@@ -73,7 +161,7 @@ class ofxUGen::SynthDef : public DoneActionReceiver
 {
 public:
 	
-	SynthDef()
+	SynthDef() : done(0)
 	{
 		Server::get();
 	}
@@ -95,17 +183,20 @@ public:
 	
 	void release()
 	{
-		OFXUGEN_SCOPED_LOCK;
-		out.release();
+		Server::get().release(out);
 	}
 	
+	// called on the audio thread
 	void handleDone(const int senderUserData)
 	{
-		out = UGen::getNull();
+		atomicSet(done, 1);
 	}
 	
 	bool isAlive()
 	{
+		if (atomicGet(done))
+			out = UGen::getNull();
+		
 		return !Out().isNull();
 	}
 
@@ -113,7 +204,6 @@ protected:
 	
 	void Out(const UGen &ugen)
 	{
-		OFXUGEN_SCOPED_LOCK;
 		out = ugen;
 	}
 	
@@ -122,6 +212,7 @@ protected:
 private:
 	
 	UGen out;
+	volatile int done;
 };
 
 namespace ofxUGen
@@ -0,0 +1,292 @@
+#include "ofxUGenParallelRenderer.h"
+
+#include "Poco/Thread.h"
+
+using namespace ofxUGen;
+
+class ParallelRenderer::Worker : public ofThread
+{
+public:
+
+	Worker(ParallelRenderer *renderer, int index) : renderer(renderer), index(index), start(false) {}
+
+	void begin() { start.set(); }
+
+	void exit()
+	{
+		stopThread();
+		start.set();
+		waitForThread(false);
+	}
+
+protected:
+
+	void threadedFunction()
+	{
+		BackgroundThread::setAudioThread();
+
+		while (true)
+		{
+			start.wait();
+
+			if (!isThreadRunning())
+				break;
+
+			renderer->joinBlock(index);
+		}
+	}
+
+private:
+
+	ParallelRenderer *renderer;
+	int index;
+	Poco::Event start;
+};
+
+
+#pragma mark - ParallelRenderer
+
+ParallelRenderer::ParallelRenderer(int num_threads)
+	: num_workers(max(num_threads, 1)),
+	  ranges(num_workers),
+	  scratch(NULL),
+	  incoming_scratch(NULL),
+	  retired_scratch(NULL),
+	  reserved_size(0),
+	  tasks(NULL),
+	  num_tasks(0),
+	  buffer_size(0),
+	  num_channels(0),
+	  block_id(0),
+	  generation(0),
+	  open_generation(0),
+	  num_active(0),
+	  num_completed(0),
+	  done(true)
+{
+	// worker 0 is the audio thread itself
+	for (int i = 1; i < num_workers; i++)
+	{
+		Worker *worker = new Worker(this, i);
+		worker->startThread(false, false);
+		workers.push_back(worker);
+	}
+}
+
+ParallelRenderer::~ParallelRenderer()
+{
+	for (int i = 0; i < workers.size(); i++)
+	{
+		workers[i]->exit();
+		delete workers[i];
+	}
+
+	workers.clear();
+
+	delete scratch;
+	delete (Scratch*)incoming_scratch;
+	delete (Scratch*)retired_scratch;
+}
+
+void ParallelRenderer::reserve(int num_tasks, int buffer_size, int num_channels)
+{
+	// delete the scratch the audio thread has finished with
+	Scratch *retired = (Scratch*)atomicGetPtr(retired_scratch);
+
+	if (retired && atomicCompareAndSwapPtr(retired_scratch, retired, NULL))
+		delete retired;
+
+	size_t size = (size_t)num_tasks * buffer_size * num_channels;
+
+	if (size <= reserved_size)
+		return;
+
+	// leave some headroom so adding one synth at a time doesn't reallocate every time
+	reserved_size = size * 2;
+	Scratch *replacement = new Scratch(reserved_size);
+
+	// replace any scratch the audio thread hasn't picked up yet
+	void *pending;
+
+	do
+	{
+		pending = atomicGetPtr(incoming_scratch);
+	}
+	while (!atomicCompareAndSwapPtr(incoming_scratch, pending, replacement));
+
+	delete (Scratch*)pending;
+}
+
+void ParallelRenderer::swapScratch()
+{
+	// wait until reserve() has deleted the last one before handing back another
+	if (atomicGetPtr(retired_scratch) != NULL)
+		return;
+
+	Scratch *replacement = (Scratch*)atomicGetPtr(incoming_scratch);
+
+	if (replacement == NULL || !atomicCompareAndSwapPtr(incoming_scratch, replacement, NULL))
+		return;
+
+	atomicSetPtr(retired_scratch, scratch);
+	scratch = replacement;
+}
+
+void ParallelRenderer::process(UGenArray &array, float **output, int buffer_size, int num_channels, unsigned int block_id)
+{
+	array.removeNulls();
+
+	// prepare serially, this is where done actions are sent and finished graphs are set to null
+	const int size = array.size();
+	for (int i = 0; i < size; i++)
+		array[i].prepareForBlock(buffer_size, block_id, -1);
+
+	swapScratch();
+
+	// anything which doesn't fit in the scratch reserved so far is rendered serially below
+	const int task_size = buffer_size * num_channels;
+	const int num_allocated_tasks = scratch ? scratch->samples.size() / max(task_size, 1) : 0;
+	const int num_parallel = min(size, num_allocated_tasks);
+
+	// no worker is inside runWorker() while the block is closed so all this is written before it's opened
+	this->tasks = array.getArray();
+	this->num_tasks = num_parallel;
+	this->buffer_size = buffer_size;
+	this->num_channels = num_channels;
+	this->block_id = block_id;
+
+	if (num_parallel > 0)
+	{
+		// reset the counter before the ranges are published so no completion from this block is lost
+		atomicSet(num_completed, 0);
+		done.reset();
+
+		// split the tasks into contiguous ranges, one for each worker
+		for (int w = 0; w < num_workers; w++)
+		{
+			ranges[w].next = (num_parallel * w) / num_workers;
+			ranges[w].end = (num_parallel * (w + 1)) / num_workers;
+		}
+
+		// zero means closed so the generations run from 1 and wrap back to 1
+		generation = (generation % 0x7FFFFFFF) + 1;
+
+		atomicSet(open_generation, generation);
+
+		for (int i = 0; i < workers.size(); i++)
+			workers[i]->begin();
+
+		runWorker(0);
+
+		done.wait();
+
+		// close the block then wait for any worker which joined it to leave, one woken late
+		// by an earlier begin() sees it closed and goes back to sleep without touching anything
+		atomicSet(open_generation, 0);
+
+		while (atomicGet(num_active) != 0)
+			Poco::Thread::yield();
+	}
+
+	// sum in array order so the mix is the same whichever thread rendered each task
+	for (int c = 0; c < num_channels; c++)
+	{
+		float *dst = output[c];
+		memset(dst, 0, sizeof(float) * buffer_size);
+
+		for (int i = 0; i < num_parallel; i++)
+		{
+			const float *src = &scratch->samples[i * task_size + c * buffer_size];
+			for (int n = 0; n < buffer_size; n++)
+				dst[n] += src[n];
+		}
+	}
+
+	for (int i = num_parallel; i < size; i++)
+		renderSerially(array[i], output);
+
+	this->tasks = NULL;
+}
+
+bool ParallelRenderer::claimTask(int range_index, int &task_index)
+{
+	Range &range = ranges[range_index];
+
+	if (atomicGet(range.next) >= range.end)
+		return false;
+
+	task_index = atomicIncrement(range.next) - 1;
+	return task_index < range.end;
+}
+
+void ParallelRenderer::joinBlock(int worker_index)
+{
+	// count ourselves in before looking so process() can't close the block and return under us
+	atomicIncrement(num_active);
+
+	// zero if the block has closed, e.g., woken by a begin() from a block already finished without us
+	const int joined_generation = atomicGet(open_generation);
+
+	if (joined_generation != 0)
+		runWorker(worker_index);
+
+	atomicDecrement(num_active);
+}
+
+void ParallelRenderer::runWorker(int worker_index)
+{
+	int task_index;
+
+	for (int i = 0; i < num_workers; i++)
+	{
+		// start with our own range then steal from the others
+		const int range_index = (worker_index + i) % num_workers;
+
+		while (claimTask(range_index, task_index))
+		{
+			renderTask(task_index);
+
+			if (atomicIncrement(num_completed) == num_tasks)
+				done.set();
+		}
+	}
+}
+
+void ParallelRenderer::renderTask(int task_index)
+{
+	UGen &ugen = tasks[task_index];
+	float *dst = &scratch->samples[task_index * buffer_size * num_channels];
+
+	for (int c = 0; c < num_channels; c++)
+	{
+		if (ugen.isNull(c))
+		{
+			memset(dst, 0, sizeof(float) * buffer_size);
+		}
+		else
+		{
+			// as Mix(array, false) does, a graph with fewer channels wraps around
+			bool should_delete = false;
+			const float *src = ugen.processBlock(should_delete, block_id, c);
+			memcpy(dst, src, sizeof(float) * buffer_size);
+		}
+
+		dst += buffer_size;
+	}
+}
+
+void ParallelRenderer::renderSerially(UGen &ugen, float **output)
+{
+	for (int c = 0; c < num_channels; c++)
+	{
+		if (ugen.isNull(c))
+			continue;
+
+		bool should_delete = false;
+		const float *src = ugen.processBlock(should_delete, block_id, c);
+
+		float *dst = output[c];
+		for (int n = 0; n < buffer_size; n++)
+			dst[n] += src[n];
+	}
+}
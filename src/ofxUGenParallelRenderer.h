@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "UGen.h"
+
+#include "Poco/Event.h"
+
+namespace ofxUGen
+{
+	class ParallelRenderer;
+}
+
+/*
+ Renders the top level UGens added with Server::play() on several cores.
+
+ Each UGen in the array is a task. Tasks are split into contiguous ranges, one per
+ worker (the audio callback thread is worker 0), and a worker which runs out of
+ its own tasks steals from the other ranges. Every task renders into its own
+ scratch block and the blocks are summed in array order at the end so the result
+ doesn't depend on which thread rendered which task.
+
+ Preparation (done actions, deletion, removing nulls) still happens serially on
+ the audio thread, only processBlock() runs in parallel. The scratch blocks are
+ allocated by reserve() on the control thread and picked up at the start of the
+ next block, tasks beyond what has been reserved are rendered serially instead. UGen graphs are not thread
+ safe so the synths must not share UGen instances with each other (e.g., a single
+ LFO feeding several voices) when this is enabled.
+ */
+class ofxUGen::ParallelRenderer
+{
+	class Worker;
+
+public:
+
+	ParallelRenderer(int num_threads);
+	~ParallelRenderer();
+
+	int getNumThreads() const { return num_workers; }
+
+	// make sure the scratch blocks for num_tasks are allocated, only call this from one control thread at a time
+	void reserve(int num_tasks, int buffer_size, int num_channels);
+
+	void process(UGenArray &array, float **output, int buffer_size, int num_channels, unsigned int block_id);
+
+private:
+
+	struct Range
+	{
+		volatile int next;
+		int end;
+	};
+
+	struct Scratch
+	{
+		Scratch(size_t size) : samples(size, 0) {}
+		vector<float> samples;
+	};
+
+	void joinBlock(int worker_index);
+	void runWorker(int worker_index);
+	bool claimTask(int range_index, int &task_index);
+	void renderTask(int task_index);
+	void renderSerially(UGen &ugen, float **output);
+	void swapScratch();
+
+	int num_workers;
+	vector<Worker*> workers;
+	vector<Range> ranges;
+
+	// only the audio thread uses scratch, reserve() hands it a larger one through incoming_scratch
+	// and the audio thread hands the old one back through retired_scratch to be deleted by reserve()
+	Scratch *scratch;
+	void * volatile incoming_scratch;
+	void * volatile retired_scratch;
+	size_t reserved_size;
+
+	// state for the current block
+	UGen *tasks;
+	int num_tasks;
+	int buffer_size;
+	int num_channels;
+	unsigned int block_id;
+
+	// each block is tagged with a generation which is only open while process() is waiting for it,
+	// num_active counts the workers inside joinBlock() so process() can wait for them to leave
+	int generation;
+	volatile int open_generation;
+	volatile int num_active;
+	volatile int num_completed;
+	Poco::Event done;
+};